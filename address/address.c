@@ -0,0 +1,440 @@
+/**
+ * @file address.c
+ * @brief Bitcoin mainnet addresses and scriptPubKeys.
+ * @details Bech32 and bech32m follow BIP-173 and BIP-350.
+ */
+#include "address.h"
+
+#include <string.h>
+
+#include <openssl/sha.h>
+
+/** @brief Base58 alphabet */
+static const char BASE58_ALPHABET[] =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/** @brief Bech32 data character set */
+static const char BECH32_CHARSET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+/** @brief Human readable part of mainnet segwit addresses */
+#define SEGWIT_HRP "bc"
+
+/** @brief Final XOR constants of bech32 (witness v0) and bech32m (v1+) */
+#define BECH32_CONST 1u
+#define BECH32M_CONST 0x2bc830a3u
+
+/** @brief Base58Check version bytes */
+#define P2PKH_VERSION 0x00
+#define P2SH_VERSION 0x05
+
+uint32_t address_purpose(address_type type) {
+    switch (type) {
+        case ADDRESS_P2PKH: return 44;
+        case ADDRESS_P2SH_P2WPKH: return 49;
+        case ADDRESS_P2WPKH: return 84;
+        default: return 86;
+    }
+}
+
+// ============ BASE58CHECK ============
+
+/**
+ * @brief Base58Check-encodes a version byte and 20-byte payload.
+ * @param version Version byte.
+ * @param payload 20-byte hash.
+ * @param out Output buffer.
+ * @param size Size of the output buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+static int base58check_encode(byte version, const byte *payload, char *out, size_t size) {
+    byte raw[25];
+    byte checksum[32];
+    raw[0] = version;
+    memcpy(raw + 1, payload, 20);
+    SHA256(raw, 21, checksum);
+    SHA256(checksum, 32, checksum);
+    memcpy(raw + 21, checksum, 4);
+
+    byte encoded[64];
+    size_t len = base58_encode(encoded, raw, sizeof(raw));
+    if (len == 0 || len + 1 > size) {
+        return ERROR_INVALID_LENGTH;
+    }
+    memcpy(out, encoded, len + 1);
+    return SUCCESS;
+}
+
+/**
+ * @brief Decodes a Base58Check string of exactly 25 bytes.
+ * @param in Base58 string.
+ * @param raw Output: version byte, 20-byte payload, 4-byte checksum.
+ * @return 0 on success, ERROR_INVALID_INPUT on bad characters, length or checksum.
+ */
+static int base58check_decode25(const char *in, byte raw[25]) {
+    size_t len = strlen(in);
+    if (len == 0 || len > 40) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    // Big-endian base-256 accumulator, multiplied by 58 per digit
+    byte acc[25] = {0};
+    for (size_t i = 0; i < len; i++) {
+        const char *pos = strchr(BASE58_ALPHABET, in[i]);
+        if (pos == NULL || in[i] == '\0') {
+            return ERROR_INVALID_INPUT;
+        }
+        uint32_t carry = (uint32_t)(pos - BASE58_ALPHABET);
+        for (int j = 24; j >= 0; j--) {
+            carry += 58u * acc[j];
+            acc[j] = carry & 0xFF;
+            carry >>= 8;
+        }
+        if (carry != 0) {
+            return ERROR_INVALID_INPUT;
+        }
+    }
+
+    // Leading '1's must match leading zero bytes exactly
+    size_t ones = 0;
+    while (in[ones] == '1') ones++;
+    size_t zeros = 0;
+    while (zeros < 25 && acc[zeros] == 0) zeros++;
+    if (ones != zeros) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte checksum[32];
+    SHA256(acc, 21, checksum);
+    SHA256(checksum, 32, checksum);
+    if (memcmp(checksum, acc + 21, 4) != 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    memcpy(raw, acc, 25);
+    return SUCCESS;
+}
+
+// ============ BECH32 ============
+
+/**
+ * @brief Bech32 checksum polymod.
+ * @param values 5-bit values.
+ * @param len Number of values.
+ * @return The polymod residue.
+ */
+static uint32_t bech32_polymod(const uint8_t *values, size_t len) {
+    static const uint32_t gen[5] = {0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3};
+    uint32_t chk = 1;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t top = chk >> 25;
+        chk = ((chk & 0x1ffffff) << 5) ^ values[i];
+        for (int j = 0; j < 5; j++) {
+            if ((top >> j) & 1) chk ^= gen[j];
+        }
+    }
+    return chk;
+}
+
+/**
+ * @brief Expands the "bc" HRP for checksumming, followed by the data.
+ * @param data 5-bit data values.
+ * @param data_len Number of data values.
+ * @param out Output (5 + data_len values).
+ * @return Number of values written.
+ */
+static size_t bech32_expand(const uint8_t *data, size_t data_len, uint8_t *out) {
+    static const char hrp[] = SEGWIT_HRP;
+    size_t n = 0;
+    for (size_t i = 0; i < 2; i++) out[n++] = (uint8_t)hrp[i] >> 5;
+    out[n++] = 0;
+    for (size_t i = 0; i < 2; i++) out[n++] = (uint8_t)hrp[i] & 31;
+    memcpy(out + n, data, data_len);
+    return n + data_len;
+}
+
+/**
+ * @brief Regroups bits (8 -> 5 with padding, or 5 -> 8 without).
+ * @param out Output values.
+ * @param out_len Output: number of values.
+ * @param to_bits Output group size.
+ * @param in Input values.
+ * @param in_len Number of input values.
+ * @param from_bits Input group size.
+ * @param pad Non-zero to pad the last group.
+ * @return 0 on success, ERROR_INVALID_INPUT on invalid padding.
+ */
+static int convert_bits(uint8_t *out, size_t *out_len, int to_bits,
+                        const uint8_t *in, size_t in_len, int from_bits, int pad) {
+    uint32_t acc = 0;
+    int bits = 0;
+    uint32_t maxv = (1u << to_bits) - 1;
+    size_t n = 0;
+    for (size_t i = 0; i < in_len; i++) {
+        acc = (acc << from_bits) | in[i];
+        bits += from_bits;
+        while (bits >= to_bits) {
+            bits -= to_bits;
+            out[n++] = (acc >> bits) & maxv;
+        }
+    }
+    if (pad) {
+        if (bits) out[n++] = (acc << (to_bits - bits)) & maxv;
+    } else if (bits >= from_bits || ((acc << (to_bits - bits)) & maxv)) {
+        return ERROR_INVALID_INPUT;
+    }
+    *out_len = n;
+    return SUCCESS;
+}
+
+/**
+ * @brief Encodes a segwit address.
+ * @param version Witness version (0-16).
+ * @param program Witness program.
+ * @param program_len Program length (2-40).
+ * @param out Output buffer.
+ * @param size Size of the output buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+static int segwit_encode(int version, const byte *program, size_t program_len,
+                         char *out, size_t size) {
+    uint8_t data[1 + 65 + 6];
+    size_t data_len = 0;
+    data[0] = (uint8_t)version;
+    convert_bits(data + 1, &data_len, 5, program, program_len, 8, 1);
+    data_len += 1;
+
+    uint8_t values[5 + sizeof(data)];
+    size_t n = bech32_expand(data, data_len, values);
+    memset(values + n, 0, 6);
+    uint32_t mod = bech32_polymod(values, n + 6) ^ (version ? BECH32M_CONST : BECH32_CONST);
+    for (int i = 0; i < 6; i++) {
+        data[data_len + i] = (mod >> (5 * (5 - i))) & 31;
+    }
+    data_len += 6;
+
+    if (3 + data_len + 1 > size) {
+        return ERROR_INVALID_LENGTH;
+    }
+    memcpy(out, SEGWIT_HRP "1", 3);
+    for (size_t i = 0; i < data_len; i++) {
+        out[3 + i] = BECH32_CHARSET[data[i]];
+    }
+    out[3 + data_len] = '\0';
+    return SUCCESS;
+}
+
+/**
+ * @brief Decodes a mainnet segwit address.
+ * @param address Address string (all lower or all upper case).
+ * @param version Output: witness version.
+ * @param program Output: witness program (40 bytes max).
+ * @param program_len Output: program length.
+ * @return 0 on success, ERROR_INVALID_INPUT for malformed addresses.
+ */
+static int segwit_decode(const char *address, int *version, byte *program,
+                         size_t *program_len) {
+    size_t len = strlen(address);
+    if (len < 14 || len > 90) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    int lower = 0, upper = 0;
+    char lowered[91];
+    for (size_t i = 0; i < len; i++) {
+        char c = address[i];
+        if (c >= 'a' && c <= 'z') lower = 1;
+        if (c >= 'A' && c <= 'Z') {
+            upper = 1;
+            c = (char)(c - 'A' + 'a');
+        }
+        lowered[i] = c;
+    }
+    lowered[len] = '\0';
+    if ((lower && upper) || strncmp(lowered, SEGWIT_HRP "1", 3) != 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint8_t data[90];
+    size_t data_len = len - 3;
+    for (size_t i = 0; i < data_len; i++) {
+        const char *pos = strchr(BECH32_CHARSET, lowered[3 + i]);
+        if (pos == NULL || lowered[3 + i] == '\0') {
+            return ERROR_INVALID_INPUT;
+        }
+        data[i] = (uint8_t)(pos - BECH32_CHARSET);
+    }
+
+    uint8_t values[5 + sizeof(data)];
+    size_t n = bech32_expand(data, data_len, values);
+    uint32_t residue = bech32_polymod(values, n);
+    int v = data[0];
+    if (v > 16 || residue != (v ? BECH32M_CONST : BECH32_CONST)) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint8_t prog[65];
+    size_t prog_len = 0;
+    if (convert_bits(prog, &prog_len, 8, data + 1, data_len - 7, 5, 0) != SUCCESS ||
+        prog_len < 2 || prog_len > 40 || (v == 0 && prog_len != 20 && prog_len != 32)) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    *version = v;
+    memcpy(program, prog, prog_len);
+    *program_len = prog_len;
+    return SUCCESS;
+}
+
+// ============ SCRIPTS ============
+
+int address_script_from_public_key(address_type type, const byte *public_key,
+                                   byte *script, size_t *script_len) {
+    if (public_key == NULL || script == NULL || script_len == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte pkh[20];
+    switch (type) {
+        case ADDRESS_P2PKH:
+            hash160(public_key, PUBLIC_KEY_LENGTH, pkh);
+            script[0] = 0x76;  // OP_DUP
+            script[1] = 0xa9;  // OP_HASH160
+            script[2] = 20;
+            memcpy(script + 3, pkh, 20);
+            script[23] = 0x88;  // OP_EQUALVERIFY
+            script[24] = 0xac;  // OP_CHECKSIG
+            *script_len = 25;
+            return SUCCESS;
+        case ADDRESS_P2SH_P2WPKH: {
+            byte redeem[22] = {0x00, 20};
+            hash160(public_key, PUBLIC_KEY_LENGTH, redeem + 2);
+            script[0] = 0xa9;  // OP_HASH160
+            script[1] = 20;
+            hash160(redeem, sizeof(redeem), script + 2);
+            script[22] = 0x87;  // OP_EQUAL
+            *script_len = 23;
+            return SUCCESS;
+        }
+        case ADDRESS_P2WPKH:
+            script[0] = 0x00;
+            script[1] = 20;
+            hash160(public_key, PUBLIC_KEY_LENGTH, script + 2);
+            *script_len = 22;
+            return SUCCESS;
+        case ADDRESS_P2TR:
+            script[0] = 0x51;  // OP_1
+            script[1] = 32;
+            *script_len = 34;
+            return taproot_output_key(public_key, script + 2);
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+int address_from_script(const byte *script, size_t script_len, char *out, size_t size) {
+    if (script == NULL || out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    if (script_len == 25 && script[0] == 0x76 && script[1] == 0xa9 &&
+        script[2] == 20 && script[23] == 0x88 && script[24] == 0xac) {
+        return base58check_encode(P2PKH_VERSION, script + 3, out, size);
+    }
+    if (script_len == 23 && script[0] == 0xa9 && script[1] == 20 && script[22] == 0x87) {
+        return base58check_encode(P2SH_VERSION, script + 2, out, size);
+    }
+    if (script_len >= 4 && script_len <= 42 &&
+        (script[0] == 0x00 || (script[0] >= 0x51 && script[0] <= 0x60)) &&
+        script[1] == script_len - 2) {
+        int version = script[0] == 0x00 ? 0 : script[0] - 0x50;
+        return segwit_encode(version, script + 2, script_len - 2, out, size);
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+int address_from_public_key(address_type type, const byte *public_key,
+                            char *out, size_t size) {
+    byte script[ADDRESS_MAX_SCRIPT_LENGTH];
+    size_t script_len = 0;
+    int result = address_script_from_public_key(type, public_key, script, &script_len);
+    if (result != SUCCESS) {
+        return result;
+    }
+    return address_from_script(script, script_len, out, size);
+}
+
+int address_to_script(const char *address, byte *script, size_t *script_len) {
+    if (address == NULL || script == NULL || script_len == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    if (strncmp(address, "bc1", 3) == 0 || strncmp(address, "BC1", 3) == 0) {
+        int version = 0;
+        byte program[40];
+        size_t program_len = 0;
+        if (segwit_decode(address, &version, program, &program_len) != SUCCESS) {
+            return ERROR_INVALID_INPUT;
+        }
+        script[0] = version ? (byte)(0x50 + version) : 0x00;
+        script[1] = (byte)program_len;
+        memcpy(script + 2, program, program_len);
+        *script_len = program_len + 2;
+        return SUCCESS;
+    }
+
+    byte raw[25];
+    if (base58check_decode25(address, raw) != SUCCESS) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (raw[0] == P2PKH_VERSION) {
+        script[0] = 0x76;
+        script[1] = 0xa9;
+        script[2] = 20;
+        memcpy(script + 3, raw + 1, 20);
+        script[23] = 0x88;
+        script[24] = 0xac;
+        *script_len = 25;
+        return SUCCESS;
+    }
+    if (raw[0] == P2SH_VERSION) {
+        script[0] = 0xa9;
+        script[1] = 20;
+        memcpy(script + 2, raw + 1, 20);
+        script[22] = 0x87;
+        *script_len = 23;
+        return SUCCESS;
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+int address_script_key(const byte *script, size_t script_len, byte *key) {
+    if (script == NULL || key == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    if (script_len == 25 && script[0] == 0x76 && script[1] == 0xa9 && script[2] == 20) {
+        memcpy(key, script + 3, 20);
+        return SUCCESS;
+    }
+    if (script_len == 23 && script[0] == 0xa9 && script[1] == 20) {
+        memcpy(key, script + 2, 20);
+        return SUCCESS;
+    }
+    if (script_len == 22 && script[0] == 0x00 && script[1] == 20) {
+        memcpy(key, script + 2, 20);
+        return SUCCESS;
+    }
+    if (script_len == 34 && (script[0] == 0x00 || script[0] == 0x51) && script[1] == 32) {
+        hash160(script + 2, 32, key);
+        return SUCCESS;
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+int address_public_key_key(address_type type, const byte *public_key, byte *key) {
+    byte script[ADDRESS_MAX_SCRIPT_LENGTH];
+    size_t script_len = 0;
+    int result = address_script_from_public_key(type, public_key, script, &script_len);
+    if (result != SUCCESS) {
+        return result;
+    }
+    return address_script_key(script, script_len, key);
+}
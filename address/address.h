@@ -0,0 +1,107 @@
+/**
+ * @file address.h
+ * @brief Bitcoin mainnet addresses and scriptPubKeys.
+ * @details Base58Check (P2PKH, P2SH) and bech32/bech32m (P2WPKH, P2TR)
+ *          encoding and decoding, plus the 20-byte match key used by the
+ *          address indexes.
+ */
+
+#ifndef ADDRESS_H
+#define ADDRESS_H
+
+#include "../hdkey/hdkey.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Buffer size that fits any address produced here */
+#define ADDRESS_MAX_LENGTH 91
+
+/** @brief Largest scriptPubKey produced or decoded here (segwit v1) */
+#define ADDRESS_MAX_SCRIPT_LENGTH 42
+
+/** @brief Size of an index match key */
+#define ADDRESS_KEY_LENGTH 20
+
+/** @brief Single-key output types, one per BIP purpose */
+typedef enum {
+    ADDRESS_P2PKH,       ///< 1..., BIP-44
+    ADDRESS_P2SH_P2WPKH, ///< 3..., BIP-49
+    ADDRESS_P2WPKH,      ///< bc1q..., BIP-84
+    ADDRESS_P2TR         ///< bc1p..., BIP-86
+} address_type;
+
+/**
+ * @brief BIP purpose (44, 49, 84 or 86) of an address type.
+ * @param type Address type.
+ * @return The purpose number.
+ */
+uint32_t address_purpose(address_type type);
+
+/**
+ * @brief Builds the scriptPubKey paying to a public key.
+ * @param type Output type.
+ * @param public_key 33-byte compressed public key.
+ * @param script Output buffer (ADDRESS_MAX_SCRIPT_LENGTH bytes).
+ * @param script_len Output: script length.
+ * @return 0 on success, negative error code on failure.
+ */
+int address_script_from_public_key(address_type type, const byte *public_key,
+                                   byte *script, size_t *script_len);
+
+/**
+ * @brief Encodes a scriptPubKey as an address.
+ * @param script scriptPubKey (P2PKH, P2SH or segwit v0-v16).
+ * @param script_len Script length.
+ * @param out Output buffer (ADDRESS_MAX_LENGTH bytes).
+ * @param size Size of the output buffer.
+ * @return 0 on success, ERROR_INVALID_INPUT for scripts without an address.
+ */
+int address_from_script(const byte *script, size_t script_len, char *out, size_t size);
+
+/**
+ * @brief Encodes the address paying to a public key.
+ * @param type Output type.
+ * @param public_key 33-byte compressed public key.
+ * @param out Output buffer (ADDRESS_MAX_LENGTH bytes).
+ * @param size Size of the output buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+int address_from_public_key(address_type type, const byte *public_key,
+                            char *out, size_t size);
+
+/**
+ * @brief Decodes a mainnet address into its scriptPubKey.
+ * @param address Base58Check or bech32/bech32m address.
+ * @param script Output buffer (ADDRESS_MAX_SCRIPT_LENGTH bytes).
+ * @param script_len Output: script length.
+ * @return 0 on success, ERROR_INVALID_INPUT for malformed addresses.
+ */
+int address_to_script(const char *address, byte *script, size_t *script_len);
+
+/**
+ * @brief Reduces a scriptPubKey to its 20-byte match key.
+ * @param script scriptPubKey.
+ * @param script_len Script length.
+ * @param key Output, ADDRESS_KEY_LENGTH bytes.
+ * @return 0 on success, ERROR_INVALID_INPUT for unsupported scripts.
+ * @note P2PKH and P2WPKH give the pubkey hash (so both match the same key),
+ *       P2SH the script hash, 32-byte witness programs HASH160(program).
+ */
+int address_script_key(const byte *script, size_t script_len, byte *key);
+
+/**
+ * @brief Match key of the output of a given type paying to a public key.
+ * @param type Output type.
+ * @param public_key 33-byte compressed public key.
+ * @param key Output, ADDRESS_KEY_LENGTH bytes.
+ * @return 0 on success, negative error code on failure.
+ */
+int address_public_key_key(address_type type, const byte *public_key, byte *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADDRESS_H
@@ -0,0 +1,473 @@
+/**
+ * @file addrmatch.c
+ * @brief Offline matching of derived addresses against a local address set.
+ */
+#include "addrmatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <openssl/crypto.h>
+
+#include "../hdkey/hdbatch.h"
+
+/** @brief Addresses derived per batch while walking a chain */
+#define ADDRMATCH_CHUNK 64
+
+/** @brief Size of one bloom block in 64-bit words (512 bits, one cache line) */
+#define BLOOM_BLOCK_WORDS 8
+
+// ============ BLOOM FILTER ============
+
+/**
+ * @brief Loads 8 bytes big-endian.
+ */
+static uint64_t load_be64(const byte *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+/**
+ * @brief Picks the bloom block of a key.
+ * @details Keys are already hashes, so bytes 0-7 select the block (by
+ *          multiply-shift range reduction) and bytes 8-15 give the probes.
+ */
+static uint64_t bloom_block(const byte *key, uint64_t blocks) {
+    return (uint64_t)(((unsigned __int128)load_be64(key) * blocks) >> 64);
+}
+
+/**
+ * @brief Sets the probe bits of a key in its block.
+ */
+static void bloom_add(uint64_t *bloom, uint64_t blocks, uint32_t k, const byte *key) {
+    uint64_t *block = bloom + bloom_block(key, blocks) * BLOOM_BLOCK_WORDS;
+    uint64_t probes = load_be64(key + 8);
+    for (uint32_t i = 0; i < k; i++) {
+        unsigned bit = (probes >> (9 * i)) & 511;
+        block[bit >> 6] |= 1ull << (bit & 63);
+    }
+}
+
+int addrmatch_maybe_contains(const addrmatch_index *index, const byte *key) {
+    if (index->count == 0) {
+        return 0;
+    }
+    const uint64_t *block = index->bloom + bloom_block(key, index->bloom_blocks) * BLOOM_BLOCK_WORDS;
+    uint64_t probes = load_be64(key + 8);
+    for (uint32_t i = 0; i < index->bloom_k; i++) {
+        unsigned bit = (probes >> (9 * i)) & 511;
+        if (!(block[bit >> 6] & (1ull << (bit & 63)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ============ SORTED INDEX ============
+
+int addrmatch_contains(const addrmatch_index *index, const byte *key) {
+    if (!addrmatch_maybe_contains(index, key)) {
+        return 0;
+    }
+
+    // Keys are uniformly distributed hashes: interpolate on the leading 64
+    // bits until the window is small, then finish with a binary search
+    uint64_t lo = 0, hi = index->count;  // candidate range [lo, hi)
+    uint64_t target = load_be64(key);
+    while (hi - lo > 32) {
+        uint64_t lo_key = load_be64(index->keys + lo * ADDRESS_KEY_LENGTH);
+        uint64_t hi_key = load_be64(index->keys + (hi - 1) * ADDRESS_KEY_LENGTH);
+        if (target < lo_key || target > hi_key) {
+            return 0;
+        }
+        uint64_t span = hi_key - lo_key;
+        uint64_t pos = lo;
+        if (span != 0) {
+            pos += (uint64_t)(((unsigned __int128)(target - lo_key) * (hi - 1 - lo)) / span);
+        }
+        int cmp = memcmp(index->keys + pos * ADDRESS_KEY_LENGTH, key, ADDRESS_KEY_LENGTH);
+        if (cmp == 0) {
+            return 1;
+        }
+        if (cmp < 0) {
+            lo = pos + 1;
+        } else {
+            hi = pos;
+        }
+        if (span == 0) {
+            break;
+        }
+    }
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        int cmp = memcmp(index->keys + mid * ADDRESS_KEY_LENGTH, key, ADDRESS_KEY_LENGTH);
+        if (cmp == 0) {
+            return 1;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+// ============ BUILDING ============
+
+static int compare_keys(const void *a, const void *b) {
+    return memcmp(a, b, ADDRESS_KEY_LENGTH);
+}
+
+/**
+ * @brief Decodes an even-length hex string.
+ * @return Number of bytes, or 0 if the string is not hex or too long.
+ */
+static size_t parse_hex(const char *hex, byte *out, size_t max) {
+    size_t len = strlen(hex);
+    if (len == 0 || len % 2 != 0 || len / 2 > max) {
+        return 0;
+    }
+    for (size_t i = 0; i < len / 2; i++) {
+        unsigned int value;
+        if (!isxdigit((unsigned char)hex[2 * i]) || !isxdigit((unsigned char)hex[2 * i + 1]) ||
+            sscanf(hex + 2 * i, "%2x", &value) != 1) {
+            return 0;
+        }
+        out[i] = (byte)value;
+    }
+    return len / 2;
+}
+
+/**
+ * @brief Turns one input line into a match key.
+ * @return 0 on success, ERROR_INVALID_INPUT for unsupported entries.
+ */
+static int line_to_key(const char *line, byte *key) {
+    byte script[ADDRESS_MAX_SCRIPT_LENGTH];
+    size_t script_len = 0;
+
+    if (address_to_script(line, script, &script_len) == SUCCESS) {
+        return address_script_key(script, script_len, key);
+    }
+    script_len = parse_hex(line, script, sizeof(script));
+    if (script_len == ADDRESS_KEY_LENGTH) {
+        memcpy(key, script, ADDRESS_KEY_LENGTH);
+        return SUCCESS;
+    }
+    if (script_len > 0) {
+        return address_script_key(script, script_len, key);
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+int addrmatch_build(FILE *in, const char *path, uint64_t *count, uint64_t *skipped) {
+    if (in == NULL || path == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    size_t capacity = 1 << 16;
+    size_t n = 0;
+    uint64_t bad = 0;
+    byte *keys = malloc(capacity * ADDRESS_KEY_LENGTH);
+    if (keys == NULL) {
+        return ERROR_INTERNAL;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        char *start = line;
+        while (isspace((unsigned char)*start)) start++;
+        start[strcspn(start, " \t\r\n,")] = '\0';
+        if (start[0] == '\0' || start[0] == '#') {
+            continue;
+        }
+        if (n == capacity) {
+            byte *grown = realloc(keys, 2 * capacity * ADDRESS_KEY_LENGTH);
+            if (grown == NULL) {
+                free(keys);
+                return ERROR_INTERNAL;
+            }
+            keys = grown;
+            capacity *= 2;
+        }
+        if (line_to_key(start, keys + n * ADDRESS_KEY_LENGTH) == SUCCESS) {
+            n++;
+        } else {
+            bad++;
+        }
+    }
+
+    qsort(keys, n, ADDRESS_KEY_LENGTH, compare_keys);
+    size_t unique = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (unique == 0 || memcmp(keys + (unique - 1) * ADDRESS_KEY_LENGTH,
+                                  keys + i * ADDRESS_KEY_LENGTH, ADDRESS_KEY_LENGTH) != 0) {
+            memmove(keys + unique * ADDRESS_KEY_LENGTH, keys + i * ADDRESS_KEY_LENGTH,
+                    ADDRESS_KEY_LENGTH);
+            unique++;
+        }
+    }
+
+    addrmatch_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ADDRMATCH_MAGIC, sizeof(header.magic));
+    header.version = ADDRMATCH_VERSION;
+    header.key_size = ADDRESS_KEY_LENGTH;
+    header.count = unique;
+    header.bloom_offset = (sizeof(header) + (uint64_t)unique * ADDRESS_KEY_LENGTH + 63) & ~(uint64_t)63;
+    header.bloom_blocks = ((uint64_t)unique * ADDRMATCH_BLOOM_BITS_PER_KEY + 511) / 512;
+    if (header.bloom_blocks == 0) {
+        header.bloom_blocks = 1;
+    }
+    header.bloom_k = ADDRMATCH_BLOOM_K;
+
+    hugepage_region bloom_region;
+    if (hugepage_alloc(&bloom_region, header.bloom_blocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t),
+                       HUGEPAGE_HUGETLB) != HUGEPAGE_OK) {
+        free(keys);
+        return ERROR_INTERNAL;
+    }
+    uint64_t *bloom = bloom_region.base;
+    for (size_t i = 0; i < unique; i++) {
+        bloom_add(bloom, header.bloom_blocks, header.bloom_k, keys + i * ADDRESS_KEY_LENGTH);
+    }
+
+    int result = SUCCESS;
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) {
+        result = ERROR_INVALID_INPUT;
+    } else {
+        static const byte zeros[64];
+        size_t body = sizeof(header) + unique * ADDRESS_KEY_LENGTH;
+        if (fwrite(&header, sizeof(header), 1, out) != 1 ||
+            fwrite(keys, ADDRESS_KEY_LENGTH, unique, out) != unique ||
+            fwrite(zeros, 1, header.bloom_offset - body, out) != header.bloom_offset - body ||
+            fwrite(bloom, BLOOM_BLOCK_WORDS * sizeof(uint64_t), header.bloom_blocks, out) !=
+                header.bloom_blocks) {
+            result = ERROR_INTERNAL;
+        }
+        if (fclose(out) != 0) {
+            result = ERROR_INTERNAL;
+        }
+    }
+
+    hugepage_free(&bloom_region);
+    free(keys);
+    if (result == SUCCESS) {
+        if (count) *count = unique;
+        if (skipped) *skipped = bad;
+    }
+    return result;
+}
+
+// ============ MAPPING ============
+
+int addrmatch_open(addrmatch_index *index, const char *path) {
+    if (index == NULL || path == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(index, 0, sizeof(*index));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(addrmatch_header)) {
+        close(fd);
+        return ERROR_INVALID_INPUT;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return ERROR_INTERNAL;
+    }
+
+    const addrmatch_header *header = map;
+    uint64_t size = (uint64_t)st.st_size;
+    if (memcmp(header->magic, ADDRMATCH_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ADDRMATCH_VERSION || header->key_size != ADDRESS_KEY_LENGTH ||
+        header->bloom_k == 0 || header->bloom_k > ADDRMATCH_BLOOM_K ||
+        header->bloom_blocks == 0 || header->bloom_offset % 64 != 0 ||
+        header->count > (size - sizeof(*header)) / ADDRESS_KEY_LENGTH ||
+        header->bloom_offset < sizeof(*header) + header->count * ADDRESS_KEY_LENGTH ||
+        header->bloom_offset > size ||
+        header->bloom_blocks > (size - header->bloom_offset) / (BLOOM_BLOCK_WORDS * sizeof(uint64_t))) {
+        munmap(map, (size_t)st.st_size);
+        return ERROR_INVALID_INPUT;
+    }
+
+    // Lookups are random: skip readahead of neighbouring pages
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+
+    index->map = map;
+    index->map_size = (size_t)st.st_size;
+    index->keys = (const byte *)map + sizeof(*header);
+    index->count = header->count;
+    index->bloom = (const uint64_t *)((const byte *)map + header->bloom_offset);
+    index->bloom_blocks = header->bloom_blocks;
+    index->bloom_k = header->bloom_k;
+
+    // Bloom probes are random: a large filter goes onto huge pages
+    size_t bloom_size = (size_t)header->bloom_blocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+    if (bloom_size >= HUGEPAGE_SIZE &&
+        hugepage_alloc(&index->bloom_copy, bloom_size, HUGEPAGE_HUGETLB) == HUGEPAGE_OK) {
+        if (index->bloom_copy.backing == HUGEPAGE_NONE) {
+            hugepage_free(&index->bloom_copy);
+        } else {
+            memcpy(index->bloom_copy.base, index->bloom, bloom_size);
+            index->bloom = index->bloom_copy.base;
+        }
+    }
+    return SUCCESS;
+}
+
+void addrmatch_close(addrmatch_index *index) {
+    if (index == NULL || index->map == NULL) {
+        return;
+    }
+    hugepage_free(&index->bloom_copy);
+    munmap((void *)index->map, index->map_size);
+    memset(index, 0, sizeof(*index));
+}
+
+// ============ GAP-LIMIT SCAN ============
+
+/**
+ * @brief Walks one chain of an account until `gap` consecutive misses.
+ * @param chain Single-key batch holding the chain key (m/purpose'/0'/account'/chain).
+ * @param addrs Scratch batch with capacity ADDRMATCH_CHUNK.
+ * @param hit Hit template; type, account and chain already set.
+ * @param used Output: non-zero if any address of the chain was found.
+ * @return 0 on success, callback value, or negative error code.
+ */
+static int scan_chain(const addrmatch_index *index, hdkey_batch *chain, hdkey_batch *addrs,
+                      uint32_t gap, addrmatch_hit *hit, addrmatch_hit_fn on_hit, void *ctx,
+                      addrmatch_stats *stats, int *used) {
+    byte keys[ADDRMATCH_CHUNK * ADDRESS_KEY_LENGTH];
+    uint64_t next_unused = 0;  // one past the last used index
+    uint64_t first = 0;
+
+    *used = 0;
+    while (first - next_unused < gap && first + ADDRMATCH_CHUNK <= BIP32_HARDENED) {
+        int result = hdkey_batch_derive_range(chain, 0, (uint32_t)first, ADDRMATCH_CHUNK, addrs);
+        if (result == SUCCESS) {
+            result = hdkey_batch_public_keys(addrs);
+        }
+        if (result != SUCCESS) {
+            return result;
+        }
+
+        // P2PKH and P2WPKH match on HASH160(pubkey) directly
+        if (hit->type == ADDRESS_P2PKH || hit->type == ADDRESS_P2WPKH) {
+            result = hdkey_batch_hash160(addrs, keys);
+        }
+        for (size_t i = 0; i < addrs->count && result == SUCCESS &&
+                           hit->type != ADDRESS_P2PKH && hit->type != ADDRESS_P2WPKH; i++) {
+            result = address_public_key_key(hit->type, addrs->public_keys + i * PUBLIC_KEY_LENGTH,
+                                            keys + i * ADDRESS_KEY_LENGTH);
+        }
+        if (result != SUCCESS) {
+            return result;
+        }
+
+        for (size_t i = 0; i < addrs->count; i++) {
+            uint32_t child = addrs->child_numbers[i];
+            if (child - next_unused >= gap) {
+                break;
+            }
+            const byte *key = keys + i * ADDRESS_KEY_LENGTH;
+            if (stats) stats->derived++;
+            if (!addrmatch_maybe_contains(index, key)) {
+                continue;
+            }
+            if (stats) stats->bloom_passes++;
+            if (!addrmatch_contains(index, key)) {
+                continue;
+            }
+            if (stats) stats->hits++;
+
+            next_unused = (uint64_t)child + 1;
+            *used = 1;
+            if (on_hit != NULL) {
+                hit->index = child;
+                result = address_from_public_key(hit->type, addrs->public_keys + i * PUBLIC_KEY_LENGTH,
+                                                 hit->address, sizeof(hit->address));
+                if (result == SUCCESS) {
+                    result = on_hit(hit, ctx);
+                }
+                if (result != SUCCESS) {
+                    return result;
+                }
+            }
+        }
+        first += ADDRMATCH_CHUNK;
+    }
+    return SUCCESS;
+}
+
+int addrmatch_scan(const addrmatch_index *index, const byte *private_key,
+                   const byte *chain_code, address_type type, uint32_t max_accounts,
+                   uint32_t gap, addrmatch_hit_fn on_hit, void *ctx,
+                   addrmatch_stats *stats) {
+    if (index == NULL || private_key == NULL || chain_code == NULL || gap == 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    hdkey_batch account, chain, addrs;
+    memset(&account, 0, sizeof(account));
+    memset(&chain, 0, sizeof(chain));
+    memset(&addrs, 0, sizeof(addrs));
+    int result = hdkey_batch_init(&account, 1);
+    if (result == SUCCESS) result = hdkey_batch_init(&chain, 1);
+    if (result == SUCCESS) result = hdkey_batch_init(&addrs, ADDRMATCH_CHUNK);
+
+    addrmatch_hit hit;
+    memset(&hit, 0, sizeof(hit));
+    hit.type = type;
+
+    for (uint32_t n = 0; n < max_accounts && result == SUCCESS; n++) {
+        uint32_t path[3] = {address_purpose(type) | BIP32_HARDENED, BIP32_HARDENED,
+                            n | BIP32_HARDENED};
+        uint32_t parent_fp = 0;
+        result = derive_bip32_path(private_key, chain_code, path, 3, account.private_keys,
+                                   account.chain_codes, &parent_fp);
+        if (result != SUCCESS) {
+            break;
+        }
+        account.count = 1;
+        account.depths[0] = 3;
+        account.child_numbers[0] = path[2];
+        account.parent_fingerprints[0] = parent_fp;
+        account.has_public_keys = 0;
+
+        int account_used = 0;
+        hit.account = n;
+        for (uint32_t c = 0; c < 2 && result == SUCCESS; c++) {
+            int chain_used = 0;
+            hit.chain = c;
+            result = hdkey_batch_derive(&account, c, &chain);
+            if (result == SUCCESS) {
+                result = scan_chain(index, &chain, &addrs, gap, &hit, on_hit, ctx, stats,
+                                    &chain_used);
+            }
+            account_used |= chain_used;
+        }
+        if (!account_used) {
+            break;
+        }
+    }
+
+    OPENSSL_cleanse(&hit, sizeof(hit));
+    hdkey_batch_free(&addrs);
+    hdkey_batch_free(&chain);
+    hdkey_batch_free(&account);
+    return result;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file addrmatch.h
+ * @brief Offline matching of derived addresses against a local address set.
+ * @details The address set is a prebuilt index file: sorted, deduplicated
+ *          20-byte match keys (see address_script_key) followed by a blocked
+ *          bloom filter. The file is memory-mapped; a lookup touches one
+ *          64-byte bloom block and, for the rare positives, a handful of
+ *          index pages found by interpolation search. A bloom filter of
+ *          2 MiB or more is copied onto huge pages, so its random probes
+ *          do not miss the TLB on every lookup.
+ */
+
+#ifndef ADDRMATCH_H
+#define ADDRMATCH_H
+
+#include <stdio.h>
+
+#include "../hdkey/hdkey.h"
+#include "../address/address.h"
+#include "../hugepage/hugepage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Index file magic */
+#define ADDRMATCH_MAGIC "MNH160IX"
+
+/** @brief Index file format version */
+#define ADDRMATCH_VERSION 1
+
+/** @brief Bloom filter bits per indexed key (about 0.1% false positives) */
+#define ADDRMATCH_BLOOM_BITS_PER_KEY 16
+
+/** @brief Bloom filter probes per key, all within one 512-bit block */
+#define ADDRMATCH_BLOOM_K 7
+
+/** @brief BIP-44 default address gap limit */
+#define ADDRMATCH_DEFAULT_GAP 20
+
+/**
+ * @brief Index file header (64 bytes, host byte order).
+ */
+typedef struct {
+    char magic[8];          ///< ADDRMATCH_MAGIC, not NUL-terminated.
+    uint32_t version;       ///< ADDRMATCH_VERSION.
+    uint32_t key_size;      ///< ADDRESS_KEY_LENGTH.
+    uint64_t count;         ///< Number of keys.
+    uint64_t bloom_offset;  ///< File offset of the bloom filter (64-aligned).
+    uint64_t bloom_blocks;  ///< Number of 64-byte bloom blocks.
+    uint32_t bloom_k;       ///< Probes per key.
+    uint8_t reserved[20];   ///< Zero.
+} addrmatch_header;
+
+/**
+ * @brief Memory-mapped index.
+ */
+typedef struct {
+    const byte *map;        ///< Whole file mapping.
+    size_t map_size;        ///< Mapping length.
+    const byte *keys;       ///< count x 20 sorted keys.
+    uint64_t count;         ///< Number of keys.
+    const uint64_t *bloom;  ///< bloom_blocks x 8 words.
+    uint64_t bloom_blocks;  ///< Number of bloom blocks.
+    uint32_t bloom_k;       ///< Probes per key.
+    hugepage_region bloom_copy;  ///< Huge-page copy of a large bloom filter, if `bloom` points there.
+} addrmatch_index;
+
+/**
+ * @brief Counters of a scan.
+ */
+typedef struct {
+    uint64_t derived;       ///< Addresses derived and looked up.
+    uint64_t bloom_passes;  ///< Lookups that passed the bloom filter.
+    uint64_t hits;          ///< Lookups found in the index.
+} addrmatch_stats;
+
+/**
+ * @brief One derived address found in the index.
+ */
+typedef struct {
+    address_type type;              ///< Output type (gives the purpose).
+    uint32_t account;               ///< Account number (hardened in the path).
+    uint32_t chain;                 ///< 0 = receive, 1 = change.
+    uint32_t index;                 ///< Address index.
+    char address[ADDRESS_MAX_LENGTH];
+} addrmatch_hit;
+
+/**
+ * @brief Called for every hit, in derivation order.
+ * @param hit The matched address.
+ * @param ctx Caller context.
+ * @return 0 to continue, anything else aborts the scan with that value.
+ */
+typedef int (*addrmatch_hit_fn)(const addrmatch_hit *hit, void *ctx);
+
+/**
+ * @brief Builds an index file from a text list of addresses.
+ * @param in One entry per line: an address, a scriptPubKey in hex or a
+ *           40-character HASH160; blank lines and '#' comments are ignored.
+ * @param path Output index file.
+ * @param count Output: number of distinct keys written (nullable).
+ * @param skipped Output: number of unsupported lines (nullable).
+ * @return 0 on success, negative error code on failure.
+ */
+int addrmatch_build(FILE *in, const char *path, uint64_t *count, uint64_t *skipped);
+
+/**
+ * @brief Maps an index file read-only.
+ * @param index Index to fill.
+ * @param path Index file.
+ * @return 0 on success, ERROR_INVALID_INPUT if the file is not a valid index.
+ */
+int addrmatch_open(addrmatch_index *index, const char *path);
+
+/**
+ * @brief Unmaps an index.
+ * @param index Index to close (can be zero-initialized).
+ */
+void addrmatch_close(addrmatch_index *index);
+
+/**
+ * @brief Bloom filter test.
+ * @param index Open index.
+ * @param key 20-byte match key.
+ * @return Non-zero if the key may be present, 0 if it is certainly absent.
+ */
+int addrmatch_maybe_contains(const addrmatch_index *index, const byte *key);
+
+/**
+ * @brief Exact membership test (bloom filter, then interpolation search).
+ * @param index Open index.
+ * @param key 20-byte match key.
+ * @return Non-zero if the key is in the index.
+ */
+int addrmatch_contains(const addrmatch_index *index, const byte *key);
+
+/**
+ * @brief Scans the accounts of one purpose with BIP-44 gap-limit rules.
+ * @param index Open index.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param type Output type; the purpose follows from it.
+ * @param max_accounts Upper bound on accounts scanned.
+ * @param gap Consecutive unused addresses that end a chain.
+ * @param on_hit Hit callback (nullable).
+ * @param ctx Callback context.
+ * @param stats Counters, accumulated (nullable).
+ * @return 0 on success, the callback's value if it aborted, or a negative error code.
+ * @note Both chains of account n are scanned; account n+1 is only scanned
+ *       if account n had a hit, as in BIP-44 account discovery.
+ */
+int addrmatch_scan(const addrmatch_index *index, const byte *private_key,
+                   const byte *chain_code, address_type type, uint32_t max_accounts,
+                   uint32_t gap, addrmatch_hit_fn on_hit, void *ctx,
+                   addrmatch_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADDRMATCH_H
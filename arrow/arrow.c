@@ -0,0 +1,524 @@
+/**
+ * @file arrow.c
+ * @brief Minimal Arrow IPC file writer for columnar exports.
+ * @details Flatbuffers are built front to back: a parent table is laid out
+ *          before its children, and its offset fields are patched once a
+ *          child is placed, so every uoffset points forward as the format
+ *          requires. Tables are 4 mod 8 aligned so that 8-byte fields, which
+ *          come first after the vtable offset, land on 8-byte boundaries.
+ */
+#include "arrow.h"
+
+#include <stdlib.h>   // For malloc, realloc, free
+#include <string.h>   // For memcpy, memset, strlen
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "the writer emits little-endian Arrow files; this host would need byte swapping"
+#endif
+
+/** @brief File magic, padded to 8 bytes at the start of the file */
+static const char arrow_magic[8] = "ARROW1";
+
+/** @brief Encapsulated message continuation marker */
+#define ARROW_CONTINUATION 0xFFFFFFFFu
+
+/** @brief MetadataVersion.V5 */
+#define ARROW_METADATA_V5 4
+
+/** @brief MessageHeader union values */
+enum { HEADER_SCHEMA = 1, HEADER_DICTIONARY_BATCH = 2, HEADER_RECORD_BATCH = 3 };
+
+/** @brief Type union values */
+enum { TYPE_INT = 2, TYPE_BINARY = 4, TYPE_UTF8 = 5 };
+
+/** @brief Most fields of any table written here */
+#define FB_MAX_FIELDS 6
+
+/** @brief Growing flatbuffer */
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    int error;
+} fb_builder;
+
+/** @brief One body buffer */
+typedef struct {
+    const void *data;
+    size_t length;
+} arrow_slice;
+
+/** @brief Encoded message: prefix, metadata and body */
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    int32_t metadata_length;
+    int64_t body_length;
+} arrow_message;
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Reserves zeroed bytes, padding first so that (position + phase) is
+ *        a multiple of alignment.
+ * @return Position of the reserved bytes (0 after an allocation failure).
+ */
+static size_t fb_alloc(fb_builder *b, size_t len, size_t alignment, size_t phase) {
+    if (b->error) return 0;
+    size_t pad = (alignment - (b->size + phase) % alignment) % alignment;
+    size_t need = b->size + pad + len;
+    if (need > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity : 512;
+        while (capacity < need) capacity *= 2;
+        uint8_t *data = realloc(b->data, capacity);
+        if (!data) {
+            b->error = ARROW_ERROR_INTERNAL;
+            return 0;
+        }
+        b->data = data;
+        b->capacity = capacity;
+    }
+    memset(b->data + b->size, 0, need - b->size);
+    size_t position = b->size + pad;
+    b->size = need;
+    return position;
+}
+
+static void fb_put(fb_builder *b, size_t position, const void *value, size_t len) {
+    if (!b->error) memcpy(b->data + position, value, len);
+}
+
+static void fb_put_u8(fb_builder *b, size_t position, uint8_t value) { fb_put(b, position, &value, 1); }
+static void fb_put_u16(fb_builder *b, size_t position, uint16_t value) { fb_put(b, position, &value, 2); }
+static void fb_put_u32(fb_builder *b, size_t position, uint32_t value) { fb_put(b, position, &value, 4); }
+static void fb_put_i64(fb_builder *b, size_t position, int64_t value) { fb_put(b, position, &value, 8); }
+
+/** @brief Points the offset field at position to target (which comes later) */
+static void fb_link(fb_builder *b, size_t position, size_t target) {
+    fb_put_u32(b, position, (uint32_t)(target - position));
+}
+
+/**
+ * @brief Lays out a vtable and its table.
+ * @param sizes Size of each field by id, 0 for absent fields.
+ * @param positions Receives the position of each present field.
+ * @return Position of the table.
+ */
+static size_t fb_table(fb_builder *b, size_t count, const uint8_t *sizes, size_t *positions) {
+    size_t vtable = fb_alloc(b, 4 + 2 * count, 2, 0);
+    uint16_t offsets[FB_MAX_FIELDS] = {0};
+    uint16_t table_size = 4;
+    // Largest fields first, so each one is naturally aligned after the 4-byte soffset
+    for (uint8_t width = 8; width >= 1; width /= 2) {
+        for (size_t i = 0; i < count; i++) {
+            if (sizes[i] == width) {
+                offsets[i] = table_size;
+                table_size += width;
+            }
+        }
+    }
+    size_t table = fb_alloc(b, table_size, 8, 4);
+    fb_put_u16(b, vtable, (uint16_t)(4 + 2 * count));
+    fb_put_u16(b, vtable + 2, table_size);
+    for (size_t i = 0; i < count; i++) {
+        fb_put_u16(b, vtable + 4 + 2 * i, offsets[i]);
+        positions[i] = table + offsets[i];
+    }
+    fb_put_u32(b, table, (uint32_t)(table - vtable));
+    return table;
+}
+
+/** @brief Vector of count elements; the elements start at the returned position + 4 */
+static size_t fb_vector(fb_builder *b, size_t count, size_t element_size, size_t alignment) {
+    size_t position = fb_alloc(b, 4 + count * element_size, alignment < 4 ? 4 : alignment, 4);
+    fb_put_u32(b, position, (uint32_t)count);
+    return position;
+}
+
+static size_t fb_string(fb_builder *b, const char *value) {
+    size_t len = strlen(value);
+    size_t position = fb_alloc(b, 4 + len + 1, 4, 0);
+    fb_put_u32(b, position, (uint32_t)len);
+    fb_put(b, position + 4, value, len);
+    return position;
+}
+
+/** @brief Int type table */
+static size_t fb_int(fb_builder *b, int32_t bit_width, int is_signed) {
+    const uint8_t sizes[2] = {4, 1};
+    size_t fields[2];
+    size_t table = fb_table(b, 2, sizes, fields);
+    fb_put_u32(b, fields[0], (uint32_t)bit_width);
+    fb_put_u8(b, fields[1], (uint8_t)is_signed);
+    return table;
+}
+
+/** @brief Field table; dictionary fields use the field position as dictionary id */
+static size_t fb_field(fb_builder *b, const arrow_field *field, int64_t id) {
+    int dictionary = field->type == ARROW_DICTIONARY;
+    // name, nullable, type_type, type, dictionary, children
+    const uint8_t sizes[6] = {4, 1, 1, 4, dictionary ? 4 : 0, 4};
+    size_t fields[6];
+    size_t table = fb_table(b, 6, sizes, fields);
+    fb_put_u8(b, fields[1], 0);
+
+    fb_link(b, fields[0], fb_string(b, field->name));
+    size_t type;
+    switch (field->type) {
+        case ARROW_UINT32:
+            fb_put_u8(b, fields[2], TYPE_INT);
+            type = fb_int(b, 32, 0);
+            break;
+        case ARROW_BINARY:
+            fb_put_u8(b, fields[2], TYPE_BINARY);
+            type = fb_table(b, 0, NULL, NULL);
+            break;
+        default:
+            // Dictionary fields carry the type of their values
+            fb_put_u8(b, fields[2], TYPE_UTF8);
+            type = fb_table(b, 0, NULL, NULL);
+            break;
+    }
+    fb_link(b, fields[3], type);
+    if (dictionary) {
+        // id, indexType, isOrdered
+        const uint8_t encoding_sizes[3] = {8, 4, 1};
+        size_t encoding_fields[3];
+        size_t encoding = fb_table(b, 3, encoding_sizes, encoding_fields);
+        fb_put_i64(b, encoding_fields[0], id);
+        fb_put_u8(b, encoding_fields[2], 0);
+        fb_link(b, fields[4], encoding);
+        fb_link(b, encoding_fields[1], fb_int(b, 32, 1));
+    }
+    fb_link(b, fields[5], fb_vector(b, 0, 4, 4));
+    return table;
+}
+
+static size_t fb_schema(fb_builder *b, const arrow_writer *writer) {
+    // endianness (Little, the default), fields
+    const uint8_t sizes[2] = {0, 4};
+    size_t fields[2];
+    size_t table = fb_table(b, 2, sizes, fields);
+    size_t vector = fb_vector(b, writer->field_count, 4, 4);
+    fb_link(b, fields[1], vector);
+    for (size_t i = 0; i < writer->field_count; i++) {
+        fb_link(b, vector + 4 + 4 * i, fb_field(b, &writer->fields[i], (int64_t)i));
+    }
+    return table;
+}
+
+/**
+ * @brief RecordBatch table: one node per column, buffers laid out back to back.
+ * @return Position of the table; body_length receives the padded body size.
+ */
+static size_t fb_record_batch(fb_builder *b, size_t rows, size_t node_count,
+                              const arrow_slice *slices, size_t slice_count, int64_t *body_length) {
+    // length, nodes, buffers
+    const uint8_t sizes[3] = {8, 4, 4};
+    size_t fields[3];
+    size_t table = fb_table(b, 3, sizes, fields);
+    fb_put_i64(b, fields[0], (int64_t)rows);
+
+    size_t nodes = fb_vector(b, node_count, 16, 8);
+    fb_link(b, fields[1], nodes);
+    for (size_t i = 0; i < node_count; i++) {
+        fb_put_i64(b, nodes + 4 + 16 * i, (int64_t)rows);   // length; null_count stays 0
+    }
+
+    size_t buffers = fb_vector(b, slice_count, 16, 8);
+    fb_link(b, fields[2], buffers);
+    size_t offset = 0;
+    for (size_t i = 0; i < slice_count; i++) {
+        fb_put_i64(b, buffers + 4 + 16 * i, (int64_t)offset);
+        fb_put_i64(b, buffers + 4 + 16 * i + 8, (int64_t)slices[i].length);
+        offset += align_up(slices[i].length, ARROW_ALIGNMENT);
+    }
+    *body_length = (int64_t)offset;
+    return table;
+}
+
+/**
+ * @brief Encodes one encapsulated message.
+ * @param header_type HEADER_*.
+ * @param dictionary_id Dictionary id for HEADER_DICTIONARY_BATCH.
+ * @param rows, node_count, slices, slice_count Batch data (not for HEADER_SCHEMA).
+ */
+static int encode_message(const arrow_writer *writer, uint8_t header_type, int64_t dictionary_id,
+                          size_t rows, size_t node_count, const arrow_slice *slices, size_t slice_count,
+                          arrow_message *message) {
+    fb_builder b = {0};
+    size_t root = fb_alloc(&b, 4, 4, 0);
+    // version, header_type, header, bodyLength
+    const uint8_t sizes[4] = {2, 1, 4, 8};
+    size_t fields[4];
+    fb_link(&b, root, fb_table(&b, 4, sizes, fields));
+    fb_put_u16(&b, fields[0], ARROW_METADATA_V5);
+    fb_put_u8(&b, fields[1], header_type);
+
+    int64_t body_length = 0;
+    if (header_type == HEADER_SCHEMA) {
+        fb_link(&b, fields[2], fb_schema(&b, writer));
+    } else if (header_type == HEADER_DICTIONARY_BATCH) {
+        // id, data, isDelta
+        const uint8_t dictionary_sizes[3] = {8, 4, 1};
+        size_t dictionary_fields[3];
+        size_t dictionary = fb_table(&b, 3, dictionary_sizes, dictionary_fields);
+        fb_link(&b, fields[2], dictionary);
+        fb_put_i64(&b, dictionary_fields[0], dictionary_id);
+        fb_link(&b, dictionary_fields[1],
+                fb_record_batch(&b, rows, node_count, slices, slice_count, &body_length));
+    } else {
+        fb_link(&b, fields[2], fb_record_batch(&b, rows, node_count, slices, slice_count, &body_length));
+    }
+    fb_put_i64(&b, fields[3], body_length);
+    if (b.error) {
+        free(b.data);
+        return b.error;
+    }
+
+    // Continuation marker and length, then the flatbuffer padded so the body starts 8-aligned
+    size_t metadata_length = align_up(8 + b.size, 8);
+    message->size = metadata_length + (size_t)body_length;
+    message->data = malloc(message->size);
+    if (!message->data) {
+        free(b.data);
+        return ARROW_ERROR_INTERNAL;
+    }
+    uint32_t prefix[2] = {ARROW_CONTINUATION, (uint32_t)(metadata_length - 8)};
+    memcpy(message->data, prefix, sizeof(prefix));
+    memcpy(message->data + 8, b.data, b.size);
+    memset(message->data + 8 + b.size, 0, metadata_length - 8 - b.size);
+    free(b.data);
+
+    uint8_t *body = message->data + metadata_length;
+    size_t offset = 0;
+    for (size_t i = 0; i < slice_count; i++) {
+        size_t padded = align_up(slices[i].length, ARROW_ALIGNMENT);
+        if (slices[i].length) memcpy(body + offset, slices[i].data, slices[i].length);
+        memset(body + offset + slices[i].length, 0, padded - slices[i].length);
+        offset += padded;
+    }
+    message->metadata_length = (int32_t)metadata_length;
+    message->body_length = body_length;
+    return ARROW_OK;
+}
+
+/** @brief Appends a message and returns its block; caller holds the lock */
+static int append_message(arrow_writer *writer, const arrow_message *message, arrow_block *block) {
+    if (fwrite(message->data, 1, message->size, writer->out) != message->size) {
+        return ARROW_ERROR_IO;
+    }
+    block->offset = writer->position;
+    block->metadata_length = message->metadata_length;
+    block->body_length = message->body_length;
+    writer->position += (int64_t)message->size;
+    return ARROW_OK;
+}
+
+/** @brief Validity, offsets and data slices of a utf8 or binary column */
+static int string_slices(const arrow_column *column, size_t rows, arrow_slice *slices) {
+    if (!column->offsets || column->offsets[0] != 0 || column->offsets[rows] < 0 ||
+        (!column->values && column->offsets[rows] > 0)) {
+        return ARROW_ERROR_INVALID;
+    }
+    slices[0] = (arrow_slice){NULL, 0};
+    slices[1] = (arrow_slice){column->offsets, (rows + 1) * sizeof(int32_t)};
+    slices[2] = (arrow_slice){column->values, (size_t)column->offsets[rows]};
+    return ARROW_OK;
+}
+
+int arrow_writer_init(arrow_writer *writer, FILE *out, const arrow_field *fields, size_t field_count) {
+    if (!writer || !out || !fields || field_count == 0) return ARROW_ERROR_INVALID;
+    memset(writer, 0, sizeof(*writer));
+    for (size_t i = 0; i < field_count; i++) {
+        if (!fields[i].name || (fields[i].type == ARROW_DICTIONARY &&
+                                (!fields[i].dictionary || fields[i].dictionary_size > INT32_MAX))) {
+            return ARROW_ERROR_INVALID;
+        }
+        if (fields[i].type == ARROW_DICTIONARY) writer->dictionary_count++;
+    }
+    writer->out = out;
+    writer->field_count = field_count;
+    writer->fields = malloc(field_count * sizeof(arrow_field));
+    writer->dictionaries = calloc(writer->dictionary_count ? writer->dictionary_count : 1, sizeof(arrow_block));
+    if (!writer->fields || !writer->dictionaries || pthread_mutex_init(&writer->lock, NULL) != 0) {
+        free(writer->fields);
+        free(writer->dictionaries);
+        return ARROW_ERROR_INTERNAL;
+    }
+    memcpy(writer->fields, fields, field_count * sizeof(arrow_field));
+
+    arrow_message message;
+    arrow_block block;
+    if (fwrite(arrow_magic, sizeof(arrow_magic), 1, out) != 1) {
+        writer->error = ARROW_ERROR_IO;
+    } else {
+        writer->position = sizeof(arrow_magic);
+        writer->error = encode_message(writer, HEADER_SCHEMA, 0, 0, 0, NULL, 0, &message);
+        if (writer->error == ARROW_OK) {
+            writer->error = append_message(writer, &message, &block);
+            free(message.data);
+        }
+    }
+
+    size_t dictionary = 0;
+    for (size_t i = 0; i < field_count && writer->error == ARROW_OK; i++) {
+        const arrow_field *field = &writer->fields[i];
+        if (field->type != ARROW_DICTIONARY) continue;
+        size_t count = field->dictionary_size;
+        size_t bytes = 0;
+        for (size_t j = 0; j < count; j++) bytes += strlen(field->dictionary[j]);
+        int32_t *offsets = malloc((count + 1) * sizeof(int32_t));
+        char *data = malloc(bytes ? bytes : 1);
+        if (!offsets || !data || bytes > INT32_MAX) {
+            writer->error = offsets && data ? ARROW_ERROR_INVALID : ARROW_ERROR_INTERNAL;
+        } else {
+            offsets[0] = 0;
+            for (size_t j = 0; j < count; j++) {
+                size_t len = strlen(field->dictionary[j]);
+                memcpy(data + offsets[j], field->dictionary[j], len);
+                offsets[j + 1] = offsets[j] + (int32_t)len;
+            }
+            arrow_column values = {data, offsets};
+            arrow_slice slices[3];
+            string_slices(&values, count, slices);
+            writer->error = encode_message(writer, HEADER_DICTIONARY_BATCH, (int64_t)i, count, 1,
+                                           slices, 3, &message);
+            if (writer->error == ARROW_OK) {
+                writer->error = append_message(writer, &message, &writer->dictionaries[dictionary++]);
+                free(message.data);
+            }
+        }
+        free(offsets);
+        free(data);
+    }
+    if (writer->error != ARROW_OK) {
+        int result = writer->error;
+        pthread_mutex_destroy(&writer->lock);
+        free(writer->fields);
+        free(writer->dictionaries);
+        memset(writer, 0, sizeof(*writer));
+        return result;
+    }
+    return ARROW_OK;
+}
+
+int arrow_writer_write_batch(arrow_writer *writer, const arrow_column *columns, size_t rows) {
+    if (!writer || !columns || rows == 0 || rows > INT32_MAX) return ARROW_ERROR_INVALID;
+    pthread_mutex_lock(&writer->lock);
+    int error = writer->error;
+    pthread_mutex_unlock(&writer->lock);
+    if (error) return error;
+
+    // Encoding runs on the calling thread; only the append below is serialized
+    size_t slice_count = 0;
+    arrow_slice stack_slices[3 * 8] = {{0}};
+    arrow_slice *slices = writer->field_count <= 8 ? stack_slices
+                                                    : malloc(3 * writer->field_count * sizeof(arrow_slice));
+    if (!slices) return ARROW_ERROR_INTERNAL;
+    int result = ARROW_OK;
+    for (size_t i = 0; i < writer->field_count && result == ARROW_OK; i++) {
+        const arrow_field *field = &writer->fields[i];
+        const arrow_column *column = &columns[i];
+        switch (field->type) {
+            case ARROW_UTF8:
+            case ARROW_BINARY:
+                result = string_slices(column, rows, slices + slice_count);
+                slice_count += 3;
+                break;
+            default:
+                // uint32 values and int32 dictionary indices share one layout
+                if (!column->values) result = ARROW_ERROR_INVALID;
+                if (field->type == ARROW_DICTIONARY && result == ARROW_OK) {
+                    const int32_t *indices = column->values;
+                    for (size_t j = 0; j < rows; j++) {
+                        if (indices[j] < 0 || (size_t)indices[j] >= field->dictionary_size) {
+                            result = ARROW_ERROR_INVALID;
+                            break;
+                        }
+                    }
+                }
+                slices[slice_count++] = (arrow_slice){NULL, 0};
+                slices[slice_count++] = (arrow_slice){column->values, rows * sizeof(uint32_t)};
+                break;
+        }
+    }
+    arrow_message message = {0};
+    if (result == ARROW_OK) {
+        result = encode_message(writer, HEADER_RECORD_BATCH, 0, rows, writer->field_count,
+                                slices, slice_count, &message);
+    }
+    if (slices != stack_slices) free(slices);
+    if (result != ARROW_OK) return result;
+
+    pthread_mutex_lock(&writer->lock);
+    if (writer->error == ARROW_OK && writer->batch_count == writer->batch_capacity) {
+        size_t capacity = writer->batch_capacity ? writer->batch_capacity * 2 : 64;
+        arrow_block *batches = realloc(writer->batches, capacity * sizeof(arrow_block));
+        if (batches) {
+            writer->batches = batches;
+            writer->batch_capacity = capacity;
+        } else {
+            writer->error = ARROW_ERROR_INTERNAL;
+        }
+    }
+    if (writer->error == ARROW_OK) {
+        writer->error = append_message(writer, &message, &writer->batches[writer->batch_count]);
+        if (writer->error == ARROW_OK) writer->batch_count++;
+    }
+    result = writer->error;
+    pthread_mutex_unlock(&writer->lock);
+    free(message.data);
+    return result;
+}
+
+/** @brief Vector of Block structs */
+static size_t fb_blocks(fb_builder *b, const arrow_block *blocks, size_t count) {
+    size_t vector = fb_vector(b, count, 24, 8);
+    for (size_t i = 0; i < count; i++) {
+        size_t block = vector + 4 + 24 * i;
+        fb_put_i64(b, block, blocks[i].offset);
+        fb_put_u32(b, block + 8, (uint32_t)blocks[i].metadata_length);
+        fb_put_i64(b, block + 16, blocks[i].body_length);
+    }
+    return vector;
+}
+
+int arrow_writer_finish(arrow_writer *writer) {
+    if (!writer || !writer->out) return ARROW_ERROR_INVALID;
+    if (writer->error == ARROW_OK) {
+        uint32_t end_of_stream[2] = {ARROW_CONTINUATION, 0};
+
+        fb_builder b = {0};
+        size_t root = fb_alloc(&b, 4, 4, 0);
+        // version, schema, dictionaries, recordBatches
+        const uint8_t sizes[4] = {2, 4, 4, 4};
+        size_t fields[4];
+        fb_link(&b, root, fb_table(&b, 4, sizes, fields));
+        fb_put_u16(&b, fields[0], ARROW_METADATA_V5);
+        fb_link(&b, fields[1], fb_schema(&b, writer));
+        fb_link(&b, fields[2], fb_blocks(&b, writer->dictionaries, writer->dictionary_count));
+        fb_link(&b, fields[3], fb_blocks(&b, writer->batches, writer->batch_count));
+
+        int32_t footer_length = (int32_t)b.size;
+        if (b.error) {
+            writer->error = b.error;
+        } else if (fwrite(end_of_stream, sizeof(end_of_stream), 1, writer->out) != 1 ||
+                   fwrite(b.data, 1, b.size, writer->out) != b.size ||
+                   fwrite(&footer_length, sizeof(footer_length), 1, writer->out) != 1 ||
+                   fwrite(arrow_magic, 6, 1, writer->out) != 1 ||
+                   fflush(writer->out) != 0) {
+            writer->error = ARROW_ERROR_IO;
+        }
+        free(b.data);
+    }
+    int result = writer->error;
+    pthread_mutex_destroy(&writer->lock);
+    free(writer->fields);
+    free(writer->dictionaries);
+    free(writer->batches);
+    memset(writer, 0, sizeof(*writer));
+    return result;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file arrow.h
+ * @brief Minimal Arrow IPC file writer for columnar exports.
+ * @details Writes the Arrow IPC file format ("ARROW1", schema, dictionary
+ *          batches, record batches, footer) that pyarrow, pandas, polars and
+ *          DuckDB load without parsing text. The flatbuffer metadata is built
+ *          by hand, so there is no Arrow or flatbuffers dependency.
+ *
+ *          Supported columns: uint32, utf8, binary, and utf8 dictionaries
+ *          with int32 indices whose values are fixed when the file is opened.
+ *          Columns never hold nulls. Record batches can be written from many
+ *          threads at once: each call encodes its batch on the calling
+ *          thread and only the append is serialized. Batches land in the
+ *          file in completion order.
+ */
+
+#ifndef ARROW_H
+#define ARROW_H
+
+#include <stdio.h>     // For FILE
+#include <stddef.h>    // For size_t
+#include <stdint.h>    // For int32_t, int64_t, uint32_t
+#include <pthread.h>   // For pthread_mutex_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Alignment of every buffer in a message body */
+#define ARROW_ALIGNMENT 64
+
+/** @brief Error codes */
+enum {
+    ARROW_OK = 0,
+    ARROW_ERROR_INVALID = -1,   /**< Bad arguments */
+    ARROW_ERROR_IO = -2,        /**< Write failure */
+    ARROW_ERROR_INTERNAL = -3   /**< Allocation failure */
+};
+
+/** @brief Column types */
+typedef enum {
+    ARROW_UINT32,       /**< arrow_column.values is uint32_t[rows] */
+    ARROW_UTF8,         /**< values is UTF-8 bytes, offsets is int32_t[rows + 1] */
+    ARROW_BINARY,       /**< values is bytes, offsets is int32_t[rows + 1] */
+    ARROW_DICTIONARY    /**< values is int32_t[rows], indices into the field's utf8 dictionary */
+} arrow_type;
+
+/**
+ * @brief One column of the schema.
+ */
+typedef struct {
+    const char *name;                /**< Column name */
+    arrow_type type;                 /**< Column type */
+    const char *const *dictionary;   /**< ARROW_DICTIONARY values, written by init */
+    size_t dictionary_size;          /**< Number of dictionary values */
+} arrow_field;
+
+/**
+ * @brief Data of one column for one record batch.
+ */
+typedef struct {
+    const void *values;              /**< See arrow_type */
+    const int32_t *offsets;          /**< ARROW_UTF8 / ARROW_BINARY only */
+} arrow_column;
+
+/** @brief Position of one message, for the file footer */
+typedef struct {
+    int64_t offset;                  /**< File offset of the message */
+    int32_t metadata_length;         /**< Prefix and flatbuffer, padded */
+    int64_t body_length;             /**< Body bytes */
+} arrow_block;
+
+/** @brief File writer; fields are private */
+typedef struct {
+    FILE *out;                       /**< Destination (need not be seekable) */
+    arrow_field *fields;             /**< Copy of the schema */
+    size_t field_count;
+    int64_t position;                /**< Bytes written so far */
+    arrow_block *dictionaries;       /**< One block per dictionary field */
+    size_t dictionary_count;
+    arrow_block *batches;            /**< One block per record batch */
+    size_t batch_count;
+    size_t batch_capacity;
+    pthread_mutex_t lock;            /**< Serializes appends */
+    int error;                       /**< First error, sticky */
+} arrow_writer;
+
+/**
+ * @brief Writes the file magic, the schema and the dictionaries.
+ * @param writer Writer to initialize.
+ * @param out Destination stream (not closed by the writer).
+ * @param fields Columns.
+ * @param field_count Number of columns.
+ * @return ARROW_OK, or a negative error code after which the writer is
+ *         released and must not be finished.
+ * @note The field names must stay valid until arrow_writer_finish(), which
+ *       repeats the schema in the footer.
+ */
+int arrow_writer_init(arrow_writer *writer, FILE *out, const arrow_field *fields, size_t field_count);
+
+/**
+ * @brief Encodes and appends one record batch; safe to call from many threads.
+ * @param writer Writer.
+ * @param columns One entry per field, in schema order.
+ * @param rows Rows in the batch.
+ * @return ARROW_OK or a negative error code (sticky).
+ */
+int arrow_writer_write_batch(arrow_writer *writer, const arrow_column *columns, size_t rows);
+
+/**
+ * @brief Writes the end-of-stream marker and the footer, and frees the writer.
+ * @param writer Writer.
+ * @return ARROW_OK, or the first error seen by the writer.
+ */
+int arrow_writer_finish(arrow_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARROW_H
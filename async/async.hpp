@@ -0,0 +1,499 @@
+/**
+ * @file async.hpp
+ * @brief C++20 coroutine API over BIP-39 seed and BIP-32 master key derivation.
+ * @details For services with an event loop: `co_await` a derivation instead
+ *          of blocking the loop thread on it. Work runs on a pool owned by a
+ *          `mnmncs::async::service`; the awaiting coroutine is resumed by
+ *          posting it to an executor chosen by the caller, normally the
+ *          caller's own loop, so it never continues on a pool thread.
+ *
+ *          - Seed derivation (PBKDF2, milliseconds) runs one request per job.
+ *          - Master key derivation from a seed (two SHA-512 compressions) is
+ *            too small for a job of its own: the pool takes every such
+ *            request queued at that moment, up to `max_batch`, and derives
+ *            them in one multi-lane call (derive_bip32_master_keys_batch).
+ *          - A request can carry a cancel_token. Cancelling it takes the
+ *            request out of the queue and resumes the coroutine with
+ *            `operation_cancelled`; a request already running completes.
+ *
+ *          An executor is any copyable type with `post(std::function<void()>)`.
+ *          `inline_executor` resumes on the pool thread itself.
+ *
+ *          Header-only; link the C sources bip39/bip39.c, hdkey/hdkey.c,
+ *          hdkey/hdbatch.c and cpto/cpto.c (compiled as C) and OpenSSL.
+ */
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <openssl/crypto.h>
+
+#include "../bip39/bip39.h"
+#include "../hdkey/hdkey.h"
+
+namespace mnmncs::async {
+
+/** @brief Fixed-size secret that is wiped when destroyed */
+template <std::size_t N>
+struct secret {
+    std::array<unsigned char, N> bytes{};
+
+    secret() = default;
+    secret(const secret &) = default;
+    secret &operator=(const secret &) = default;
+    ~secret() { OPENSSL_cleanse(bytes.data(), N); }
+
+    unsigned char *data() noexcept { return bytes.data(); }
+    const unsigned char *data() const noexcept { return bytes.data(); }
+    static constexpr std::size_t size() noexcept { return N; }
+};
+
+/** @brief BIP-39 seed */
+using seed = secret<BIP39_SEED_LENGTH>;
+
+/** @brief BIP-32 master key */
+struct master_key {
+    secret<PRIVATE_KEY_LENGTH> private_key;
+    secret<CHAIN_CODE_LENGTH> chain_code;
+};
+
+/** @brief Thrown by co_await when the request was cancelled before it ran */
+struct operation_cancelled : std::runtime_error {
+    operation_cancelled() : std::runtime_error("operation cancelled") {}
+};
+
+/** @brief What a request is resumed on */
+template <class E>
+concept executor = std::copy_constructible<E> && requires(E e, std::function<void()> f) {
+    e.post(std::move(f));
+};
+
+/** @brief Resumes on the pool thread that finished the work (no event loop needed) */
+struct inline_executor {
+    void post(std::function<void()> f) const { f(); }
+};
+
+namespace detail {
+
+/**
+ * @brief Cancellation flag and the callbacks of the requests it covers.
+ */
+class cancel_state {
+public:
+    /** @brief Registers a callback; returns 0 (and does not register) if already cancelled */
+    std::uint64_t add(std::function<void()> callback) {
+        std::lock_guard lock(mutex_);
+        if (cancelled_) {
+            return 0;
+        }
+        callbacks_.emplace_back(++last_id_, std::move(callback));
+        return last_id_;
+    }
+
+    void remove(std::uint64_t id) {
+        std::lock_guard lock(mutex_);
+        for (auto it = callbacks_.begin(); it != callbacks_.end(); ++it) {
+            if (it->first == id) {
+                callbacks_.erase(it);
+                return;
+            }
+        }
+    }
+
+    void cancel() {
+        std::vector<std::pair<std::uint64_t, std::function<void()>>> callbacks;
+        {
+            std::lock_guard lock(mutex_);
+            if (cancelled_) {
+                return;
+            }
+            cancelled_ = true;
+            callbacks.swap(callbacks_);
+        }
+        // Outside the lock: a callback resumes a coroutine, which may cancel again
+        for (auto &entry : callbacks) {
+            entry.second();
+        }
+    }
+
+    bool cancelled() const {
+        std::lock_guard lock(mutex_);
+        return cancelled_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    bool cancelled_ = false;
+    std::uint64_t last_id_ = 0;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> callbacks_;
+};
+
+/** @brief Life cycle of a request; exactly one of running or cancelled wins */
+enum job_state : int { JOB_QUEUED, JOB_RUNNING, JOB_CANCELLED };
+
+/**
+ * @brief A queued request and its outcome.
+ */
+template <class T>
+struct job {
+    std::atomic<int> state{JOB_QUEUED};
+    std::function<void()> resume;              ///< Posts the awaiting coroutine to its executor.
+    std::shared_ptr<cancel_state> cancel;      ///< Nullable.
+    std::uint64_t cancel_id = 0;
+    std::optional<T> result;                   ///< Empty after a failure or cancellation.
+
+    /** @brief Claims the job for a pool thread; false if it was cancelled */
+    bool start() {
+        int expected = JOB_QUEUED;
+        return state.compare_exchange_strong(expected, JOB_RUNNING);
+    }
+
+    /** @brief Claims the job for cancellation; false if a pool thread has it */
+    bool abandon() {
+        int expected = JOB_QUEUED;
+        return state.compare_exchange_strong(expected, JOB_CANCELLED);
+    }
+
+    /** @brief Drops the cancel callback and resumes the caller */
+    void finish() {
+        if (cancel != nullptr && cancel_id != 0) {
+            cancel->remove(cancel_id);
+        }
+        resume();
+    }
+};
+
+struct seed_request {
+    std::string mnemonic;
+    std::string passphrase;
+
+    ~seed_request() {
+        OPENSSL_cleanse(mnemonic.data(), mnemonic.size());
+        OPENSSL_cleanse(passphrase.data(), passphrase.size());
+    }
+};
+
+struct seed_job : job<seed> {
+    seed_request request;
+};
+
+struct master_job : job<master_key> {
+    seed input;
+};
+
+} // namespace detail
+
+/** @brief Requests covered by a cancel_source */
+class cancel_token {
+public:
+    cancel_token() = default;
+    bool cancelled() const { return state_ != nullptr && state_->cancelled(); }
+
+private:
+    friend class cancel_source;
+    friend class service;
+    explicit cancel_token(std::shared_ptr<detail::cancel_state> state) : state_(std::move(state)) {}
+    std::shared_ptr<detail::cancel_state> state_;
+};
+
+/** @brief Cancels every queued request made with one of its tokens */
+class cancel_source {
+public:
+    cancel_source() : state_(std::make_shared<detail::cancel_state>()) {}
+    cancel_token token() const { return cancel_token(state_); }
+    void cancel() { state_->cancel(); }
+
+private:
+    std::shared_ptr<detail::cancel_state> state_;
+};
+
+/** @brief Pool counters */
+struct service_stats {
+    std::uint64_t seeds = 0;        ///< Seeds derived.
+    std::uint64_t master_keys = 0;  ///< Master keys derived.
+    std::uint64_t batches = 0;      ///< Batched master key calls.
+    std::uint64_t cancelled = 0;    ///< Requests cancelled before they ran.
+};
+
+template <class T, class Job, executor E>
+class operation;
+
+/**
+ * @brief Worker pool serving derivation requests.
+ * @note Destroy it after the operations awaited on it have completed; any
+ *       still queued then are resumed with operation_cancelled.
+ */
+class service {
+public:
+    /** @brief Master keys derived per batch at most */
+    static constexpr std::size_t default_max_batch = 64;
+
+    /**
+     * @brief Starts the pool.
+     * @param threads Pool threads, 0 for one per CPU.
+     * @param max_batch Master key requests per batched call.
+     */
+    explicit service(std::size_t threads = 0, std::size_t max_batch = default_max_batch)
+        : max_batch_(max_batch > 0 ? max_batch : 1) {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        }
+        for (std::size_t i = 0; i < threads; i++) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    service(const service &) = delete;
+    service &operator=(const service &) = delete;
+
+    ~service() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+        for (auto &job : seed_queue_) {
+            if (job->abandon()) {
+                job->finish();
+            }
+        }
+        for (auto &job : master_queue_) {
+            if (job->abandon()) {
+                job->finish();
+            }
+        }
+    }
+
+    /**
+     * @brief Derives the BIP-39 seed of a phrase.
+     * @param ex Executor the awaiting coroutine is resumed on.
+     * @param mnemonic Space separated phrase (NFKD normalized).
+     * @param passphrase Optional passphrase.
+     * @param token Cancels the request while it is queued.
+     * @return Awaitable yielding a seed; throws operation_cancelled or std::runtime_error.
+     */
+    template <executor E>
+    operation<seed, detail::seed_job, E> derive_seed(E ex, std::string mnemonic, std::string passphrase = {},
+                                                     cancel_token token = {}) {
+        auto job = std::make_shared<detail::seed_job>();
+        job->request.mnemonic = std::move(mnemonic);
+        job->request.passphrase = std::move(passphrase);
+        return operation<seed, detail::seed_job, E>(this, std::move(ex), std::move(job), std::move(token));
+    }
+
+    /**
+     * @brief Derives the BIP-32 master key of a seed, batched with other such requests.
+     * @param ex Executor the awaiting coroutine is resumed on.
+     * @param input BIP-39 seed.
+     * @param token Cancels the request while it is queued.
+     * @return Awaitable yielding a master_key; throws operation_cancelled or std::runtime_error.
+     */
+    template <executor E>
+    operation<master_key, detail::master_job, E> derive_master_key(E ex, const seed &input,
+                                                                   cancel_token token = {}) {
+        auto job = std::make_shared<detail::master_job>();
+        job->input = input;
+        return operation<master_key, detail::master_job, E>(this, std::move(ex), std::move(job), std::move(token));
+    }
+
+    service_stats stats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    template <class T, class Job, executor E>
+    friend class operation;
+
+    /**
+     * @brief Queues a job; returns false if its token is already cancelled.
+     * @note Takes its own references: once the cancel callback is registered,
+     *       a cancel() on another thread may resume the caller and destroy
+     *       the awaiter that held the originals.
+     */
+    template <class Job>
+    bool submit(std::shared_ptr<Job> job, cancel_token token) {
+        if (token.state_ != nullptr) {
+            job->cancel = token.state_;
+            std::weak_ptr<Job> weak = job;
+            job->cancel_id = token.state_->add([this, weak] {
+                auto claimed = weak.lock();
+                if (claimed != nullptr && claimed->abandon()) {
+                    {
+                        std::lock_guard lock(mutex_);
+                        stats_.cancelled++;
+                    }
+                    claimed->resume();
+                }
+            });
+            if (job->cancel_id == 0) {
+                // Cancelled before it was queued: it never runs, so it counts as cancelled too
+                job->abandon();
+                std::lock_guard lock(mutex_);
+                stats_.cancelled++;
+                return false;
+            }
+        }
+        {
+            std::lock_guard lock(mutex_);
+            if constexpr (std::is_same_v<Job, detail::seed_job>) {
+                seed_queue_.push_back(job);
+            } else {
+                master_queue_.push_back(job);
+            }
+        }
+        ready_.notify_one();
+        return true;
+    }
+
+    void run() {
+        std::vector<std::shared_ptr<detail::master_job>> batch;
+        for (;;) {
+            std::shared_ptr<detail::seed_job> single;
+            batch.clear();
+            {
+                std::unique_lock lock(mutex_);
+                ready_.wait(lock, [this] { return stopping_ || !seed_queue_.empty() || !master_queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                // Cheap master key requests first, all of them in one call;
+                // cancelled entries are dropped here
+                while (!master_queue_.empty() && batch.size() < max_batch_) {
+                    auto job = std::move(master_queue_.front());
+                    master_queue_.pop_front();
+                    if (job->start()) {
+                        batch.push_back(std::move(job));
+                    }
+                }
+                while (batch.empty() && single == nullptr && !seed_queue_.empty()) {
+                    auto job = std::move(seed_queue_.front());
+                    seed_queue_.pop_front();
+                    if (job->start()) {
+                        single = std::move(job);
+                    }
+                }
+            }
+            if (!batch.empty()) {
+                run_batch(batch);
+            } else if (single != nullptr) {
+                run_seed(*single);
+            }
+        }
+    }
+
+    void run_seed(detail::seed_job &job) {
+        seed out;
+        const char *passphrase = job.request.passphrase.empty() ? nullptr : job.request.passphrase.c_str();
+        if (bip39_mnemonic_to_seed(job.request.mnemonic.c_str(), passphrase, out.data()) == 0) {
+            job.result = out;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            stats_.seeds++;
+        }
+        job.finish();
+    }
+
+    void run_batch(std::vector<std::shared_ptr<detail::master_job>> &batch) {
+        std::size_t count = batch.size();
+        std::vector<unsigned char> seeds(count * BIP39_SEED_LENGTH);
+        std::vector<unsigned char> keys(count * PRIVATE_KEY_LENGTH);
+        std::vector<unsigned char> chain_codes(count * CHAIN_CODE_LENGTH);
+        for (std::size_t i = 0; i < count; i++) {
+            std::copy(batch[i]->input.bytes.begin(), batch[i]->input.bytes.end(),
+                      seeds.begin() + static_cast<std::ptrdiff_t>(i * BIP39_SEED_LENGTH));
+        }
+        bool ok = derive_bip32_master_keys_batch(seeds.data(), count, keys.data(), chain_codes.data()) == SUCCESS;
+        for (std::size_t i = 0; i < count && ok; i++) {
+            master_key key;
+            std::copy_n(keys.begin() + static_cast<std::ptrdiff_t>(i * PRIVATE_KEY_LENGTH), PRIVATE_KEY_LENGTH,
+                        key.private_key.bytes.begin());
+            std::copy_n(chain_codes.begin() + static_cast<std::ptrdiff_t>(i * CHAIN_CODE_LENGTH), CHAIN_CODE_LENGTH,
+                        key.chain_code.bytes.begin());
+            batch[i]->result = key;
+        }
+        OPENSSL_cleanse(seeds.data(), seeds.size());
+        OPENSSL_cleanse(keys.data(), keys.size());
+        OPENSSL_cleanse(chain_codes.data(), chain_codes.size());
+        {
+            std::lock_guard lock(mutex_);
+            stats_.master_keys += count;
+            stats_.batches++;
+        }
+        for (auto &job : batch) {
+            job->finish();
+        }
+    }
+
+    std::size_t max_batch_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+    std::deque<std::shared_ptr<detail::seed_job>> seed_queue_;
+    std::deque<std::shared_ptr<detail::master_job>> master_queue_;
+    service_stats stats_;
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * @brief Awaitable for one request; the request is queued when awaited.
+ */
+template <class T, class Job, executor E>
+class operation {
+public:
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        job_->resume = [ex = ex_, handle]() mutable { ex.post([handle] { handle.resume(); }); };
+        // submit() gets copies; nothing of *this is touched after it registers the cancel callback
+        service *owner = service_;
+        return owner->submit(job_, token_);
+    }
+
+    T await_resume() {
+        // Only a job that never ran is cancelled; one that ran and failed reports the failure
+        if (job_->state.load() == detail::JOB_CANCELLED) {
+            throw operation_cancelled();
+        }
+        if (!job_->result) {
+            throw std::runtime_error("derivation failed");
+        }
+        return std::move(*job_->result);
+    }
+
+private:
+    friend class service;
+    operation(service *owner, E ex, std::shared_ptr<Job> job, cancel_token token)
+        : service_(owner), ex_(std::move(ex)), job_(std::move(job)), token_(std::move(token)) {}
+
+    service *service_;
+    E ex_;
+    std::shared_ptr<Job> job_;
+    cancel_token token_;
+};
+
+} // namespace mnmncs::async
+
+#endif // ASYNC_HPP
@@ -0,0 +1,735 @@
+/**
+ * @file bench.c
+ * @brief Micro-benchmarks for the building blocks of the batch pipelines
+ *
+ * Each benchmark runs a fixed number of operations and reports the wall
+ * time per operation and the throughput. The inter-stage queue benchmarks
+ * hand 64-bit records from producer to consumer threads through the
+ * lock-free ring and through a mutex/condition-variable queue of the same
+ * capacity, one element or a batch per call, and check that every record
+ * arrives exactly once. The TLB benchmarks walk a random cycle through a
+ * 256 MiB table mapped on 4 KiB pages and on huge pages. The kernel
+ * benchmarks time one SHA-512 block compression, one BIP-39 seed
+ * (PBKDF2-HMAC-SHA512, 2048 rounds) alone and eight lanes at a time, and
+ * one wordlist lookup. The seed batcher benchmark has client threads ask
+ * for one seed each, as a service would, and prints the batch fill, window
+ * and latency percentiles of the batcher to stderr.
+ *
+ * Around each run the hardware counters of the process and the threads it
+ * starts are read through perf_event_open: cycles, instructions, branch
+ * misses, L1D, LLC and dTLB read misses, reported per operation along with
+ * the IPC. Counters the kernel or the PMU refuses are shown as "-".
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "ring/ring.h"
+#include "hugepage/hugepage.h"
+#include "cpto/cpto.h"
+#include "wordlist/wordlist.h"
+#include "bip39/seedbatch.h"
+
+/** @brief Default operations per benchmark */
+#define BENCH_DEFAULT_OPS 4000000
+
+/** @brief Slots of the queues under test */
+#define QUEUE_CAPACITY 1024
+
+/** @brief Elements per call in the batched queue benchmarks */
+#define QUEUE_BATCH 32
+
+/** @brief Table walked by the TLB benchmarks, far beyond the 4 KiB-page TLB reach */
+#define TLB_TABLE_SIZE ((size_t)256 << 20)
+
+/** @brief Wordlist looked up by the wordlist benchmark */
+#define WORDLIST_BENCH_DIR "./wordlists"
+#define WORDLIST_BENCH_NAME "english.txt"
+
+/**
+ * @brief Bounded FIFO guarded by one mutex, the baseline for the ring.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+    uint64_t *items;
+    size_t capacity;
+    size_t head;          ///< Next element to pop.
+    size_t count;         ///< Elements held.
+    int closed;
+} mutex_queue;
+
+static int mutex_queue_init(mutex_queue *queue, size_t capacity) {
+    memset(queue, 0, sizeof(*queue));
+    queue->items = malloc(capacity * sizeof(uint64_t));
+    if (queue->items == NULL) {
+        return -1;
+    }
+    queue->capacity = capacity;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    return 0;
+}
+
+static void mutex_queue_free(mutex_queue *queue) {
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+}
+
+/** @brief Pushes all elements, as many per lock acquisition as fit */
+static void mutex_queue_push(mutex_queue *queue, const uint64_t *items, size_t count) {
+    pthread_mutex_lock(&queue->lock);
+    while (count > 0) {
+        while (queue->count == queue->capacity) {
+            pthread_cond_wait(&queue->not_full, &queue->lock);
+        }
+        while (count > 0 && queue->count < queue->capacity) {
+            queue->items[(queue->head + queue->count++) % queue->capacity] = *items++;
+            count--;
+        }
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/** @brief Pops 1 to max elements; 0 once closed and empty */
+static size_t mutex_queue_pop(mutex_queue *queue, uint64_t *items, size_t max) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    size_t n = 0;
+    while (n < max && queue->count > 0) {
+        items[n++] = queue->items[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+    }
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return n;
+}
+
+static void mutex_queue_close(mutex_queue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Shared state of one queue benchmark run.
+ */
+typedef struct {
+    int use_ring;                 ///< Ring if set, mutex queue otherwise.
+    ring ring;
+    mutex_queue mutex;
+    size_t batch;                 ///< Elements per push/pop call.
+    size_t per_producer;          ///< Records pushed by each producer.
+    atomic_size_t producers_left; ///< The last producer out closes the queue.
+    atomic_uint_fast64_t sum;     ///< Sum of the records popped.
+    atomic_size_t popped;         ///< Records popped.
+} queue_bench;
+
+typedef struct {
+    queue_bench *bench;
+    size_t id;
+} queue_thread;
+
+static void *queue_producer(void *arg) {
+    queue_thread *self = arg;
+    queue_bench *bench = self->bench;
+    uint64_t items[QUEUE_BATCH];
+    uint64_t next = (uint64_t)self->id * bench->per_producer + 1;
+    for (size_t done = 0; done < bench->per_producer;) {
+        size_t n = bench->per_producer - done < bench->batch ? bench->per_producer - done : bench->batch;
+        for (size_t i = 0; i < n; i++) {
+            items[i] = next++;
+        }
+        if (bench->use_ring) {
+            ring_push_all(&bench->ring, items, n);
+        } else {
+            mutex_queue_push(&bench->mutex, items, n);
+        }
+        done += n;
+    }
+    if (atomic_fetch_sub(&bench->producers_left, 1) == 1) {
+        if (bench->use_ring) {
+            ring_close(&bench->ring);
+        } else {
+            mutex_queue_close(&bench->mutex);
+        }
+    }
+    return NULL;
+}
+
+static void *queue_consumer(void *arg) {
+    queue_bench *bench = ((queue_thread *)arg)->bench;
+    uint64_t items[QUEUE_BATCH];
+    uint64_t sum = 0;
+    size_t popped = 0;
+    for (;;) {
+        size_t n = bench->use_ring ? ring_pop_wait(&bench->ring, items, bench->batch)
+                                   : mutex_queue_pop(&bench->mutex, items, bench->batch);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            sum += items[i];
+        }
+        popped += n;
+    }
+    atomic_fetch_add(&bench->sum, sum);
+    atomic_fetch_add(&bench->popped, popped);
+    return NULL;
+}
+
+/**
+ * @brief Runs producers and consumers over one queue.
+ *
+ * @param[in] use_ring Ring if set, mutex queue otherwise
+ * @param[in] producers Producer threads
+ * @param[in] consumers Consumer threads
+ * @param[in] batch Elements per call (1 to QUEUE_BATCH)
+ * @param[in] ops Records to hand over (rounded down to a multiple of producers)
+ * @return Records handed over, 0 on failure or lost/duplicated records
+ */
+static uint64_t run_queue(int use_ring, size_t producers, size_t consumers, size_t batch, uint64_t ops) {
+    queue_bench bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.use_ring = use_ring;
+    bench.batch = batch;
+    bench.per_producer = ops / producers;
+    atomic_init(&bench.producers_left, producers);
+    int result = use_ring ? ring_init(&bench.ring, QUEUE_CAPACITY, sizeof(uint64_t))
+                          : mutex_queue_init(&bench.mutex, QUEUE_CAPACITY);
+    if (result != 0) {
+        return 0;
+    }
+
+    size_t threads = producers + consumers;
+    pthread_t ids[threads];
+    queue_thread args[threads];
+    for (size_t t = 0; t < threads; t++) {
+        args[t].bench = &bench;
+        args[t].id = t < producers ? t : t - producers;
+        pthread_create(&ids[t], NULL, t < producers ? queue_producer : queue_consumer, &args[t]);
+    }
+    for (size_t t = 0; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    if (use_ring) {
+        ring_free(&bench.ring);
+    } else {
+        mutex_queue_free(&bench.mutex);
+    }
+
+    uint64_t total = (uint64_t)bench.per_producer * producers;
+    if (atomic_load(&bench.popped) != total || atomic_load(&bench.sum) != total * (total + 1) / 2) {
+        fprintf(stderr, "Queue lost or duplicated records\n");
+        return 0;
+    }
+    return total;
+}
+
+static uint64_t bench_ring_1p1c(void *state, uint64_t ops) { (void)state; return run_queue(1, 1, 1, 1, ops); }
+static uint64_t bench_mutex_1p1c(void *state, uint64_t ops) { (void)state; return run_queue(0, 1, 1, 1, ops); }
+static uint64_t bench_ring_4p4c(void *state, uint64_t ops) { (void)state; return run_queue(1, 4, 4, 1, ops); }
+static uint64_t bench_mutex_4p4c(void *state, uint64_t ops) { (void)state; return run_queue(0, 4, 4, 1, ops); }
+static uint64_t bench_ring_4p4c_batch(void *state, uint64_t ops) {
+    (void)state;
+    return run_queue(1, 4, 4, QUEUE_BATCH, ops);
+}
+static uint64_t bench_mutex_4p4c_batch(void *state, uint64_t ops) {
+    (void)state;
+    return run_queue(0, 4, 4, QUEUE_BATCH, ops);
+}
+
+/**
+ * @brief Table for the TLB benchmarks: one random cycle through its cache lines.
+ */
+typedef struct {
+    hugepage_region region;
+    size_t lines;           ///< 64-byte lines in the table.
+} tlb_table;
+
+/**
+ * @brief Maps a TLB_TABLE_SIZE table and links its lines into one random cycle.
+ *
+ * @param[in] best Most TLB-friendly backing to try
+ * @return Table, or NULL on failure
+ *
+ * @note Sattolo's shuffle gives a single cycle, so a walk visits every line
+ *       once per lap and each load depends on the one before it
+ */
+static tlb_table *tlb_setup(hugepage_backing best) {
+    tlb_table *table = calloc(1, sizeof(*table));
+    if (table == NULL || hugepage_alloc(&table->region, TLB_TABLE_SIZE, best) != HUGEPAGE_OK) {
+        free(table);
+        return NULL;
+    }
+    table->lines = TLB_TABLE_SIZE / 64;
+    uint32_t *order = malloc(table->lines * sizeof(uint32_t));
+    if (order == NULL) {
+        hugepage_free(&table->region);
+        free(table);
+        return NULL;
+    }
+    for (size_t i = 0; i < table->lines; i++) {
+        order[i] = (uint32_t)i;
+    }
+    uint64_t rng = 0x9e3779b97f4a7c15ull;
+    for (size_t i = table->lines - 1; i > 0; i--) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        size_t j = rng % i;
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    uint8_t *base = table->region.base;
+    for (size_t i = 0; i < table->lines; i++) {
+        // Line order[i] points at line order[i + 1]
+        *(uint32_t *)(base + (size_t)order[i] * 64) = order[(i + 1) % table->lines];
+    }
+    free(order);
+    fprintf(stderr, "tlb table: %zu MiB on %s pages\n", (size_t)(TLB_TABLE_SIZE >> 20),
+            hugepage_backing_name(table->region.backing));
+    return table;
+}
+
+static void *tlb_setup_small(void) { return tlb_setup(HUGEPAGE_NONE); }
+static void *tlb_setup_huge(void) { return tlb_setup(HUGEPAGE_HUGETLB); }
+
+static void tlb_teardown(void *state) {
+    tlb_table *table = state;
+    hugepage_free(&table->region);
+    free(table);
+}
+
+/** @brief Dependent random loads through the table, one per operation */
+static uint64_t bench_tlb_walk(void *state, uint64_t ops) {
+    const tlb_table *table = state;
+    const uint8_t *base = table->region.base;
+    uint32_t line = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        line = *(const uint32_t *)(base + (size_t)line * 64);
+    }
+    /* Keep the chain live */
+    return line < table->lines ? ops : 0;
+}
+
+/** @brief One SHA-512 block compression per operation, each chained on the last */
+static uint64_t bench_sha512_block(void *state, uint64_t ops) {
+    (void)state;
+    uint64_t digest[8] = {0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull,
+                          0xa54ff53a5f1d36f1ull, 0x510e527fade682d1ull, 0x9b05688c2b3e6c1full,
+                          0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull};
+    uint8_t block[SHA512_BLOCK_SIZE] = {0};
+    for (uint64_t i = 0; i < ops; i++) {
+        memcpy(block, digest, sizeof(digest));
+        sha512_compress(digest, block);
+    }
+    return digest[0] != 0 || digest[1] != 0 ? ops : 0;
+}
+
+/** @brief One BIP-39 seed (PBKDF2-HMAC-SHA512, 2048 rounds) per operation */
+static uint64_t bench_pbkdf2_seed(void *state, uint64_t ops) {
+    (void)state;
+    static const char mnemonic[] = "abandon abandon abandon abandon abandon abandon "
+                                   "abandon abandon abandon abandon abandon about";
+    uint8_t seed[64] = {0};
+    for (uint64_t i = 0; i < ops; i++) {
+        pbkdf2_hmac_sha512((const uint8_t *)mnemonic, sizeof(mnemonic) - 1,
+                           (const uint8_t *)"mnemonic", 8, 2048, seed, sizeof(seed));
+    }
+    // First byte of the BIP-39 test vector seed for this phrase
+    return seed[0] == 0x5e ? ops : 0;
+}
+
+/** @brief One BIP-39 seed per operation, derived SHA512_LANES at a time */
+static uint64_t bench_pbkdf2_seed_lanes(void *state, uint64_t ops) {
+    (void)state;
+    static const char mnemonic[] = "abandon abandon abandon abandon abandon abandon "
+                                   "abandon abandon abandon abandon abandon about";
+    const uint8_t *passwords[SHA512_LANES], *salts[SHA512_LANES];
+    size_t password_lens[SHA512_LANES], salt_lens[SHA512_LANES];
+    for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+        passwords[lane] = (const uint8_t *)mnemonic;
+        password_lens[lane] = sizeof(mnemonic) - 1;
+        salts[lane] = (const uint8_t *)"mnemonic";
+        salt_lens[lane] = 8;
+    }
+    uint8_t seeds[SHA512_LANES][64] = {{0}};
+    for (uint64_t i = 0; i < ops; i += SHA512_LANES) {
+        size_t lanes = ops - i < SHA512_LANES ? (size_t)(ops - i) : SHA512_LANES;
+        pbkdf2_hmac_sha512_lanes(passwords, password_lens, salts, salt_lens, 2048, lanes, seeds);
+    }
+    return seeds[0][0] == 0x5e ? ops : 0;
+}
+
+/** @brief Client threads asking a seed batcher for one seed at a time */
+#define SEEDBATCH_BENCH_CLIENTS 16
+
+/**
+ * @brief A batcher, the share of the operations of each client, and its counters.
+ */
+typedef struct {
+    bip39_seedbatch batch;
+    uint64_t per_client;
+    atomic_uint_fast64_t done;
+    bip39_seedbatch_stats stats;    ///< Read before the batcher is freed.
+} seedbatch_bench;
+
+static void *seedbatch_setup(void) {
+    return calloc(1, sizeof(seedbatch_bench));
+}
+
+static void seedbatch_teardown(void *state) {
+    seedbatch_bench *bench = state;
+    const bip39_seedbatch_stats *stats = &bench->stats;
+    fprintf(stderr, "seedbatch: %llu batches, %.2f lanes filled, window %.0f us, "
+            "p50 %.0f us, p99 %.0f us\n", (unsigned long long)stats->batches, stats->mean_fill,
+            stats->window_us, stats->p50_us, stats->p99_us);
+    free(bench);
+}
+
+static void *seedbatch_client(void *arg) {
+    seedbatch_bench *bench = arg;
+    static const char mnemonic[] = "abandon abandon abandon abandon abandon abandon "
+                                   "abandon abandon abandon abandon abandon about";
+    uint8_t seed[BIP39_SEED_SIZE];
+    for (uint64_t i = 0; i < bench->per_client; i++) {
+        if (bip39_seedbatch_mnemonic_to_seed(&bench->batch, mnemonic, NULL, seed) != 0 ||
+            seed[0] != 0x5e) {
+            return NULL;
+        }
+        atomic_fetch_add(&bench->done, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief One seed per operation, through the batcher
+ *
+ * @note The batcher starts and stops inside the run, so the hardware
+ *       counters include its workers
+ */
+static uint64_t bench_seedbatch(void *state, uint64_t ops) {
+    seedbatch_bench *bench = state;
+    bip39_seedbatch_config config = {BIP39_SEEDBATCH_MAX_LANES, 200, 0};
+    if (bip39_seedbatch_init(&bench->batch, &config) != 0) {
+        return 0;
+    }
+    pthread_t clients[SEEDBATCH_BENCH_CLIENTS];
+    size_t started = 0;
+    bench->per_client = (ops + SEEDBATCH_BENCH_CLIENTS - 1) / SEEDBATCH_BENCH_CLIENTS;
+    while (started < SEEDBATCH_BENCH_CLIENTS &&
+           pthread_create(&clients[started], NULL, seedbatch_client, bench) == 0) {
+        started++;
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(clients[i], NULL);
+    }
+    bip39_seedbatch_get_stats(&bench->batch, &bench->stats);
+    bip39_seedbatch_free(&bench->batch);
+    uint64_t done = atomic_load(&bench->done);
+    return started == SEEDBATCH_BENCH_CLIENTS && done == bench->per_client * SEEDBATCH_BENCH_CLIENTS ? done : 0;
+}
+
+/**
+ * @brief Wordlist and the words to look up, in shuffled order.
+ */
+typedef struct {
+    wordlist_registry registry;
+    const wordlist *list;
+    const char *queries[WORDLIST_WORD_COUNT];
+} wordlist_bench;
+
+static void *wordlist_setup(void) {
+    wordlist_bench *bench = calloc(1, sizeof(*bench));
+    if (bench == NULL) {
+        return NULL;
+    }
+    int position;
+    if (wordlist_registry_open(&bench->registry, WORDLIST_BENCH_DIR) != WORDLIST_OK ||
+        (position = wordlist_registry_find(&bench->registry, WORDLIST_BENCH_NAME)) < 0 ||
+        (bench->list = wordlist_registry_get(&bench->registry, (size_t)position, NULL)) == NULL) {
+        wordlist_registry_close(&bench->registry);
+        free(bench);
+        return NULL;
+    }
+    for (size_t i = 0; i < WORDLIST_WORD_COUNT; i++) {
+        bench->queries[i] = bench->list->words[i];
+    }
+    uint64_t rng = 0x2545f4914f6cdd1dull;
+    for (size_t i = WORDLIST_WORD_COUNT - 1; i > 0; i--) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        size_t j = rng % (i + 1);
+        const char *t = bench->queries[i];
+        bench->queries[i] = bench->queries[j];
+        bench->queries[j] = t;
+    }
+    return bench;
+}
+
+static void wordlist_teardown(void *state) {
+    wordlist_bench *bench = state;
+    wordlist_registry_close(&bench->registry);
+    free(bench);
+}
+
+/** @brief One word-to-index lookup per operation */
+static uint64_t bench_wordlist_lookup(void *state, uint64_t ops) {
+    const wordlist_bench *bench = state;
+    for (uint64_t i = 0; i < ops; i++) {
+        if (wordlist_index_of(bench->list, bench->queries[i % WORDLIST_WORD_COUNT]) < 0) {
+            return 0;
+        }
+    }
+    return ops;
+}
+
+/**
+ * @brief One benchmark.
+ */
+typedef struct {
+    const char *name;
+    void *(*setup)(void);                      ///< Untimed preparation (nullable).
+    uint64_t (*run)(void *state, uint64_t ops); ///< Runs `ops` operations; returns how many completed, 0 on failure.
+    void (*teardown)(void *state);             ///< Releases the setup state (nullable).
+    unsigned cost_shift;                       ///< Runs the requested operations divided by 2^cost_shift.
+} bench_case;
+
+static const bench_case BENCH_CASES[] = {
+    {"ring_1p1c", NULL, bench_ring_1p1c, NULL, 0},
+    {"mutex_1p1c", NULL, bench_mutex_1p1c, NULL, 0},
+    {"ring_4p4c", NULL, bench_ring_4p4c, NULL, 0},
+    {"mutex_4p4c", NULL, bench_mutex_4p4c, NULL, 0},
+    {"ring_4p4c_batch32", NULL, bench_ring_4p4c_batch, NULL, 0},
+    {"mutex_4p4c_batch32", NULL, bench_mutex_4p4c_batch, NULL, 0},
+    {"tlb_walk_4k", tlb_setup_small, bench_tlb_walk, tlb_teardown, 0},
+    {"tlb_walk_huge", tlb_setup_huge, bench_tlb_walk, tlb_teardown, 0},
+    {"sha512_block", NULL, bench_sha512_block, NULL, 2},
+    {"pbkdf2_seed", NULL, bench_pbkdf2_seed, NULL, 12},
+    {"pbkdf2_seed_lanes", NULL, bench_pbkdf2_seed_lanes, NULL, 12},
+    {"seedbatch_16c", seedbatch_setup, bench_seedbatch, seedbatch_teardown, 12},
+    {"wordlist_lookup", wordlist_setup, bench_wordlist_lookup, wordlist_teardown, 0},
+};
+
+/**
+ * @brief Hardware events counted around each run.
+ */
+typedef enum {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_DTLB_MISSES,
+    COUNTER_COUNT
+} counter_id;
+
+/** @brief perf_event_attr type and config of each counter_id */
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} COUNTER_EVENTS[COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+/**
+ * @brief Open counters, one file descriptor each (-1 when refused).
+ *
+ * @note The events are not grouped: a group that does not fit the PMU is
+ *       never scheduled, while single events are multiplexed and scaled.
+ *       Inheriting counters also cannot be read as a group.
+ */
+typedef struct {
+    int fds[COUNTER_COUNT];
+    double values[COUNTER_COUNT];   ///< Counts of the last run, scaled for multiplexing; < 0 if unknown.
+} counters;
+
+/**
+ * @brief Opens the counters for this process and every thread it starts later.
+ *
+ * @param[out] set Counters, disabled
+ * @param[in] report Prints why when no counter can be opened
+ * @return Number of counters opened
+ *
+ * @note User-space counting only, which perf_event_paranoid up to 2 allows.
+ *       A fresh set per run: an inherited counter keeps the counts of exited
+ *       threads, which PERF_EVENT_IOC_RESET does not clear
+ */
+static size_t counters_open(counters *set, int report) {
+    size_t opened = 0;
+    int error = 0;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = COUNTER_EVENTS[i].type;
+        attr.config = COUNTER_EVENTS[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        set->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        set->values[i] = -1;
+        if (set->fds[i] >= 0) {
+            opened++;
+        } else if (error == 0) {
+            error = errno;
+        }
+    }
+    if (opened == 0 && report) {
+        fprintf(stderr, "hardware counters unavailable (perf_event_open: %s)%s\n", strerror(error),
+                error == EACCES || error == EPERM ? "; check kernel.perf_event_paranoid" : "");
+    }
+    return opened;
+}
+
+static void counters_close(counters *set) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (set->fds[i] >= 0) {
+            close(set->fds[i]);
+        }
+    }
+}
+
+/** @brief Starts the open counters */
+static void counters_start(counters *set) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (set->fds[i] >= 0) {
+            ioctl(set->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/**
+ * @brief Stops the counters and reads them into values.
+ *
+ * @note Threads add their counts when they exit, so join them first
+ */
+static void counters_stop(counters *set) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        set->values[i] = -1;
+        if (set->fds[i] < 0) {
+            continue;
+        }
+        ioctl(set->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t data[3]; // value, time enabled, time running
+        if (read(set->fds[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) {
+            continue;
+        }
+        set->values[i] = (double)data[0] * ((double)data[1] / (double)data[2]);
+    }
+}
+
+/** @brief Prints a count per operation, or "-" when unknown */
+static void print_per_op(double value, uint64_t ops, const char *format) {
+    if (value < 0) {
+        printf(" %9s", "-");
+    } else {
+        printf(format, value / (double)ops);
+    }
+}
+
+/** @brief Monotonic time in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Runs the benchmarks whose name contains a filter
+ *
+ * @note Usage: ./bench [filter] [operations]
+ */
+int main(int argc, char *argv[]) {
+    const char *filter = argc > 1 ? argv[1] : "";
+    long long ops = argc > 2 ? strtoll(argv[2], NULL, 10) : BENCH_DEFAULT_OPS;
+    if (argc > 3 || ops < 1) {
+        fprintf(stderr, "Usage: %s [filter] [operations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    counters hw;
+    int counters_reported = 0;
+    int status = EXIT_SUCCESS;
+    printf("%-22s %12s %10s %10s %10s %9s %9s %9s %9s %9s %9s\n", "benchmark", "ops", "seconds",
+           "ns/op", "Mops/s", "cycles/op", "IPC", "brmiss/op", "L1D/op", "LLC/op", "dTLB/op");
+    for (size_t i = 0; i < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]); i++) {
+        const bench_case *bench = &BENCH_CASES[i];
+        if (strstr(bench->name, filter) == NULL) {
+            continue;
+        }
+        void *state = NULL;
+        if (bench->setup != NULL && (state = bench->setup()) == NULL) {
+            fprintf(stderr, "%s: setup failed\n", bench->name);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        uint64_t requested = (uint64_t)ops >> bench->cost_shift;
+        // Opened after setup, read once teardown has joined the run's threads
+        counters_open(&hw, !counters_reported);
+        counters_reported = 1;
+        counters_start(&hw);
+        double start = now_seconds();
+        uint64_t done = bench->run(state, requested > 0 ? requested : 1);
+        double seconds = now_seconds() - start;
+        if (bench->teardown != NULL) {
+            bench->teardown(state);
+        }
+        counters_stop(&hw);
+        counters_close(&hw);
+        if (done == 0) {
+            fprintf(stderr, "%s failed\n", bench->name);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        printf("%-22s %12llu %10.3f %10.1f %10.2f", bench->name, (unsigned long long)done,
+               seconds, seconds * 1e9 / (double)done, (double)done / seconds / 1e6);
+        const double *v = hw.values;
+        print_per_op(v[COUNTER_CYCLES], done, " %9.0f");
+        if (v[COUNTER_CYCLES] > 0 && v[COUNTER_INSTRUCTIONS] >= 0) {
+            printf(" %9.2f", v[COUNTER_INSTRUCTIONS] / v[COUNTER_CYCLES]);
+        } else {
+            printf(" %9s", "-");
+        }
+        print_per_op(v[COUNTER_BRANCH_MISSES], done, " %9.3f");
+        print_per_op(v[COUNTER_L1D_MISSES], done, " %9.3f");
+        print_per_op(v[COUNTER_LLC_MISSES], done, " %9.3f");
+        print_per_op(v[COUNTER_DTLB_MISSES], done, " %9.3f");
+        printf("\n");
+    }
+    return status;
+}
@@ -13,101 +13,34 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
 
- #include <openssl/hmac.h>
- #include <openssl/sha.h>
- #include <openssl/evp.h>
+#include <openssl/crypto.h>
 
-/** @brief Type definition for byte to improve readability */
-typedef unsigned char byte;
-
-/** @brief Size of SHA-512 digest in bytes */
-#define SHA512_DIGEST_SIZE 64
-
-/** @brief Expected BIP-39 seed length in bytes */
-#define BIP39_SEED_LENGTH 64
-
-/** @brief Private key length in bytes */
-#define PRIVATE_KEY_LENGTH 32
-
-/** @brief Chain code length in bytes */
-#define CHAIN_CODE_LENGTH 32
-
-/** @brief Version byte for mainnet private key */
-#define WIF_VERSION_BYTE 0x80
-
-/** @brief BIP-32 root key for HMAC derivation */
-#define BIP32_KEY "Bitcoin seed"
-
-/** @brief Error codes for functions */
-enum {
-    SUCCESS = 0,
-    ERROR_INVALID_INPUT = -1,
-    ERROR_INVALID_LENGTH = -2,
-    ERROR_INTERNAL = -3
-};
-
-/**
- * @brief Implementation of Base58 encoding for Bitcoin addresses and keys
- * 
- * @param[out] output Base58-encoded output string
- * @param[in] input Binary input data
- * @param[in] input_len Length of input data in bytes
- * @return Length of the encoded string
- */
-size_t base58_encode(byte *output, const byte *input, size_t input_len) {
-    /* Declare Base58 alphabet */
-    const char *alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-    
-    /* Count leading zeros */
-    size_t zeros = 0;
-    while (zeros < input_len && input[zeros] == 0) {
-        zeros++;
-    }
-    
-    /* Calculate output size: worst case is 1.4x input size */
-    size_t output_size = input_len * 138 / 100 + 1;
-    byte buffer[output_size];
-    memset(buffer, 0, output_size);
-    
-    /* Convert binary to Base58 */
-    for (size_t i = zeros; i < input_len; i++) {
-        uint32_t carry = input[i];
-        size_t j = 0;
-        
-        for (size_t k = output_size - 1; k >= 0; k--, j++) {
-            if (j < output_size) {
-                carry += 256 * buffer[k];
-                buffer[k] = carry % 58;
-                carry /= 58;
-            }
-            
-            if (carry == 0 && j >= output_size - 1) {
-                break;
-            }
-        }
-    }
-    
-    /* Skip leading zeros in result */
-    size_t result_start = 0;
-    while (result_start < output_size && buffer[result_start] == 0) {
-        result_start++;
-    }
-    
-    /* Add leading '1' chars for each leading zero byte */
-    size_t output_index = 0;
-    for (size_t i = 0; i < zeros; i++) {
-        output[output_index++] = '1';
-    }
-    
-    /* Convert to Base58 alphabet */
-    for (size_t i = result_start; i < output_size; i++) {
-        output[output_index++] = alphabet[buffer[i]];
-    }
-    
-    output[output_index] = '\0';
-    return output_index;
-}
+#include "hdkey/hdkey.h"
+#include "hdkey/hdbatch.h"
+#include "descriptor/descriptor.h"
+#include "addrmatch/addrmatch.h"
+#include "scan/scan.h"
+#include "bip85/bip85.h"
+#include "bip39/correct.h"
+#include "bip39/detect.h"
+#include "bip39/seedcache.h"
+#include "bip39/recover.h"
+#include "cluster/cluster.h"
+#include "shmipc/shmipc.h"
+#include "bip38/bip38.h"
+#include "seal/seal.h"
+#include "record/record.h"
+#include "arrow/arrow.h"
+#include "keystore/keystore.h"
+#include "ring/ring.h"
+#include "topology/topology.h"
+#include "hugepage/hugepage.h"
 
 /**
  * @brief Converts a hexadecimal string to binary data
@@ -153,143 +86,6 @@ static void print_hex(const char *label, const byte *data, size_t len) {
     printf("\n");
 }
 
-/**
- * @brief Derives BIP-32 master key and chain code from a BIP-39 seed
- *
- * @param[in] seed Pointer to the BIP-39 seed
- * @param[in] seed_len Length of the seed in bytes
- * @param[out] private_key_out Buffer to store the master private key (32 bytes)
- * @param[out] chain_code_out Buffer to store the chain code (32 bytes)
- * @return 0 on success, negative error code on failure
- * 
- * @note Uses HMAC-SHA512 with "Bitcoin seed" as key per BIP-32 specification
- * @note Output buffers must be at least 32 bytes each
- */
-static int derive_bip32_master_key(
-    const byte *seed, 
-    size_t seed_len,
-    byte *private_key_out, 
-    byte *chain_code_out
-) {
-    if (seed == NULL || private_key_out == NULL || chain_code_out == NULL) {
-        return ERROR_INVALID_INPUT;
-    }
-    
-    if (seed_len != BIP39_SEED_LENGTH) {
-        fprintf(stderr, "Invalid seed length: %zu bytes (expected %d)\n", 
-                seed_len, BIP39_SEED_LENGTH);
-        return ERROR_INVALID_LENGTH;
-    }
-    
-    byte master_key[SHA512_DIGEST_SIZE];
-    
-    /* HMAC-SHA512 with key "Bitcoin seed" and message as the seed */
-    unsigned int md_len = SHA512_DIGEST_SIZE;
-    if (HMAC(EVP_sha512(), 
-        BIP32_KEY, strlen(BIP32_KEY),
-            seed, seed_len,
-            master_key, &md_len) == NULL) {
-        fprintf(stderr, "HMAC-SHA512 failed\n");
-        return ERROR_INTERNAL;
-    }
-    
-    /* First 32 bytes are the master private key */
-    memcpy(private_key_out, master_key, PRIVATE_KEY_LENGTH);
-    
-    /* Last 32 bytes are the chain code */
-    memcpy(chain_code_out, master_key + PRIVATE_KEY_LENGTH, CHAIN_CODE_LENGTH);
-    
-    return SUCCESS;
-}
-
-/**
- * @brief Converts a private key to WIF (Wallet Import Format)
- *
- * @param[in] private_key 32-byte private key
- * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
- * @return 0 on success, negative error code on failure
- */
-static int private_key_to_wif(const byte *private_key, byte *wif_key) {
-    if (private_key == NULL || wif_key == NULL) {
-        return ERROR_INVALID_INPUT;
-    }
-
-    byte versioned_key[PRIVATE_KEY_LENGTH + 1 + 4]; /* Key + version + checksum */
-    byte checksum[32];
-
-    /* Prepend version byte (0x80 for mainnet) */
-    versioned_key[0] = WIF_VERSION_BYTE;
-    memcpy(versioned_key + 1, private_key, PRIVATE_KEY_LENGTH);
-
-    /* Double SHA-256 checksum */
-    SHA256(versioned_key, PRIVATE_KEY_LENGTH + 1, checksum);
-    SHA256(checksum, 32, checksum);
-
-    /* Append first 4 bytes of checksum */
-    memcpy(versioned_key + PRIVATE_KEY_LENGTH + 1, checksum, 4);
-
-    /* Base58Check encode */
-    size_t len = base58_encode(wif_key, versioned_key, PRIVATE_KEY_LENGTH + 1 + 4);
-    if (len == 0) {
-        return ERROR_INTERNAL;
-    }
-    
-    wif_key[len] = '\0';
-    return SUCCESS;
-}
-
-/**
- * @brief Generate extended private key (xprv) from master private key and chain code
- *
- * @param[in] private_key 32-byte private key
- * @param[in] chain_code 32-byte chain code
- * @param[out] xprv Output buffer for xprv (should be at least 112 bytes)
- * @return 0 on success, negative error code on failure
- */
-static int generate_xprv(const byte *private_key, const byte *chain_code, byte *xprv) {
-    if (private_key == NULL || chain_code == NULL || xprv == NULL) {
-        return ERROR_INVALID_INPUT;
-    }
-
-    /* xprv format:
-     * 4 bytes: version
-     * 1 byte: depth
-     * 4 bytes: parent fingerprint
-     * 4 bytes: child number
-     * 32 bytes: chain code
-     * 33 bytes: private key (0x00 + 32-byte key)
-     * 4 bytes: checksum
-     * Total: 82 bytes
-     */
-    byte xprv_raw[82];
-    
-    /* xprv version bytes */
-    byte version[4] = {0x04, 0x88, 0xAD, 0xE4};
-    
-    /* Build xprv structure */
-    memcpy(xprv_raw, version, 4);
-    memset(xprv_raw + 4, 0, 9);  /* Depth, fingerprint, and child number */
-    memcpy(xprv_raw + 13, chain_code, 32);
-    xprv_raw[45] = 0x00;  /* Prepend 0x00 to private key */
-    memcpy(xprv_raw + 46, private_key, 32);
-
-    /* Calculate checksum (first 4 bytes of double SHA-256) */
-    byte checksum[32];
-    SHA256(xprv_raw, 78, checksum);
-    SHA256(checksum, 32, checksum);
-    
-    memcpy(xprv_raw + 78, checksum, 4);
-
-    /* Base58 encode the extended key */
-    size_t len = base58_encode(xprv, xprv_raw, 82);
-    if (len == 0) {
-        return ERROR_INTERNAL;
-    }
-    
-    xprv[len] = '\0';
-    return SUCCESS;
-}
-
 /**
  * @brief Print xprv and WIF formats of a private key
  *
@@ -344,17 +140,23 @@ static int print_xprv_and_wif(const byte *private_key, const byte *chain_code) {
     
     printf("Option 2: Descriptor Wallet Import\n");
     printf("----------------------------------\n");
-    printf("# First get the descriptor checksum:\n");
-    printf("bitcoin-cli getdescriptorinfo \"pkh(%s)\"\n\n", wif_key);
-    printf("# Then import using the descriptor (replace #checksum):\n");
+    /* Checksum computed in-tree, no getdescriptorinfo round trip */
+    char desc[DESCRIPTOR_MAX_LENGTH];
+    snprintf(desc, sizeof(desc), "pkh(%s)", wif_key);
+    result = descriptor_append_checksum(desc, sizeof(desc));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Failed to compute descriptor checksum\n");
+        return result;
+    }
     printf("bitcoin-cli importdescriptors '[{\n");
-    printf("  \"desc\": \"pkh(%s)#checksum\",\n", wif_key);
+    printf("  \"desc\": \"%s\",\n", desc);
     printf("  \"timestamp\": \"now\",\n");
     printf("  \"label\": \"my_label\",\n");
     printf("  \"active\": false\n");
     printf("}]'\n");
     printf("# There is probably a more up-to-date improved way of importing descriptors.\n");
-    printf("# But we are using `active: false` here to be able to import single key into wallet.");
+    printf("# But we are using `active: false` here to be able to import single key into wallet.\n");
+    printf("# For HD account descriptors (wpkh/tr/pkh with origin info) run: bip32 descriptors <seed_hex>");
 
     return SUCCESS;
 }
@@ -367,6 +169,30 @@ void print_ending() {
     printf("\n");
 }
 
+/**
+ * @brief Prints the seed, master key and the xprv/WIF import instructions
+ *
+ * @param[in] seed 64-byte BIP-39 seed
+ * @param[in] private_key 32-byte master private key
+ * @param[in] chain_code 32-byte master chain code
+ * @return 0 on success, negative error code on failure
+ */
+static int print_master_key_results(const byte *seed, const byte *private_key,
+                                    const byte *chain_code) {
+    /* Print results */
+    printf("Input BIP-39 Seed (hex):\n");
+    print_hex("Seed", seed, BIP39_SEED_LENGTH);
+    printf("\nBIP-32 Master Key Derivation Results:\n");
+    print_hex("Master Private Key", private_key, PRIVATE_KEY_LENGTH);
+    print_hex("Master Chain Code", chain_code, CHAIN_CODE_LENGTH);
+    printf("\n");
+
+    /* Print xprv and WIF formats */
+    int result = print_xprv_and_wif(private_key, chain_code);
+    print_ending();
+    return result;
+}
+
 /**
  * @brief Processes a BIP-39 seed in hex format and derives/displays BIP-32 master key
  *
@@ -397,46 +223,2444 @@ static int process_bip32_seed(const char *seed_hex) {
         return result;
     }
     
-    /* Print results */
-    printf("Input BIP-39 Seed (hex):\n");
-    print_hex("Seed", seed, sizeof(seed));
-    printf("\nBIP-32 Master Key Derivation Results:\n");
-    print_hex("Master Private Key", private_key, sizeof(private_key));
-    print_hex("Master Chain Code", chain_code, sizeof(chain_code));
-    printf("\n");
+    return print_master_key_results(seed, private_key, chain_code);
+}
 
-    /* Print xprv and WIF formats */
-    result = print_xprv_and_wif(private_key, chain_code);
-    print_ending();
+/**
+ * @brief Checks a phrase against the English wordlist and its checksum
+ *
+ * @param[in] mnemonic Space separated mnemonic phrase
+ * @return 0 if the phrase is valid, negative error code otherwise
+ *
+ * @note PBKDF2 accepts any string, so a mistyped phrase would silently give
+ *       the keys of another wallet; the reason a phrase is refused goes to stderr
+ */
+static int check_mnemonic(const char *mnemonic) {
+    char buffer[BIP39_MNEMONIC_MAX_SIZE];
+    if (strlen(mnemonic) >= sizeof(buffer)) {
+        fprintf(stderr, "Phrase too long\n");
+        return ERROR_INVALID_INPUT;
+    }
+    bip39_wordlist list;
+    if (bip39_wordlist_load(&list, "./wordlists/english.txt") != 0) {
+        fprintf(stderr, "Cannot load ./wordlists/english.txt\n");
+        return ERROR_INVALID_INPUT;
+    }
+
+    strcpy(buffer, mnemonic);
+    uint16_t indices[24];
+    size_t count = 0;
+    int result = SUCCESS;
+    char *save = NULL;
+    for (char *word = strtok_r(buffer, " ", &save); word != NULL && result == SUCCESS;
+         word = strtok_r(NULL, " ", &save)) {
+        if (count == 24) {
+            fprintf(stderr, "More than 24 words\n");
+            result = ERROR_INVALID_INPUT;
+            break;
+        }
+        size_t i = 0;
+        while (i < BIP39_WORD_COUNT && strcmp(list.words[i], word) != 0) i++;
+        if (i == BIP39_WORD_COUNT) {
+            fprintf(stderr, "Word %zu is not in the English list (try `correct`)\n", count + 1);
+            result = ERROR_INVALID_INPUT;
+        }
+        indices[count++] = (uint16_t)i;
+    }
+    byte entropy[32];
+    if (result == SUCCESS && (count < 12 || count % 3 != 0)) {
+        fprintf(stderr, "A phrase has 12, 15, 18, 21 or 24 words, not %zu\n", count);
+        result = ERROR_INVALID_INPUT;
+    } else if (result == SUCCESS && bip39_indices_to_entropy(indices, count, entropy, NULL) != 0) {
+        fprintf(stderr, "Invalid checksum: a word is wrong or out of order (try `correct`)\n");
+        result = ERROR_INVALID_INPUT;
+    }
+
+    OPENSSL_cleanse(buffer, sizeof(buffer));
+    OPENSSL_cleanse(indices, sizeof(indices));
+    OPENSSL_cleanse(entropy, sizeof(entropy));
+    bip39_wordlist_free(&list);
+    return result;
+}
+
+/**
+ * @brief Derives/displays the BIP-32 master key directly from a mnemonic
+ *
+ * @param[in] mnemonic Space separated mnemonic phrase
+ * @param[in] passphrase Optional BIP-39 passphrase (can be NULL)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note The seed is handed from PBKDF2 to the master-key HMAC in memory,
+ *       without the hex round-trip through `mnemonics` and `bip32 <seed_hex>`.
+ *       Phrases with an unknown word or a bad checksum are refused.
+ */
+static int process_bip32_mnemonic(const char *mnemonic, const char *passphrase) {
+    if (mnemonic == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    int result = check_mnemonic(mnemonic);
     if (result != SUCCESS) {
         return result;
     }
-    
+
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+
+    result = derive_bip32_master_key_from_mnemonic(mnemonic, passphrase, seed,
+                                                   private_key, chain_code);
+    if (result != SUCCESS) {
+        fprintf(stderr, "Failed to derive master key from mnemonic\n");
+        return result;
+    }
+
+    return print_master_key_results(seed, private_key, chain_code);
+}
+
+/** @brief Suggestions printed per misspelled word and phrases printed in correct mode */
+#define CORRECT_MAX_SUGGESTIONS 8
+
+/**
+ * @brief Suggests corrections for a mistyped phrase
+ *
+ * @param[in] mnemonic Space separated phrase as typed
+ * @param[in] max_distance Largest edit distance per word
+ * @return 0 if at least one phrase with a valid checksum was found
+ *
+ * @note Prints the nearest words for every position not in the English list,
+ *       then the checksum-valid phrases, lowest total distance first
+ */
+static int process_bip32_correct(const char *mnemonic, unsigned max_distance) {
+    char buffer[BIP39_MNEMONIC_MAX_SIZE];
+    const char *words[24];
+    size_t count = 0;
+    if (strlen(mnemonic) >= sizeof(buffer)) {
+        fprintf(stderr, "Phrase too long\n");
+        return ERROR_INVALID_INPUT;
+    }
+    strcpy(buffer, mnemonic);
+    for (char *word = strtok(buffer, " \t"); word != NULL; word = strtok(NULL, " \t")) {
+        if (count == 24) {
+            fprintf(stderr, "More than 24 words\n");
+            return ERROR_INVALID_INPUT;
+        }
+        words[count++] = word;
+    }
+
+    bip39_wordlist list;
+    bip39_corrector corrector;
+    if (bip39_wordlist_load(&list, "./wordlists/english.txt") != 0) {
+        fprintf(stderr, "Cannot load ./wordlists/english.txt\n");
+        return ERROR_INVALID_INPUT;
+    }
+    if (bip39_corrector_init(&corrector, &list) != 0) {
+        bip39_wordlist_free(&list);
+        return ERROR_INTERNAL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bip39_candidate candidates[CORRECT_MAX_SUGGESTIONS];
+        size_t found = bip39_correct_word(&corrector, words[i], max_distance,
+                                          candidates, CORRECT_MAX_SUGGESTIONS);
+        if (found > 0 && candidates[0].distance == 0) {
+            continue;
+        }
+        printf("word %zu \"%s\":", i + 1, words[i]);
+        for (size_t j = 0; j < found && j < CORRECT_MAX_SUGGESTIONS; j++) {
+            printf(" %s(%u)", list.words[candidates[j].index], candidates[j].distance);
+        }
+        printf(found == 0 ? " no word within %u edits\n" : "\n", max_distance);
+    }
+
+    bip39_phrase_candidate phrases[CORRECT_MAX_SUGGESTIONS];
+    uint64_t checked = 0;
+    int found = bip39_correct_phrase(&corrector, words, count, max_distance,
+                                     phrases, CORRECT_MAX_SUGGESTIONS, &checked);
+    int result = SUCCESS;
+    if (found < 0) {
+        fprintf(stderr, "Cannot search: wrong word count, a word without candidates, "
+                        "or too many combinations (lower the distance)\n");
+        result = ERROR_INVALID_INPUT;
+    } else {
+        fprintf(stderr, "%llu combinations checked, %d with a valid checksum\n",
+                (unsigned long long)checked, found);
+        for (int i = 0; i < found; i++) {
+            for (size_t j = 0; j < count; j++) {
+                printf(j ? " %s" : "%s", list.words[phrases[i].indices[j]]);
+            }
+            printf("  (%u edits)\n", phrases[i].distance);
+        }
+        result = found > 0 ? SUCCESS : ERROR_INVALID_INPUT;
+    }
+
+    OPENSSL_cleanse(buffer, sizeof(buffer));
+    OPENSSL_cleanse(phrases, sizeof(phrases));
+    bip39_corrector_free(&corrector);
+    bip39_wordlist_free(&list);
+    return result;
+}
+
+/**
+ * @brief Prints checksummed account descriptors for a seed
+ *
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] accounts Number of accounts, starting at 0
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr" or NULL for all four
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_descriptors(const char *seed_hex, uint32_t accounts,
+                                     const char *type_name, FILE *out) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+
+    descriptor_type types[] = {DESCRIPTOR_PKH, DESCRIPTOR_SH_WPKH,
+                               DESCRIPTOR_WPKH, DESCRIPTOR_TR};
+    size_t type_count = sizeof(types) / sizeof(types[0]);
+    if (type_name != NULL) {
+        if (descriptor_type_from_name(type_name, &types[0]) != SUCCESS) {
+            fprintf(stderr, "Unknown descriptor type: %s (pkh, sh-wpkh, wpkh, tr)\n", type_name);
+            return ERROR_INVALID_INPUT;
+        }
+        type_count = 1;
+    }
+
+    int result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+        return result;
+    }
+    result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+    for (size_t i = 0; i < type_count && result == SUCCESS; i++) {
+        result = descriptor_write_accounts(out, private_key, chain_code,
+                                           types[i], 0, accounts);
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Failed to build descriptors\n");
+    }
+
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/**
+ * @brief Builds an address index file from a text list
+ *
+ * @param[in] list_path Text file with one address, scriptPubKey hex or HASH160 per line ("-" for stdin)
+ * @param[in] index_path Index file to write
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_index_build(const char *list_path, const char *index_path) {
+    FILE *in = strcmp(list_path, "-") == 0 ? stdin : fopen(list_path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot open %s\n", list_path);
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint64_t count = 0;
+    uint64_t skipped = 0;
+    int result = addrmatch_build(in, index_path, &count, &skipped);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Failed to write index %s\n", index_path);
+        return result;
+    }
+    fprintf(stderr, "Indexed %llu keys, skipped %llu unsupported lines\n",
+            (unsigned long long)count, (unsigned long long)skipped);
     return SUCCESS;
 }
 
 /**
- * @brief Main function demonstrating BIP-32 master key derivation
+ * @brief Prints one matched address with its derivation path
  *
- * @param[in] argc Number of command-line arguments
- * @param[in] argv Array of command-line argument strings
- * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure
- * 
- * @note Expects one argument: 128-character hex string representing BIP-39 seed
- * @note Usage: ./program <seed_hex>
+ * @param[in] hit Matched address
+ * @param[in] ctx Unused
+ * @return 0 to continue the scan
  */
-int main(int argc, char *argv[]) {
-    printf("\n\nBIP-32 creating pubkey and privkey to import.\n\n");
-    /* Check if seed hex is provided as command-line argument */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <64-byte-seed-in-hex>\n", argv[0]);
-        fprintf(stderr, "Example: %s 2f00201a843bf367ed45fda52ea0d3aba21ee730ad1a93189e67ae0e6faae4bb3a32629b955d1cfcde3becc25f2e39519e1e5d9ee8318c6217b11bcedb9f9683\n", argv[0]);
-        return EXIT_FAILURE;
+static int print_match(const addrmatch_hit *hit, void *ctx) {
+    (void)ctx;
+    printf("m/%u'/0'/%u'/%u/%u %s\n", address_purpose(hit->type), hit->account,
+           hit->chain, hit->index, hit->address);
+    return SUCCESS;
+}
+
+/** @brief Most accounts scanned per purpose in match mode */
+#define MATCH_MAX_ACCOUNTS 100
+
+/**
+ * @brief Finds the used addresses of a seed in an address index
+ *
+ * @param[in] index_path Index file built with "index"
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] gap Gap limit per chain
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr" or NULL for all four
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_match(const char *index_path, const char *seed_hex, uint32_t gap,
+                               const char *type_name) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+
+    /* Descriptor types and address types share their order */
+    address_type types[] = {ADDRESS_P2PKH, ADDRESS_P2SH_P2WPKH, ADDRESS_P2WPKH, ADDRESS_P2TR};
+    size_t type_count = sizeof(types) / sizeof(types[0]);
+    if (type_name != NULL) {
+        descriptor_type type;
+        if (descriptor_type_from_name(type_name, &type) != SUCCESS) {
+            fprintf(stderr, "Unknown address type: %s (pkh, sh-wpkh, wpkh, tr)\n", type_name);
+            return ERROR_INVALID_INPUT;
+        }
+        types[0] = (address_type)type;
+        type_count = 1;
     }
-    
-    if (process_bip32_seed(argv[1]) != SUCCESS) {
-        return EXIT_FAILURE;
+
+    int result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+        return result;
     }
-    
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+
+    addrmatch_index index;
+    result = addrmatch_open(&index, index_path);
+    if (result != SUCCESS) {
+        fprintf(stderr, "Cannot open address index %s\n", index_path);
+        OPENSSL_cleanse(seed, sizeof(seed));
+        return result;
+    }
+
+    addrmatch_stats stats = {0, 0, 0};
+    result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+    for (size_t i = 0; i < type_count && result == SUCCESS; i++) {
+        result = addrmatch_scan(&index, private_key, chain_code, types[i], MATCH_MAX_ACCOUNTS,
+                                gap, print_match, NULL, &stats);
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Address scan failed\n");
+    } else {
+        fprintf(stderr, "Checked %llu addresses: %llu bloom positives, %llu used\n",
+                (unsigned long long)stats.derived, (unsigned long long)stats.bloom_passes,
+                (unsigned long long)stats.hits);
+    }
+
+    addrmatch_close(&index);
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/**
+ * @brief Selects the address types of a scan by name
+ *
+ * @param[out] spec Scan spec whose types are set
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr", "all" or NULL for all four
+ * @return 0 on success, ERROR_INVALID_INPUT for an unknown name
+ */
+static int set_scan_types(scan_spec *spec, const char *type_name) {
+    spec->types = SCAN_ALL_TYPES;
+    if (type_name != NULL && strcmp(type_name, "all") != 0) {
+        /* Descriptor types and address types share their order */
+        descriptor_type type;
+        if (descriptor_type_from_name(type_name, &type) != SUCCESS) {
+            fprintf(stderr, "Unknown address type: %s (pkh, sh-wpkh, wpkh, tr, all)\n", type_name);
+            return ERROR_INVALID_INPUT;
+        }
+        spec->types = SCAN_TYPE((address_type)type);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Prints one block of scanned addresses, one "path address" line each
+ *
+ * @param[in] entries Addresses of one chain
+ * @param[in] count Number of entries
+ * @param[in] ctx Output stream
+ * @return 0 on success, ERROR_INTERNAL if the stream failed
+ */
+static int print_scan_block(const scan_entry *entries, size_t count, void *ctx) {
+    FILE *out = ctx;
+    for (size_t i = 0; i < count; i++) {
+        const scan_entry *e = &entries[i];
+        fprintf(out, "m/%u'/0'/%u'/%u/%u %s\n", address_purpose(e->type), e->account,
+                e->chain, e->index, e->address);
+    }
+    return ferror(out) ? ERROR_INTERNAL : SUCCESS;
+}
+
+/**
+ * @brief Derives the addresses of many purposes and accounts in one run
+ *
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] spec Scan spec; types of 0 means all four
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr" or NULL for all four
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_scan(const char *seed_hex, scan_spec *spec, const char *type_name,
+                              FILE *out) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+
+    int result = set_scan_types(spec, type_name);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+        return result;
+    }
+
+    result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+    if (result == SUCCESS) {
+        result = scan_run(private_key, chain_code, spec, print_scan_block, out);
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Address scan failed\n");
+    }
+
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/** @brief Size of an xpub string buffer */
+#define ARROW_XPUB_SIZE 112
+
+/** @brief Size of a "m/purpose'/0'/account'/chain" string buffer */
+#define ARROW_PATH_SIZE 32
+
+/**
+ * @brief Columnar export state shared by the scan workers
+ */
+typedef struct {
+    arrow_writer writer;
+    uint32_t fingerprint;                ///< Master key fingerprint
+    int type_slots[4];                   ///< Position of each address type in the export, -1 if absent
+    uint32_t first_account;
+    uint32_t accounts;
+    unsigned chains;                     ///< SCAN_RECEIVE and/or SCAN_CHANGE
+} arrow_export;
+
+/**
+ * @brief Encodes one scanned block as a record batch, on the worker that derived it
+ *
+ * @param[in] entries Addresses of one chain
+ * @param[in] count Number of entries
+ * @param[in] ctx Export state
+ * @return 0 on success, negative error code on failure
+ */
+static int write_arrow_block(const scan_entry *entries, size_t count, void *ctx) {
+    arrow_export *export = ctx;
+    uint32_t indices[SCAN_BLOCK];
+    int32_t paths[SCAN_BLOCK];
+    uint32_t fingerprints[SCAN_BLOCK];
+    int32_t xpubs[SCAN_BLOCK];
+    char addresses[SCAN_BLOCK * ADDRESS_MAX_LENGTH];
+    int32_t address_offsets[SCAN_BLOCK + 1];
+    byte scripts[SCAN_BLOCK * ADDRESS_MAX_SCRIPT_LENGTH];
+    int32_t script_offsets[SCAN_BLOCK + 1];
+
+    /* Every entry of a block shares the type, account and chain */
+    uint32_t account_slot = (uint32_t)export->type_slots[entries[0].type] * export->accounts +
+                            (entries[0].account - export->first_account);
+    uint32_t chain_slot = export->chains == (SCAN_RECEIVE | SCAN_CHANGE) ? entries[0].chain : 0;
+    uint32_t chain_count = export->chains == (SCAN_RECEIVE | SCAN_CHANGE) ? 2 : 1;
+
+    address_offsets[0] = 0;
+    script_offsets[0] = 0;
+    int result = SUCCESS;
+    for (size_t i = 0; i < count && result == SUCCESS; i++) {
+        const scan_entry *e = &entries[i];
+        indices[i] = e->index;
+        paths[i] = (int32_t)(account_slot * chain_count + chain_slot);
+        fingerprints[i] = export->fingerprint;
+        xpubs[i] = (int32_t)account_slot;
+
+        size_t len = strlen(e->address);
+        memcpy(addresses + address_offsets[i], e->address, len);
+        address_offsets[i + 1] = address_offsets[i] + (int32_t)len;
+
+        /* Decoding the address is cheaper than a second taproot tweak */
+        size_t script_len = 0;
+        result = address_to_script(e->address, scripts + script_offsets[i], &script_len);
+        script_offsets[i + 1] = script_offsets[i] + (int32_t)script_len;
+    }
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    arrow_column columns[] = {
+        {indices, NULL}, {paths, NULL}, {fingerprints, NULL}, {xpubs, NULL},
+        {addresses, address_offsets}, {scripts, script_offsets},
+    };
+    return arrow_writer_write_batch(&export->writer, columns, count) == ARROW_OK ? SUCCESS : ERROR_INTERNAL;
+}
+
+/**
+ * @brief Builds the path and account xpub dictionaries of an export
+ *
+ * @param[in] private_key Master private key
+ * @param[in] chain_code Master chain code
+ * @param[in] spec Scan spec
+ * @param[out] paths Path strings, one per type, account and chain (ARROW_PATH_SIZE each)
+ * @param[out] xpubs Account xpubs, one per type and account (ARROW_XPUB_SIZE each)
+ * @return 0 on success, negative error code on failure
+ */
+static int build_arrow_dictionaries(const byte *private_key, const byte *chain_code,
+                                    const scan_spec *spec, char *paths, char *xpubs) {
+    byte coin_key[PRIVATE_KEY_LENGTH], coin_chain[CHAIN_CODE_LENGTH];
+    byte account_key[PRIVATE_KEY_LENGTH], account_chain[CHAIN_CODE_LENGTH];
+    byte public_key[PUBLIC_KEY_LENGTH];
+    int result = SUCCESS;
+    size_t path = 0;
+    size_t xpub = 0;
+
+    for (int t = 0; t < 4 && result == SUCCESS; t++) {
+        if (!(spec->types & SCAN_TYPE(t))) {
+            continue;
+        }
+        /* m/purpose'/0' once per type, like the scan itself */
+        uint32_t purpose = address_purpose((address_type)t);
+        uint32_t prefix[2] = {purpose | BIP32_HARDENED, BIP32_HARDENED};
+        result = derive_bip32_path(private_key, chain_code, prefix, 2, coin_key, coin_chain, NULL);
+        if (result == SUCCESS) {
+            result = private_key_to_public_key(coin_key, public_key);
+        }
+        uint32_t coin_fingerprint = result == SUCCESS ? public_key_fingerprint(public_key) : 0;
+
+        for (uint32_t a = 0; a < spec->account_count && result == SUCCESS; a++) {
+            uint32_t account = spec->first_account + a;
+            result = derive_bip32_child_key(coin_key, coin_chain, account | BIP32_HARDENED,
+                                            account_key, account_chain);
+            if (result == SUCCESS) {
+                result = private_key_to_public_key(account_key, public_key);
+            }
+            if (result == SUCCESS) {
+                result = generate_extended_xpub(public_key, account_chain, 3, coin_fingerprint,
+                                                account | BIP32_HARDENED,
+                                                (byte *)xpubs + xpub++ * ARROW_XPUB_SIZE);
+            }
+            for (uint32_t c = 0; c < 2; c++) {
+                if (spec->chains & (1u << c)) {
+                    snprintf(paths + path++ * ARROW_PATH_SIZE, ARROW_PATH_SIZE,
+                             "m/%u'/0'/%u'/%u", purpose, account, c);
+                }
+            }
+        }
+    }
+
+    OPENSSL_cleanse(coin_key, sizeof(coin_key));
+    OPENSSL_cleanse(coin_chain, sizeof(coin_chain));
+    OPENSSL_cleanse(account_key, sizeof(account_key));
+    OPENSSL_cleanse(account_chain, sizeof(account_chain));
+    return result;
+}
+
+/**
+ * @brief Writes a scan as an Arrow IPC file: index, path, fingerprint, xpub,
+ *        address and script columns
+ *
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] spec Scan spec; types of 0 means all four
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr" or NULL for all four
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Each block of SCAN_BLOCK addresses becomes one record batch, encoded
+ *       on the worker that derived it; batches follow completion order, so
+ *       readers sort by path and index when order matters. Paths and account
+ *       xpubs are dictionary columns.
+ */
+static int process_bip32_arrow(const char *seed_hex, scan_spec *spec, const char *type_name,
+                               FILE *out) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+    byte master_public[PUBLIC_KEY_LENGTH];
+
+    int result = set_scan_types(spec, type_name);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+        return result;
+    }
+
+    arrow_export export;
+    memset(&export, 0, sizeof(export));
+    export.first_account = spec->first_account;
+    export.accounts = spec->account_count;
+    export.chains = spec->chains;
+    size_t type_count = 0;
+    for (int t = 0; t < 4; t++) {
+        export.type_slots[t] = spec->types & SCAN_TYPE(t) ? (int)type_count++ : -1;
+    }
+    size_t chain_count = spec->chains == (SCAN_RECEIVE | SCAN_CHANGE) ? 2 : 1;
+    size_t xpub_count = type_count * spec->account_count;
+    size_t path_count = xpub_count * chain_count;
+
+    char *paths = malloc(path_count * ARROW_PATH_SIZE);
+    char *xpubs = malloc(xpub_count * ARROW_XPUB_SIZE);
+    const char **dictionary = malloc((path_count + xpub_count) * sizeof(char *));
+    if (paths == NULL || xpubs == NULL || dictionary == NULL) {
+        result = ERROR_INTERNAL;
+    }
+
+    if (result == SUCCESS) {
+        result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+    }
+    if (result == SUCCESS) {
+        result = private_key_to_public_key(private_key, master_public);
+    }
+    if (result == SUCCESS) {
+        export.fingerprint = public_key_fingerprint(master_public);
+        result = build_arrow_dictionaries(private_key, chain_code, spec, paths, xpubs);
+    }
+    if (result == SUCCESS) {
+        for (size_t i = 0; i < path_count; i++) {
+            dictionary[i] = paths + i * ARROW_PATH_SIZE;
+        }
+        for (size_t i = 0; i < xpub_count; i++) {
+            dictionary[path_count + i] = xpubs + i * ARROW_XPUB_SIZE;
+        }
+        arrow_field fields[] = {
+            {"index", ARROW_UINT32, NULL, 0},
+            {"path", ARROW_DICTIONARY, dictionary, path_count},
+            {"fingerprint", ARROW_UINT32, NULL, 0},
+            {"xpub", ARROW_DICTIONARY, dictionary + path_count, xpub_count},
+            {"address", ARROW_UTF8, NULL, 0},
+            {"script", ARROW_BINARY, NULL, 0},
+        };
+        result = arrow_writer_init(&export.writer, out, fields, sizeof(fields) / sizeof(fields[0])) == ARROW_OK
+                     ? SUCCESS : ERROR_INTERNAL;
+        if (result == SUCCESS) {
+            result = scan_run_parallel(private_key, chain_code, spec, write_arrow_block, &export);
+            int finished = arrow_writer_finish(&export.writer);
+            if (result == SUCCESS && finished != ARROW_OK) {
+                result = ERROR_INTERNAL;
+            }
+        }
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Arrow export failed\n");
+    }
+
+    free(dictionary);
+    free(xpubs);
+    free(paths);
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/**
+ * @brief Key store load state
+ */
+typedef struct {
+    keystore_writer writer;
+    uint32_t fingerprint;                ///< Master key fingerprint
+} keystore_load;
+
+/**
+ * @brief Appends one block of scanned addresses to a key store
+ *
+ * @param[in] entries Addresses of one chain
+ * @param[in] count Number of entries
+ * @param[in] ctx Load state
+ * @return 0 on success, negative error code on failure
+ */
+static int store_scan_block(const scan_entry *entries, size_t count, void *ctx) {
+    keystore_load *load = ctx;
+    keystore_entry batch[SCAN_BLOCK];
+    for (size_t i = 0; i < count; i++) {
+        const scan_entry *e = &entries[i];
+        uint32_t path[5] = {address_purpose(e->type) | BIP32_HARDENED, BIP32_HARDENED,
+                            e->account | BIP32_HARDENED, e->chain, e->index};
+        int result = keystore_entry_set(&batch[i], load->fingerprint, path, 5, e->type, e->public_key);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    return keystore_writer_append(&load->writer, batch, count);
+}
+
+/**
+ * @brief Appends the scan of a seed to a key store, then rebuilds its indexes
+ *
+ * @param[in] base Store base name
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] spec Scan spec; its threads also sort the indexes
+ * @param[in] type_name "pkh", "sh-wpkh", "wpkh", "tr" or NULL for all four
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_keystore_add(const char *base, const char *seed_hex, scan_spec *spec,
+                                      const char *type_name) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+    byte master_public[PUBLIC_KEY_LENGTH];
+
+    int result = set_scan_types(spec, type_name);
+    if (result != SUCCESS) {
+        return result;
+    }
+    result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+        return result;
+    }
+
+    keystore_load load;
+    memset(&load, 0, sizeof(load));
+    result = keystore_writer_open(&load.writer, base);
+    if (result != SUCCESS) {
+        fprintf(stderr, "Cannot open key store %s\n", base);
+        OPENSSL_cleanse(seed, sizeof(seed));
+        return result;
+    }
+    uint64_t before = load.writer.count;
+
+    result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+    if (result == SUCCESS) {
+        result = private_key_to_public_key(private_key, master_public);
+    }
+    if (result == SUCCESS) {
+        load.fingerprint = public_key_fingerprint(master_public);
+        result = scan_run(private_key, chain_code, spec, store_scan_block, &load);
+    }
+    uint64_t added = load.writer.count - before;
+    if (keystore_writer_close(&load.writer) != SUCCESS && result == SUCCESS) {
+        result = ERROR_INTERNAL;
+    }
+
+    uint64_t indexed = 0;
+    if (result == SUCCESS) {
+        result = keystore_build_index(base, spec->threads, &indexed);
+    }
+    if (result != SUCCESS) {
+        fprintf(stderr, "Key store update failed\n");
+    } else {
+        fprintf(stderr, "Stored %llu keys of %08x, %llu indexed\n", (unsigned long long)added,
+                load.fingerprint, (unsigned long long)indexed);
+    }
+
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/**
+ * @brief Prints a key store entry as "fingerprint/path address"
+ *
+ * @param[in] entry Entry found
+ * @param[in] ctx Unused
+ * @return 0 to continue the lookup
+ */
+static int print_keystore_entry(const keystore_entry *entry, void *ctx) {
+    (void)ctx;
+    char address[ADDRESS_MAX_LENGTH];
+    if (address_from_public_key((address_type)entry->type, entry->public_key,
+                                address, sizeof(address)) != SUCCESS) {
+        strcpy(address, "-");
+    }
+    printf("%08x", entry->seed_fingerprint);
+    for (uint8_t i = 0; i < entry->depth && i < KEYSTORE_MAX_DEPTH; i++) {
+        printf("/%u%s", entry->path[i] & ~BIP32_HARDENED, entry->path[i] & BIP32_HARDENED ? "'" : "");
+    }
+    printf(" %s\n", address);
+    return SUCCESS;
+}
+
+/**
+ * @brief Looks up which seed and path produced an address, a HASH160 or a key origin
+ *
+ * @param[in] base Store base name
+ * @param[in] query Address, 40-character HASH160 / match key, or "fingerprint/path"
+ *                  such as "73c5da0a/84'/0'/0'/0/5"
+ * @return 0 if something was found, negative error code otherwise
+ */
+static int process_bip32_keystore_find(const char *base, const char *query) {
+    keystore store;
+    int result = keystore_open(&store, base);
+    if (result != SUCCESS) {
+        fprintf(stderr, "Cannot open key store %s\n", base);
+        return result;
+    }
+
+    int found;
+    const char *slash = strchr(query, '/');
+    byte key[ADDRESS_KEY_LENGTH];
+    if (slash != NULL) {
+        char fingerprint_hex[9] = {0};
+        uint32_t path[KEYSTORE_MAX_DEPTH];
+        size_t depth = 0;
+        char *end = NULL;
+        if (slash - query == 8) {
+            memcpy(fingerprint_hex, query, 8);
+        }
+        unsigned long fingerprint = strtoul(fingerprint_hex, &end, 16);
+        found = fingerprint_hex[0] != '\0' && *end == '\0' &&
+                        parse_bip32_path(slash + 1, path, KEYSTORE_MAX_DEPTH, &depth) == SUCCESS
+                    ? keystore_find_path(&store, (uint32_t)fingerprint, path, depth,
+                                         print_keystore_entry, NULL)
+                    : ERROR_INVALID_INPUT;
+    } else if (strlen(query) == 2 * ADDRESS_KEY_LENGTH && hex_to_bin(key, query, sizeof(key)) == SUCCESS) {
+        found = keystore_find_key(&store, key, print_keystore_entry, NULL);
+    } else {
+        byte script[ADDRESS_MAX_SCRIPT_LENGTH];
+        size_t script_len = 0;
+        found = address_to_script(query, script, &script_len) == SUCCESS &&
+                        address_script_key(script, script_len, key) == SUCCESS
+                    ? keystore_find_key(&store, key, print_keystore_entry, NULL)
+                    : ERROR_INVALID_INPUT;
+    }
+
+    if (found < 0) {
+        fprintf(stderr, "Invalid query: %s (address, HASH160 hex or fingerprint/path)\n", query);
+        result = ERROR_INVALID_INPUT;
+    } else if (found == 0) {
+        fprintf(stderr, "Not found in %llu keys\n", (unsigned long long)store.count);
+        result = ERROR_INVALID_INPUT;
+    }
+    keystore_close(&store);
+    return result;
+}
+
+/**
+ * @brief Writes BIP-85 child mnemonics for a range of indices
+ *
+ * @param[in] seed_hex Hexadecimal string of the BIP-39 seed (128 characters)
+ * @param[in] words Words per child mnemonic (12, 18 or 24)
+ * @param[in] first First child index
+ * @param[in] count Number of children
+ * @param[in] language BIP-85 language code; its list is read from ./wordlists
+ * @param[in] threads Worker threads, 0 for one per CPU
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_bip85(const char *seed_hex, uint32_t words, uint32_t first,
+                               uint32_t count, uint32_t language, size_t threads,
+                               FILE *out) {
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+
+    const char *name = bip85_language_name(language);
+    char path[64];
+    bip39_wordlist list;
+    if (name == NULL) {
+        fprintf(stderr, "Unknown BIP-85 language code: %u\n", language);
+        return ERROR_INVALID_INPUT;
+    }
+    snprintf(path, sizeof(path), "./wordlists/%s.txt", name);
+    if (bip39_wordlist_load(&list, path) != 0) {
+        fprintf(stderr, "Cannot load wordlist %s\n", path);
+        return ERROR_INVALID_INPUT;
+    }
+
+    int result = hex_to_bin(seed, seed_hex, sizeof(seed));
+    if (result != SUCCESS) {
+        fprintf(stderr, "Invalid seed hex string\n");
+    } else {
+        result = derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code);
+        if (result == SUCCESS) {
+            result = bip85_bip39_range(private_key, chain_code, language, words, first, count,
+                                       &list, threads, out);
+        }
+        if (result != SUCCESS) {
+            fprintf(stderr, "Failed to derive BIP-85 mnemonics\n");
+        }
+    }
+
+    bip39_wordlist_free(&list);
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return result;
+}
+
+/** @brief Number of seeds read and derived per batch in bulk mode */
+#define BULK_BATCH_SIZE 4096
+
+/** @brief Batches in flight per bulk worker */
+#define BULK_JOBS_PER_THREAD 2
+
+/**
+ * @brief One batch of the bulk pipeline, passed by pointer between its stages
+ */
+typedef struct {
+    uint64_t sequence;  ///< Position of the batch in the input.
+    size_t count;       ///< Seeds in the batch.
+    byte *seeds;        ///< BULK_BATCH_SIZE concatenated 64-byte seeds.
+    byte *xprvs;        ///< BULK_BATCH_SIZE xprv strings, 112 bytes apart.
+    int result;         ///< Outcome of the derive stage.
+} bulk_job;
+
+/**
+ * @brief Queues between the read, derive and write stages of bulk mode
+ */
+typedef struct {
+    ring free_jobs;              ///< Empty batches, refilled by the reader.
+    ring work;                   ///< Read batches, taken by the derive workers.
+    ring done;                   ///< Derived batches, written in input order.
+    size_t job_count;            ///< Batches in circulation.
+    atomic_size_t workers_left;  ///< The last worker out closes `done`.
+    atomic_int error;            ///< First error of any stage.
+    FILE *out;                   ///< Output stream (stdout or a sealed export).
+    const topology *topo;        ///< Set when workers are pinned.
+    const int *cpus;             ///< Planned CPU of each worker.
+    atomic_size_t next_cpu;      ///< Next entry of `cpus` to take.
+} bulk_pipeline;
+
+/**
+ * @brief Derives and serializes the xprv keys for a batch of seeds
+ *
+ * @param[in,out] job Batch with seeds and count set; xprvs and result are filled
+ * @param[in,out] keys Key batch with capacity for BULK_BATCH_SIZE keys
+ */
+static void bulk_derive(bulk_job *job, hdkey_batch *keys) {
+    job->result = hdkey_batch_from_seeds(keys, job->seeds, job->count);
+    if (job->result != SUCCESS) {
+        fprintf(stderr, "Failed to derive master keys\n");
+        return;
+    }
+    job->result = hdkey_batch_serialize_xprv(keys, job->xprvs, 112);
+    if (job->result != SUCCESS) {
+        fprintf(stderr, "Failed to generate xprv\n");
+    }
+}
+
+/**
+ * @brief Derive stage: takes read batches until the reader is done
+ *
+ * @param[in] arg Pipeline
+ * @return NULL
+ */
+static void *bulk_worker(void *arg) {
+    bulk_pipeline *pipeline = arg;
+    if (pipeline->topo != NULL) {
+        /* Pin before allocating, so the key batch lands on this worker's node */
+        topology_pin_thread(pipeline->topo, pipeline->cpus[atomic_fetch_add(&pipeline->next_cpu, 1)]);
+    }
+    hdkey_batch keys;
+    int ready = hdkey_batch_init(&keys, BULK_BATCH_SIZE) == SUCCESS;
+    bulk_job *job;
+    while (ring_pop_wait(&pipeline->work, &job, 1) == 1) {
+        if (!ready) {
+            job->result = ERROR_INTERNAL;
+        } else if (atomic_load(&pipeline->error) == SUCCESS) {
+            bulk_derive(job, &keys);
+        }
+        ring_push_all(&pipeline->done, &job, 1);
+    }
+    hdkey_batch_free(&keys);
+    if (atomic_fetch_sub(&pipeline->workers_left, 1) == 1) {
+        ring_close(&pipeline->done);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Write stage: prints derived batches in input order and recycles them
+ *
+ * @param[in] arg Pipeline
+ * @return NULL
+ *
+ * @note Batches keep circulating after an error, so the reader never waits
+ *       for one forever; they are just not written
+ */
+static void *bulk_writer(void *arg) {
+    bulk_pipeline *pipeline = arg;
+    bulk_job **pending = calloc(pipeline->job_count, sizeof(bulk_job *));
+    if (pending == NULL) {
+        atomic_store(&pipeline->error, ERROR_INTERNAL);
+    }
+    uint64_t next = 0;
+    bulk_job *job;
+    while (ring_pop_wait(&pipeline->done, &job, 1) == 1) {
+        if (pending == NULL) {
+            ring_push_all(&pipeline->free_jobs, &job, 1);
+            continue;
+        }
+        pending[job->sequence % pipeline->job_count] = job;
+        while ((job = pending[next % pipeline->job_count]) != NULL && job->sequence == next) {
+            pending[next % pipeline->job_count] = NULL;
+            int expected = SUCCESS;
+            if (job->result != SUCCESS) {
+                atomic_compare_exchange_strong(&pipeline->error, &expected, job->result);
+            } else if (atomic_load(&pipeline->error) == SUCCESS) {
+                for (size_t i = 0; i < job->count; i++) {
+                    fprintf(pipeline->out, "%s\n", job->xprvs + i * 112);
+                }
+                if (ferror(pipeline->out)) {
+                    atomic_compare_exchange_strong(&pipeline->error, &expected, ERROR_INTERNAL);
+                }
+            }
+            OPENSSL_cleanse(job->seeds, job->count * BIP39_SEED_LENGTH);
+            OPENSSL_cleanse(job->xprvs, job->count * 112);
+            ring_push_all(&pipeline->free_jobs, &job, 1);
+            next++;
+        }
+    }
+    free(pending);
+    return NULL;
+}
+
+/**
+ * @brief Bulk provisioning: one hex seed per stdin line, one xprv per output line
+ *
+ * @param[in] threads Derive workers, 0 for one per online CPU (or per planned CPU when pinned)
+ * @param[in] placement Worker pinning, TOPOLOGY_ANY for none
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note A three-stage pipeline over lock-free rings: this thread reads
+ *       BULK_BATCH_SIZE seeds per batch, the workers derive and serialize
+ *       whole batches into an hdkey_batch, and a writer thread prints them
+ *       in input order. Empty lines are skipped
+ */
+static int process_bip32_bulk(size_t threads, topology_placement placement, FILE *out) {
+    bulk_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    topology topo;
+    memset(&topo, 0, sizeof(topo));
+    int *cpus = NULL;
+    if (placement != TOPOLOGY_ANY) {
+        if (topology_load(&topo, NULL) != TOPOLOGY_OK) {
+            fprintf(stderr, "Cannot read the CPU topology\n");
+            return ERROR_INTERNAL;
+        }
+        cpus = malloc((threads > topo.cpu_count ? threads : topo.cpu_count) * sizeof(int));
+        threads = cpus ? topology_plan(&topo, placement, threads, cpus) : 0;
+        if (threads == 0) {
+            free(cpus);
+            topology_free(&topo);
+            return ERROR_INTERNAL;
+        }
+        pipeline.topo = &topo;
+        pipeline.cpus = cpus;
+    } else if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+    pipeline.job_count = threads * BULK_JOBS_PER_THREAD + 1;
+    pipeline.out = out;
+    atomic_init(&pipeline.workers_left, threads);
+    atomic_init(&pipeline.next_cpu, 0);
+    atomic_init(&pipeline.error, SUCCESS);
+
+    bulk_job *jobs = calloc(pipeline.job_count, sizeof(bulk_job));
+    int result = jobs != NULL &&
+                 ring_init(&pipeline.free_jobs, pipeline.job_count, sizeof(bulk_job *)) == RING_OK &&
+                 ring_init(&pipeline.work, pipeline.job_count, sizeof(bulk_job *)) == RING_OK &&
+                 ring_init(&pipeline.done, pipeline.job_count, sizeof(bulk_job *)) == RING_OK
+                 ? SUCCESS : ERROR_INTERNAL;
+    /* Every batch buffer comes from one huge-page arena */
+    hugepage_arena buffers = {0};
+    size_t buffer_size = pipeline.job_count * (size_t)BULK_BATCH_SIZE * (BIP39_SEED_LENGTH + 112);
+    if (result == SUCCESS && hugepage_arena_init(&buffers, buffer_size) != HUGEPAGE_OK) {
+        result = ERROR_INTERNAL;
+    }
+    for (size_t j = 0; result == SUCCESS && j < pipeline.job_count; j++) {
+        jobs[j].seeds = hugepage_arena_alloc(&buffers, (size_t)BULK_BATCH_SIZE * BIP39_SEED_LENGTH, 64);
+        jobs[j].xprvs = hugepage_arena_alloc(&buffers, (size_t)BULK_BATCH_SIZE * 112, 64);
+        if (jobs[j].seeds == NULL || jobs[j].xprvs == NULL) {
+            result = ERROR_INTERNAL;
+        }
+        bulk_job *job = &jobs[j];
+        ring_push(&pipeline.free_jobs, &job, 1);
+    }
+
+    pthread_t writer;
+    pthread_t *workers = malloc(threads * sizeof(pthread_t));
+    size_t started = 0;
+    bool writer_started = false;
+    if (result == SUCCESS && workers != NULL && pthread_create(&writer, NULL, bulk_writer, &pipeline) == 0) {
+        writer_started = true;
+        while (started < threads && pthread_create(&workers[started], NULL, bulk_worker, &pipeline) == 0) {
+            started++;
+        }
+    }
+    if (!writer_started || started == 0) {
+        result = ERROR_INTERNAL;
+    }
+    /* Workers that never started still count down */
+    atomic_fetch_sub(&pipeline.workers_left, threads - started);
+
+    char line[256];
+    size_t line_no = 0;
+    uint64_t sequence = 0;
+    bulk_job *job = NULL;
+    while (result == SUCCESS && atomic_load(&pipeline.error) == SUCCESS) {
+        if (job == NULL) {
+            ring_pop_wait(&pipeline.free_jobs, &job, 1);
+            job->count = 0;
+            job->result = SUCCESS;
+            job->sequence = sequence;
+        }
+        bool eof = fgets(line, sizeof(line), stdin) == NULL;
+        if (!eof) {
+            line_no++;
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0') {
+                continue;
+            }
+            if (hex_to_bin(job->seeds + job->count * BIP39_SEED_LENGTH, line, BIP39_SEED_LENGTH) != SUCCESS) {
+                fprintf(stderr, "Invalid seed hex string on line %zu\n", line_no);
+                result = ERROR_INVALID_INPUT;
+                break;
+            }
+            job->count++;
+        }
+        if (job->count == BULK_BATCH_SIZE || (eof && job->count > 0)) {
+            ring_push_all(&pipeline.work, &job, 1);
+            job = NULL;
+            sequence++;
+        }
+        if (eof) {
+            break;
+        }
+    }
+
+    if (writer_started) {
+        ring_close(&pipeline.work);
+        for (size_t t = 0; t < started; t++) {
+            pthread_join(workers[t], NULL);
+        }
+        if (started == 0) {
+            ring_close(&pipeline.done);
+        }
+        pthread_join(writer, NULL);
+    }
+    if (result == SUCCESS) {
+        result = atomic_load(&pipeline.error);
+    }
+
+    OPENSSL_cleanse(line, sizeof(line));
+    hugepage_arena_free(&buffers);
+    free(jobs);
+    free(workers);
+    free(cpus);
+    topology_free(&topo);
+    ring_free(&pipeline.free_jobs);
+    ring_free(&pipeline.work);
+    ring_free(&pipeline.done);
+    return result;
+}
+
+/** @brief Records derived per batch in records mode */
+#define RECORDS_BATCH_SIZE 256
+
+/** @brief Deepest parent path accepted for the child public keys of a record */
+#define RECORDS_MAX_DEPTH 8
+
+/**
+ * @brief Fills the key fields of a batch of records whose seeds are set
+ *
+ * @param[in,out] records Records with seed filled
+ * @param[in] count Number of records
+ * @param[in] indices Parent path of the child public keys
+ * @param[in] depth Number of path indices
+ * @param[in] pubkeys Child public keys per record
+ * @param[in,out] batches Three key batches of RECORDS_BATCH_SIZE capacity
+ * @param[out] seeds Scratch for count seeds
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Every level of the path is one hdkey_batch_derive() over all lanes
+ */
+static int records_derive(seed_record *records, size_t count, const uint32_t *indices,
+                          size_t depth, uint32_t pubkeys, hdkey_batch batches[3], byte *seeds) {
+    for (size_t i = 0; i < count; i++) {
+        memcpy(seeds + i * BIP39_SEED_LENGTH, records[i].seed, BIP39_SEED_LENGTH);
+    }
+    hdkey_batch *parent = &batches[0];
+    int result = hdkey_batch_from_seeds(parent, seeds, count);
+    if (result == SUCCESS) result = hdkey_batch_public_keys(parent);
+    if (result != SUCCESS) return result;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(records[i].master_key, parent->private_keys + 32 * i, 32);
+        memcpy(records[i].chain_code, parent->chain_codes + 32 * i, 32);
+        memcpy(records[i].master_public_key, parent->public_keys + 33 * i, 33);
+        records[i].fields |= RECORD_HAS_MASTER;
+    }
+    if (pubkeys == 0) return SUCCESS;
+
+    for (size_t level = 0; level < depth; level++) {
+        hdkey_batch *child = parent == &batches[0] ? &batches[1] : &batches[0];
+        result = hdkey_batch_derive(parent, indices[level], child);
+        if (result != SUCCESS) return result;
+        parent = child;
+    }
+    for (uint32_t k = 0; k < pubkeys; k++) {
+        hdkey_batch *leaf = &batches[2];
+        result = hdkey_batch_derive(parent, k, leaf);
+        if (result == SUCCESS) result = hdkey_batch_public_keys(leaf);
+        if (result != SUCCESS) return result;
+        for (size_t i = 0; i < count; i++) {
+            memcpy(records[i].pubkeys[k], leaf->public_keys + 33 * i, 33);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        records[i].pubkey_count = (uint8_t)pubkeys;
+        records[i].fields |= RECORD_HAS_PUBKEYS;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Binary batch output: one entropy or seed hex per stdin line, one
+ *        fixed-width record per line to the output
+ *
+ * @param[in] path Parent path of the child public keys, e.g. "m/84'/0'/0'/0"
+ * @param[in] pubkeys Child public keys per record (0 to RECORD_MAX_PUBKEYS)
+ * @param[out] out Output stream (a file, a pipe or a sealed export)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note 32 to 64 hex digits are entropy: the record gets its checksum, word
+ *       indices and English mnemonic seed (no passphrase). 128 hex digits
+ *       are a seed. See record/record.h for the layout.
+ */
+static int process_bip32_records(const char *path, uint32_t pubkeys, FILE *out) {
+    uint32_t indices[RECORDS_MAX_DEPTH];
+    size_t depth = 0;
+    if (parse_bip32_path(path, indices, RECORDS_MAX_DEPTH, &depth) != SUCCESS) {
+        fprintf(stderr, "Invalid derivation path: %s\n", path);
+        return ERROR_INVALID_INPUT;
+    }
+    bip39_wordlist list;
+    if (bip39_wordlist_load(&list, "./wordlists/english.txt") != 0) {
+        fprintf(stderr, "Cannot load ./wordlists/english.txt\n");
+        return ERROR_INVALID_INPUT;
+    }
+
+    hdkey_batch batches[3] = {{0}};
+    seed_record *records = calloc(RECORDS_BATCH_SIZE, sizeof(seed_record));
+    byte *seeds = malloc((size_t)RECORDS_BATCH_SIZE * BIP39_SEED_LENGTH);
+    int result = records && seeds ? SUCCESS : ERROR_INTERNAL;
+    for (int b = 0; b < 3 && result == SUCCESS; b++) {
+        result = hdkey_batch_init(&batches[b], RECORDS_BATCH_SIZE);
+    }
+    record_writer writer;
+    if (result == SUCCESS && record_writer_init(&writer, out, path, pubkeys) != RECORD_OK) {
+        fprintf(stderr, "Cannot write the record header\n");
+        result = ERROR_INTERNAL;
+    }
+
+    char line[256];
+    char mnemonic[BIP39_MNEMONIC_MAX_SIZE];
+    byte entropy[32];
+    size_t count = 0;
+    size_t line_no = 0;
+    while (result == SUCCESS && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        seed_record *record = &records[count];
+        memset(record, 0, sizeof(*record));
+        size_t len = strlen(line) / 2;
+        if (len == BIP39_SEED_LENGTH) {
+            result = hex_to_bin(record->seed, line, BIP39_SEED_LENGTH);
+        } else {
+            result = hex_to_bin(entropy, line, len <= sizeof(entropy) ? len : 0);
+            if (result == SUCCESS && record_set_entropy(record, entropy, len) != RECORD_OK) {
+                result = ERROR_INVALID_LENGTH;
+            }
+            if (result == SUCCESS &&
+                (bip39_entropy_to_mnemonic(entropy, len, &list, mnemonic, sizeof(mnemonic)) != 0 ||
+                 bip39_mnemonic_to_seed(mnemonic, NULL, record->seed) != 0)) {
+                result = ERROR_INTERNAL;
+            }
+        }
+        if (result != SUCCESS) {
+            fprintf(stderr, "Invalid entropy or seed hex string on line %zu\n", line_no);
+            break;
+        }
+        record->fields |= RECORD_HAS_SEED;
+        if (++count == RECORDS_BATCH_SIZE) {
+            result = records_derive(records, count, indices, depth, pubkeys, batches, seeds);
+            if (result == SUCCESS && record_writer_append(&writer, records, count) != RECORD_OK) {
+                result = ERROR_INTERNAL;
+            }
+            count = 0;
+        }
+    }
+    if (result == SUCCESS && count > 0) {
+        result = records_derive(records, count, indices, depth, pubkeys, batches, seeds);
+        if (result == SUCCESS && record_writer_append(&writer, records, count) != RECORD_OK) {
+            result = ERROR_INTERNAL;
+        }
+    }
+    if (result == SUCCESS && record_writer_finish(&writer) != RECORD_OK) {
+        fprintf(stderr, "Failed to write records\n");
+        result = ERROR_INTERNAL;
+    }
+
+    OPENSSL_cleanse(line, sizeof(line));
+    OPENSSL_cleanse(mnemonic, sizeof(mnemonic));
+    OPENSSL_cleanse(entropy, sizeof(entropy));
+    if (records) OPENSSL_cleanse(records, (size_t)RECORDS_BATCH_SIZE * sizeof(seed_record));
+    if (seeds) OPENSSL_cleanse(seeds, (size_t)RECORDS_BATCH_SIZE * BIP39_SEED_LENGTH);
+    free(records);
+    free(seeds);
+    for (int b = 0; b < 3; b++) hdkey_batch_free(&batches[b]);
+    bip39_wordlist_free(&list);
+    return result;
+}
+
+/**
+ * @brief BIP-38 for cold storage: one key per stdin line, one result per output line
+ *
+ * @param[in] encrypt true to turn WIF keys into "6P..." keys, false for the reverse
+ * @param[in] passphrase Passphrase
+ * @param[in] threads Threads for the scrypt lanes of each key, 0 for one per CPU
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note One scrypt arena is reused for the whole run, so the 16 MiB
+ *       scratchpad per thread is allocated once; empty lines are skipped
+ */
+static int process_bip32_bip38(bool encrypt, const char *passphrase, size_t threads, FILE *out) {
+    scrypt_arena arena = {0};
+    char line[256];
+    byte result_key[BIP38_MAX_SIZE];
+    size_t line_no = 0;
+    int result = SUCCESS;
+    while (result == SUCCESS && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        result = encrypt
+            ? bip38_encrypt_wif(line, passphrase, threads, &arena, (char *)result_key, sizeof(result_key))
+            : bip38_decrypt_to_wif(line, passphrase, threads, &arena, result_key);
+        if (result == BIP38_ERROR_PASSPHRASE) {
+            fprintf(stderr, "Wrong passphrase for the key on line %zu\n", line_no);
+        } else if (result != SUCCESS) {
+            fprintf(stderr, "Invalid %s key on line %zu\n", encrypt ? "WIF" : "BIP-38", line_no);
+        } else {
+            fprintf(out, "%s\n", result_key);
+        }
+    }
+
+    OPENSSL_cleanse(line, sizeof(line));
+    OPENSSL_cleanse(result_key, sizeof(result_key));
+    scrypt_arena_free(&arena);
+    return result;
+}
+
+/**
+ * @brief Mixed-language phrase import: one phrase per stdin line, no language hint
+ *
+ * @param[out] out Output stream (stdout or a sealed export)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Every list in ./wordlists is indexed once; each phrase prints as
+ *       "<language> <entropy_hex>", and unknown, mixed or ambiguous phrases
+ *       stop the run with the line number. Empty lines are skipped
+ */
+static int process_bip32_detect(FILE *out) {
+    bip39_detector detector;
+    if (bip39_detector_load(&detector, "./wordlists") < 0) {
+        fprintf(stderr, "Cannot load any wordlist from ./wordlists\n");
+        return ERROR_INVALID_INPUT;
+    }
+
+    char line[BIP39_MNEMONIC_MAX_SIZE * 2];
+    bip39_detection detection;
+    size_t line_no = 0;
+    int result = SUCCESS;
+    while (result == SUCCESS && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        switch (bip39_detect(&detector, line, &detection)) {
+        case BIP39_DETECT_OK: {
+            byte entropy[32];
+            size_t len = 0;
+            bip39_indices_to_entropy(detection.indices, detection.word_count, entropy, &len);
+            fprintf(out, "%s ", detector.names[detection.language]);
+            for (size_t i = 0; i < len; i++) {
+                fprintf(out, "%02x", entropy[i]);
+            }
+            fprintf(out, "\n");
+            OPENSSL_cleanse(entropy, sizeof(entropy));
+            break;
+        }
+        case BIP39_DETECT_UNKNOWN_WORD:
+            fprintf(stderr, "Line %zu: word %zu is in no wordlist\n", line_no, detection.bad_word + 1);
+            result = ERROR_INVALID_INPUT;
+            break;
+        case BIP39_DETECT_MIXED:
+            fprintf(stderr, "Line %zu: word %zu is from another wordlist than the words before it\n",
+                    line_no, detection.bad_word + 1);
+            result = ERROR_INVALID_INPUT;
+            break;
+        case BIP39_DETECT_AMBIGUOUS:
+            fprintf(stderr, "Line %zu: valid in several wordlists, language is ambiguous\n", line_no);
+            result = ERROR_INVALID_INPUT;
+            break;
+        case BIP39_DETECT_CHECKSUM:
+            fprintf(stderr, "Line %zu: invalid checksum\n", line_no);
+            result = ERROR_INVALID_INPUT;
+            break;
+        default:
+            fprintf(stderr, "Line %zu: expected 12, 15, 18, 21 or 24 words\n", line_no);
+            result = ERROR_INVALID_INPUT;
+            break;
+        }
+    }
+
+    OPENSSL_cleanse(line, sizeof(line));
+    OPENSSL_cleanse(&detection, sizeof(detection));
+    bip39_detector_free(&detector);
+    return result;
+}
+
+/** @brief Phrases between two sweeps of expired seed cache entries */
+#define UNLOCK_PURGE_INTERVAL 1024
+
+/**
+ * @brief Unlocks phrases through an encrypted seed cache, as a wallet service would
+ *
+ * @param[in] capacity Most seeds kept
+ * @param[in] ttl_seconds Lifetime of a cached seed
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Each stdin line is "<words>" or "<words>\t<passphrase>" and prints
+ *       "<fingerprint> <master xpub>". Repeated phrases skip PBKDF2 while
+ *       their seed is cached; the cache counters go to stderr at the end
+ */
+static int process_bip32_unlock(uint32_t capacity, uint32_t ttl_seconds) {
+    bip39_seedcache cache;
+    if (bip39_seedcache_init(&cache, capacity, ttl_seconds) != 0) {
+        fprintf(stderr, "Cannot create the seed cache\n");
+        return ERROR_INTERNAL;
+    }
+
+    char line[BIP39_MNEMONIC_MAX_SIZE * 2];
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+    byte public_key[PUBLIC_KEY_LENGTH];
+    byte xpub[ARROW_XPUB_SIZE];
+    size_t line_no = 0;
+    int result = SUCCESS;
+    while (result == SUCCESS && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        char *passphrase = strchr(line, '\t');
+        if (passphrase != NULL) {
+            *passphrase++ = '\0';
+        }
+        if (bip39_seedcache_mnemonic_to_seed(&cache, line, passphrase, seed, NULL) != 0) {
+            fprintf(stderr, "Line %zu: cannot derive the seed\n", line_no);
+            result = ERROR_INVALID_INPUT;
+            break;
+        }
+        result = derive_bip32_master_key(seed, BIP39_SEED_LENGTH, private_key, chain_code);
+        if (result == SUCCESS) {
+            result = private_key_to_public_key(private_key, public_key);
+        }
+        if (result == SUCCESS) {
+            result = generate_extended_xpub(public_key, chain_code, 0, 0, 0, xpub);
+        }
+        if (result == SUCCESS) {
+            printf("%08x %s\n", public_key_fingerprint(public_key), (char *)xpub);
+        }
+        if (line_no % UNLOCK_PURGE_INTERVAL == 0) {
+            bip39_seedcache_purge(&cache);
+        }
+    }
+
+    bip39_seedcache_stats stats;
+    bip39_seedcache_get_stats(&cache, &stats);
+    fprintf(stderr, "Seed cache: %llu hits, %llu derived, %llu evicted, %llu expired\n",
+            (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+            (unsigned long long)stats.evictions, (unsigned long long)stats.expirations);
+
+    OPENSSL_cleanse(line, sizeof(line));
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    bip39_seedcache_free(&cache);
+    return result;
+}
+
+/** @brief Target duration of one recovery lease, in seconds */
+#define RECOVER_LEASE_SECONDS 10.0
+
+/** @brief Seconds without word from a worker before its lease is taken back */
+#define RECOVER_LEASE_TIMEOUT 60.0
+
+/** @brief Candidates in a worker's first lease, before its rate is known */
+#define RECOVER_FIRST_LEASE 64
+
+/** @brief Seconds between coordinator progress lines */
+#define RECOVER_LOG_INTERVAL 5.0
+
+/**
+ * @brief Builds the job line of a recovery
+ *
+ * @param[out] text Output, CLUSTER_LINE_SIZE / 2 bytes
+ * @param[in] fingerprint Master key fingerprint (8 hex digits)
+ * @param[in] words Phrase with "?" for lost words
+ * @param[in] passphrase Passphrase with "?" for lost characters (can be NULL)
+ * @param[in] charset Characters a lost character can be (can be NULL)
+ * @return 0 on success, ERROR_INVALID_INPUT if a field holds a tab or newline or the line is too long
+ */
+static int recover_job_text(char *text, const char *fingerprint, const char *words,
+                            const char *passphrase, const char *charset) {
+    const char *fields[] = {fingerprint, words, passphrase ? passphrase : "", charset ? charset : ""};
+    for (size_t i = 0; i < 4; i++) {
+        if (strpbrk(fields[i], "\t\r\n") != NULL) {
+            fprintf(stderr, "Job fields cannot hold tabs or newlines\n");
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    int len = snprintf(text, CLUSTER_LINE_SIZE / 2, "%s\t%s\t%s\t%s", fields[0], fields[1], fields[2], fields[3]);
+    if (len < 0 || len >= CLUSTER_LINE_SIZE / 2) {
+        fprintf(stderr, "Job too long\n");
+        return ERROR_INVALID_INPUT;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Parses a job line, reporting what is wrong with it
+ *
+ * @return 0 on success, ERROR_INVALID_INPUT otherwise
+ */
+static int recover_parse_job(bip39_recover_job *job, const bip39_wordlist *list, const char *text) {
+    size_t bad_word = 0;
+    switch (bip39_recover_parse(job, list, text, &bad_word)) {
+    case BIP39_RECOVER_OK:
+        return SUCCESS;
+    case BIP39_RECOVER_ERROR_UNKNOWN_WORD:
+        fprintf(stderr, "Word %zu is not in the English list (use ? for a lost word)\n", bad_word + 1);
+        return ERROR_INVALID_INPUT;
+    case BIP39_RECOVER_ERROR_TOO_LARGE:
+        fprintf(stderr, "Too many candidates: fewer lost words or characters\n");
+        return ERROR_INVALID_INPUT;
+    default:
+        fprintf(stderr, "Expected an 8-digit fingerprint and 12, 15, 18, 21 or 24 words\n");
+        return ERROR_INVALID_INPUT;
+    }
+}
+
+/** @brief Prints a matching candidate: the phrase, and the passphrase after a tab if there is one */
+static void recover_print_match(void *ctx, uint64_t number) {
+    const bip39_recover_job *job = ctx;
+    char mnemonic[BIP39_MNEMONIC_MAX_SIZE];
+    char passphrase[BIP39_RECOVER_MAX_PASSPHRASE + 1];
+    if (bip39_recover_candidate(job, number, mnemonic, passphrase) == 1) {
+        printf(passphrase[0] != '\0' ? "%s\t%s\n" : "%s\n", mnemonic, passphrase);
+        fflush(stdout);
+    }
+    OPENSSL_cleanse(mnemonic, sizeof(mnemonic));
+    OPENSSL_cleanse(passphrase, sizeof(passphrase));
+}
+
+/**
+ * @brief One recovery worker connection.
+ */
+typedef struct {
+    const bip39_wordlist *list;
+    bip39_recover_job job;
+    const char *host;
+    const char *port;
+    char name[64];
+    uint64_t searched;
+    uint64_t derived;        ///< Seeds derived (candidates with a valid checksum).
+    int result;              ///< cluster_work() result.
+} recover_worker;
+
+static int recover_worker_start(void *ctx, const char *text, uint64_t total) {
+    recover_worker *worker = ctx;
+    if (recover_parse_job(&worker->job, worker->list, text) != SUCCESS || worker->job.size != total) {
+        return ERROR_INVALID_INPUT;
+    }
+    return SUCCESS;
+}
+
+static int recover_worker_search(void *ctx, uint64_t first, uint64_t count,
+                                 cluster_match_fn match, void *match_ctx) {
+    recover_worker *worker = ctx;
+    return bip39_recover_search(&worker->job, first, count, match, match_ctx, &worker->derived) < 0
+               ? ERROR_INTERNAL : SUCCESS;
+}
+
+static void *recover_worker_thread(void *arg) {
+    recover_worker *worker = arg;
+    cluster_worker callbacks = {recover_worker_start, recover_worker_search, worker, worker->name};
+    worker->result = cluster_work(worker->host, worker->port, &callbacks, &worker->searched);
+    OPENSSL_cleanse(&worker->job, sizeof(worker->job));
+    return NULL;
+}
+
+/**
+ * @brief Runs recovery workers against a coordinator, one connection per thread
+ *
+ * @param[in] list English wordlist
+ * @param[in] host Coordinator host
+ * @param[in] port Coordinator port
+ * @param[in] threads Worker threads, 0 for one per CPU
+ * @return 0 if every worker ran until the coordinator was done
+ */
+static int run_recover_workers(const bip39_wordlist *list, const char *host, const char *port, size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    recover_worker *workers = calloc(threads, sizeof(recover_worker));
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    if (workers == NULL || ids == NULL) {
+        free(workers);
+        free(ids);
+        return ERROR_INTERNAL;
+    }
+    char host_name[32] = "host";
+    gethostname(host_name, sizeof(host_name) - 1);
+    size_t started = 0;
+    for (; started < threads; started++) {
+        recover_worker *worker = &workers[started];
+        worker->list = list;
+        worker->host = host;
+        worker->port = port;
+        snprintf(worker->name, sizeof(worker->name), "%s/%ld/%zu", host_name, (long)getpid(), started);
+        if (pthread_create(&ids[started], NULL, recover_worker_thread, worker) != 0) {
+            break;
+        }
+    }
+
+    int result = started == threads ? SUCCESS : ERROR_INTERNAL;
+    uint64_t searched = 0, derived = 0;
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+        searched += workers[i].searched;
+        derived += workers[i].derived;
+        if (workers[i].result != CLUSTER_OK) {
+            fprintf(stderr, "Worker %zu stopped: %s\n", i,
+                    workers[i].result == CLUSTER_ERROR_NETWORK ? "connection failed or lost" :
+                    workers[i].result == CLUSTER_ERROR_SEARCH ? "bad job or derivation failure" : "protocol error");
+            result = ERROR_INTERNAL;
+        }
+    }
+    fprintf(stderr, "Searched %llu candidates, derived %llu seeds\n",
+            (unsigned long long)searched, (unsigned long long)derived);
+    free(workers);
+    free(ids);
+    return result;
+}
+
+/**
+ * @brief Workers of the loopback mode, run beside the coordinator.
+ */
+typedef struct {
+    const bip39_wordlist *list;
+    char port[8];
+    size_t threads;
+    int result;
+} recover_loopback;
+
+static void *recover_loopback_thread(void *arg) {
+    recover_loopback *loopback = arg;
+    loopback->result = run_recover_workers(loopback->list, "127.0.0.1", loopback->port, loopback->threads);
+    return NULL;
+}
+
+/**
+ * @brief Hands out a recovery job to workers until every candidate is searched
+ *
+ * @param[in] fd Listening socket
+ * @param[in] job Parsed job
+ * @param[in] text Job line sent to workers
+ * @return 0 if at least one candidate matched
+ *
+ * @note Matching phrases go to stdout as they are reported; progress and
+ *       worker events go to stderr
+ */
+static int coordinate_recovery(int fd, bip39_recover_job *job, const char *text) {
+    cluster_config config = {job->size, text, RECOVER_LEASE_SECONDS, RECOVER_LEASE_TIMEOUT,
+                             RECOVER_FIRST_LEASE, stderr, RECOVER_LOG_INTERVAL};
+    cluster_stats stats;
+    int result = cluster_coordinate(fd, &config, recover_print_match, job, &stats);
+    if (result != CLUSTER_OK) {
+        fprintf(stderr, "Coordinator failed\n");
+        return ERROR_INTERNAL;
+    }
+    fprintf(stderr, "%llu candidates in %.1f s (%.1f/s), %llu matches, %llu leases, %llu re-leased, "
+                    "%llu worker connections\n", (unsigned long long)stats.searched, stats.seconds,
+            stats.seconds > 0 ? (double)stats.searched / stats.seconds : 0.0,
+            (unsigned long long)stats.matches, (unsigned long long)stats.leases,
+            (unsigned long long)stats.released, (unsigned long long)stats.workers);
+    return stats.matches > 0 ? SUCCESS : ERROR_INVALID_INPUT;
+}
+
+/**
+ * @brief Recovers lost words or passphrase characters over TCP workers
+ *
+ * @param[in] mode "serve" (coordinator), "work" (worker) or "local" (both, over loopback)
+ * @param[in] argc Arguments after the mode
+ * @param[in] argv serve: <port> <fingerprint> <words> [passphrase] [charset];
+ *                 work: <host> <port> [threads];
+ *                 local: <workers> <fingerprint> <words> [passphrase] [charset]
+ * @return 0 on success (serve and local: at least one match), negative error code otherwise
+ */
+static int process_bip32_recover(const char *mode, int argc, char *argv[]) {
+    bip39_wordlist list;
+    if (bip39_wordlist_load(&list, "./wordlists/english.txt") != 0) {
+        fprintf(stderr, "Cannot load ./wordlists/english.txt\n");
+        return ERROR_INVALID_INPUT;
+    }
+    if (strcmp(mode, "work") == 0) {
+        long threads = argc > 2 ? strtol(argv[2], NULL, 10) : 0;
+        int result = threads < 0 || threads > 1024 ? ERROR_INVALID_INPUT
+                                                   : run_recover_workers(&list, argv[0], argv[1], (size_t)threads);
+        bip39_wordlist_free(&list);
+        return result;
+    }
+
+    char text[CLUSTER_LINE_SIZE / 2];
+    bip39_recover_job job;
+    long workers = strtol(argv[0], NULL, 10);
+    int result = recover_job_text(text, argv[1], argv[2], argc > 3 ? argv[3] : NULL, argc > 4 ? argv[4] : NULL);
+    if (result == SUCCESS) {
+        result = recover_parse_job(&job, &list, text);
+    }
+    int local = strcmp(mode, "local") == 0;
+    if (result == SUCCESS && local && (workers < 1 || workers > 1024)) {
+        fprintf(stderr, "Invalid worker count: %s\n", argv[0]);
+        result = ERROR_INVALID_INPUT;
+    }
+    int fd = -1;
+    uint16_t port = 0;
+    if (result == SUCCESS && cluster_listen(local ? "127.0.0.1" : NULL, local ? "0" : argv[0], &fd, &port) != CLUSTER_OK) {
+        fprintf(stderr, "Cannot listen on port %s\n", local ? "0" : argv[0]);
+        result = ERROR_INTERNAL;
+    }
+    if (result == SUCCESS) {
+        fprintf(stderr, "Listening on port %u: %zu lost words, %zu lost characters, %llu candidates\n",
+                (unsigned)port, job.lost_word_count, job.lost_char_count, (unsigned long long)job.size);
+    }
+
+    /* Loopback: the workers run in this process but still go through TCP */
+    pthread_t pool;
+    int pool_started = 0;
+    recover_loopback loopback;
+    if (result == SUCCESS && local) {
+        loopback.list = &list;
+        snprintf(loopback.port, sizeof(loopback.port), "%u", (unsigned)port);
+        loopback.threads = (size_t)workers;
+        pool_started = pthread_create(&pool, NULL, recover_loopback_thread, &loopback) == 0;
+        result = pool_started ? SUCCESS : ERROR_INTERNAL;
+    }
+    if (result == SUCCESS) {
+        result = coordinate_recovery(fd, &job, text);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (pool_started) {
+        pthread_join(pool, NULL);
+        if (result == SUCCESS && loopback.result != SUCCESS) {
+            result = loopback.result;
+        }
+    }
+
+    OPENSSL_cleanse(text, sizeof(text));
+    OPENSSL_cleanse(&job, sizeof(job));
+    bip39_wordlist_free(&list);
+    return result;
+}
+
+/** @brief Slots of a shared-memory ring when none are given */
+#define SHM_DEFAULT_SLOTS 64
+
+/** @brief Round trips timed by `shm ping` when no count is given */
+#define SHM_PING_COUNT 100000
+
+/** @brief Region stopped by SIGINT and SIGTERM while serving */
+static shmipc_region *shm_serving;
+
+static void shm_stop_signal(int signum) {
+    (void)signum;
+    if (shm_serving != NULL) {
+        shmipc_stop(shm_serving);
+    }
+}
+
+/**
+ * @brief Serves a batch of shared-memory requests
+ *
+ * @param[in] ctx Unused
+ * @param[in,out] slots Requests; responses and statuses are written back
+ * @param[in] count Number of requests
+ *
+ * @note The seeds of the batch are derived together on the SHA-512 lanes;
+ *       master keys are derived one by one. Strings from clients are
+ *       terminated here, whatever they wrote
+ */
+static void serve_shm_batch(void *ctx, shmipc_slot *const *slots, size_t count) {
+    (void)ctx;
+    const char *mnemonics[SHMIPC_BATCH];
+    const char *passphrases[SHMIPC_BATCH];
+    size_t lanes[SHMIPC_BATCH];
+    size_t lane_count = 0;
+    byte seeds[SHMIPC_BATCH][BIP39_SEED_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        shmipc_slot *slot = slots[i];
+        slot->status = SHMIPC_OK;
+        if (slot->op == SHMIPC_OP_SEED || slot->op == SHMIPC_OP_MNEMONIC_KEY) {
+            slot->mnemonic[sizeof(slot->mnemonic) - 1] = '\0';
+            slot->passphrase[sizeof(slot->passphrase) - 1] = '\0';
+            mnemonics[lane_count] = slot->mnemonic;
+            passphrases[lane_count] = slot->passphrase;
+            lanes[lane_count++] = i;
+        } else if (slot->op != SHMIPC_OP_PING && slot->op != SHMIPC_OP_MASTER_KEY) {
+            slot->status = SHMIPC_ERROR_INVALID;
+        }
+    }
+
+    if (lane_count > 0) {
+        int derived = bip39_mnemonics_to_seeds(mnemonics, passphrases, lane_count, seeds) == 0;
+        for (size_t lane = 0; lane < lane_count; lane++) {
+            shmipc_slot *slot = slots[lanes[lane]];
+            if (derived) {
+                memcpy(slot->seed, seeds[lane], BIP39_SEED_SIZE);
+            } else {
+                slot->status = SHMIPC_ERROR_FAILED;
+            }
+        }
+        OPENSSL_cleanse(seeds, sizeof(seeds));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        shmipc_slot *slot = slots[i];
+        if (slot->status != SHMIPC_OK ||
+            (slot->op != SHMIPC_OP_MASTER_KEY && slot->op != SHMIPC_OP_MNEMONIC_KEY)) {
+            continue;
+        }
+        if (derive_bip32_master_key(slot->seed, BIP39_SEED_SIZE, slot->private_key,
+                                    slot->chain_code) != SUCCESS ||
+            private_key_to_public_key(slot->private_key, slot->public_key) != SUCCESS) {
+            slot->status = SHMIPC_ERROR_FAILED;
+            continue;
+        }
+        slot->fingerprint = public_key_fingerprint(slot->public_key);
+    }
+}
+
+/**
+ * @brief Serves seed and master key requests over a shared-memory ring until SIGINT or SIGTERM
+ *
+ * @param[in] name Region name
+ * @param[in] slots Slots in the ring
+ * @param[in] workers Worker threads (0 for the CPU count)
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_shm_serve(const char *name, uint32_t slots, uint32_t workers) {
+    shmipc_region region;
+    int result = shmipc_create(&region, name, slots);
+    if (result != SHMIPC_OK) {
+        fprintf(stderr, "Cannot create the shared-memory ring %s (%d)%s\n", name, result,
+                result == SHMIPC_ERROR_SYSTEM ? "; a stale one may be left in /dev/shm" : "");
+        return ERROR_INTERNAL;
+    }
+
+    shm_serving = &region;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = shm_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    fprintf(stderr, "Serving %s: %u slots of %zu bytes\n", name, slots, sizeof(shmipc_slot));
+    result = shmipc_serve(&region, workers, serve_shm_batch, NULL);
+
+    shmipc_stats stats;
+    shmipc_get_stats(&region, &stats);
+    fprintf(stderr, "%llu requests in %llu batches (%.2f per batch)\n",
+            (unsigned long long)stats.requests, (unsigned long long)stats.batches,
+            stats.batches > 0 ? (double)stats.requests / (double)stats.batches : 0.0);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    shm_serving = NULL;
+    shmipc_close(&region);
+    return result == SHMIPC_OK ? SUCCESS : ERROR_INTERNAL;
+}
+
+/**
+ * @brief Times empty round trips through a running server's ring
+ *
+ * @param[in] name Region name
+ * @param[in] count Round trips
+ * @return 0 on success, negative error code on failure
+ */
+static int process_bip32_shm_ping(const char *name, uint64_t count) {
+    shmipc_region region;
+    if (shmipc_open(&region, name) != SHMIPC_OK) {
+        fprintf(stderr, "Cannot open the shared-memory ring %s\n", name);
+        return ERROR_INVALID_INPUT;
+    }
+    uint64_t total_ns = 0, min_ns = UINT64_MAX, max_ns = 0;
+    int result = SUCCESS;
+    for (uint64_t i = 0; i < count && result == SUCCESS; i++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        shmipc_slot *slot = shmipc_acquire(&region);
+        if (slot == NULL) {
+            result = ERROR_INTERNAL;
+            break;
+        }
+        slot->op = SHMIPC_OP_PING;
+        if (shmipc_call(&region, slot) != SHMIPC_OK) {
+            result = ERROR_INTERNAL;
+        }
+        shmipc_release(&region, slot);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        uint64_t ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000u + (uint64_t)end.tv_nsec -
+                      (uint64_t)start.tv_nsec;
+        total_ns += ns;
+        min_ns = ns < min_ns ? ns : min_ns;
+        max_ns = ns > max_ns ? ns : max_ns;
+    }
+    if (result == SUCCESS) {
+        printf("%llu round trips: mean %.0f ns, min %llu ns, max %llu ns\n", (unsigned long long)count,
+               (double)total_ns / (double)count, (unsigned long long)min_ns, (unsigned long long)max_ns);
+    } else {
+        fprintf(stderr, "The server stopped\n");
+    }
+    shmipc_close(&region);
+    return result;
+}
+
+/**
+ * @brief Derives the seed and master key of a phrase through a running server
+ *
+ * @param[in] name Region name
+ * @param[in] words Mnemonic phrase
+ * @param[in] passphrase Optional passphrase (can be NULL)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note The phrase is checked like `mnemonic` does before it is sent
+ */
+static int process_bip32_shm_mnemonic(const char *name, const char *words, const char *passphrase) {
+    size_t passphrase_len = passphrase != NULL ? strlen(passphrase) : 0;
+    if (strlen(words) >= BIP39_MNEMONIC_MAX_SIZE || passphrase_len > SHMIPC_MAX_PASSPHRASE) {
+        fprintf(stderr, "Phrase or passphrase too long\n");
+        return ERROR_INVALID_INPUT;
+    }
+    int result = check_mnemonic(words);
+    if (result != SUCCESS) {
+        return result;
+    }
+    shmipc_region region;
+    if (shmipc_open(&region, name) != SHMIPC_OK) {
+        fprintf(stderr, "Cannot open the shared-memory ring %s\n", name);
+        return ERROR_INVALID_INPUT;
+    }
+    shmipc_slot *slot = shmipc_acquire(&region);
+    if (slot == NULL) {
+        fprintf(stderr, "The server stopped\n");
+        shmipc_close(&region);
+        return ERROR_INTERNAL;
+    }
+    slot->op = SHMIPC_OP_MNEMONIC_KEY;
+    memcpy(slot->mnemonic, words, strlen(words) + 1);
+    memcpy(slot->passphrase, passphrase != NULL ? passphrase : "", passphrase_len + 1);
+    int status = shmipc_call(&region, slot);
+    result = ERROR_INTERNAL;
+    if (status == SHMIPC_OK) {
+        result = print_master_key_results(slot->seed, slot->private_key, slot->chain_code);
+    } else {
+        fprintf(stderr, "Request failed (%d)\n", status);
+    }
+    shmipc_release(&region, slot);
+    shmipc_close(&region);
+    return result;
+}
+
+/**
+ * @brief Parses a seal cipher name
+ *
+ * @param[in] name "chacha20" (ChaCha20-Poly1305), "aes-gcm" (AES-256-GCM) or NULL for chacha20
+ * @param[out] cipher Parsed cipher
+ * @return 0 on success, ERROR_INVALID_INPUT for unknown names
+ */
+static int seal_cipher_from_name(const char *name, seal_cipher *cipher) {
+    if (name == NULL || strcmp(name, "chacha20") == 0) {
+        *cipher = SEAL_CHACHA20_POLY1305;
+    } else if (strcmp(name, "aes-gcm") == 0) {
+        *cipher = SEAL_AES_256_GCM;
+    } else {
+        fprintf(stderr, "Unknown cipher: %s (chacha20, aes-gcm)\n", name);
+        return ERROR_INVALID_INPUT;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Seals stdin into an encrypted export file
+ *
+ * @param[in] path Output file
+ * @param[in] passphrase Operator passphrase
+ * @param[in] cipher_name Cipher name, NULL for ChaCha20-Poly1305
+ * @return 0 on success, negative error code on failure
+ *
+ * @note For output of other tools (e.g. mnemonics); bip32's own export
+ *       commands can seal directly with --seal
+ */
+static int process_bip32_seal(const char *path, const char *passphrase, const char *cipher_name) {
+    seal_cipher cipher;
+    if (seal_cipher_from_name(cipher_name, &cipher) != SUCCESS) {
+        return ERROR_INVALID_INPUT;
+    }
+    FILE *out = seal_fopen(path, passphrase, cipher);
+    if (out == NULL) {
+        fprintf(stderr, "Cannot create sealed file %s\n", path);
+        return ERROR_INTERNAL;
+    }
+
+    char buffer[SEAL_DEFAULT_CHUNK_SIZE];
+    size_t n;
+    int result = SUCCESS;
+    while ((n = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
+        if (fwrite(buffer, 1, n, out) != n) {
+            result = ERROR_INTERNAL;
+            break;
+        }
+    }
+    if (ferror(stdin)) {
+        result = ERROR_INTERNAL;
+    }
+    OPENSSL_cleanse(buffer, sizeof(buffer));
+    if (fclose(out) != 0 || result != SUCCESS) {
+        fprintf(stderr, "Failed to write sealed file %s\n", path);
+        return ERROR_INTERNAL;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Decrypts chunks of a sealed export file to stdout
+ *
+ * @param[in] path Sealed file
+ * @param[in] passphrase Operator passphrase
+ * @param[in] first First chunk to decrypt
+ * @param[in] count Number of chunks, 0 for all remaining
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Every chunk is authenticated before any of its bytes are written
+ */
+static int process_bip32_unseal(const char *path, const char *passphrase,
+                                uint64_t first, uint64_t count) {
+    seal_reader reader;
+    int result = seal_reader_open(&reader, path, passphrase);
+    if (result == SEAL_ERROR_AUTH) {
+        fprintf(stderr, "Wrong passphrase or corrupted file %s\n", path);
+        return ERROR_INVALID_INPUT;
+    }
+    if (result != SEAL_OK) {
+        fprintf(stderr, "Cannot open sealed file %s\n", path);
+        return ERROR_INVALID_INPUT;
+    }
+    uint64_t end = reader.chunk_count;
+    if (count > 0 && first < end && count < end - first) {
+        end = first + count;
+    }
+
+    uint8_t *chunk = malloc(reader.chunk_size);
+    result = chunk ? SUCCESS : ERROR_INTERNAL;
+    for (uint64_t i = first; i < end && result == SUCCESS; i++) {
+        size_t len = 0;
+        if (seal_reader_read_chunk(&reader, i, chunk, &len) != SEAL_OK) {
+            fprintf(stderr, "Chunk %llu failed authentication\n", (unsigned long long)i);
+            result = ERROR_INVALID_INPUT;
+        } else if (fwrite(chunk, 1, len, stdout) != len) {
+            result = ERROR_INTERNAL;
+        }
+        OPENSSL_cleanse(chunk, len);
+    }
+    free(chunk);
+    seal_reader_close(&reader);
+    return result;
+}
+
+/**
+ * @brief Turns an export command's result into an exit code, sealing the output
+ *
+ * @param[in] out Output stream of the command (stdout or a sealed export)
+ * @param[in] result Result of the command
+ * @return EXIT_SUCCESS if the command and the final flush succeeded
+ */
+static int finish_export(FILE *out, int result) {
+    if (out != stdout && fclose(out) != 0) {
+        fprintf(stderr, "Failed to seal the export file\n");
+        return EXIT_FAILURE;
+    }
+    return result == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Main function demonstrating BIP-32 master key derivation
+ *
+ * @param[in] argc Number of command-line arguments
+ * @param[in] argv Array of command-line argument strings
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure
+ * 
+ * @note Expects one argument: 128-character hex string representing BIP-39 seed
+ * @note Usage: ./program <seed_hex>
+ * @note Usage: ./program mnemonic "<words>" [passphrase]
+ * @note Usage: ./program correct "<words>" [max_distance]
+ * @note Usage: ./program detect < phrases.txt
+ * @note Usage: ./program unlock [capacity] [ttl_seconds] < phrases.txt
+ * @note Usage: ./program recover serve <port> <fingerprint> "<words with ?>" ["<passphrase with ?>"] [charset]
+ * @note Usage: ./program recover work <host> <port> [threads]
+ * @note Usage: ./program recover local <workers> <fingerprint> "<words with ?>" ["<passphrase with ?>"] [charset]
+ * @note Usage: ./program shm serve <name> [slots] [workers]
+ * @note Usage: ./program shm ping <name> [count]
+ * @note Usage: ./program shm mnemonic <name> "<words>" [passphrase]
+ * @note Usage: ./program bulk [threads] < seeds.txt
+ * @note Usage: ./program records [path] [pubkeys] < entropy_or_seeds.txt > out.rec
+ * @note Usage: ./program descriptors <seed_hex> [accounts] [pkh|sh-wpkh|wpkh|tr]
+ * @note Usage: ./program index <addresses.txt> <out.idx>
+ * @note Usage: ./program match <index.idx> <seed_hex> [gap] [pkh|sh-wpkh|wpkh|tr]
+ * @note Usage: ./program keystore add <store> <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads]
+ * @note Usage: ./program keystore index <store> [threads]
+ * @note Usage: ./program keystore find <store> <address|hash160|fingerprint/path>
+ * @note Usage: ./program bip85 <seed_hex> [12|18|24] [first] [count] [language] [threads]
+ * @note Usage: ./program scan <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads]
+ * @note Usage: ./program arrow <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads] > keys.arrow
+ * @note Usage: ./program bip38 encrypt|decrypt <passphrase> [threads] < keys.txt
+ * @note Usage: ./program seal <out.sealed> <passphrase> [chacha20|aes-gcm] < plain.txt
+ * @note Usage: ./program unseal <in.sealed> <passphrase> [first_chunk] [chunks]
+ * @note Usage: ./program --seal <out.sealed> <passphrase> bulk|records|descriptors|bip85|scan|arrow|bip38|detect ...
+ * @note Usage: ./program --pin|--pin-cores [--seal ...] bulk|scan|arrow|keystore add ...
+ */
+int main(int argc, char *argv[]) {
+    /* Worker pinning for the pooled commands, before any --seal */
+    topology_placement placement = TOPOLOGY_ANY;
+    if (argc >= 3 && (strcmp(argv[1], "--pin") == 0 || strcmp(argv[1], "--pin-cores") == 0)) {
+        placement = strcmp(argv[1], "--pin") == 0 ? TOPOLOGY_SPREAD : TOPOLOGY_CORES;
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+        const char *command = argc >= 5 && strcmp(argv[1], "--seal") == 0 ? argv[4] : argv[1];
+        if (strcmp(command, "bulk") != 0 && strcmp(command, "scan") != 0 &&
+            strcmp(command, "arrow") != 0 && strcmp(command, "keystore") != 0) {
+            fprintf(stderr, "--pin and --pin-cores work with bulk, scan, arrow and keystore add\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Encrypted export: the command writes straight into a sealed file */
+    FILE *out = stdout;
+    if (argc >= 5 && strcmp(argv[1], "--seal") == 0) {
+        const char *export_commands[] = {"bulk", "descriptors", "bip85", "scan", "bip38", "detect", "records", "arrow"};
+        bool exportable = false;
+        for (size_t i = 0; i < sizeof(export_commands) / sizeof(export_commands[0]); i++) {
+            exportable = exportable || strcmp(argv[4], export_commands[i]) == 0;
+        }
+        if (!exportable) {
+            fprintf(stderr, "--seal works with bulk, records, descriptors, bip85, scan, arrow, bip38 and detect\n");
+            return EXIT_FAILURE;
+        }
+        out = seal_fopen(argv[2], argv[3], SEAL_CHACHA20_POLY1305);
+        if (out == NULL) {
+            fprintf(stderr, "Cannot create sealed file %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+        argv[3] = argv[0];
+        argv += 3;
+        argc -= 3;
+    }
+
+    /* Bulk provisioning writes bare xprv lines, so no banner */
+    if (argc >= 2 && argc <= 3 && strcmp(argv[1], "bulk") == 0) {
+        long threads = argc > 2 ? strtol(argv[2], NULL, 10) : 0;
+        if (threads < 0 || threads > 1024) {
+            fprintf(stderr, "Invalid thread count: %s\n", argv[2]);
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        return finish_export(out, process_bip32_bulk((size_t)threads, placement, out));
+    }
+
+    /* Fixed-width binary records for downstream tools */
+    if (argc >= 2 && argc <= 4 && strcmp(argv[1], "records") == 0) {
+        const char *path = argc > 2 ? argv[2] : "m/84'/0'/0'/0";
+        long pubkeys = argc > 3 ? strtol(argv[3], NULL, 10) : RECORD_MAX_PUBKEYS;
+        if (pubkeys < 0 || pubkeys > RECORD_MAX_PUBKEYS || strlen(path) >= RECORD_PATH_SIZE) {
+            fprintf(stderr, "Invalid records arguments (pubkeys 0-%d, path under %d characters)\n",
+                    RECORD_MAX_PUBKEYS, RECORD_PATH_SIZE);
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        return finish_export(out, process_bip32_records(path, (uint32_t)pubkeys, out));
+    }
+
+    /* Descriptor lines only, ready for importdescriptors */
+    if (argc >= 3 && argc <= 5 && strcmp(argv[1], "descriptors") == 0) {
+        long accounts = argc > 3 ? strtol(argv[3], NULL, 10) : 1;
+        if (accounts < 1 || accounts > 100000) {
+            fprintf(stderr, "Invalid account count: %s\n", argv[3]);
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        const char *type_name = argc > 4 ? argv[4] : NULL;
+        return finish_export(out, process_bip32_descriptors(argv[2], (uint32_t)accounts, type_name, out));
+    }
+
+    /* Offline address-set audit */
+    if (argc == 4 && strcmp(argv[1], "index") == 0) {
+        return process_bip32_index_build(argv[2], argv[3]) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 6 && strcmp(argv[1], "match") == 0) {
+        long gap = argc > 4 ? strtol(argv[4], NULL, 10) : ADDRMATCH_DEFAULT_GAP;
+        if (gap < 1 || gap > 1000000) {
+            fprintf(stderr, "Invalid gap limit: %s\n", argv[4]);
+            return EXIT_FAILURE;
+        }
+        const char *type_name = argc > 5 ? argv[5] : NULL;
+        return process_bip32_match(argv[2], argv[3], (uint32_t)gap, type_name) == SUCCESS
+                   ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Which seed and path produced an address: indexed store of derived public keys */
+    if (argc >= 4 && argc <= 9 && strcmp(argv[1], "keystore") == 0 && strcmp(argv[2], "add") == 0) {
+        long accounts = argc > 5 ? strtol(argv[5], NULL, 10) : 1;
+        long addresses = argc > 6 ? strtol(argv[6], NULL, 10) : 20;
+        long threads = argc > 8 ? strtol(argv[8], NULL, 10) : 0;
+        if (argc < 5 || accounts < 1 || accounts > 100000 || addresses < 1 || addresses > 100000000 ||
+            threads < 0 || threads > 1024) {
+            fprintf(stderr, "Invalid keystore add arguments\n");
+            return EXIT_FAILURE;
+        }
+        scan_spec spec = {SCAN_ALL_TYPES, 0, (uint32_t)accounts, SCAN_RECEIVE | SCAN_CHANGE,
+                          0, (uint32_t)addresses, (size_t)threads, placement};
+        const char *type_name = argc > 7 ? argv[7] : NULL;
+        return process_bip32_keystore_add(argv[3], argv[4], &spec, type_name) == SUCCESS
+                   ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 5 && strcmp(argv[1], "keystore") == 0 && strcmp(argv[2], "index") == 0) {
+        long threads = argc > 4 ? strtol(argv[4], NULL, 10) : 0;
+        uint64_t indexed = 0;
+        if (threads < 0 || threads > 1024 ||
+            keystore_build_index(argv[3], (size_t)threads, &indexed) != SUCCESS) {
+            fprintf(stderr, "Cannot index key store %s\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        fprintf(stderr, "Indexed %llu keys\n", (unsigned long long)indexed);
+        return EXIT_SUCCESS;
+    }
+    if (argc == 5 && strcmp(argv[1], "keystore") == 0 && strcmp(argv[2], "find") == 0) {
+        return process_bip32_keystore_find(argv[3], argv[4]) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Child mnemonics, one "index words" line each */
+    if (argc >= 3 && argc <= 8 && strcmp(argv[1], "bip85") == 0) {
+        long words = argc > 3 ? strtol(argv[3], NULL, 10) : 12;
+        long first = argc > 4 ? strtol(argv[4], NULL, 10) : 0;
+        long count = argc > 5 ? strtol(argv[5], NULL, 10) : 1;
+        long language = argc > 6 ? strtol(argv[6], NULL, 10) : BIP85_ENGLISH;
+        long threads = argc > 7 ? strtol(argv[7], NULL, 10) : 0;
+        if ((words != 12 && words != 18 && words != 24) || first < 0 || first >= (long)BIP32_HARDENED ||
+            count < 1 || count > (long)BIP32_HARDENED - first || language < 0 ||
+            threads < 0 || threads > 1024) {
+            fprintf(stderr, "Invalid BIP-85 arguments\n");
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        return finish_export(out, process_bip32_bip85(argv[2], (uint32_t)words, (uint32_t)first,
+                                                      (uint32_t)count, (uint32_t)language,
+                                                      (size_t)threads, out));
+    }
+
+    /* Receive and change addresses of every purpose and account in one run */
+    if (argc >= 3 && argc <= 7 && (strcmp(argv[1], "scan") == 0 || strcmp(argv[1], "arrow") == 0)) {
+        long accounts = argc > 3 ? strtol(argv[3], NULL, 10) : 1;
+        long addresses = argc > 4 ? strtol(argv[4], NULL, 10) : 20;
+        long threads = argc > 6 ? strtol(argv[6], NULL, 10) : 0;
+        if (accounts < 1 || accounts > 100000 || addresses < 1 || addresses > 100000000 ||
+            threads < 0 || threads > 1024) {
+            fprintf(stderr, "Invalid scan size\n");
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        scan_spec spec = {SCAN_ALL_TYPES, 0, (uint32_t)accounts, SCAN_RECEIVE | SCAN_CHANGE,
+                          0, (uint32_t)addresses, (size_t)threads, placement};
+        const char *type_name = argc > 5 ? argv[5] : NULL;
+        /* Same grid as a columnar file for dataframe tools */
+        if (strcmp(argv[1], "arrow") == 0) {
+            return finish_export(out, process_bip32_arrow(argv[2], &spec, type_name, out));
+        }
+        return finish_export(out, process_bip32_scan(argv[2], &spec, type_name, out));
+    }
+
+    /* Passphrase-protected keys for cold storage, one per line */
+    if (argc >= 4 && argc <= 5 && strcmp(argv[1], "bip38") == 0 &&
+        (strcmp(argv[2], "encrypt") == 0 || strcmp(argv[2], "decrypt") == 0)) {
+        long threads = argc > 4 ? strtol(argv[4], NULL, 10) : 0;
+        if (threads < 0 || threads > 1024) {
+            fprintf(stderr, "Invalid thread count: %s\n", argv[4]);
+            return finish_export(out, ERROR_INVALID_INPUT);
+        }
+        return finish_export(out, process_bip32_bip38(strcmp(argv[2], "encrypt") == 0, argv[3],
+                                                      (size_t)threads, out));
+    }
+
+    /* Phrases in any loaded language, detected per line */
+    if (argc == 2 && strcmp(argv[1], "detect") == 0) {
+        return finish_export(out, process_bip32_detect(out));
+    }
+
+    /* A sealed export needs one of the commands above */
+    if (out != stdout) {
+        fprintf(stderr, "Invalid arguments for %s\n", argv[1]);
+        return finish_export(out, ERROR_INVALID_INPUT);
+    }
+
+    /* Typo recovery for a phrase that fails its checksum */
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "correct") == 0) {
+        long max_distance = argc > 3 ? strtol(argv[3], NULL, 10) : 2;
+        if (max_distance < 0 || max_distance > 8) {
+            fprintf(stderr, "Invalid edit distance: %s\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        return process_bip32_correct(argv[2], (unsigned)max_distance) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Repeated unlocks served from an encrypted seed cache */
+    if (argc >= 2 && argc <= 4 && strcmp(argv[1], "unlock") == 0) {
+        long capacity = argc > 2 ? strtol(argv[2], NULL, 10) : 256;
+        long ttl = argc > 3 ? strtol(argv[3], NULL, 10) : 300;
+        if (capacity < 1 || capacity > (long)BIP39_SEEDCACHE_MAX_CAPACITY) {
+            fprintf(stderr, "Invalid cache capacity: %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+        if (ttl < 0 || ttl > 86400) {
+            fprintf(stderr, "Invalid TTL: %s\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        return process_bip32_unlock((uint32_t)capacity, (uint32_t)ttl) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Distributed recovery of lost words or passphrase characters */
+    if (argc >= 3 && strcmp(argv[1], "recover") == 0 &&
+        (((strcmp(argv[2], "serve") == 0 || strcmp(argv[2], "local") == 0) && argc >= 6 && argc <= 8) ||
+         (strcmp(argv[2], "work") == 0 && argc >= 5 && argc <= 6))) {
+        return process_bip32_recover(argv[2], argc - 3, argv + 3) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Resident server for callers on the same host, and its test clients */
+    if (argc >= 4 && argc <= 6 && strcmp(argv[1], "shm") == 0 && strcmp(argv[2], "serve") == 0) {
+        long slots = argc > 4 ? strtol(argv[4], NULL, 10) : SHM_DEFAULT_SLOTS;
+        long workers = argc > 5 ? strtol(argv[5], NULL, 10) : 0;
+        if (slots < 1 || slots > SHMIPC_MAX_SLOTS) {
+            fprintf(stderr, "Invalid slot count: %s\n", argv[4]);
+            return EXIT_FAILURE;
+        }
+        if (workers < 0 || workers > 1024) {
+            fprintf(stderr, "Invalid worker count: %s\n", argv[5]);
+            return EXIT_FAILURE;
+        }
+        return process_bip32_shm_serve(argv[3], (uint32_t)slots, (uint32_t)workers) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 5 && strcmp(argv[1], "shm") == 0 && strcmp(argv[2], "ping") == 0) {
+        long long count = argc > 4 ? strtoll(argv[4], NULL, 10) : SHM_PING_COUNT;
+        if (count < 1) {
+            fprintf(stderr, "Invalid count: %s\n", argv[4]);
+            return EXIT_FAILURE;
+        }
+        return process_bip32_shm_ping(argv[3], (uint64_t)count) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 5 && argc <= 6 && strcmp(argv[1], "shm") == 0 && strcmp(argv[2], "mnemonic") == 0) {
+        return process_bip32_shm_mnemonic(argv[3], argv[4], argc > 5 ? argv[5] : NULL) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Encrypt any stream, or read a sealed export back */
+    if (argc >= 4 && argc <= 5 && strcmp(argv[1], "seal") == 0) {
+        const char *cipher_name = argc > 4 ? argv[4] : NULL;
+        return process_bip32_seal(argv[2], argv[3], cipher_name) == SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 6 && strcmp(argv[1], "unseal") == 0) {
+        long long first = argc > 4 ? strtoll(argv[4], NULL, 10) : 0;
+        long long count = argc > 5 ? strtoll(argv[5], NULL, 10) : 0;
+        if (first < 0 || count < 0) {
+            fprintf(stderr, "Invalid chunk range\n");
+            return EXIT_FAILURE;
+        }
+        return process_bip32_unseal(argv[2], argv[3], (uint64_t)first, (uint64_t)count) == SUCCESS
+                   ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    printf("\n\nBIP-32 creating pubkey and privkey to import.\n\n");
+
+    /* Fused mnemonic -> seed -> master key pipeline */
+    if (argc >= 3 && strcmp(argv[1], "mnemonic") == 0) {
+        const char *passphrase = argc > 3 ? argv[3] : NULL;
+        if (process_bip32_mnemonic(argv[2], passphrase) != SUCCESS) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /* Check if seed hex is provided as command-line argument */
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <64-byte-seed-in-hex>\n", argv[0]);
+        fprintf(stderr, "       %s mnemonic \"<words>\" [passphrase]\n", argv[0]);
+        fprintf(stderr, "       %s correct \"<words>\" [max_distance]\n", argv[0]);
+        fprintf(stderr, "       %s detect < phrases.txt\n", argv[0]);
+        fprintf(stderr, "       %s unlock [capacity] [ttl_seconds] < phrases.txt\n", argv[0]);
+        fprintf(stderr, "       %s recover serve <port> <fingerprint> \"<words with ?>\" [\"<passphrase with ?>\"] [charset]\n", argv[0]);
+        fprintf(stderr, "       %s recover work <host> <port> [threads]\n", argv[0]);
+        fprintf(stderr, "       %s recover local <workers> <fingerprint> \"<words with ?>\" [\"<passphrase with ?>\"] [charset]\n", argv[0]);
+        fprintf(stderr, "       %s shm serve <name> [slots] [workers]\n", argv[0]);
+        fprintf(stderr, "       %s shm ping <name> [count]\n", argv[0]);
+        fprintf(stderr, "       %s shm mnemonic <name> \"<words>\" [passphrase]\n", argv[0]);
+        fprintf(stderr, "       %s bulk [threads] < seeds.txt\n", argv[0]);
+        fprintf(stderr, "       %s records [path] [pubkeys] < entropy_or_seeds.txt > out.rec\n", argv[0]);
+        fprintf(stderr, "       %s descriptors <seed_hex> [accounts] [pkh|sh-wpkh|wpkh|tr]\n", argv[0]);
+        fprintf(stderr, "       %s index <addresses.txt> <out.idx>\n", argv[0]);
+        fprintf(stderr, "       %s bip85 <seed_hex> [12|18|24] [first] [count] [language] [threads]\n", argv[0]);
+        fprintf(stderr, "       %s scan <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads]\n", argv[0]);
+        fprintf(stderr, "       %s arrow <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads] > keys.arrow\n", argv[0]);
+        fprintf(stderr, "       %s match <index.idx> <seed_hex> [gap] [pkh|sh-wpkh|wpkh|tr]\n", argv[0]);
+        fprintf(stderr, "       %s keystore add <store> <seed_hex> [accounts] [addresses] [pkh|sh-wpkh|wpkh|tr|all] [threads]\n", argv[0]);
+        fprintf(stderr, "       %s keystore index <store> [threads]\n", argv[0]);
+        fprintf(stderr, "       %s keystore find <store> <address|hash160|fingerprint/path>\n", argv[0]);
+        fprintf(stderr, "       %s bip38 encrypt|decrypt <passphrase> [threads] < keys.txt\n", argv[0]);
+        fprintf(stderr, "       %s seal <out.sealed> <passphrase> [chacha20|aes-gcm] < plain.txt\n", argv[0]);
+        fprintf(stderr, "       %s unseal <in.sealed> <passphrase> [first_chunk] [chunks]\n", argv[0]);
+        fprintf(stderr, "       %s --seal <out.sealed> <passphrase> bulk|records|descriptors|bip85|scan|arrow|bip38|detect ...\n", argv[0]);
+        fprintf(stderr, "       %s --pin|--pin-cores [--seal ...] bulk|scan|arrow|keystore add ...\n", argv[0]);
+        fprintf(stderr, "Example: %s 2f00201a843bf367ed45fda52ea0d3aba21ee730ad1a93189e67ae0e6faae4bb3a32629b955d1cfcde3becc25f2e39519e1e5d9ee8318c6217b11bcedb9f9683\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    
+    if (process_bip32_seed(argv[1]) != SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
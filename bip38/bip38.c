@@ -0,0 +1,206 @@
+/**
+ * @file bip38.c
+ * @brief BIP-38 passphrase-protected private keys (non-EC-multiply mode).
+ */
+#include "bip38.h"
+
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+/** @brief Prefix of non-EC-multiplied keys */
+static const byte BIP38_PREFIX[2] = {0x01, 0x42};
+
+/** @brief Flag byte: both high bits are always set in this mode */
+#define BIP38_FLAG_BASE 0xC0
+
+/** @brief Flag bit for keys used with compressed public keys */
+#define BIP38_FLAG_COMPRESSED 0x20
+
+/** @brief Version byte of P2PKH addresses */
+#define P2PKH_VERSION_BYTE 0x00
+
+/**
+ * @brief addresshash: first 4 bytes of SHA256(SHA256(P2PKH address string)).
+ * @param private_key 32-byte private key.
+ * @param compressed Hash the address of the compressed public key.
+ * @param out 4-byte address hash.
+ * @return 0 on success, negative error code on failure.
+ */
+static int address_hash(const byte *private_key, int compressed, byte out[4]) {
+    byte public_key[UNCOMPRESSED_PUBLIC_KEY_LENGTH];
+    size_t public_key_len = compressed ? PUBLIC_KEY_LENGTH : UNCOMPRESSED_PUBLIC_KEY_LENGTH;
+    int result = compressed ? private_key_to_public_key(private_key, public_key)
+                            : private_key_to_uncompressed_public_key(private_key, public_key);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    byte payload[25];
+    byte digest[SHA256_DIGEST_LENGTH];
+    payload[0] = P2PKH_VERSION_BYTE;
+    hash160(public_key, public_key_len, payload + 1);
+    SHA256(payload, 21, digest);
+    SHA256(digest, sizeof(digest), digest);
+    memcpy(payload + 21, digest, 4);
+
+    byte address[40];
+    size_t len = base58_encode(address, payload, sizeof(payload));
+    if (len == 0) {
+        return ERROR_INTERNAL;
+    }
+    SHA256(address, len, digest);
+    SHA256(digest, sizeof(digest), digest);
+    memcpy(out, digest, 4);
+    return SUCCESS;
+}
+
+/**
+ * @brief derivedhalf1 || derivedhalf2 = scrypt(passphrase, addresshash, 16384, 8, 8, 64).
+ */
+static int derive_halves(const char *passphrase, const byte salt[4], size_t threads,
+                         scrypt_arena *arena, byte derived[64]) {
+    if (passphrase == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    return scrypt((const uint8_t *)passphrase, strlen(passphrase), salt, 4,
+                  BIP38_SCRYPT_N, BIP38_SCRYPT_R, BIP38_SCRYPT_P, threads, arena,
+                  derived, 64) == 0 ? SUCCESS : ERROR_INTERNAL;
+}
+
+/**
+ * @brief AES-256-ECB over two blocks without padding.
+ * @param key 32-byte key (derivedhalf2).
+ * @param in 32 bytes of input.
+ * @param out 32 bytes of output.
+ * @param encrypt 1 to encrypt, 0 to decrypt.
+ * @return 0 on success, ERROR_INTERNAL on an OpenSSL failure.
+ */
+static int aes256_ecb(const byte *key, const byte *in, byte *out, int encrypt) {
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len = 0;
+    int ok = ctx != NULL &&
+             EVP_CipherInit_ex(ctx, EVP_aes_256_ecb(), NULL, key, NULL, encrypt) == 1 &&
+             EVP_CIPHER_CTX_set_padding(ctx, 0) == 1 &&
+             EVP_CipherUpdate(ctx, out, &len, in, 32) == 1 && len == 32;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok ? SUCCESS : ERROR_INTERNAL;
+}
+
+int bip38_encrypt(const byte *private_key, int compressed, const char *passphrase,
+                  size_t threads, scrypt_arena *arena, char *out, size_t size) {
+    if (private_key == NULL || passphrase == NULL || out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte raw[BIP38_RAW_LENGTH + 4];
+    byte derived[64];
+    byte block[32];
+    raw[0] = BIP38_PREFIX[0];
+    raw[1] = BIP38_PREFIX[1];
+    raw[2] = BIP38_FLAG_BASE | (compressed ? BIP38_FLAG_COMPRESSED : 0);
+
+    int result = address_hash(private_key, compressed, raw + 3);
+    if (result == SUCCESS) {
+        result = derive_halves(passphrase, raw + 3, threads, arena, derived);
+    }
+    if (result == SUCCESS) {
+        for (int i = 0; i < 32; i++) block[i] = private_key[i] ^ derived[i];
+        result = aes256_ecb(derived + 32, block, raw + 7, 1);
+    }
+    if (result == SUCCESS) {
+        byte digest[SHA256_DIGEST_LENGTH];
+        SHA256(raw, BIP38_RAW_LENGTH, digest);
+        SHA256(digest, sizeof(digest), digest);
+        memcpy(raw + BIP38_RAW_LENGTH, digest, 4);
+
+        byte encoded[BIP38_MAX_SIZE + 8];
+        size_t len = base58_encode(encoded, raw, sizeof(raw));
+        if (len == 0 || len + 1 > size) {
+            result = ERROR_INVALID_LENGTH;
+        } else {
+            memcpy(out, encoded, len + 1);
+        }
+    }
+
+    OPENSSL_cleanse(derived, sizeof(derived));
+    OPENSSL_cleanse(block, sizeof(block));
+    return result;
+}
+
+int bip38_decrypt(const char *encrypted, const char *passphrase,
+                  size_t threads, scrypt_arena *arena,
+                  byte *private_key_out, int *compressed) {
+    if (encrypted == NULL || passphrase == NULL || private_key_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte raw[BIP38_RAW_LENGTH + 4];
+    byte digest[SHA256_DIGEST_LENGTH];
+    if (base58_decode(raw, sizeof(raw), encrypted) != sizeof(raw)) {
+        return ERROR_INVALID_INPUT;
+    }
+    SHA256(raw, BIP38_RAW_LENGTH, digest);
+    SHA256(digest, sizeof(digest), digest);
+    // EC-multiplied keys (0x01 0x43) need the intermediate-code flow; not supported
+    if (CRYPTO_memcmp(digest, raw + BIP38_RAW_LENGTH, 4) != 0 ||
+        raw[0] != BIP38_PREFIX[0] || raw[1] != BIP38_PREFIX[1] ||
+        (raw[2] & ~BIP38_FLAG_COMPRESSED) != BIP38_FLAG_BASE) {
+        return ERROR_INVALID_INPUT;
+    }
+    int is_compressed = (raw[2] & BIP38_FLAG_COMPRESSED) != 0;
+
+    byte derived[64];
+    byte key[PRIVATE_KEY_LENGTH];
+    byte check[4];
+    int result = derive_halves(passphrase, raw + 3, threads, arena, derived);
+    if (result == SUCCESS) {
+        result = aes256_ecb(derived + 32, raw + 7, key, 0);
+    }
+    if (result == SUCCESS) {
+        for (int i = 0; i < PRIVATE_KEY_LENGTH; i++) key[i] ^= derived[i];
+        // A wrong passphrase yields an unrelated key (or an invalid scalar)
+        result = address_hash(key, is_compressed, check) == SUCCESS &&
+                 CRYPTO_memcmp(check, raw + 3, 4) == 0 ? SUCCESS : BIP38_ERROR_PASSPHRASE;
+    }
+    if (result == SUCCESS) {
+        memcpy(private_key_out, key, PRIVATE_KEY_LENGTH);
+        if (compressed) {
+            *compressed = is_compressed;
+        }
+    }
+
+    OPENSSL_cleanse(derived, sizeof(derived));
+    OPENSSL_cleanse(key, sizeof(key));
+    return result;
+}
+
+int bip38_encrypt_wif(const char *wif, const char *passphrase,
+                      size_t threads, scrypt_arena *arena, char *out, size_t size) {
+    byte key[PRIVATE_KEY_LENGTH];
+    int compressed = 0;
+    int result = wif_to_private_key(wif, key, &compressed);
+    if (result == SUCCESS) {
+        result = bip38_encrypt(key, compressed, passphrase, threads, arena, out, size);
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    return result;
+}
+
+int bip38_decrypt_to_wif(const char *encrypted, const char *passphrase,
+                         size_t threads, scrypt_arena *arena, byte *wif_out) {
+    if (wif_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    byte key[PRIVATE_KEY_LENGTH];
+    int compressed = 0;
+    int result = bip38_decrypt(encrypted, passphrase, threads, arena, key, &compressed);
+    if (result == SUCCESS) {
+        result = compressed ? private_key_to_compressed_wif(key, wif_out)
+                            : private_key_to_wif(key, wif_out);
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    return result;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file bip38.h
+ * @brief BIP-38 passphrase-protected private keys (non-EC-multiply mode).
+ * @details The key is XORed with scrypt(passphrase, addresshash, 16384, 8, 8)
+ *          and AES-256 encrypted, where addresshash is the first four bytes
+ *          of SHA256(SHA256(P2PKH address)). The result is the "6P..."
+ *          Base58Check string printed for cold storage instead of raw WIF.
+ */
+
+#ifndef BIP38_H
+#define BIP38_H
+
+#include "../hdkey/hdkey.h"
+#include "../scrypt/scrypt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief scrypt parameters fixed by BIP-38 */
+#define BIP38_SCRYPT_N 16384
+#define BIP38_SCRYPT_R 8
+#define BIP38_SCRYPT_P 8
+
+/** @brief Decoded length: 0x01 0x42, flag, addresshash, two AES blocks */
+#define BIP38_RAW_LENGTH 39
+
+/** @brief Output buffer size for an encrypted key (58 characters + NUL) */
+#define BIP38_MAX_SIZE 64
+
+/** @brief Returned by decryption when the address hash does not match */
+#define BIP38_ERROR_PASSPHRASE (-4)
+
+/**
+ * @brief Encrypts a private key.
+ * @param private_key 32-byte private key.
+ * @param compressed Nonzero if the key is used with its compressed public key.
+ * @param passphrase Passphrase (UTF-8, expected NFC normalized).
+ * @param threads Threads for the scrypt lanes, 0 for one per online CPU.
+ * @param arena Reused scrypt scratch, or NULL for a temporary one.
+ * @param out Output buffer for the "6P..." string.
+ * @param size Size of the output buffer (BIP38_MAX_SIZE fits).
+ * @return 0 on success, negative error code on failure.
+ */
+int bip38_encrypt(const byte *private_key, int compressed, const char *passphrase,
+                  size_t threads, scrypt_arena *arena, char *out, size_t size);
+
+/**
+ * @brief Decrypts a BIP-38 key.
+ * @param encrypted "6P..." string.
+ * @param passphrase Passphrase.
+ * @param threads Threads for the scrypt lanes, 0 for one per online CPU.
+ * @param arena Reused scrypt scratch, or NULL for a temporary one.
+ * @param private_key_out 32-byte private key.
+ * @param compressed Set to the compression flag of the key (can be NULL).
+ * @return 0 on success, BIP38_ERROR_PASSPHRASE on a wrong passphrase,
+ *         ERROR_INVALID_INPUT on malformed or EC-multiplied input.
+ */
+int bip38_decrypt(const char *encrypted, const char *passphrase,
+                  size_t threads, scrypt_arena *arena,
+                  byte *private_key_out, int *compressed);
+
+/**
+ * @brief Encrypts a WIF key, keeping its compression flag.
+ * @param wif Mainnet WIF string.
+ * @param passphrase Passphrase.
+ * @param threads Threads for the scrypt lanes, 0 for one per online CPU.
+ * @param arena Reused scrypt scratch, or NULL for a temporary one.
+ * @param out Output buffer for the "6P..." string.
+ * @param size Size of the output buffer (BIP38_MAX_SIZE fits).
+ * @return 0 on success, negative error code on failure.
+ */
+int bip38_encrypt_wif(const char *wif, const char *passphrase,
+                      size_t threads, scrypt_arena *arena, char *out, size_t size);
+
+/**
+ * @brief Decrypts a BIP-38 key back to WIF.
+ * @param encrypted "6P..." string.
+ * @param passphrase Passphrase.
+ * @param threads Threads for the scrypt lanes, 0 for one per online CPU.
+ * @param arena Reused scrypt scratch, or NULL for a temporary one.
+ * @param wif_out Output buffer for the WIF (at least 53 bytes).
+ * @return 0 on success, negative error code as bip38_decrypt().
+ */
+int bip38_decrypt_to_wif(const char *encrypted, const char *passphrase,
+                         size_t threads, scrypt_arena *arena, byte *wif_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP38_H
@@ -0,0 +1,240 @@
+/**
+ * @file bip39.c
+ * @brief BIP-39 mnemonic helpers.
+ * @details Implements the entropy to mnemonic and mnemonic to seed steps of
+ *          BIP-39 on top of OpenSSL.
+ */
+#include "bip39.h"
+
+#include <stdio.h>   // For FILE
+#include <stdlib.h>  // For malloc, free
+#include <string.h>  // For strlen, memcpy
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#include "../cpto/cpto.h"
+
+/**
+ * @brief Derives the 64-byte BIP-39 seed from a mnemonic phrase.
+ * @param mnemonic Space separated mnemonic phrase (NFKD normalized).
+ * @param passphrase Optional passphrase (can be NULL).
+ * @param seed Output buffer for the derived seed.
+ * @return 0 on success, -1 on invalid input or KDF failure.
+ */
+int bip39_mnemonic_to_seed(const char *mnemonic, const char *passphrase,
+                           uint8_t seed[BIP39_SEED_SIZE]) {
+    if (!mnemonic || !seed) return -1;
+
+    // Salt is "mnemonic" followed by the optional passphrase
+    size_t pass_len = passphrase ? strlen(passphrase) : 0;
+    unsigned char salt[8 + pass_len];
+    memcpy(salt, "mnemonic", 8);
+    if (pass_len) memcpy(salt + 8, passphrase, pass_len);
+
+    int ok = PKCS5_PBKDF2_HMAC(mnemonic, (int)strlen(mnemonic),
+                               salt, (int)(8 + pass_len),
+                               BIP39_PBKDF2_ROUNDS, EVP_sha512(),
+                               BIP39_SEED_SIZE, seed);
+    OPENSSL_cleanse(salt, sizeof(salt));
+    return ok == 1 ? 0 : -1;
+}
+
+int bip39_mnemonics_to_seeds(const char *const *mnemonics, const char *const *passphrases,
+                             size_t count, uint8_t (*seeds)[BIP39_SEED_SIZE]) {
+    if ((!mnemonics || !seeds) && count > 0) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!mnemonics[i]) return -1;
+    }
+
+    for (size_t base = 0; base < count; base += SHA512_LANES) {
+        size_t lanes = count - base < SHA512_LANES ? count - base : SHA512_LANES;
+        const uint8_t *passwords[SHA512_LANES], *salts[SHA512_LANES];
+        size_t password_lens[SHA512_LANES], salt_lens[SHA512_LANES];
+        unsigned char *salt_buffers[SHA512_LANES] = {0};
+        int ok = 1;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            const char *passphrase = passphrases ? passphrases[base + lane] : NULL;
+            size_t pass_len = passphrase ? strlen(passphrase) : 0;
+            salt_buffers[lane] = malloc(8 + pass_len);
+            if (!salt_buffers[lane]) {
+                ok = 0;
+                break;
+            }
+            memcpy(salt_buffers[lane], "mnemonic", 8);
+            if (pass_len) memcpy(salt_buffers[lane] + 8, passphrase, pass_len);
+            passwords[lane] = (const uint8_t *)mnemonics[base + lane];
+            password_lens[lane] = strlen(mnemonics[base + lane]);
+            salts[lane] = salt_buffers[lane];
+            salt_lens[lane] = 8 + pass_len;
+        }
+        if (ok) {
+            pbkdf2_hmac_sha512_lanes(passwords, password_lens, salts, salt_lens,
+                                     BIP39_PBKDF2_ROUNDS, lanes, seeds + base);
+        }
+        for (size_t lane = 0; lane < lanes; lane++) {
+            if (salt_buffers[lane]) OPENSSL_cleanse(salt_buffers[lane], salt_lens[lane]);
+            free(salt_buffers[lane]);
+        }
+        if (!ok) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Loads a wordlist file (one word per line, 2048 lines).
+ * @param list Wordlist to fill.
+ * @param path Wordlist file, e.g. "wordlists/english.txt".
+ * @return 0 on success, -1 if the file cannot be read or is not 2048 words.
+ */
+int bip39_wordlist_load(bip39_wordlist *list, const char *path) {
+    if (!list || !path) return -1;
+    memset(list, 0, sizeof(*list));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    if (size <= 0 || size > BIP39_WORD_COUNT * (BIP39_MAX_WORD_SIZE + 2)) {
+        fclose(file);
+        return -1;
+    }
+
+    char *arena = malloc((size_t)size + 1);
+    if (!arena || fread(arena, 1, (size_t)size, file) != (size_t)size) {
+        free(arena);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    arena[size] = '\0';
+
+    // Split in place: every line becomes a NUL-terminated word
+    size_t count = 0;
+    char *line = arena;
+    while (*line && count <= BIP39_WORD_COUNT) {
+        size_t len = strcspn(line, "\r\n");
+        char *next = line + len;
+        next += strspn(next, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || len > BIP39_MAX_WORD_SIZE || count == BIP39_WORD_COUNT) {
+            free(arena);
+            memset(list, 0, sizeof(*list));
+            return -1;
+        }
+        list->words[count++] = line;
+        line = next;
+    }
+    if (count != BIP39_WORD_COUNT) {
+        free(arena);
+        memset(list, 0, sizeof(*list));
+        return -1;
+    }
+
+    list->arena = arena;
+    return 0;
+}
+
+/**
+ * @brief Frees a loaded wordlist.
+ * @param list Wordlist to free (can be zero-initialized).
+ */
+void bip39_wordlist_free(bip39_wordlist *list) {
+    if (!list) return;
+    free(list->arena);
+    memset(list, 0, sizeof(*list));
+}
+
+/**
+ * @brief Encodes entropy as a BIP-39 mnemonic.
+ * @param entropy Entropy bytes.
+ * @param len Entropy length: 16, 20, 24, 28 or 32 bytes (12 to 24 words).
+ * @param list Wordlist.
+ * @param out Output buffer for the space separated words.
+ * @param size Size of the output buffer (BIP39_MNEMONIC_MAX_SIZE fits all).
+ * @return 0 on success, -1 on invalid input or a too small buffer.
+ */
+int bip39_entropy_to_mnemonic(const uint8_t *entropy, size_t len,
+                              const bip39_wordlist *list, char *out, size_t size) {
+    if (!entropy || !list || !list->arena || !out || size == 0 ||
+        len < 16 || len > 32 || len % 4 != 0) {
+        return -1;
+    }
+
+    // Entropy followed by its checksum byte; only len / 4 bits of it are used
+    uint8_t bits[33];
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    memcpy(bits, entropy, len);
+    SHA256(entropy, len, hash);
+    bits[len] = hash[0];
+
+    size_t word_count = len * 3 / 4;
+    size_t pos = 0;
+    int result = 0;
+    for (size_t i = 0; i < word_count; i++) {
+        size_t bit = i * 11;
+        uint32_t window = ((uint32_t)bits[bit / 8] << 16) |
+                          ((uint32_t)bits[bit / 8 + 1] << 8) |
+                          (bit / 8 + 2 <= len ? bits[bit / 8 + 2] : 0);
+        uint32_t index = (window >> (13 - bit % 8)) & 0x7FF;
+
+        const char *word = list->words[index];
+        size_t word_len = strlen(word);
+        if (pos + (i > 0) + word_len + 1 > size) {
+            result = -1;
+            break;
+        }
+        if (i > 0) out[pos++] = ' ';
+        memcpy(out + pos, word, word_len);
+        pos += word_len;
+    }
+    out[result == 0 ? pos : 0] = '\0';
+
+    OPENSSL_cleanse(bits, sizeof(bits));
+    OPENSSL_cleanse(hash, sizeof(hash));
+    return result;
+}
+
+/**
+ * @brief Decodes word indices back to entropy and checks the checksum.
+ * @param indices Word indices (0..2047).
+ * @param count Number of words: 12, 15, 18, 21 or 24.
+ * @param entropy Output buffer, at least 32 bytes.
+ * @param len Set to the entropy length (can be NULL).
+ * @return 0 if the checksum matches, -1 otherwise or on invalid input.
+ */
+int bip39_indices_to_entropy(const uint16_t *indices, size_t count,
+                             uint8_t *entropy, size_t *len) {
+    if (!indices || !entropy || count < 12 || count > 24 || count % 3 != 0) {
+        return -1;
+    }
+
+    // Pack 11 bits per word; the last count / 3 bits are the checksum
+    uint8_t bits[33] = {0};
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] >= BIP39_WORD_COUNT) return -1;
+        for (int b = 0; b < 11; b++) {
+            size_t bit = i * 11 + (size_t)b;
+            if ((indices[i] >> (10 - b)) & 1) {
+                bits[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+            }
+        }
+    }
+
+    size_t entropy_len = count * 4 / 3;
+    size_t checksum_bits = count / 3;
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    SHA256(bits, entropy_len, hash);
+    uint8_t mask = (uint8_t)(0xFF << (8 - checksum_bits));
+    int result = (hash[0] & mask) == (bits[entropy_len] & mask) ? 0 : -1;
+    if (result == 0) {
+        memcpy(entropy, bits, entropy_len);
+        if (len) *len = entropy_len;
+    }
+
+    OPENSSL_cleanse(bits, sizeof(bits));
+    OPENSSL_cleanse(hash, sizeof(hash));
+    return result;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file bip39.h
+ * @brief BIP-39 mnemonic helpers.
+ * @details Seed derivation from a mnemonic phrase, usable without going
+ *          through the text output of the mnemonics program.
+ */
+
+#ifndef BIP39_H
+#define BIP39_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Length of a BIP-39 seed in bytes */
+#define BIP39_SEED_SIZE 64
+
+/** @brief PBKDF2 iteration count mandated by BIP-39 */
+#define BIP39_PBKDF2_ROUNDS 2048
+
+/** @brief Number of words in a BIP-39 wordlist */
+#define BIP39_WORD_COUNT 2048
+
+/** @brief Longest word accepted in a wordlist, in bytes (UTF-8) */
+#define BIP39_MAX_WORD_SIZE 32
+
+/** @brief Buffer size that fits any mnemonic (24 words and separators) */
+#define BIP39_MNEMONIC_MAX_SIZE (24 * (BIP39_MAX_WORD_SIZE + 1))
+
+/**
+ * @brief A loaded 2048-word list.
+ */
+typedef struct {
+    char *arena;                              ///< All words, NUL-separated.
+    const char *words[BIP39_WORD_COUNT];      ///< Word i, pointing into arena.
+} bip39_wordlist;
+
+/**
+ * @brief Loads a wordlist file (one word per line, 2048 lines).
+ * @param list Wordlist to fill.
+ * @param path Wordlist file, e.g. "wordlists/english.txt".
+ * @return 0 on success, -1 if the file cannot be read or is not 2048 words.
+ */
+int bip39_wordlist_load(bip39_wordlist *list, const char *path);
+
+/**
+ * @brief Frees a loaded wordlist.
+ * @param list Wordlist to free (can be zero-initialized).
+ */
+void bip39_wordlist_free(bip39_wordlist *list);
+
+/**
+ * @brief Encodes entropy as a BIP-39 mnemonic.
+ * @param entropy Entropy bytes.
+ * @param len Entropy length: 16, 20, 24, 28 or 32 bytes (12 to 24 words).
+ * @param list Wordlist.
+ * @param out Output buffer for the space separated words.
+ * @param size Size of the output buffer (BIP39_MNEMONIC_MAX_SIZE fits all).
+ * @return 0 on success, -1 on invalid input or a too small buffer.
+ * @note The SHA-256 checksum (len / 4 bits) is appended to the entropy and
+ *       the result split into 11-bit word indices, most significant first.
+ */
+int bip39_entropy_to_mnemonic(const uint8_t *entropy, size_t len,
+                              const bip39_wordlist *list, char *out, size_t size);
+
+/**
+ * @brief Derives the 64-byte BIP-39 seed from a mnemonic phrase.
+ * @param mnemonic Space separated mnemonic phrase (NFKD normalized).
+ * @param passphrase Optional passphrase (can be NULL).
+ * @param seed Output buffer for the derived seed.
+ * @return 0 on success, -1 on invalid input or KDF failure.
+ */
+int bip39_mnemonic_to_seed(const char *mnemonic, const char *passphrase,
+                           uint8_t seed[BIP39_SEED_SIZE]);
+
+/**
+ * @brief Derives the seeds of several phrases, eight PBKDF2 runs at a time.
+ * @param mnemonics Phrases (NFKD normalized).
+ * @param passphrases Passphrase of each phrase (the array and its entries can be NULL).
+ * @param count Number of phrases.
+ * @param seeds Output: one seed per phrase.
+ * @return 0 on success, -1 on invalid input.
+ * @note Same seeds as bip39_mnemonic_to_seed(), through the multi-lane
+ *       pbkdf2_hmac_sha512_lanes(): a group of 8 costs about as much as a
+ *       few single seeds when the CPU has AVX2 or AVX-512.
+ */
+int bip39_mnemonics_to_seeds(const char *const *mnemonics, const char *const *passphrases,
+                             size_t count, uint8_t (*seeds)[BIP39_SEED_SIZE]);
+
+/**
+ * @brief Decodes word indices back to entropy and checks the checksum.
+ * @param indices Word indices (0..2047).
+ * @param count Number of words: 12, 15, 18, 21 or 24.
+ * @param entropy Output buffer, at least 32 bytes.
+ * @param len Set to the entropy length (can be NULL).
+ * @return 0 if the checksum matches, -1 otherwise or on invalid input.
+ */
+int bip39_indices_to_entropy(const uint16_t *indices, size_t count,
+                             uint8_t *entropy, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_H
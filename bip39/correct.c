@@ -0,0 +1,275 @@
+/**
+ * @file correct.c
+ * @brief Typo correction for BIP-39 words and phrases.
+ */
+#include "correct.h"
+
+#include <stdlib.h>  // For malloc, free, qsort
+#include <string.h>  // For memset, strlen
+
+#include <openssl/crypto.h>
+
+/** @brief Number of column blocks in a list */
+#define BLOCKS (BIP39_WORD_COUNT / BIP39_CORRECT_LANES)
+
+int bip39_corrector_init(bip39_corrector *corrector, const bip39_wordlist *list) {
+    if (!corrector || !list || !list->arena) return -1;
+    memset(corrector, 0, sizeof(*corrector));
+
+    corrector->columns = calloc((size_t)BLOCKS * BIP39_MAX_WORD_SIZE, BIP39_CORRECT_LANES);
+    if (!corrector->columns) return -1;
+    corrector->list = list;
+
+    // Column-major per block, so one load fetches byte j of eight words
+    for (size_t w = 0; w < BIP39_WORD_COUNT; w++) {
+        size_t block = w / BIP39_CORRECT_LANES;
+        size_t lane = w % BIP39_CORRECT_LANES;
+        size_t len = strlen(list->words[w]);
+        corrector->lengths[w] = (uint8_t)len;
+        if (len > corrector->block_length[block]) {
+            corrector->block_length[block] = (uint8_t)len;
+        }
+        for (size_t j = 0; j < len; j++) {
+            corrector->columns[(block * BIP39_MAX_WORD_SIZE + j) * BIP39_CORRECT_LANES + lane] =
+                (uint8_t)list->words[w][j];
+        }
+    }
+    return 0;
+}
+
+void bip39_corrector_free(bip39_corrector *corrector) {
+    if (!corrector) return;
+    free(corrector->columns);
+    memset(corrector, 0, sizeof(*corrector));
+}
+
+/*
+ * Myers/Hyyrö bit-parallel Levenshtein distance. The typed word is the
+ * pattern (bit i of peq[c] is set when typed[i] == c); each list word is the
+ * text. Vertical deltas Pv/Mv of one DP column live in a 32-bit word, and
+ * the score tracks the bottom cell D[m][j]. Shifting a 1 into Ph gives the
+ * D[0][j] = j boundary of a full-word (not substring) distance.
+ */
+
+/**
+ * @brief Distances from the pattern to the eight words of one block (portable).
+ */
+static void block_distances_scalar(const uint8_t *columns, const uint8_t *lengths, size_t max_len,
+                                   const uint32_t peq[256], unsigned m, uint8_t *out) {
+    uint32_t last = 1u << (m - 1);
+    for (int lane = 0; lane < BIP39_CORRECT_LANES; lane++) {
+        uint32_t pv = ~0u, mv = 0;
+        unsigned score = m;
+        for (size_t j = 0; j < lengths[lane] && j < max_len; j++) {
+            uint32_t eq = peq[columns[j * BIP39_CORRECT_LANES + lane]];
+            uint32_t xv = eq | mv;
+            uint32_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint32_t ph = mv | ~(xh | pv);
+            uint32_t mh = pv & xh;
+            if (ph & last) score++;
+            if (mh & last) score--;
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        out[lane] = (uint8_t)score;
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CORRECT_HAVE_X86 1
+
+/**
+ * @brief Distances from the pattern to the eight words of one block (AVX2).
+ * @note Lanes are words; peq is gathered per lane. A lane's score is latched
+ *       when j reaches its word length.
+ */
+__attribute__((target("avx2")))
+static void block_distances_avx2(const uint8_t *columns, const uint8_t *lengths, size_t max_len,
+                                 const uint32_t peq[256], unsigned m, uint8_t *out) {
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i last = _mm256_set1_epi32((int)(1u << (m - 1)));
+    __m256i pv = ones;
+    __m256i mv = _mm256_setzero_si256();
+    __m256i score = _mm256_set1_epi32((int)m);
+    __m256i result = score;
+    __m256i len = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)lengths));
+
+    for (size_t j = 0; j < max_len; j++) {
+        __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(columns + j * BIP39_CORRECT_LANES)));
+        __m256i eq = _mm256_i32gather_epi32((const int *)peq, c, 4);
+        __m256i xv = _mm256_or_si256(eq, mv);
+        __m256i sum = _mm256_add_epi32(_mm256_and_si256(eq, pv), pv);
+        __m256i xh = _mm256_or_si256(_mm256_xor_si256(sum, pv), eq);
+        __m256i ph = _mm256_or_si256(mv, _mm256_xor_si256(_mm256_or_si256(xh, pv), ones));
+        __m256i mh = _mm256_and_si256(pv, xh);
+        // score += (ph & last) != 0; score -= (mh & last) != 0 (compare gives -1)
+        score = _mm256_sub_epi32(score, _mm256_cmpeq_epi32(_mm256_and_si256(ph, last), last));
+        score = _mm256_add_epi32(score, _mm256_cmpeq_epi32(_mm256_and_si256(mh, last), last));
+        ph = _mm256_or_si256(_mm256_slli_epi32(ph, 1), one);
+        mh = _mm256_slli_epi32(mh, 1);
+        pv = _mm256_or_si256(mh, _mm256_xor_si256(_mm256_or_si256(xv, ph), ones));
+        mv = _mm256_and_si256(ph, xv);
+        __m256i done = _mm256_cmpeq_epi32(len, _mm256_set1_epi32((int)j + 1));
+        result = _mm256_blendv_epi8(result, score, done);
+    }
+
+    uint32_t lanes[BIP39_CORRECT_LANES];
+    _mm256_storeu_si256((__m256i *)lanes, result);
+    for (int lane = 0; lane < BIP39_CORRECT_LANES; lane++) {
+        out[lane] = (uint8_t)lanes[lane];
+    }
+}
+#endif
+
+/** @brief Block kernel chosen on first use from the CPU features. */
+typedef void (*block_distances_fn)(const uint8_t *, const uint8_t *, size_t,
+                                   const uint32_t *, unsigned, uint8_t *);
+
+/**
+ * @brief Picks the widest kernel the running CPU supports.
+ * @return Kernel function pointer.
+ */
+static block_distances_fn block_distances_select(void) {
+#ifdef CORRECT_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return block_distances_avx2;
+#endif
+    return block_distances_scalar;
+}
+
+/**
+ * @brief Ranks candidates: distance, then longer common prefix, then list order.
+ */
+static int compare_candidates(const void *a, const void *b) {
+    const bip39_candidate *x = a;
+    const bip39_candidate *y = b;
+    if (x->distance != y->distance) return x->distance < y->distance ? -1 : 1;
+    if (x->prefix != y->prefix) return x->prefix > y->prefix ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+size_t bip39_correct_word(const bip39_corrector *corrector, const char *typed,
+                          unsigned max_distance, bip39_candidate *out, size_t max_out) {
+    static block_distances_fn kernel = NULL;
+    if (!corrector || !corrector->columns || !typed) return 0;
+    size_t m = strlen(typed);
+    if (m == 0 || m > BIP39_MAX_WORD_SIZE) return 0;
+    if (!kernel) kernel = block_distances_select();
+
+    uint32_t peq[256] = {0};
+    for (size_t i = 0; i < m; i++) {
+        peq[(uint8_t)typed[i]] |= 1u << i;
+    }
+
+    bip39_candidate found[BIP39_WORD_COUNT];
+    size_t count = 0;
+    for (size_t block = 0; block < BLOCKS; block++) {
+        const uint8_t *lengths = corrector->lengths + block * BIP39_CORRECT_LANES;
+        uint8_t distances[BIP39_CORRECT_LANES];
+        kernel(corrector->columns + block * BIP39_MAX_WORD_SIZE * BIP39_CORRECT_LANES, lengths,
+               corrector->block_length[block], peq, (unsigned)m, distances);
+        for (int lane = 0; lane < BIP39_CORRECT_LANES; lane++) {
+            if (distances[lane] > max_distance) continue;
+            uint16_t index = (uint16_t)(block * BIP39_CORRECT_LANES + (size_t)lane);
+            const char *word = corrector->list->words[index];
+            uint8_t prefix = 0;
+            while (word[prefix] && word[prefix] == typed[prefix]) prefix++;
+            found[count++] = (bip39_candidate){index, distances[lane], prefix};
+        }
+    }
+
+    qsort(found, count, sizeof(found[0]), compare_candidates);
+    memcpy(out, found, (count < max_out ? count : max_out) * sizeof(found[0]));
+    return count;
+}
+
+/** @brief Depth-first walk over the candidate product of a phrase */
+typedef struct {
+    const bip39_candidate *const *candidates;  ///< Candidates per position.
+    const size_t *counts;                      ///< Candidates per position.
+    size_t count;                              ///< Words in the phrase.
+    uint16_t indices[24];                      ///< Current combination.
+    bip39_phrase_candidate *out;               ///< Best phrases so far, sorted.
+    size_t max_out;
+    size_t found;                              ///< Phrases kept in out.
+    uint64_t checked;                          ///< Combinations checksummed.
+} phrase_search;
+
+/**
+ * @brief Keeps a valid phrase if it is among the max_out lowest distances.
+ */
+static void keep_phrase(phrase_search *s, unsigned distance) {
+    size_t pos = s->found < s->max_out ? s->found : s->max_out;
+    while (pos > 0 && s->out[pos - 1].distance > distance) pos--;
+    if (pos >= s->max_out) return;
+    size_t last = s->found < s->max_out ? s->found : s->max_out - 1;
+    memmove(&s->out[pos + 1], &s->out[pos], (last - pos) * sizeof(s->out[0]));
+    memcpy(s->out[pos].indices, s->indices, sizeof(s->indices));
+    s->out[pos].distance = distance;
+    if (s->found < s->max_out) s->found++;
+}
+
+static void search_phrase(phrase_search *s, size_t position, unsigned distance) {
+    if (position == s->count) {
+        uint8_t entropy[32];
+        s->checked++;
+        if (bip39_indices_to_entropy(s->indices, s->count, entropy, NULL) == 0) {
+            keep_phrase(s, distance);
+            OPENSSL_cleanse(entropy, sizeof(entropy));
+        }
+        return;
+    }
+    for (size_t i = 0; i < s->counts[position]; i++) {
+        const bip39_candidate *c = &s->candidates[position][i];
+        s->indices[position] = c->index;
+        search_phrase(s, position + 1, distance + c->distance);
+    }
+}
+
+int bip39_correct_phrase(const bip39_corrector *corrector, const char *const *words,
+                         size_t count, unsigned max_distance,
+                         bip39_phrase_candidate *out, size_t max_out, uint64_t *checked) {
+    if (checked) *checked = 0;
+    if (!corrector || !words || !out || max_out == 0 ||
+        count < 12 || count > 24 || count % 3 != 0) {
+        return -1;
+    }
+
+    bip39_candidate *candidates[24] = {0};
+    size_t counts[24];
+    uint64_t combinations = 1;
+    int result = 0;
+    for (size_t i = 0; i < count && result == 0; i++) {
+        candidates[i] = malloc(BIP39_WORD_COUNT * sizeof(bip39_candidate));
+        if (!candidates[i]) {
+            result = -1;
+            break;
+        }
+        counts[i] = bip39_correct_word(corrector, words[i], max_distance,
+                                       candidates[i], BIP39_WORD_COUNT);
+        // An exact word is trusted; only misspelled positions branch
+        if (counts[i] > 0 && candidates[i][0].distance == 0) {
+            counts[i] = 1;
+        }
+        combinations *= counts[i] ? counts[i] : 1;
+        if (counts[i] == 0 || combinations > BIP39_CORRECT_MAX_COMBINATIONS) {
+            result = -1;
+        }
+    }
+
+    if (result == 0) {
+        phrase_search s = {(const bip39_candidate *const *)candidates, counts, count,
+                           {0}, out, max_out, 0, 0};
+        search_phrase(&s, 0, 0);
+        if (checked) *checked = s.checked;
+        result = (int)s.found;
+        OPENSSL_cleanse(s.indices, sizeof(s.indices));
+    }
+
+    for (size_t i = 0; i < count; i++) free(candidates[i]);
+    return result;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file correct.h
+ * @brief Typo correction for BIP-39 words and phrases.
+ * @details Edit distances from a typed word to every word of a list are
+ *          computed with Myers' bit-parallel algorithm, eight (AVX2) words
+ *          at a time over a column-major copy of the list. Phrase recovery
+ *          combines the per-position candidates and keeps only phrases with
+ *          a valid checksum.
+ */
+
+#ifndef BIP39_CORRECT_H
+#define BIP39_CORRECT_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint16_t, uint64_t
+
+#include "bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Words per column block (one AVX2 register of 32-bit lanes) */
+#define BIP39_CORRECT_LANES 8
+
+/** @brief Phrase combinations checked at most by bip39_correct_phrase() */
+#define BIP39_CORRECT_MAX_COMBINATIONS (1u << 22)
+
+/**
+ * @brief Word list packed for distance scans.
+ */
+typedef struct {
+    const bip39_wordlist *list;   ///< Source list (must outlive the corrector).
+    uint8_t *columns;             ///< Byte j of word b*8+l at [(b * MAX_WORD_SIZE + j) * 8 + l].
+    uint8_t lengths[BIP39_WORD_COUNT];                        ///< Byte length of each word.
+    uint8_t block_length[BIP39_WORD_COUNT / BIP39_CORRECT_LANES]; ///< Longest word per block.
+} bip39_corrector;
+
+/**
+ * @brief A candidate word for one typed word.
+ */
+typedef struct {
+    uint16_t index;     ///< Word index in the list.
+    uint8_t distance;   ///< Levenshtein distance (bytes) to the typed word.
+    uint8_t prefix;     ///< Length of the common prefix (tie-breaker).
+} bip39_candidate;
+
+/**
+ * @brief A corrected phrase with a valid checksum.
+ */
+typedef struct {
+    uint16_t indices[24];   ///< Word indices.
+    unsigned distance;      ///< Sum of the per-word distances.
+} bip39_phrase_candidate;
+
+/**
+ * @brief Packs a wordlist for correction.
+ * @param corrector Corrector to fill.
+ * @param list Loaded wordlist.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int bip39_corrector_init(bip39_corrector *corrector, const bip39_wordlist *list);
+
+/**
+ * @brief Frees a corrector.
+ * @param corrector Corrector to free (can be zero-initialized).
+ */
+void bip39_corrector_free(bip39_corrector *corrector);
+
+/**
+ * @brief Finds the words within max_distance edits of a typed word.
+ * @param corrector Packed list.
+ * @param typed Typed word (at most BIP39_MAX_WORD_SIZE bytes).
+ * @param max_distance Largest edit distance to return.
+ * @param out Output candidates, best first: lower distance, then longer
+ *            common prefix, then list order.
+ * @param max_out Capacity of out.
+ * @return Number of candidates found (may exceed max_out; only max_out are
+ *         written).
+ */
+size_t bip39_correct_word(const bip39_corrector *corrector, const char *typed,
+                          unsigned max_distance, bip39_candidate *out, size_t max_out);
+
+/**
+ * @brief Recovers phrases with a valid checksum from a typed phrase.
+ * @param corrector Packed list.
+ * @param words Typed words.
+ * @param count Number of words: 12, 15, 18, 21 or 24.
+ * @param max_distance Largest edit distance per word. A word typed exactly
+ *                     as a list word is kept as is.
+ * @param out Output phrases, lowest total distance first.
+ * @param max_out Capacity of out.
+ * @param checked Set to the number of combinations checked (can be NULL).
+ * @return Number of phrases written, or -1 if a word has no candidate or the
+ *         combinations exceed BIP39_CORRECT_MAX_COMBINATIONS.
+ */
+int bip39_correct_phrase(const bip39_corrector *corrector, const char *const *words,
+                         size_t count, unsigned max_distance,
+                         bip39_phrase_candidate *out, size_t max_out, uint64_t *checked);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_CORRECT_H
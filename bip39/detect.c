@@ -0,0 +1,221 @@
+/**
+ * @file detect.c
+ * @brief Wordlist language detection for BIP-39 phrases.
+ */
+#include "detect.h"
+
+#include <dirent.h>  // For opendir, readdir, closedir
+#include <stdio.h>   // For snprintf
+#include <stdlib.h>  // For calloc, free, qsort
+#include <string.h>  // For memset, memcpy, strcmp, strlen
+
+#include <openssl/crypto.h>
+
+/**
+ * @brief FNV-1a hash of a byte string.
+ */
+static uint64_t hash_word(const char *word, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)word[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/**
+ * @brief Finds the entry of a word.
+ * @return Entry, or NULL if no loaded list has the word.
+ */
+static const bip39_detect_entry *find_word(const bip39_detector *detector,
+                                           const char *word, size_t len) {
+    uint64_t h = hash_word(word, len);
+    for (size_t slot = h & detector->slot_mask;; slot = (slot + 1) & detector->slot_mask) {
+        uint32_t e = detector->slots[slot];
+        if (e == 0) return NULL;
+        const bip39_detect_entry *entry = &detector->entries[e - 1];
+        if (entry->hash == h && strncmp(entry->word, word, len) == 0 && entry->word[len] == '\0') {
+            return entry;
+        }
+    }
+}
+
+/**
+ * @brief Adds list l to the index.
+ * @return 0 on success, -1 if a word appears twice in the list.
+ */
+static int index_list(bip39_detector *detector, size_t l) {
+    for (uint16_t i = 0; i < BIP39_WORD_COUNT; i++) {
+        const char *word = detector->lists[l].words[i];
+        uint64_t h = hash_word(word, strlen(word));
+        size_t slot = h & detector->slot_mask;
+        while (detector->slots[slot]) {
+            bip39_detect_entry *entry = &detector->entries[detector->slots[slot] - 1];
+            if (entry->hash == h && strcmp(entry->word, word) == 0) break;
+            slot = (slot + 1) & detector->slot_mask;
+        }
+        if (!detector->slots[slot]) {
+            bip39_detect_entry *entry = &detector->entries[detector->entry_count++];
+            entry->word = word;
+            entry->hash = h;
+            detector->slots[slot] = (uint32_t)detector->entry_count;
+        }
+        bip39_detect_entry *entry = &detector->entries[detector->slots[slot] - 1];
+        if (entry->mask & (1u << l)) return -1;
+        entry->mask |= (uint16_t)(1u << l);
+        entry->indices[l] = i;
+    }
+    return 0;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+int bip39_detector_load(bip39_detector *detector, const char *dir) {
+    if (!detector || !dir) return -1;
+    memset(detector, 0, sizeof(*detector));
+
+    DIR *d = opendir(dir);
+    if (!d) return -1;
+    char *files[BIP39_DETECT_MAX_LANGUAGES * 4];
+    size_t file_count = 0;
+    struct dirent *ent;
+    while ((ent = readdir(d)) && file_count < sizeof(files) / sizeof(files[0])) {
+        size_t len = strlen(ent->d_name);
+        if (len <= 4 || len - 4 >= BIP39_DETECT_NAME_SIZE ||
+            strcmp(ent->d_name + len - 4, ".txt") != 0) {
+            continue;
+        }
+        files[file_count] = strdup(ent->d_name);
+        if (files[file_count]) file_count++;
+    }
+    closedir(d);
+    qsort(files, file_count, sizeof(files[0]), compare_names);
+
+    for (size_t f = 0; f < file_count; f++) {
+        char path[4096];
+        size_t l = detector->languages;
+        if (l < BIP39_DETECT_MAX_LANGUAGES &&
+            snprintf(path, sizeof(path), "%s/%s", dir, files[f]) < (int)sizeof(path) &&
+            bip39_wordlist_load(&detector->lists[l], path) == 0) {
+            size_t len = strlen(files[f]) - 4;
+            memcpy(detector->names[l], files[f], len);
+            detector->names[l][len] = '\0';
+            detector->languages++;
+        }
+        free(files[f]);
+    }
+    if (detector->languages == 0) return -1;
+
+    // Load factor at most 1/2 even if no word is shared
+    size_t words = detector->languages * BIP39_WORD_COUNT;
+    size_t slots = 1;
+    while (slots < 2 * words) slots <<= 1;
+    detector->entries = calloc(words, sizeof(bip39_detect_entry));
+    detector->slots = calloc(slots, sizeof(uint32_t));
+    detector->slot_mask = slots - 1;
+    if (!detector->entries || !detector->slots) {
+        bip39_detector_free(detector);
+        return -1;
+    }
+
+    for (size_t l = 0; l < detector->languages;) {
+        if (index_list(detector, l) == 0) {
+            l++;
+            continue;
+        }
+        // A list with duplicate words cannot be decoded; drop it and rebuild
+        bip39_wordlist_free(&detector->lists[l]);
+        memmove(&detector->lists[l], &detector->lists[l + 1],
+                (detector->languages - l - 1) * sizeof(detector->lists[0]));
+        memmove(detector->names[l], detector->names[l + 1],
+                (detector->languages - l - 1) * sizeof(detector->names[0]));
+        detector->languages--;
+        memset(detector->entries, 0, words * sizeof(bip39_detect_entry));
+        memset(detector->slots, 0, slots * sizeof(uint32_t));
+        detector->entry_count = 0;
+        l = 0;
+    }
+    if (detector->languages == 0) {
+        bip39_detector_free(detector);
+        return -1;
+    }
+    return (int)detector->languages;
+}
+
+void bip39_detector_free(bip39_detector *detector) {
+    if (!detector) return;
+    for (size_t l = 0; l < detector->languages; l++) {
+        bip39_wordlist_free(&detector->lists[l]);
+    }
+    free(detector->entries);
+    free(detector->slots);
+    memset(detector, 0, sizeof(*detector));
+}
+
+/**
+ * @brief Length of the separator at s (space, tab, newline or U+3000), or 0.
+ */
+static size_t separator_length(const char *s) {
+    if (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') return 1;
+    if ((uint8_t)s[0] == 0xe3 && (uint8_t)s[1] == 0x80 && (uint8_t)s[2] == 0x80) return 3;
+    return 0;
+}
+
+int bip39_detect(const bip39_detector *detector, const char *phrase, bip39_detection *result) {
+    if (!result) return BIP39_DETECT_INVALID;
+    memset(result, 0, sizeof(*result));
+    result->language = -1;
+    if (!detector || !detector->slots || !phrase) return BIP39_DETECT_INVALID;
+
+    // One pass: look each word up once and narrow the candidate lists
+    const bip39_detect_entry *entries[24];
+    uint16_t mask = (uint16_t)((1u << detector->languages) - 1);
+    size_t count = 0;
+    const char *p = phrase;
+    for (;;) {
+        size_t sep;
+        while ((sep = separator_length(p))) p += sep;
+        if (!*p) break;
+        const char *word = p;
+        while (*p && !separator_length(p)) p++;
+        if (count == 24) return BIP39_DETECT_INVALID;
+
+        const bip39_detect_entry *entry = find_word(detector, word, (size_t)(p - word));
+        if (!entry) {
+            result->bad_word = count;
+            return BIP39_DETECT_UNKNOWN_WORD;
+        }
+        if (mask && !(mask & entry->mask)) result->bad_word = count;
+        mask &= entry->mask;
+        entries[count++] = entry;
+    }
+    result->word_count = count;
+    result->candidates = mask;
+    if (count < 12 || count % 3 != 0) return BIP39_DETECT_INVALID;
+    if (!mask) return BIP39_DETECT_MIXED;
+
+    // Lists sharing every word are told apart by the checksum
+    int found = -1;
+    for (size_t l = 0; l < detector->languages; l++) {
+        if (!(mask & (1u << l))) continue;
+        uint16_t indices[24];
+        uint8_t entropy[32];
+        for (size_t i = 0; i < count; i++) indices[i] = entries[i]->indices[l];
+        if (bip39_indices_to_entropy(indices, count, entropy, NULL) == 0) {
+            OPENSSL_cleanse(entropy, sizeof(entropy));
+            if (found >= 0) {
+                OPENSSL_cleanse(indices, sizeof(indices));
+                OPENSSL_cleanse(result->indices, sizeof(result->indices));
+                return BIP39_DETECT_AMBIGUOUS;
+            }
+            found = (int)l;
+            memcpy(result->indices, indices, count * sizeof(indices[0]));
+        }
+        OPENSSL_cleanse(indices, sizeof(indices));
+    }
+    if (found < 0) return BIP39_DETECT_CHECKSUM;
+    result->language = found;
+    return BIP39_DETECT_OK;
+}
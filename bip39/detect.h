@@ -0,0 +1,102 @@
+/**
+ * @file detect.h
+ * @brief Wordlist language detection for BIP-39 phrases.
+ * @details Every word of every loaded list goes into one hash table whose
+ *          entries carry a language bitmask and the word's index in each
+ *          list. A phrase is classified in one pass by ANDing the masks of
+ *          its words; when several languages share all the words, the
+ *          checksum decides, and inputs that stay ambiguous are rejected.
+ */
+
+#ifndef BIP39_DETECT_H
+#define BIP39_DETECT_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint16_t, uint32_t, uint64_t
+
+#include "bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Most lists a detector can hold (bits of the language mask) */
+#define BIP39_DETECT_MAX_LANGUAGES 16
+
+/** @brief Longest language name kept (file name without .txt) */
+#define BIP39_DETECT_NAME_SIZE 64
+
+/** @brief Results of bip39_detect() */
+enum {
+    BIP39_DETECT_OK = 0,
+    BIP39_DETECT_INVALID = -1,        ///< Not 12, 15, 18, 21 or 24 words.
+    BIP39_DETECT_UNKNOWN_WORD = -2,   ///< A word is in no loaded list.
+    BIP39_DETECT_MIXED = -3,          ///< No single list holds every word.
+    BIP39_DETECT_AMBIGUOUS = -4,      ///< Several lists fit and pass the checksum.
+    BIP39_DETECT_CHECKSUM = -5        ///< No list holding every word passes the checksum.
+};
+
+/**
+ * @brief One distinct word across all lists.
+ */
+typedef struct {
+    const char *word;                                  ///< Word text (in one of the lists).
+    uint64_t hash;                                     ///< FNV-1a hash of the word.
+    uint16_t mask;                                     ///< Bit l set if list l has the word.
+    uint16_t indices[BIP39_DETECT_MAX_LANGUAGES];      ///< Index in list l (valid if bit l set).
+} bip39_detect_entry;
+
+/**
+ * @brief All loaded lists and their combined index.
+ */
+typedef struct {
+    size_t languages;                                              ///< Loaded lists.
+    char names[BIP39_DETECT_MAX_LANGUAGES][BIP39_DETECT_NAME_SIZE];///< List names ("english", ...).
+    bip39_wordlist lists[BIP39_DETECT_MAX_LANGUAGES];              ///< The lists.
+    bip39_detect_entry *entries;                                   ///< Distinct words.
+    size_t entry_count;                                            ///< Number of entries.
+    uint32_t *slots;                                               ///< Open addressing table, entry + 1 or 0.
+    size_t slot_mask;                                              ///< Table size - 1 (power of two).
+} bip39_detector;
+
+/**
+ * @brief Outcome of a detection.
+ */
+typedef struct {
+    int language;             ///< Detected list, or -1.
+    uint16_t candidates;      ///< Lists holding every word (before the checksum).
+    size_t word_count;        ///< Words in the phrase.
+    size_t bad_word;          ///< Position of the unknown word, or of the first word
+                              ///< that left no common list (MIXED).
+    uint16_t indices[24];     ///< Word indices in the detected list.
+} bip39_detection;
+
+/**
+ * @brief Loads every 2048-word *.txt list of a directory and indexes them.
+ * @param detector Detector to fill.
+ * @param dir Directory, e.g. "./wordlists"; lists are taken in name order.
+ * @return Number of lists loaded, or -1 if none could be loaded or on
+ *         allocation failure. Files that are not valid lists are skipped.
+ */
+int bip39_detector_load(bip39_detector *detector, const char *dir);
+
+/**
+ * @brief Frees a detector and its lists.
+ * @param detector Detector to free (can be zero-initialized).
+ */
+void bip39_detector_free(bip39_detector *detector);
+
+/**
+ * @brief Detects the list of a phrase and decodes it.
+ * @param detector Loaded detector.
+ * @param phrase Words separated by spaces, tabs or ideographic spaces (U+3000).
+ * @param result Detection details.
+ * @return BIP39_DETECT_OK or one of the negative BIP39_DETECT_* codes.
+ */
+int bip39_detect(const bip39_detector *detector, const char *phrase, bip39_detection *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_DETECT_H
@@ -0,0 +1,183 @@
+/**
+ * @file recover.c
+ * @brief Search space of a phrase recovery: missing words and passphrase characters.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "recover.h"
+
+#include <stdlib.h>  // For strtoul
+#include <string.h>  // For memcpy, strlen, strchr, strcmp, strtok_r
+
+#include <openssl/crypto.h>
+
+#include "../cpto/cpto.h"
+#include "../hdkey/hdkey.h"
+
+/**
+ * @brief Copies the next tab-separated field.
+ * @param text Cursor, moved past the field and its tab.
+ * @param out Output buffer.
+ * @param size Size of out.
+ * @return 0 on success, -1 if the field does not fit.
+ */
+static int next_field(const char **text, char *out, size_t size) {
+    const char *end = strchr(*text, '\t');
+    size_t len = end ? (size_t)(end - *text) : strlen(*text);
+    if (len >= size) return -1;
+    memcpy(out, *text, len);
+    out[len] = '\0';
+    *text = end ? end + 1 : *text + len;
+    return 0;
+}
+
+int bip39_recover_parse(bip39_recover_job *job, const bip39_wordlist *list,
+                        const char *text, size_t *bad_word) {
+    if (!job || !list || !text) return BIP39_RECOVER_ERROR_FORMAT;
+    memset(job, 0, sizeof(*job));
+    job->list = list;
+
+    char field[BIP39_MNEMONIC_MAX_SIZE];
+    char *end;
+    if (next_field(&text, field, sizeof(field)) != 0 || strlen(field) != 8) {
+        return BIP39_RECOVER_ERROR_FORMAT;
+    }
+    job->fingerprint = (uint32_t)strtoul(field, &end, 16);
+    if (*end != '\0') return BIP39_RECOVER_ERROR_FORMAT;
+
+    int result = BIP39_RECOVER_OK;
+    char *save = NULL;
+    if (next_field(&text, field, sizeof(field)) != 0) return BIP39_RECOVER_ERROR_FORMAT;
+    for (char *word = strtok_r(field, " ", &save); word && result == BIP39_RECOVER_OK;
+         word = strtok_r(NULL, " ", &save)) {
+        if (job->word_count == 24) {
+            result = BIP39_RECOVER_ERROR_FORMAT;
+            break;
+        }
+        size_t position = job->word_count++;
+        if (strcmp(word, "?") == 0) {
+            job->lost_words[job->lost_word_count++] = (uint8_t)position;
+            continue;
+        }
+        size_t i = 0;
+        while (i < BIP39_WORD_COUNT && strcmp(list->words[i], word) != 0) i++;
+        if (i == BIP39_WORD_COUNT) {
+            if (bad_word) *bad_word = position;
+            result = BIP39_RECOVER_ERROR_UNKNOWN_WORD;
+        }
+        job->indices[position] = (uint16_t)i;
+    }
+    OPENSSL_cleanse(field, sizeof(field));
+    if (result != BIP39_RECOVER_OK) return result;
+    if (job->word_count < 12 || job->word_count % 3 != 0) return BIP39_RECOVER_ERROR_FORMAT;
+
+    if (next_field(&text, job->passphrase, sizeof(job->passphrase)) != 0) {
+        return BIP39_RECOVER_ERROR_FORMAT;
+    }
+    for (size_t i = 0; job->passphrase[i] != '\0'; i++) {
+        if (job->passphrase[i] == '?') job->lost_chars[job->lost_char_count++] = (uint8_t)i;
+    }
+    if (next_field(&text, job->charset, sizeof(job->charset)) != 0 || *text != '\0') {
+        return BIP39_RECOVER_ERROR_FORMAT;
+    }
+    if (job->charset[0] == '\0') strcpy(job->charset, BIP39_RECOVER_DEFAULT_CHARSET);
+    job->charset_size = strlen(job->charset);
+
+    job->size = 1;
+    for (size_t i = 0; i < job->lost_word_count + job->lost_char_count; i++) {
+        uint64_t radix = i < job->lost_word_count ? BIP39_WORD_COUNT : job->charset_size;
+        if (job->size > BIP39_RECOVER_MAX_SIZE / radix) return BIP39_RECOVER_ERROR_TOO_LARGE;
+        job->size *= radix;
+    }
+    return BIP39_RECOVER_OK;
+}
+
+/**
+ * @brief Fills the lost words and characters of candidate `number`.
+ * @return 1 if the checksum is valid, 0 if not.
+ */
+static int fill_candidate(const bip39_recover_job *job, uint64_t number,
+                          uint16_t indices[24], char *passphrase) {
+    memcpy(indices, job->indices, sizeof(job->indices));
+    for (size_t i = 0; i < job->lost_word_count; i++) {
+        indices[job->lost_words[i]] = (uint16_t)(number % BIP39_WORD_COUNT);
+        number /= BIP39_WORD_COUNT;
+    }
+    memcpy(passphrase, job->passphrase, sizeof(job->passphrase));
+    for (size_t i = 0; i < job->lost_char_count; i++) {
+        passphrase[job->lost_chars[i]] = job->charset[number % job->charset_size];
+        number /= job->charset_size;
+    }
+    uint8_t entropy[32];
+    int valid = bip39_indices_to_entropy(indices, job->word_count, entropy, NULL) == 0;
+    OPENSSL_cleanse(entropy, sizeof(entropy));
+    return valid;
+}
+
+/** @brief Joins the words of a phrase with single spaces */
+static void join_words(const bip39_recover_job *job, const uint16_t indices[24], char *mnemonic) {
+    size_t len = 0;
+    for (size_t i = 0; i < job->word_count; i++) {
+        const char *word = job->list->words[indices[i]];
+        size_t word_len = strlen(word);
+        if (i) mnemonic[len++] = ' ';
+        memcpy(mnemonic + len, word, word_len);
+        len += word_len;
+    }
+    mnemonic[len] = '\0';
+}
+
+int bip39_recover_candidate(const bip39_recover_job *job, uint64_t number,
+                            char *mnemonic, char *passphrase) {
+    if (!job || !mnemonic || !passphrase || number >= job->size) return -1;
+    uint16_t indices[24];
+    int valid = fill_candidate(job, number, indices, passphrase);
+    join_words(job, indices, mnemonic);
+    OPENSSL_cleanse(indices, sizeof(indices));
+    return valid;
+}
+
+int bip39_recover_search(const bip39_recover_job *job, uint64_t first, uint64_t count,
+                         bip39_recover_match_fn match, void *ctx, uint64_t *derived) {
+    if (!job || first > job->size) return -1;
+    if (count > job->size - first) count = job->size - first;
+
+    uint16_t indices[24];
+    char mnemonic[BIP39_MNEMONIC_MAX_SIZE];
+    char passphrase[BIP39_RECOVER_MAX_PASSPHRASE + 1];
+    uint8_t salt[8 + BIP39_RECOVER_MAX_PASSPHRASE];
+    byte seed[BIP39_SEED_LENGTH];
+    byte private_key[PRIVATE_KEY_LENGTH];
+    byte chain_code[CHAIN_CODE_LENGTH];
+    byte public_key[PUBLIC_KEY_LENGTH];
+    int matches = 0;
+    memcpy(salt, "mnemonic", 8);
+
+    for (uint64_t number = first; number < first + count; number++) {
+        if (!fill_candidate(job, number, indices, passphrase)) continue;
+        join_words(job, indices, mnemonic);
+        size_t passphrase_len = strlen(passphrase);
+        memcpy(salt + 8, passphrase, passphrase_len);
+        pbkdf2_hmac_sha512((const uint8_t *)mnemonic, strlen(mnemonic), salt, 8 + passphrase_len,
+                           BIP39_PBKDF2_ROUNDS, seed, sizeof(seed));
+        if (derived) (*derived)++;
+        if (derive_bip32_master_key(seed, sizeof(seed), private_key, chain_code) != SUCCESS ||
+            private_key_to_public_key(private_key, public_key) != SUCCESS) {
+            matches = -1;
+            break;
+        }
+        if (public_key_fingerprint(public_key) == job->fingerprint) {
+            matches++;
+            if (match) match(ctx, number);
+        }
+    }
+
+    OPENSSL_cleanse(indices, sizeof(indices));
+    OPENSSL_cleanse(mnemonic, sizeof(mnemonic));
+    OPENSSL_cleanse(passphrase, sizeof(passphrase));
+    OPENSSL_cleanse(salt, sizeof(salt));
+    OPENSSL_cleanse(seed, sizeof(seed));
+    OPENSSL_cleanse(private_key, sizeof(private_key));
+    OPENSSL_cleanse(chain_code, sizeof(chain_code));
+    return matches;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file recover.h
+ * @brief Search space of a phrase recovery: missing words and passphrase characters.
+ * @details A recovery job is a phrase with "?" for each word that is lost,
+ *          a passphrase with "?" for each character that is lost, the
+ *          characters a lost passphrase character can be, and the master key
+ *          fingerprint of the wallet (as shown in descriptors and by
+ *          `bip32 unlock`).
+ *
+ *          Candidates are numbered 0 .. size-1, lost words first (2048 each,
+ *          first "?" least significant), then lost characters, so a range of
+ *          numbers is a self-contained share of the work. Candidates whose
+ *          checksum is invalid cost one SHA-256; the others one BIP-39 PBKDF2
+ *          and one master key derivation.
+ */
+
+#ifndef BIP39_RECOVER_H
+#define BIP39_RECOVER_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint16_t, uint32_t, uint64_t
+
+#include "bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Longest passphrase handled, in bytes */
+#define BIP39_RECOVER_MAX_PASSPHRASE 128
+
+/** @brief Longest passphrase character set */
+#define BIP39_RECOVER_MAX_CHARSET 128
+
+/** @brief Characters tried for a lost passphrase character when the job names none */
+#define BIP39_RECOVER_DEFAULT_CHARSET "abcdefghijklmnopqrstuvwxyz0123456789"
+
+/** @brief Most candidates in one job (the numbering stays below 2^63) */
+#define BIP39_RECOVER_MAX_SIZE ((uint64_t)1 << 62)
+
+/** @brief Error codes */
+enum {
+    BIP39_RECOVER_OK = 0,
+    BIP39_RECOVER_ERROR_FORMAT = -1,        ///< Malformed job or bad word count.
+    BIP39_RECOVER_ERROR_UNKNOWN_WORD = -2,  ///< A known word is not in the list.
+    BIP39_RECOVER_ERROR_TOO_LARGE = -3      ///< More than BIP39_RECOVER_MAX_SIZE candidates.
+};
+
+/**
+ * @brief A parsed recovery job.
+ */
+typedef struct {
+    const bip39_wordlist *list;                        ///< Wordlist (must outlive the job).
+    uint32_t fingerprint;                              ///< Master key fingerprint searched for.
+    uint16_t indices[24];                              ///< Word indices; lost words are filled per candidate.
+    size_t word_count;                                 ///< 12, 15, 18, 21 or 24.
+    uint8_t lost_words[24];                            ///< Positions of the lost words.
+    size_t lost_word_count;
+    char passphrase[BIP39_RECOVER_MAX_PASSPHRASE + 1]; ///< Passphrase; lost characters are filled per candidate.
+    uint8_t lost_chars[BIP39_RECOVER_MAX_PASSPHRASE];  ///< Positions of the lost characters.
+    size_t lost_char_count;
+    char charset[BIP39_RECOVER_MAX_CHARSET + 1];       ///< Characters a lost character can be.
+    size_t charset_size;
+    uint64_t size;                                     ///< Number of candidates.
+} bip39_recover_job;
+
+/**
+ * @brief Parses a job.
+ * @param job Job to fill.
+ * @param list Wordlist the phrase is in.
+ * @param text "<fingerprint hex>\t<phrase>[\t<passphrase>[\t<charset>]]".
+ * @param bad_word Set to the 0-based position of an unknown word (can be NULL).
+ * @return BIP39_RECOVER_OK or a negative error code.
+ */
+int bip39_recover_parse(bip39_recover_job *job, const bip39_wordlist *list,
+                        const char *text, size_t *bad_word);
+
+/**
+ * @brief Writes out one candidate.
+ * @param job Job.
+ * @param number Candidate number, below job->size.
+ * @param mnemonic Output phrase (BIP39_MNEMONIC_MAX_SIZE bytes).
+ * @param passphrase Output passphrase (BIP39_RECOVER_MAX_PASSPHRASE + 1 bytes).
+ * @return 1 if the phrase has a valid checksum, 0 if not, -1 on invalid input.
+ */
+int bip39_recover_candidate(const bip39_recover_job *job, uint64_t number,
+                            char *mnemonic, char *passphrase);
+
+/**
+ * @brief Called for every candidate whose master key has the job's fingerprint.
+ */
+typedef void (*bip39_recover_match_fn)(void *ctx, uint64_t number);
+
+/**
+ * @brief Tests a range of candidates.
+ * @param job Job.
+ * @param first First candidate number.
+ * @param count Number of candidates (clipped to job->size).
+ * @param match Called for each match, in increasing order (can be NULL).
+ * @param ctx Passed to match.
+ * @param derived Incremented by the number of seeds derived (can be NULL).
+ * @return Number of matches, or -1 on invalid input or a derivation failure.
+ * @note The fingerprint has 32 bits: over billions of candidates expect
+ *       false matches, and confirm each one against an address or xpub.
+ */
+int bip39_recover_search(const bip39_recover_job *job, uint64_t first, uint64_t count,
+                         bip39_recover_match_fn match, void *ctx, uint64_t *derived);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_RECOVER_H
@@ -0,0 +1,291 @@
+/**
+ * @file seedbatch.c
+ * @brief Micro-batching of BIP-39 seed derivations onto the SIMD lanes of PBKDF2.
+ */
+#include "seedbatch.h"
+
+#include <stdlib.h>    // For calloc, free
+#include <string.h>    // For memcpy, memset
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For sysconf
+
+#include <openssl/crypto.h>
+
+#include "../cpto/cpto.h"
+
+/** @brief Gap assumed before two requests have been seen: long enough never to wait */
+#define INITIAL_GAP_NS 1e9
+
+/** @brief Weight of the newest gap in the moving average */
+#define GAP_WEIGHT (1.0 / 8)
+
+/**
+ * @brief One queued request.
+ */
+struct bip39_seedbatch_request {
+    const char *mnemonic;
+    const char *passphrase;
+    uint8_t *seed;
+    uint64_t arrival_ns;
+    int done;
+    int result;
+    pthread_cond_t finished;         ///< Signalled once done is set.
+    bip39_seedbatch_request *next;
+};
+
+/**
+ * @brief Monotonic clock in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Histogram bucket of a latency: exact below 8 ns, then 8 per power of two.
+ */
+static size_t latency_bucket(uint64_t ns) {
+    if (ns < 8) return (size_t)ns;
+    unsigned msb = 63 - (unsigned)__builtin_clzll(ns);
+    size_t bucket = (size_t)(msb - 2) * 8 + (size_t)((ns >> (msb - 3)) & 7);
+    return bucket < BIP39_SEEDBATCH_BUCKETS ? bucket : BIP39_SEEDBATCH_BUCKETS - 1;
+}
+
+/**
+ * @brief Middle of the latencies a bucket holds, in nanoseconds.
+ */
+static double bucket_value(size_t bucket) {
+    if (bucket < 8) return (double)bucket;
+    unsigned msb = (unsigned)(bucket / 8) + 2;
+    double width = (double)((uint64_t)1 << (msb - 3));
+    return (double)(8 + bucket % 8) * width + width / 2;
+}
+
+/**
+ * @brief Latency below which a fraction `q` of the requests finished, in microseconds.
+ */
+static double latency_percentile(const bip39_seedbatch *batch, double q) {
+    if (batch->requests == 0) return 0;
+    uint64_t target = (uint64_t)(q * (double)batch->requests);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BIP39_SEEDBATCH_BUCKETS; i++) {
+        seen += batch->latency[i];
+        if (seen >= target) return bucket_value(i) / 1000;
+    }
+    return bucket_value(BIP39_SEEDBATCH_BUCKETS - 1) / 1000;
+}
+
+/**
+ * @brief Gap between arrivals to plan with: the average, or longer if the
+ *        queue has been quiet for longer than that.
+ */
+static double arrival_gap(const bip39_seedbatch *batch, uint64_t now) {
+    double quiet = (double)(now - batch->last_arrival_ns);
+    return quiet > batch->gap_ns ? quiet : batch->gap_ns;
+}
+
+/**
+ * @brief How long the oldest waiting request may wait for the batch to fill.
+ * @note Zero when not even one more request is expected within the cap.
+ */
+static double current_window(bip39_seedbatch *batch, uint64_t now) {
+    double gap = arrival_gap(batch, now);
+    double window = 0;
+    if (gap < (double)batch->max_window_ns) {
+        window = (double)(batch->lanes - batch->pending) * gap;
+        if (window > (double)batch->max_window_ns) window = (double)batch->max_window_ns;
+    }
+    batch->window_ns = window;
+    return window;
+}
+
+/**
+ * @brief Derives the seeds of up to `lanes` requests in one multi-lane call.
+ */
+static int derive_batch(bip39_seedbatch_request **requests, size_t count) {
+    const char *mnemonics[BIP39_SEEDBATCH_MAX_LANES];
+    const char *passphrases[BIP39_SEEDBATCH_MAX_LANES];
+    uint8_t seeds[BIP39_SEEDBATCH_MAX_LANES][BIP39_SEED_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        mnemonics[i] = requests[i]->mnemonic;
+        passphrases[i] = requests[i]->passphrase;
+    }
+    int result = bip39_mnemonics_to_seeds(mnemonics, passphrases, count, seeds);
+    if (result == 0) {
+        for (size_t i = 0; i < count; i++) memcpy(requests[i]->seed, seeds[i], BIP39_SEED_SIZE);
+    }
+    OPENSSL_cleanse(seeds, sizeof(seeds));
+    return result;
+}
+
+/**
+ * @brief Worker: dispatches a batch once it is full or its window has passed.
+ */
+static void *worker_main(void *arg) {
+    bip39_seedbatch *batch = arg;
+    pthread_mutex_lock(&batch->lock);
+    for (;;) {
+        if (batch->pending == 0) {
+            if (batch->stopping) break;
+            pthread_cond_wait(&batch->arrived, &batch->lock);
+            continue;
+        }
+        if (batch->pending < batch->lanes && !batch->stopping) {
+            uint64_t now = now_ns();
+            uint64_t deadline = batch->head->arrival_ns + (uint64_t)current_window(batch, now);
+            if (now < deadline) {
+                struct timespec until = {(time_t)(deadline / 1000000000), (long)(deadline % 1000000000)};
+                pthread_cond_timedwait(&batch->arrived, &batch->lock, &until);
+                continue;
+            }
+        }
+
+        bip39_seedbatch_request *requests[BIP39_SEEDBATCH_MAX_LANES];
+        size_t count = 0;
+        while (batch->head && count < batch->lanes) {
+            requests[count++] = batch->head;
+            batch->head = batch->head->next;
+        }
+        if (!batch->head) batch->tail = NULL;
+        batch->pending -= (uint32_t)count;
+        if (batch->pending > 0) pthread_cond_signal(&batch->arrived);
+        pthread_mutex_unlock(&batch->lock);
+
+        int result = derive_batch(requests, count);
+
+        pthread_mutex_lock(&batch->lock);
+        uint64_t now = now_ns();
+        batch->batches++;
+        if (count == batch->lanes) batch->full_batches++;
+        for (size_t i = 0; i < count; i++) {
+            batch->latency[latency_bucket(now - requests[i]->arrival_ns)]++;
+            batch->requests++;
+            requests[i]->result = result;
+            requests[i]->done = 1;
+            pthread_cond_signal(&requests[i]->finished);
+        }
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return NULL;
+}
+
+/**
+ * @brief Stops and joins the first `count` workers.
+ */
+static void stop_workers(bip39_seedbatch *batch, uint32_t count) {
+    pthread_mutex_lock(&batch->lock);
+    batch->stopping = 1;
+    pthread_cond_broadcast(&batch->arrived);
+    pthread_mutex_unlock(&batch->lock);
+    for (uint32_t i = 0; i < count; i++) pthread_join(batch->threads[i], NULL);
+}
+
+// ============ API ============
+
+int bip39_seedbatch_init(bip39_seedbatch *batch, const bip39_seedbatch_config *config) {
+    if (!batch) return -1;
+    bip39_seedbatch_config settings = {BIP39_SEEDBATCH_MAX_LANES, 200, 0};
+    if (config) settings = *config;
+    if (settings.lanes == 0) settings.lanes = BIP39_SEEDBATCH_MAX_LANES;
+    if (settings.lanes > BIP39_SEEDBATCH_MAX_LANES || settings.lanes > SHA512_LANES) return -1;
+    if (settings.workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        settings.workers = online > 0 ? (uint32_t)online : 1;
+    }
+    if (settings.workers > BIP39_SEEDBATCH_MAX_WORKERS) settings.workers = BIP39_SEEDBATCH_MAX_WORKERS;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->lanes = settings.lanes;
+    batch->max_window_ns = (uint64_t)settings.max_window_us * 1000;
+    batch->gap_ns = INITIAL_GAP_NS;
+    batch->started_ns = batch->last_arrival_ns = now_ns();
+    batch->threads = calloc(settings.workers, sizeof(*batch->threads));
+    if (!batch->threads) return -1;
+
+    // Window deadlines are on the monotonic clock
+    pthread_condattr_t attr;
+    int ready = pthread_condattr_init(&attr) == 0;
+    if (ready) {
+        ready = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+                pthread_cond_init(&batch->arrived, &attr) == 0;
+        pthread_condattr_destroy(&attr);
+    }
+    if (!ready || pthread_mutex_init(&batch->lock, NULL) != 0) {
+        if (ready) pthread_cond_destroy(&batch->arrived);
+        free(batch->threads);
+        memset(batch, 0, sizeof(*batch));
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < settings.workers; i++) {
+        if (pthread_create(&batch->threads[i], NULL, worker_main, batch) != 0) {
+            stop_workers(batch, i);
+            pthread_cond_destroy(&batch->arrived);
+            pthread_mutex_destroy(&batch->lock);
+            free(batch->threads);
+            memset(batch, 0, sizeof(*batch));
+            return -1;
+        }
+        batch->thread_count++;
+    }
+    return 0;
+}
+
+void bip39_seedbatch_free(bip39_seedbatch *batch) {
+    if (!batch || !batch->threads) return;
+    stop_workers(batch, batch->thread_count);
+    pthread_cond_destroy(&batch->arrived);
+    pthread_mutex_destroy(&batch->lock);
+    free(batch->threads);
+    memset(batch, 0, sizeof(*batch));
+}
+
+int bip39_seedbatch_mnemonic_to_seed(bip39_seedbatch *batch, const char *mnemonic,
+                                     const char *passphrase, uint8_t seed[BIP39_SEED_SIZE]) {
+    if (!batch || !batch->threads || !mnemonic || !seed) return -1;
+    bip39_seedbatch_request request = {0};
+    request.mnemonic = mnemonic;
+    request.passphrase = passphrase;
+    request.seed = seed;
+    if (pthread_cond_init(&request.finished, NULL) != 0) return -1;
+
+    pthread_mutex_lock(&batch->lock);
+    uint64_t now = now_ns();
+    double gap = (double)(now - batch->last_arrival_ns);
+    if (gap > INITIAL_GAP_NS) gap = INITIAL_GAP_NS;
+    batch->gap_ns += (gap - batch->gap_ns) * GAP_WEIGHT;
+    batch->last_arrival_ns = now;
+    request.arrival_ns = now;
+    if (batch->tail) batch->tail->next = &request;
+    else batch->head = &request;
+    batch->tail = &request;
+    batch->pending++;
+    pthread_cond_signal(&batch->arrived);
+    while (!request.done) pthread_cond_wait(&request.finished, &batch->lock);
+    pthread_mutex_unlock(&batch->lock);
+
+    pthread_cond_destroy(&request.finished);
+    return request.result;
+}
+
+void bip39_seedbatch_get_stats(bip39_seedbatch *batch, bip39_seedbatch_stats *stats) {
+    if (!batch || !stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!batch->threads) return;
+    pthread_mutex_lock(&batch->lock);
+    uint64_t now = now_ns();
+    stats->requests = batch->requests;
+    stats->batches = batch->batches;
+    stats->full_batches = batch->full_batches;
+    stats->mean_fill = batch->batches ? (double)batch->requests / (double)batch->batches : 0;
+    stats->window_us = batch->window_ns / 1000;
+    stats->arrival_rate = 1e9 / arrival_gap(batch, now);
+    stats->p50_us = latency_percentile(batch, 0.50);
+    stats->p99_us = latency_percentile(batch, 0.99);
+    if (now > batch->started_ns) {
+        stats->throughput = (double)batch->requests * 1e9 / (double)(now - batch->started_ns);
+    }
+    pthread_mutex_unlock(&batch->lock);
+}
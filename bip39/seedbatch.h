@@ -0,0 +1,136 @@
+/**
+ * @file seedbatch.h
+ * @brief Micro-batching of BIP-39 seed derivations onto the SIMD lanes of PBKDF2.
+ * @details bip39_mnemonics_to_seeds() derives up to 8 seeds for little more
+ *          than the price of one, but callers of a service ask for one seed
+ *          at a time. A batcher queues single requests and lets worker
+ *          threads dispatch them together: a batch leaves as soon as `lanes`
+ *          requests are waiting, or when the oldest one has waited the
+ *          current window.
+ *
+ *          The window adapts to the arrival rate, tracked as a moving average
+ *          of the gap between requests. It is the time the missing lanes are
+ *          expected to take to arrive, capped by `max_window_us`; when not
+ *          even one more request is expected within the cap, requests go out
+ *          at once. Under light load a request therefore pays no wait, and
+ *          under heavy load batches fill without waiting either: the window
+ *          only matters in between, where it trades up to `max_window_us` of
+ *          latency for fuller batches.
+ *
+ *          Latencies (queueing, waiting and derivation) go into a log-scale
+ *          histogram, so the p50 and p99 of a configuration can be read next
+ *          to its throughput and batch fill.
+ */
+
+#ifndef BIP39_SEEDBATCH_H
+#define BIP39_SEEDBATCH_H
+
+#include <stddef.h>   // For size_t
+#include <stdint.h>   // For uint8_t, uint32_t, uint64_t
+#include <pthread.h>  // For pthread_mutex_t, pthread_cond_t, pthread_t
+
+#include "bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Most requests in one batch (the lanes of the multi-buffer SHA-512) */
+#define BIP39_SEEDBATCH_MAX_LANES 8
+
+/** @brief Most worker threads */
+#define BIP39_SEEDBATCH_MAX_WORKERS 256
+
+/** @brief Latency histogram buckets: 8 per power of two, up to 2^40 ns */
+#define BIP39_SEEDBATCH_BUCKETS (41 * 8)
+
+/**
+ * @brief Batcher settings.
+ */
+typedef struct {
+    uint32_t lanes;          ///< Requests per batch, 1 to BIP39_SEEDBATCH_MAX_LANES (0 for the most).
+    uint32_t max_window_us;  ///< Longest a request waits for others, e.g. 200 (0 never waits).
+    uint32_t workers;        ///< Threads running batches (0 for the CPU count).
+} bip39_seedbatch_config;
+
+/**
+ * @brief Batcher counters.
+ */
+typedef struct {
+    uint64_t requests;       ///< Seeds derived.
+    uint64_t batches;        ///< Batches dispatched.
+    uint64_t full_batches;   ///< Batches that filled every lane.
+    double mean_fill;        ///< Average requests per batch.
+    double window_us;        ///< Window currently applied.
+    double arrival_rate;     ///< Requests per second, moving average.
+    double p50_us;           ///< Median latency.
+    double p99_us;           ///< 99th percentile latency.
+    double throughput;       ///< Seeds per second since the batcher started.
+} bip39_seedbatch_stats;
+
+/** @brief A queued request; lives on the caller's stack */
+typedef struct bip39_seedbatch_request bip39_seedbatch_request;
+
+/**
+ * @brief Batcher; fields are private.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t arrived;              ///< Signalled on each request and on shutdown.
+    pthread_t *threads;
+    uint32_t thread_count;
+    uint32_t lanes;
+    uint64_t max_window_ns;
+    bip39_seedbatch_request *head;       ///< Oldest waiting request.
+    bip39_seedbatch_request *tail;
+    uint32_t pending;
+    int stopping;
+    uint64_t started_ns;
+    uint64_t last_arrival_ns;
+    double gap_ns;                       ///< Moving average of the gap between arrivals.
+    double window_ns;                    ///< Last window applied.
+    uint64_t requests;
+    uint64_t batches;
+    uint64_t full_batches;
+    uint64_t latency[BIP39_SEEDBATCH_BUCKETS];
+} bip39_seedbatch;
+
+/**
+ * @brief Creates a batcher and starts its workers.
+ * @param batch Batcher to initialize.
+ * @param config Settings (NULL for 8 lanes, a 200 µs cap and one worker per CPU).
+ * @return 0 on success, -1 on invalid settings or if the threads cannot start.
+ */
+int bip39_seedbatch_init(bip39_seedbatch *batch, const bip39_seedbatch_config *config);
+
+/**
+ * @brief Derives the requests still queued, stops the workers and frees the batcher.
+ * @param batch Batcher (can be zero-initialized).
+ * @note No request may be submitted once this is called.
+ */
+void bip39_seedbatch_free(bip39_seedbatch *batch);
+
+/**
+ * @brief bip39_mnemonic_to_seed() through the batcher; safe to call from many threads.
+ * @param batch Batcher.
+ * @param mnemonic Space separated mnemonic phrase (NFKD normalized).
+ * @param passphrase Optional passphrase (can be NULL).
+ * @param seed Output buffer for the seed.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ * @note Blocks until the batch holding the request has been derived.
+ */
+int bip39_seedbatch_mnemonic_to_seed(bip39_seedbatch *batch, const char *mnemonic,
+                                     const char *passphrase, uint8_t seed[BIP39_SEED_SIZE]);
+
+/**
+ * @brief Returns the counters and latency percentiles.
+ * @param batch Batcher.
+ * @param stats Output.
+ */
+void bip39_seedbatch_get_stats(bip39_seedbatch *batch, bip39_seedbatch_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_SEEDBATCH_H
@@ -0,0 +1,289 @@
+/**
+ * @file seedcache.c
+ * @brief Bounded, encrypted in-memory cache of BIP-39 seeds.
+ */
+#include "seedcache.h"
+
+#include <stdlib.h>    // For calloc, free, malloc
+#include <string.h>    // For memcmp, memcpy, memset, strlen
+#include <time.h>      // For clock_gettime
+#include <sys/mman.h>  // For mmap, mlock, madvise
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include "../cpto/cpto.h"
+
+/** @brief Size of each of the two cache keys */
+#define KEY_SIZE 32
+
+/** @brief Size of the page holding the keys */
+#define KEY_PAGE_SIZE 4096
+
+/**
+ * @brief Monotonic clock in milliseconds.
+ */
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Keyed hash of phrase and passphrase; a NUL separates the two.
+ */
+static int lookup_tag(const bip39_seedcache *cache, const char *mnemonic, const char *passphrase,
+                      uint8_t tag[BIP39_SEEDCACHE_TAG_SIZE]) {
+    size_t mnemonic_len = strlen(mnemonic);
+    size_t passphrase_len = passphrase ? strlen(passphrase) : 0;
+    size_t len = mnemonic_len + 1 + passphrase_len;
+    uint8_t *message = malloc(len);
+    if (!message) return -1;
+    memcpy(message, mnemonic, mnemonic_len);
+    message[mnemonic_len] = 0;
+    if (passphrase_len) memcpy(message + mnemonic_len + 1, passphrase, passphrase_len);
+    hmac_sha256(cache->keys, KEY_SIZE, message, len, tag);
+    OPENSSL_cleanse(message, len);
+    free(message);
+    return 0;
+}
+
+/**
+ * @brief Encrypts or decrypts the seed of an entry, bound to its tag.
+ * @return 0 on success, -1 on failure (or a bad Poly1305 tag when decrypting).
+ */
+static int crypt_entry(const bip39_seedcache *cache, bip39_seedcache_entry *entry,
+                       const uint8_t *in, uint8_t *out, int encrypt) {
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len = 0, tail = 0;
+    int ok = ctx &&
+             EVP_CipherInit_ex(ctx, EVP_chacha20_poly1305(), NULL, cache->keys + KEY_SIZE,
+                               entry->nonce, encrypt) == 1 &&
+             EVP_CipherUpdate(ctx, NULL, &len, entry->tag, sizeof(entry->tag)) == 1 &&
+             EVP_CipherUpdate(ctx, out, &len, in, BIP39_SEED_SIZE) == 1;
+    if (ok && !encrypt) {
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, sizeof(entry->mac), entry->mac) == 1;
+    }
+    ok = ok && EVP_CipherFinal_ex(ctx, out + len, &tail) == 1;
+    if (ok && encrypt) {
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, sizeof(entry->mac), entry->mac) == 1;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ok ? 0 : -1;
+}
+
+// ============ TABLE AND LRU LIST ============
+
+static uint32_t tag_hash(const uint8_t *tag) {
+    uint32_t h;
+    memcpy(&h, tag, sizeof(h));  // The tag is an HMAC: any 4 bytes are uniform
+    return h;
+}
+
+/**
+ * @brief Finds the table slot of a tag.
+ * @return Slot index; the slot is empty if the tag is absent.
+ */
+static uint32_t find_slot(const bip39_seedcache *cache, const uint8_t *tag) {
+    uint32_t slot = tag_hash(tag) & cache->slot_mask;
+    while (cache->slots[slot] != 0 &&
+           memcmp(cache->entries[cache->slots[slot] - 1].tag, tag, BIP39_SEEDCACHE_TAG_SIZE) != 0) {
+        slot = (slot + 1) & cache->slot_mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Empties a slot, shifting back later entries of its probe run.
+ */
+static void clear_slot(bip39_seedcache *cache, uint32_t slot) {
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & cache->slot_mask; cache->slots[next] != 0;
+         next = (next + 1) & cache->slot_mask) {
+        uint32_t home = tag_hash(cache->entries[cache->slots[next] - 1].tag) & cache->slot_mask;
+        // Move the entry into the hole unless its home lies cyclically in (hole, next]
+        if (((next - home) & cache->slot_mask) >= ((next - hole) & cache->slot_mask)) {
+            cache->slots[hole] = cache->slots[next];
+            hole = next;
+        }
+    }
+    cache->slots[hole] = 0;
+}
+
+static void lru_unlink(bip39_seedcache *cache, uint32_t i) {
+    bip39_seedcache_entry *e = &cache->entries[i];
+    if (e->prev != cache->capacity) cache->entries[e->prev].next = e->next;
+    else cache->head = e->next;
+    if (e->next != cache->capacity) cache->entries[e->next].prev = e->prev;
+    else cache->tail = e->prev;
+}
+
+static void lru_push_front(bip39_seedcache *cache, uint32_t i) {
+    bip39_seedcache_entry *e = &cache->entries[i];
+    e->prev = cache->capacity;
+    e->next = cache->head;
+    if (cache->head != cache->capacity) cache->entries[cache->head].prev = i;
+    else cache->tail = i;
+    cache->head = i;
+}
+
+/**
+ * @brief Removes and wipes entry i; the last entry moves into its place.
+ */
+static void remove_entry(bip39_seedcache *cache, uint32_t i) {
+    clear_slot(cache, find_slot(cache, cache->entries[i].tag));
+    lru_unlink(cache, i);
+
+    uint32_t last = cache->count - 1;
+    if (i != last) {
+        bip39_seedcache_entry *moved = &cache->entries[last];
+        cache->slots[find_slot(cache, moved->tag)] = i + 1;
+        if (moved->prev != cache->capacity) cache->entries[moved->prev].next = i;
+        else cache->head = i;
+        if (moved->next != cache->capacity) cache->entries[moved->next].prev = i;
+        else cache->tail = i;
+        memcpy(&cache->entries[i], moved, sizeof(*moved));
+    }
+    OPENSSL_cleanse(&cache->entries[last], sizeof(cache->entries[last]));
+    cache->count--;
+}
+
+// ============ API ============
+
+int bip39_seedcache_init(bip39_seedcache *cache, uint32_t capacity, uint32_t ttl_seconds) {
+    if (!cache || capacity == 0 || capacity > BIP39_SEEDCACHE_MAX_CAPACITY) return -1;
+    memset(cache, 0, sizeof(*cache));
+
+    // Keys in their own page: locked so they are never swapped, and left out of core dumps
+    void *page = mmap(NULL, KEY_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED) return -1;
+    (void)mlock(page, KEY_PAGE_SIZE);
+#ifdef MADV_DONTDUMP
+    (void)madvise(page, KEY_PAGE_SIZE, MADV_DONTDUMP);
+#endif
+    cache->keys = page;
+
+    uint32_t slots = 1;
+    while (slots < 2 * capacity) slots <<= 1;
+    cache->entries = calloc(capacity, sizeof(*cache->entries));
+    cache->slots = calloc(slots, sizeof(*cache->slots));
+    if (!cache->entries || !cache->slots || RAND_bytes(cache->keys, 2 * KEY_SIZE) != 1 ||
+        pthread_mutex_init(&cache->lock, NULL) != 0) {
+        free(cache->entries);
+        free(cache->slots);
+        OPENSSL_cleanse(page, KEY_PAGE_SIZE);
+        munlock(page, KEY_PAGE_SIZE);
+        munmap(page, KEY_PAGE_SIZE);
+        memset(cache, 0, sizeof(*cache));
+        return -1;
+    }
+    cache->slot_mask = slots - 1;
+    cache->capacity = capacity;
+    cache->head = cache->tail = capacity;
+    cache->ttl_ms = (uint64_t)ttl_seconds * 1000;
+    return 0;
+}
+
+void bip39_seedcache_free(bip39_seedcache *cache) {
+    if (!cache || !cache->keys) return;
+    OPENSSL_cleanse(cache->entries, (size_t)cache->capacity * sizeof(*cache->entries));
+    OPENSSL_cleanse(cache->keys, KEY_PAGE_SIZE);
+    munlock(cache->keys, KEY_PAGE_SIZE);
+    munmap(cache->keys, KEY_PAGE_SIZE);
+    free(cache->entries);
+    free(cache->slots);
+    pthread_mutex_destroy(&cache->lock);
+    memset(cache, 0, sizeof(*cache));
+}
+
+int bip39_seedcache_mnemonic_to_seed(bip39_seedcache *cache, const char *mnemonic,
+                                     const char *passphrase, uint8_t seed[BIP39_SEED_SIZE],
+                                     int *hit) {
+    if (hit) *hit = 0;
+    if (!cache || !cache->keys || !mnemonic || !seed) return -1;
+    uint8_t tag[BIP39_SEEDCACHE_TAG_SIZE];
+    if (lookup_tag(cache, mnemonic, passphrase, tag) != 0) return -1;
+
+    pthread_mutex_lock(&cache->lock);
+    uint32_t slot = find_slot(cache, tag);
+    if (cache->slots[slot] != 0) {
+        uint32_t i = cache->slots[slot] - 1;
+        bip39_seedcache_entry *entry = &cache->entries[i];
+        if (entry->expires <= now_ms()) {
+            remove_entry(cache, i);
+            cache->stats.expirations++;
+        } else if (crypt_entry(cache, entry, entry->sealed, seed, 0) == 0) {
+            lru_unlink(cache, i);
+            lru_push_front(cache, i);
+            cache->stats.hits++;
+            pthread_mutex_unlock(&cache->lock);
+            OPENSSL_cleanse(tag, sizeof(tag));
+            if (hit) *hit = 1;
+            return 0;
+        } else {
+            remove_entry(cache, i);  // Corrupted in memory: derive again
+        }
+    }
+    cache->stats.misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    // The expensive part runs unlocked
+    if (bip39_mnemonic_to_seed(mnemonic, passphrase, seed) != 0) {
+        OPENSSL_cleanse(tag, sizeof(tag));
+        return -1;
+    }
+    uint64_t derived = now_ms();
+
+    pthread_mutex_lock(&cache->lock);
+    slot = find_slot(cache, tag);
+    if (cache->slots[slot] != 0) {
+        remove_entry(cache, cache->slots[slot] - 1);  // Another thread inserted it meanwhile
+    }
+    if (cache->count == cache->capacity) {
+        remove_entry(cache, cache->tail);
+        cache->stats.evictions++;
+    }
+    uint32_t i = cache->count;
+    bip39_seedcache_entry *entry = &cache->entries[i];
+    memcpy(entry->tag, tag, sizeof(tag));
+    // 64-bit counter nonce: never reused under one key
+    memset(entry->nonce, 0, sizeof(entry->nonce));
+    uint64_t counter = ++cache->nonce_counter;
+    memcpy(entry->nonce + 4, &counter, sizeof(counter));
+    entry->expires = derived + cache->ttl_ms;
+    if (crypt_entry(cache, entry, seed, entry->sealed, 1) == 0) {
+        cache->count++;
+        cache->slots[find_slot(cache, tag)] = i + 1;
+        lru_push_front(cache, i);
+    } else {
+        OPENSSL_cleanse(entry, sizeof(*entry));  // Not cached; the seed is still returned
+    }
+    pthread_mutex_unlock(&cache->lock);
+    OPENSSL_cleanse(tag, sizeof(tag));
+    return 0;
+}
+
+size_t bip39_seedcache_purge(bip39_seedcache *cache) {
+    if (!cache || !cache->keys) return 0;
+    pthread_mutex_lock(&cache->lock);
+    uint64_t now = now_ms();
+    size_t dropped = 0;
+    for (uint32_t i = cache->count; i-- > 0;) {
+        // Walking down, the entry moved into slot i by a removal was already checked
+        if (cache->entries[i].expires <= now) {
+            remove_entry(cache, i);
+            dropped++;
+        }
+    }
+    cache->stats.expirations += dropped;
+    pthread_mutex_unlock(&cache->lock);
+    return dropped;
+}
+
+void bip39_seedcache_get_stats(bip39_seedcache *cache, bip39_seedcache_stats *stats) {
+    if (!cache || !stats) return;
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file seedcache.h
+ * @brief Bounded, encrypted in-memory cache of BIP-39 seeds.
+ * @details For long-running processes that see the same mnemonic and
+ *          passphrase again (wallet unlocks, re-derivations): a hit costs a
+ *          keyed hash and one AEAD decryption instead of 2048 rounds of
+ *          PBKDF2-HMAC-SHA512.
+ *
+ *          Entries are looked up by HMAC-SHA256 of the phrase and passphrase
+ *          under a random per-cache key, so neither is kept. Seeds are held
+ *          sealed with ChaCha20-Poly1305 under a second random key, with the
+ *          lookup tag as associated data. Both keys live in one locked page
+ *          left out of core dumps. An entry expires a fixed time after it was
+ *          derived; the least recently used entry makes room when the cache
+ *          is full. Evicted and expired entries are wiped.
+ */
+
+#ifndef BIP39_SEEDCACHE_H
+#define BIP39_SEEDCACHE_H
+
+#include <stddef.h>   // For size_t
+#include <stdint.h>   // For uint8_t, uint32_t, uint64_t
+#include <pthread.h>  // For pthread_mutex_t
+
+#include "bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Lookup tag size (HMAC-SHA256) */
+#define BIP39_SEEDCACHE_TAG_SIZE 32
+
+/** @brief Most entries a cache can hold */
+#define BIP39_SEEDCACHE_MAX_CAPACITY (1u << 20)
+
+/**
+ * @brief One cached seed, sealed.
+ */
+typedef struct {
+    uint8_t tag[BIP39_SEEDCACHE_TAG_SIZE];     ///< Keyed hash of phrase and passphrase.
+    uint8_t nonce[12];                         ///< Unique per insertion.
+    uint8_t sealed[BIP39_SEED_SIZE];           ///< Encrypted seed.
+    uint8_t mac[16];                           ///< Poly1305 tag.
+    uint64_t expires;                          ///< Monotonic time in ms.
+    uint32_t prev;                             ///< More recently used entry, or capacity.
+    uint32_t next;                             ///< Less recently used entry, or capacity.
+} bip39_seedcache_entry;
+
+/**
+ * @brief Cache counters.
+ */
+typedef struct {
+    uint64_t hits;          ///< Seeds served from the cache.
+    uint64_t misses;        ///< Seeds derived with PBKDF2.
+    uint64_t evictions;     ///< Entries dropped to make room.
+    uint64_t expirations;   ///< Entries dropped because their TTL ran out.
+} bip39_seedcache_stats;
+
+/**
+ * @brief Seed cache; fields are private.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    uint8_t *keys;                   ///< Locked page: MAC key, then encryption key.
+    bip39_seedcache_entry *entries;  ///< capacity entries.
+    uint32_t *slots;                 ///< Open-addressing table of entry + 1, 0 when empty.
+    uint32_t slot_mask;
+    uint32_t capacity;
+    uint32_t count;                  ///< Entries in use (the first `count` of `entries`).
+    uint32_t head;                   ///< Most recently used, or capacity.
+    uint32_t tail;                   ///< Least recently used, or capacity.
+    uint64_t ttl_ms;
+    uint64_t nonce_counter;          ///< Source of unique nonces.
+    bip39_seedcache_stats stats;
+} bip39_seedcache;
+
+/**
+ * @brief Creates a cache.
+ * @param cache Cache to initialize.
+ * @param capacity Most entries held (1 to BIP39_SEEDCACHE_MAX_CAPACITY).
+ * @param ttl_seconds Lifetime of an entry, counted from its derivation.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int bip39_seedcache_init(bip39_seedcache *cache, uint32_t capacity, uint32_t ttl_seconds);
+
+/**
+ * @brief Wipes every entry and the keys, and frees the cache.
+ * @param cache Cache (can be zero-initialized).
+ */
+void bip39_seedcache_free(bip39_seedcache *cache);
+
+/**
+ * @brief bip39_mnemonic_to_seed() through the cache; safe to call from many threads.
+ * @param cache Cache.
+ * @param mnemonic Space separated mnemonic phrase (NFKD normalized).
+ * @param passphrase Optional passphrase (can be NULL).
+ * @param seed Output buffer for the seed.
+ * @param hit Output: 1 if the seed came from the cache, 0 if derived (nullable).
+ * @return 0 on success, -1 on invalid input or KDF failure.
+ * @note PBKDF2 runs outside the lock. Two threads missing on the same
+ *       phrase at once both derive it; the second insert replaces the first.
+ */
+int bip39_seedcache_mnemonic_to_seed(bip39_seedcache *cache, const char *mnemonic,
+                                     const char *passphrase, uint8_t seed[BIP39_SEED_SIZE],
+                                     int *hit);
+
+/**
+ * @brief Drops and wipes all expired entries.
+ * @param cache Cache.
+ * @return Number of entries dropped.
+ * @note Lookups drop the expired entries they meet; call this periodically
+ *       so entries that are never asked for again do not linger.
+ */
+size_t bip39_seedcache_purge(bip39_seedcache *cache);
+
+/**
+ * @brief Returns the counters.
+ * @param cache Cache.
+ * @param stats Output.
+ */
+void bip39_seedcache_get_stats(bip39_seedcache *cache, bip39_seedcache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_SEEDCACHE_H
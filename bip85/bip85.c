@@ -0,0 +1,244 @@
+/**
+ * @file bip85.c
+ * @brief BIP-85 deterministic entropy from a BIP-32 master key.
+ */
+#include "bip85.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <openssl/crypto.h>
+
+#include "../hdkey/hdbatch.h"
+#include "../cpto/cpto.h"
+
+/** @brief HMAC key of the entropy step */
+static const byte BIP85_HMAC_KEY[] = "bip-entropy-from-k";
+
+/** @brief Longest output line: index, space, mnemonic, newline */
+#define BIP85_LINE_SIZE (11 + BIP39_MNEMONIC_MAX_SIZE + 1)
+
+static const char *const LANGUAGE_NAMES[] = {
+    "english", "japanese", "korean", "spanish", "chinese_simplified",
+    "chinese_traditional", "french", "italian", "czech"
+};
+
+const char *bip85_language_name(uint32_t language) {
+    if (language >= sizeof(LANGUAGE_NAMES) / sizeof(LANGUAGE_NAMES[0])) {
+        return NULL;
+    }
+    return LANGUAGE_NAMES[language];
+}
+
+int bip85_entropy(const byte *private_key, const byte *chain_code,
+                  const uint32_t *path, size_t depth, byte *entropy) {
+    if (private_key == NULL || chain_code == NULL || path == NULL || entropy == NULL ||
+        depth == 0 || path[0] != (BIP85_PURPOSE | BIP32_HARDENED)) {
+        return ERROR_INVALID_INPUT;
+    }
+    for (size_t i = 0; i < depth; i++) {
+        if (path[i] < BIP32_HARDENED) {
+            return ERROR_INVALID_INPUT;
+        }
+    }
+
+    byte key[PRIVATE_KEY_LENGTH];
+    byte chain[CHAIN_CODE_LENGTH];
+    int result = derive_bip32_path(private_key, chain_code, path, depth, key, chain, NULL);
+    if (result == SUCCESS) {
+        hmac_sha512(BIP85_HMAC_KEY, sizeof(BIP85_HMAC_KEY) - 1, key, sizeof(key), entropy);
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    OPENSSL_cleanse(chain, sizeof(chain));
+    return result;
+}
+
+/**
+ * @brief Entropy bytes used for a mnemonic of `words` words.
+ * @return 16, 24 or 32, or 0 for unsupported word counts.
+ */
+static size_t mnemonic_entropy_length(uint32_t words) {
+    switch (words) {
+        case 12: return 16;
+        case 18: return 24;
+        case 24: return 32;
+        default: return 0;
+    }
+}
+
+int bip85_bip39(const byte *private_key, const byte *chain_code, uint32_t language,
+                uint32_t words, uint32_t index, const bip39_wordlist *list,
+                char *out, size_t size) {
+    size_t len = mnemonic_entropy_length(words);
+    if (len == 0 || list == NULL || language >= BIP32_HARDENED || index >= BIP32_HARDENED) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint32_t path[5] = {BIP85_PURPOSE | BIP32_HARDENED, BIP85_APP_BIP39 | BIP32_HARDENED,
+                        language | BIP32_HARDENED, words | BIP32_HARDENED,
+                        index | BIP32_HARDENED};
+    byte entropy[BIP85_ENTROPY_LENGTH];
+    int result = bip85_entropy(private_key, chain_code, path, 5, entropy);
+    if (result == SUCCESS && bip39_entropy_to_mnemonic(entropy, len, list, out, size) != 0) {
+        result = ERROR_INVALID_LENGTH;
+    }
+    OPENSSL_cleanse(entropy, sizeof(entropy));
+    return result;
+}
+
+// ============ RANGE ============
+
+/**
+ * @brief One block of children, run by one thread.
+ */
+typedef struct {
+    hdkey_batch *prefix;        ///< m/83696968'/39'/language'/words', public key computed.
+    hdkey_batch kids;           ///< Scratch, capacity BIP85_BLOCK.
+    const bip39_wordlist *list;
+    size_t entropy_length;
+    uint32_t first;
+    size_t count;
+    char *text;                 ///< BIP85_BLOCK lines.
+    size_t text_length;
+    int result;
+} bip85_job;
+
+/**
+ * @brief Derives a block of children and renders their lines.
+ * @param arg The bip85_job.
+ * @return NULL; the outcome is in job->result.
+ */
+static void *run_job(void *arg) {
+    bip85_job *job = arg;
+    job->text_length = 0;
+    job->result = hdkey_batch_derive_range(job->prefix, 0, job->first | BIP32_HARDENED,
+                                           job->count, &job->kids);
+
+    const byte *keys[SHA512_LANES];
+    const byte *msgs[SHA512_LANES];
+    byte entropy[SHA512_LANES][SHA512_DIGEST_SIZE];
+    for (size_t l = 0; l < SHA512_LANES; l++) {
+        keys[l] = BIP85_HMAC_KEY;
+    }
+
+    for (size_t base = 0; base < job->count && job->result == SUCCESS; base += SHA512_LANES) {
+        size_t n = job->count - base < SHA512_LANES ? job->count - base : SHA512_LANES;
+        for (size_t l = 0; l < SHA512_LANES; l++) {
+            msgs[l] = job->kids.private_keys + (base + (l < n ? l : 0)) * PRIVATE_KEY_LENGTH;
+        }
+        hmac_sha512_lanes(keys, sizeof(BIP85_HMAC_KEY) - 1, msgs, PRIVATE_KEY_LENGTH, entropy);
+
+        for (size_t l = 0; l < n; l++) {
+            char *line = job->text + job->text_length;
+            int prefix = snprintf(line, BIP85_LINE_SIZE, "%u ", job->first + (uint32_t)(base + l));
+            if (bip39_entropy_to_mnemonic(entropy[l], job->entropy_length, job->list,
+                                          line + prefix, BIP85_LINE_SIZE - prefix - 1) != 0) {
+                job->result = ERROR_INVALID_LENGTH;
+                break;
+            }
+            size_t len = prefix + strlen(line + prefix);
+            line[len++] = '\n';
+            job->text_length += len;
+        }
+    }
+
+    OPENSSL_cleanse(entropy, sizeof(entropy));
+    return NULL;
+}
+
+int bip85_bip39_range(const byte *private_key, const byte *chain_code, uint32_t language,
+                      uint32_t words, uint32_t first, uint32_t count,
+                      const bip39_wordlist *list, size_t threads, FILE *out) {
+    size_t entropy_length = mnemonic_entropy_length(words);
+    if (private_key == NULL || chain_code == NULL || list == NULL || out == NULL ||
+        entropy_length == 0 || language >= BIP32_HARDENED || first >= BIP32_HARDENED ||
+        count > BIP32_HARDENED - first) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+
+    // Shared prefix m/83696968'/39'/language'/words', derived once
+    hdkey_batch prefix;
+    int result = hdkey_batch_init(&prefix, 1);
+    if (result != SUCCESS) {
+        return result;
+    }
+    uint32_t path[4] = {BIP85_PURPOSE | BIP32_HARDENED, BIP85_APP_BIP39 | BIP32_HARDENED,
+                        language | BIP32_HARDENED, words | BIP32_HARDENED};
+    uint32_t parent_fp = 0;
+    result = derive_bip32_path(private_key, chain_code, path, 4, prefix.private_keys,
+                               prefix.chain_codes, &parent_fp);
+    if (result == SUCCESS) {
+        prefix.count = 1;
+        prefix.depths[0] = 4;
+        prefix.child_numbers[0] = path[3];
+        prefix.parent_fingerprints[0] = parent_fp;
+        prefix.has_public_keys = 0;
+        // Workers share the prefix read-only, so its public key is computed now
+        result = hdkey_batch_public_keys(&prefix);
+    }
+
+    bip85_job *jobs = calloc(threads, sizeof(*jobs));
+    pthread_t *workers = calloc(threads, sizeof(*workers));
+    if (jobs == NULL || workers == NULL) {
+        result = ERROR_INTERNAL;
+    }
+    for (size_t t = 0; t < threads && result == SUCCESS; t++) {
+        jobs[t].prefix = &prefix;
+        jobs[t].list = list;
+        jobs[t].entropy_length = entropy_length;
+        jobs[t].text = malloc((size_t)BIP85_BLOCK * BIP85_LINE_SIZE);
+        result = jobs[t].text ? hdkey_batch_init(&jobs[t].kids, BIP85_BLOCK) : ERROR_INTERNAL;
+    }
+
+    // One block per thread per wave; blocks are written in index order
+    uint64_t next = first;
+    uint64_t end = (uint64_t)first + count;
+    while (next < end && result == SUCCESS) {
+        size_t active = 0;
+        for (; active < threads && next < end; active++) {
+            jobs[active].first = (uint32_t)next;
+            jobs[active].count = end - next < BIP85_BLOCK ? (size_t)(end - next) : BIP85_BLOCK;
+            next += jobs[active].count;
+        }
+
+        size_t started = 1;
+        for (; started < active; started++) {
+            if (pthread_create(&workers[started], NULL, run_job, &jobs[started]) != 0) {
+                break;
+            }
+        }
+        run_job(&jobs[0]);
+        for (size_t t = started; t < active; t++) {
+            run_job(&jobs[t]);  // thread creation failed: finish inline
+        }
+        for (size_t t = 1; t < started; t++) {
+            pthread_join(workers[t], NULL);
+        }
+
+        for (size_t t = 0; t < active && result == SUCCESS; t++) {
+            result = jobs[t].result;
+            if (result == SUCCESS &&
+                fwrite(jobs[t].text, 1, jobs[t].text_length, out) != jobs[t].text_length) {
+                result = ERROR_INTERNAL;
+            }
+        }
+    }
+
+    for (size_t t = 0; jobs != NULL && t < threads; t++) {
+        if (jobs[t].text != NULL) {
+            OPENSSL_cleanse(jobs[t].text, (size_t)BIP85_BLOCK * BIP85_LINE_SIZE);
+            free(jobs[t].text);
+        }
+        hdkey_batch_free(&jobs[t].kids);
+    }
+    free(jobs);
+    free(workers);
+    hdkey_batch_free(&prefix);
+    return result;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bip85.h
+ * @brief BIP-85 deterministic entropy from a BIP-32 master key.
+ * @details Child entropy is HMAC-SHA512("bip-entropy-from-k", k) where k is
+ *          the private key at a hardened path under m/83696968'. The BIP-39
+ *          application (m/83696968'/39'/language'/words'/index') turns that
+ *          entropy into child mnemonics for sub-wallets.
+ */
+
+#ifndef BIP85_H
+#define BIP85_H
+
+#include <stdio.h>
+
+#include "../hdkey/hdkey.h"
+#include "../bip39/bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Root of every BIP-85 path (hardened) */
+#define BIP85_PURPOSE 83696968u
+
+/** @brief BIP-39 application number (hardened) */
+#define BIP85_APP_BIP39 39u
+
+/** @brief Length of derived entropy */
+#define BIP85_ENTROPY_LENGTH 64
+
+/** @brief Child indices derived per job in range mode */
+#define BIP85_BLOCK 256
+
+/** @brief BIP-85 language codes of the BIP-39 application */
+typedef enum {
+    BIP85_ENGLISH = 0,
+    BIP85_JAPANESE = 1,
+    BIP85_KOREAN = 2,
+    BIP85_SPANISH = 3,
+    BIP85_CHINESE_SIMPLIFIED = 4,
+    BIP85_CHINESE_TRADITIONAL = 5,
+    BIP85_FRENCH = 6,
+    BIP85_ITALIAN = 7,
+    BIP85_CZECH = 8
+} bip85_language;
+
+/**
+ * @brief Wordlist file name stem of a language ("english", ...).
+ * @param language Language code.
+ * @return The name, or NULL for unknown codes.
+ */
+const char *bip85_language_name(uint32_t language);
+
+/**
+ * @brief Derives BIP-85 entropy for an arbitrary path.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param path Path indices, all hardened, starting with BIP85_PURPOSE'.
+ * @param depth Number of indices.
+ * @param entropy Output, BIP85_ENTROPY_LENGTH bytes.
+ * @return 0 on success, negative error code on failure.
+ */
+int bip85_entropy(const byte *private_key, const byte *chain_code,
+                  const uint32_t *path, size_t depth, byte *entropy);
+
+/**
+ * @brief Derives one child mnemonic.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param language Language code (only selects the path; pass its wordlist).
+ * @param words 12, 18 or 24.
+ * @param index Child index.
+ * @param list Wordlist of the language.
+ * @param out Output buffer (BIP39_MNEMONIC_MAX_SIZE bytes).
+ * @param size Size of the output buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+int bip85_bip39(const byte *private_key, const byte *chain_code, uint32_t language,
+                uint32_t words, uint32_t index, const bip39_wordlist *list,
+                char *out, size_t size);
+
+/**
+ * @brief Derives child mnemonics first..first+count-1 and writes them out.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param language Language code.
+ * @param words 12, 18 or 24.
+ * @param first First child index.
+ * @param count Number of children.
+ * @param list Wordlist of the language.
+ * @param threads Worker threads, 0 for one per online CPU.
+ * @param out Stream receiving one "index mnemonic" line per child, in order.
+ * @return 0 on success, negative error code on failure.
+ * @note m/83696968'/39'/language'/words' is derived once; children are
+ *       derived BIP85_BLOCK at a time with multi-lane HMAC-SHA512.
+ */
+int bip85_bip39_range(const byte *private_key, const byte *chain_code, uint32_t language,
+                      uint32_t words, uint32_t first, uint32_t count,
+                      const bip39_wordlist *list, size_t threads, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP85_H
@@ -0,0 +1,618 @@
+/**
+ * @file cluster.c
+ * @brief Splitting a numbered search space over workers on other hosts, over TCP.
+ */
+#define _GNU_SOURCE
+#include "cluster.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <openssl/crypto.h>
+
+/** @brief Progress reports per lease */
+#define CLUSTER_PROGRESS_STEPS 16
+
+/** @brief Milliseconds a worker waits after "WAIT" */
+#define CLUSTER_WAIT_MS 500
+
+/** @brief Milliseconds the coordinator sleeps in poll() at most, to check lease deadlines */
+#define CLUSTER_POLL_MS 250
+
+/** @brief Milliseconds the coordinator waits for workers to hang up after "DONE" */
+#define CLUSTER_LINGER_MS 2000
+
+/** @brief Longest worker name kept */
+#define CLUSTER_NAME_SIZE 64
+
+/** @brief Monotonic time in seconds */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Sends one formatted line.
+ * @return 0 on success, -1 if the peer is gone.
+ */
+static int send_line(int fd, const char *format, ...) {
+    char line[CLUSTER_LINE_SIZE];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line) - 1, format, args);
+    va_end(args);
+    if (len < 0 || (size_t)len >= sizeof(line) - 1) {
+        return -1;
+    }
+    line[len++] = '\n';
+    for (int sent = 0; sent < len;) {
+        ssize_t n = send(fd, line + sent, (size_t)(len - sent), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        sent += (int)n;
+    }
+    return 0;
+}
+
+int cluster_listen(const char *host, const char *port, int *fd, uint16_t *bound) {
+    if (port == NULL || fd == NULL) {
+        return CLUSTER_ERROR_INVALID;
+    }
+    struct addrinfo hints, *list;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host, port, &hints, &list) != 0) {
+        return CLUSTER_ERROR_NETWORK;
+    }
+    *fd = -1;
+    for (struct addrinfo *ai = list; ai != NULL && *fd < 0; ai = ai->ai_next) {
+        int s = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (s < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(s, ai->ai_addr, ai->ai_addrlen) == 0 && listen(s, 64) == 0) {
+            *fd = s;
+        } else {
+            close(s);
+        }
+    }
+    freeaddrinfo(list);
+    if (*fd < 0) {
+        return CLUSTER_ERROR_NETWORK;
+    }
+    if (bound != NULL) {
+        struct sockaddr_storage addr;
+        socklen_t len = sizeof(addr);
+        getsockname(*fd, (struct sockaddr *)&addr, &len);
+        *bound = ntohs(addr.ss_family == AF_INET6 ? ((struct sockaddr_in6 *)&addr)->sin6_port
+                                                  : ((struct sockaddr_in *)&addr)->sin_port);
+    }
+    return CLUSTER_OK;
+}
+
+/**
+ * @brief A range of candidates.
+ */
+typedef struct {
+    uint64_t first;
+    uint64_t count;
+} span;
+
+/**
+ * @brief One connected worker, as the coordinator sees it.
+ */
+typedef struct {
+    int fd;
+    char name[CLUSTER_NAME_SIZE];
+    char in[CLUSTER_LINE_SIZE];   /**< Bytes received, not yet a full line */
+    size_t in_len;
+    int greeted;                  /**< HELLO received */
+    int leased;                   /**< Holds `lease` */
+    span lease;
+    uint64_t progress;            /**< Candidates of the lease reported searched */
+    double lease_start;
+    double last_seen;             /**< Time of the last message */
+    double rate;                  /**< Candidates per second, 0 until a lease completed */
+    uint64_t searched;            /**< Candidates searched over the connection */
+} peer;
+
+/**
+ * @brief Coordinator state.
+ */
+typedef struct {
+    const cluster_config *config;
+    cluster_match_fn match;
+    void *ctx;
+    peer *peers;
+    size_t peer_count;
+    size_t peer_capacity;
+    uint64_t next;                /**< First candidate never leased */
+    span *lost;                   /**< Ranges taken back, leased again first */
+    size_t lost_count;
+    size_t lost_capacity;
+    uint64_t *matches;            /**< Distinct matches, for dropping repeats */
+    size_t match_capacity;
+    cluster_stats stats;
+} coordinator;
+
+static void coordinator_log(const coordinator *c, const char *format, ...) {
+    if (c->config->log == NULL) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(c->config->log, format, args);
+    va_end(args);
+    fflush(c->config->log);
+}
+
+/** @brief Candidates not searched and not leased */
+static uint64_t unleased(const coordinator *c) {
+    uint64_t total = c->config->total - c->next;
+    for (size_t i = 0; i < c->lost_count; i++) {
+        total += c->lost[i].count;
+    }
+    return total;
+}
+
+/**
+ * @brief Closes a worker's connection, taking back the unsearched part of its lease.
+ * @return CLUSTER_OK, or CLUSTER_ERROR_INTERNAL if the range could not be kept.
+ */
+static int drop_peer(coordinator *c, size_t index, const char *reason) {
+    peer *p = &c->peers[index];
+    int result = CLUSTER_OK;
+    if (p->leased && p->progress < p->lease.count) {
+        if (c->lost_count == c->lost_capacity) {
+            size_t capacity = c->lost_capacity ? c->lost_capacity * 2 : 16;
+            span *grown = realloc(c->lost, capacity * sizeof(span));
+            if (grown != NULL) {
+                c->lost = grown;
+                c->lost_capacity = capacity;
+            }
+        }
+        if (c->lost_count < c->lost_capacity) {
+            c->lost[c->lost_count++] = (span){p->lease.first + p->progress, p->lease.count - p->progress};
+            c->stats.released++;
+            coordinator_log(c, "worker %s %s; re-leasing %llu candidates from %llu\n", p->name, reason,
+                            (unsigned long long)(p->lease.count - p->progress),
+                            (unsigned long long)(p->lease.first + p->progress));
+        } else {
+            result = CLUSTER_ERROR_INTERNAL;
+        }
+    } else if (p->greeted) {
+        coordinator_log(c, "worker %s %s after %llu candidates\n", p->name, reason,
+                        (unsigned long long)p->searched);
+    }
+    close(p->fd);
+    c->peers[index] = c->peers[--c->peer_count];
+    return result;
+}
+
+/**
+ * @brief Picks the next range for a worker.
+ * @return 1 with a range, 0 if nothing is left to lease.
+ */
+static int next_lease(coordinator *c, const peer *p, span *out) {
+    const cluster_config *config = c->config;
+    double size = p->rate > 0 ? p->rate * config->lease_seconds : (double)config->first_lease;
+    uint64_t count = size < 1 ? 1 : size > (double)config->total ? config->total : (uint64_t)size;
+    // Near the end, share what is left among all workers
+    uint64_t share = (unleased(c) + c->peer_count - 1) / (c->peer_count ? c->peer_count : 1);
+    if (count > share) {
+        count = share > 0 ? share : 1;
+    }
+
+    if (c->lost_count > 0) {
+        span *lost = &c->lost[c->lost_count - 1];
+        *out = (span){lost->first, count < lost->count ? count : lost->count};
+        lost->first += out->count;
+        lost->count -= out->count;
+        if (lost->count == 0) {
+            c->lost_count--;
+        }
+        return 1;
+    }
+    if (c->next < config->total) {
+        *out = (span){c->next, count < config->total - c->next ? count : config->total - c->next};
+        c->next += out->count;
+        return 1;
+    }
+    return 0;
+}
+
+/** @brief Records a match unless it was reported before */
+static int add_match(coordinator *c, uint64_t number) {
+    for (uint64_t i = 0; i < c->stats.matches; i++) {
+        if (c->matches[i] == number) {
+            return 0;
+        }
+    }
+    if (c->stats.matches == c->match_capacity) {
+        size_t capacity = c->match_capacity ? c->match_capacity * 2 : 16;
+        uint64_t *grown = realloc(c->matches, capacity * sizeof(uint64_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        c->matches = grown;
+        c->match_capacity = capacity;
+    }
+    c->matches[c->stats.matches++] = number;
+    if (c->match != NULL) {
+        c->match(c->ctx, number);
+    }
+    return 0;
+}
+
+/**
+ * @brief Handles one line from a worker.
+ * @return 0 to keep the connection, -1 to drop it.
+ */
+static int handle_line(coordinator *c, peer *p, char *line, double now) {
+    unsigned long long a, b;
+    p->last_seen = now;
+    if (strncmp(line, "HELLO ", 6) == 0 && !p->greeted) {
+        snprintf(p->name, sizeof(p->name), "%s", line + 6);
+        p->greeted = 1;
+        coordinator_log(c, "worker %s joined\n", p->name);
+        return send_line(p->fd, "JOB %llu %s", (unsigned long long)c->config->total, c->config->job);
+    }
+    if (!p->greeted) {
+        return -1;
+    }
+    if (strcmp(line, "LEASE") == 0 && !p->leased) {
+        if (next_lease(c, p, &p->lease)) {
+            p->leased = 1;
+            p->progress = 0;
+            p->lease_start = now;
+            c->stats.leases++;
+            return send_line(p->fd, "RANGE %llu %llu", (unsigned long long)p->lease.first,
+                             (unsigned long long)p->lease.count);
+        }
+        return send_line(p->fd, c->stats.searched < c->config->total ? "WAIT" : "DONE");
+    }
+    if (!p->leased) {
+        return -1;
+    }
+    if (sscanf(line, "MATCH %llu", &a) == 1) {
+        if (a < p->lease.first + p->progress || a >= p->lease.first + p->lease.count) {
+            return -1;
+        }
+        return add_match(c, a);
+    }
+    if (sscanf(line, "PROGRESS %llu", &b) == 1) {
+        if (b < p->progress || b > p->lease.count) {
+            return -1;
+        }
+        c->stats.searched += b - p->progress;
+        p->searched += b - p->progress;
+        p->progress = b;
+        return 0;
+    }
+    if (strcmp(line, "COMPLETE") == 0) {
+        c->stats.searched += p->lease.count - p->progress;
+        p->searched += p->lease.count - p->progress;
+        double elapsed = now - p->lease_start;
+        if (elapsed > 0) {
+            double rate = (double)p->lease.count / elapsed;
+            p->rate = p->rate > 0 ? (p->rate + rate) / 2 : rate;
+        }
+        p->leased = 0;
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Reads what a worker sent and handles every complete line.
+ * @return 0 to keep the connection, -1 to drop it.
+ */
+static int read_peer(coordinator *c, peer *p, double now) {
+    ssize_t n = recv(p->fd, p->in + p->in_len, sizeof(p->in) - 1 - p->in_len, 0);
+    if (n <= 0) {
+        return n < 0 && errno == EINTR ? 0 : -1;
+    }
+    p->in_len += (size_t)n;
+    p->in[p->in_len] = '\0';
+    char *line = p->in, *end;
+    while ((end = strchr(line, '\n')) != NULL) {
+        *end = '\0';
+        if (end > line && end[-1] == '\r') {
+            end[-1] = '\0';
+        }
+        if (handle_line(c, p, line, now) != 0) {
+            return -1;
+        }
+        line = end + 1;
+    }
+    p->in_len = strlen(line);
+    memmove(p->in, line, p->in_len);
+    // A full buffer without a newline is not a protocol line
+    return p->in_len < sizeof(p->in) - 1 ? 0 : -1;
+}
+
+/**
+ * @brief Tells every worker it is done and waits for them to hang up.
+ * @note Closing at once would reset connections whose worker just sent
+ *       "LEASE", and a reset discards the unread "DONE".
+ */
+static void finish_peers(coordinator *c, struct pollfd *fds) {
+    for (size_t i = 0; i < c->peer_count; i++) {
+        send_line(c->peers[i].fd, "DONE");
+        shutdown(c->peers[i].fd, SHUT_WR);
+    }
+    double deadline = now_seconds() + CLUSTER_LINGER_MS / 1000.0;
+    while (c->peer_count > 0 && now_seconds() < deadline) {
+        for (size_t i = 0; i < c->peer_count; i++) {
+            fds[i] = (struct pollfd){c->peers[i].fd, POLLIN, 0};
+        }
+        size_t polled = c->peer_count;
+        if (poll(fds, polled, CLUSTER_POLL_MS) < 0 && errno != EINTR) {
+            break;
+        }
+        for (size_t i = polled; i-- > 0;) {
+            char discard[256];
+            if (fds[i].revents != 0 && recv(c->peers[i].fd, discard, sizeof(discard), 0) <= 0) {
+                drop_peer(c, i, "finished");
+            }
+        }
+    }
+    while (c->peer_count > 0) {
+        drop_peer(c, c->peer_count - 1, "finished");
+    }
+}
+
+int cluster_coordinate(int fd, const cluster_config *config, cluster_match_fn match, void *ctx,
+                       cluster_stats *stats) {
+    if (fd < 0 || config == NULL || config->job == NULL || config->total == 0 ||
+        config->lease_seconds <= 0 || config->lease_timeout <= 0 || strchr(config->job, '\n') != NULL) {
+        return CLUSTER_ERROR_INVALID;
+    }
+    coordinator c;
+    memset(&c, 0, sizeof(c));
+    c.config = config;
+    c.match = match;
+    c.ctx = ctx;
+    struct pollfd *fds = malloc((CLUSTER_MAX_WORKERS + 1) * sizeof(struct pollfd));
+    if (fds == NULL) {
+        return CLUSTER_ERROR_INTERNAL;
+    }
+
+    int result = CLUSTER_OK;
+    double start = now_seconds(), last_log = start;
+    while (result == CLUSTER_OK && c.stats.searched < config->total) {
+        fds[0] = (struct pollfd){fd, POLLIN, 0};
+        for (size_t i = 0; i < c.peer_count; i++) {
+            fds[i + 1] = (struct pollfd){c.peers[i].fd, POLLIN, 0};
+        }
+        size_t polled = c.peer_count;
+        if (poll(fds, polled + 1, CLUSTER_POLL_MS) < 0 && errno != EINTR) {
+            result = CLUSTER_ERROR_NETWORK;
+            break;
+        }
+        double now = now_seconds();
+
+        // Walk backwards: dropping a peer moves the last one into its slot
+        for (size_t i = polled; i-- > 0;) {
+            if (fds[i + 1].revents != 0 && read_peer(&c, &c.peers[i], now) != 0 &&
+                drop_peer(&c, i, "disconnected") != CLUSTER_OK) {
+                result = CLUSTER_ERROR_INTERNAL;
+            }
+        }
+        // Connections that never said HELLO are timed out too
+        for (size_t i = c.peer_count; i-- > 0;) {
+            const peer *p = &c.peers[i];
+            if ((p->leased || !p->greeted) && now - p->last_seen > config->lease_timeout &&
+                drop_peer(&c, i, "timed out") != CLUSTER_OK) {
+                result = CLUSTER_ERROR_INTERNAL;
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            int client = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+            if (client >= 0 && c.peer_count == CLUSTER_MAX_WORKERS) {
+                close(client);
+            } else if (client >= 0) {
+                if (c.peer_count == c.peer_capacity) {
+                    size_t capacity = c.peer_capacity ? c.peer_capacity * 2 : 16;
+                    peer *grown = realloc(c.peers, capacity * sizeof(peer));
+                    if (grown == NULL) {
+                        close(client);
+                        result = CLUSTER_ERROR_INTERNAL;
+                        break;
+                    }
+                    c.peers = grown;
+                    c.peer_capacity = capacity;
+                }
+                peer *p = &c.peers[c.peer_count++];
+                memset(p, 0, sizeof(*p));
+                p->fd = client;
+                p->last_seen = now;
+                strcpy(p->name, "?");
+                c.stats.workers++;
+            }
+        }
+        if (config->log_interval > 0 && now - last_log >= config->log_interval) {
+            last_log = now;
+            coordinator_log(&c, "%llu/%llu searched (%.1f%%), %.0f/s, %zu workers, %llu matches, "
+                            "%llu leases re-leased\n", (unsigned long long)c.stats.searched,
+                            (unsigned long long)config->total,
+                            100.0 * (double)c.stats.searched / (double)config->total,
+                            (double)c.stats.searched / (now - start), c.peer_count,
+                            (unsigned long long)c.stats.matches, (unsigned long long)c.stats.released);
+        }
+    }
+
+    finish_peers(&c, fds);
+    c.stats.seconds = now_seconds() - start;
+    if (stats != NULL) {
+        *stats = c.stats;
+    }
+    free(fds);
+    free(c.peers);
+    free(c.lost);
+    free(c.matches);
+    return result;
+}
+
+/**
+ * @brief Worker side of a connection.
+ */
+typedef struct {
+    int fd;
+    char in[CLUSTER_LINE_SIZE];
+    size_t in_len;
+    int failed;      /**< A send failed inside the search callback */
+} connection;
+
+/**
+ * @brief Reads one line.
+ * @return 0 on success, -1 if the connection closed or the line is too long.
+ */
+static int read_line(connection *conn, char *line, size_t size) {
+    for (;;) {
+        char *end = memchr(conn->in, '\n', conn->in_len);
+        if (end != NULL) {
+            size_t len = (size_t)(end - conn->in);
+            if (len >= size) {
+                return -1;
+            }
+            memcpy(line, conn->in, len);
+            line[len] = '\0';
+            conn->in_len -= len + 1;
+            memmove(conn->in, end + 1, conn->in_len);
+            return 0;
+        }
+        if (conn->in_len == sizeof(conn->in)) {
+            return -1;
+        }
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        conn->in_len += (size_t)n;
+    }
+}
+
+/** @brief Match callback handed to the search: forwards the match to the coordinator */
+static void send_match(void *ctx, uint64_t number) {
+    connection *conn = ctx;
+    if (send_line(conn->fd, "MATCH %llu", (unsigned long long)number) != 0) {
+        conn->failed = 1;
+    }
+}
+
+/** @brief Opens a TCP connection */
+static int connect_to(const char *host, const char *port) {
+    struct addrinfo hints, *list;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &list) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = list; ai != NULL && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(list);
+    return fd;
+}
+
+/**
+ * @brief Searches one lease in CLUSTER_PROGRESS_STEPS steps, reporting after each.
+ */
+static int work_lease(connection *conn, const cluster_worker *worker, uint64_t first, uint64_t count,
+                      uint64_t *searched) {
+    uint64_t step = count / CLUSTER_PROGRESS_STEPS > 0 ? count / CLUSTER_PROGRESS_STEPS : 1;
+    for (uint64_t done = 0; done < count;) {
+        uint64_t n = count - done < step ? count - done : step;
+        if (worker->search(worker->ctx, first + done, n, send_match, conn) != 0) {
+            return CLUSTER_ERROR_SEARCH;
+        }
+        done += n;
+        *searched += n;
+        if (conn->failed || send_line(conn->fd, "PROGRESS %llu", (unsigned long long)done) != 0) {
+            return CLUSTER_ERROR_NETWORK;
+        }
+    }
+    return send_line(conn->fd, "COMPLETE") == 0 ? CLUSTER_OK : CLUSTER_ERROR_NETWORK;
+}
+
+int cluster_work(const char *host, const char *port, const cluster_worker *worker, uint64_t *searched) {
+    uint64_t local = 0;
+    if (searched == NULL) {
+        searched = &local;
+    }
+    *searched = 0;
+    if (host == NULL || port == NULL || worker == NULL || worker->start == NULL || worker->search == NULL) {
+        return CLUSTER_ERROR_INVALID;
+    }
+    connection *conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        return CLUSTER_ERROR_INTERNAL;
+    }
+    char *line = malloc(CLUSTER_LINE_SIZE);
+    conn->fd = line != NULL ? connect_to(host, port) : -1;
+    if (conn->fd < 0) {
+        free(line);
+        free(conn);
+        return line != NULL ? CLUSTER_ERROR_NETWORK : CLUSTER_ERROR_INTERNAL;
+    }
+
+    int result = CLUSTER_OK;
+    unsigned long long total, first, count;
+    int offset = 0;
+    if (send_line(conn->fd, "HELLO %s", worker->name != NULL ? worker->name : "worker") != 0 ||
+        read_line(conn, line, CLUSTER_LINE_SIZE) != 0) {
+        result = CLUSTER_ERROR_NETWORK;
+    } else if (sscanf(line, "JOB %llu %n", &total, &offset) != 1 || offset == 0) {
+        result = CLUSTER_ERROR_PROTOCOL;
+    } else if (worker->start(worker->ctx, line + offset, total) != 0) {
+        result = CLUSTER_ERROR_SEARCH;
+    }
+    while (result == CLUSTER_OK) {
+        if (send_line(conn->fd, "LEASE") != 0 || read_line(conn, line, CLUSTER_LINE_SIZE) != 0) {
+            result = CLUSTER_ERROR_NETWORK;
+        } else if (strcmp(line, "DONE") == 0) {
+            break;
+        } else if (strcmp(line, "WAIT") == 0) {
+            usleep(CLUSTER_WAIT_MS * 1000);
+        } else if (sscanf(line, "RANGE %llu %llu", &first, &count) == 2 && count > 0) {
+            result = work_lease(conn, worker, first, count, searched);
+        } else {
+            result = CLUSTER_ERROR_PROTOCOL;
+        }
+    }
+
+    // The job line can hold partial secrets
+    OPENSSL_cleanse(line, CLUSTER_LINE_SIZE);
+    OPENSSL_cleanse(conn->in, sizeof(conn->in));
+    close(conn->fd);
+    free(line);
+    free(conn);
+    return result;
+}
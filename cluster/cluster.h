@@ -0,0 +1,140 @@
+/**
+ * @file cluster.h
+ * @brief Splitting a numbered search space over workers on other hosts, over TCP.
+ * @details A coordinator owns a space of candidates numbered 0 .. total-1
+ *          and an opaque job description. Workers connect, receive the job,
+ *          and repeatedly lease a range of candidates, search it, and report
+ *          matches and progress. Leases are sized from each worker's measured
+ *          rate so one takes about `lease_seconds`, and shrink near the end so
+ *          the last ranges are shared out.
+ *
+ *          A lease whose worker disconnects, or sends nothing for
+ *          `lease_timeout` seconds, is re-leased from the last progress it
+ *          reported; matches are reported before the progress that covers
+ *          them, so none are lost and duplicates are dropped.
+ *
+ *          Protocol, one text line per message:
+ *          - worker: "HELLO <name>"          coordinator: "JOB <total> <job>"
+ *          - worker: "LEASE"                 coordinator: "RANGE <first> <count>",
+ *                                            "WAIT" (retry shortly) or "DONE"
+ *          - worker: "MATCH <number>", "PROGRESS <searched>" (from the lease
+ *            start), "COMPLETE"
+ *
+ *          There is no encryption or authentication: the job holds partial
+ *          secrets, so run it on a trusted network or through SSH tunnels.
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <stddef.h>   // For size_t
+#include <stdint.h>   // For uint16_t, uint64_t
+#include <stdio.h>    // For FILE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Longest protocol line, job included */
+#define CLUSTER_LINE_SIZE 4096
+
+/** @brief Most workers connected at once */
+#define CLUSTER_MAX_WORKERS 1024
+
+/** @brief Error codes */
+enum {
+    CLUSTER_OK = 0,
+    CLUSTER_ERROR_INVALID = -1,    /**< Bad arguments */
+    CLUSTER_ERROR_NETWORK = -2,    /**< Cannot resolve, bind, connect, or the peer went away */
+    CLUSTER_ERROR_PROTOCOL = -3,   /**< Unexpected message */
+    CLUSTER_ERROR_INTERNAL = -4,   /**< Allocation failure */
+    CLUSTER_ERROR_SEARCH = -5      /**< The worker's search callback failed */
+};
+
+/**
+ * @brief What a coordinator hands out.
+ */
+typedef struct {
+    uint64_t total;          /**< Candidates, numbered 0 .. total-1 */
+    const char *job;         /**< Job description sent to workers (one line, no newline) */
+    double lease_seconds;    /**< Target duration of one lease, e.g. 10 */
+    double lease_timeout;    /**< Seconds without a message before a lease is taken back */
+    uint64_t first_lease;    /**< Size of a worker's first lease, before its rate is known */
+    FILE *log;               /**< Progress and worker events (nullable) */
+    double log_interval;     /**< Seconds between progress lines */
+} cluster_config;
+
+/**
+ * @brief Coordinator counters.
+ */
+typedef struct {
+    uint64_t searched;       /**< Candidates searched */
+    uint64_t matches;        /**< Distinct matches */
+    uint64_t leases;         /**< Ranges handed out */
+    uint64_t released;       /**< Leases taken back from dead or silent workers */
+    uint64_t workers;        /**< Worker connections accepted */
+    double seconds;          /**< Wall time */
+} cluster_stats;
+
+/** @brief Called with the number of a candidate a worker matched */
+typedef void (*cluster_match_fn)(void *ctx, uint64_t number);
+
+/**
+ * @brief Search callback of a worker.
+ * @param ctx Worker context.
+ * @param first First candidate.
+ * @param count Candidates.
+ * @param match Report each match through this, in order.
+ * @param match_ctx Passed to match.
+ * @return 0 on success, negative on failure.
+ */
+typedef int (*cluster_search_fn)(void *ctx, uint64_t first, uint64_t count,
+                                 cluster_match_fn match, void *match_ctx);
+
+/**
+ * @brief What a worker runs.
+ */
+typedef struct {
+    int (*start)(void *ctx, const char *job, uint64_t total);  /**< Prepares the job; 0 on success */
+    cluster_search_fn search;
+    void *ctx;
+    const char *name;        /**< Shown in the coordinator log */
+} cluster_worker;
+
+/**
+ * @brief Opens a listening TCP socket.
+ * @param host Address to bind, NULL for all interfaces.
+ * @param port Port, "0" for any free port.
+ * @param fd Output: the socket.
+ * @param bound Output: the port bound (can be NULL).
+ * @return CLUSTER_OK or a negative error code.
+ */
+int cluster_listen(const char *host, const char *port, int *fd, uint16_t *bound);
+
+/**
+ * @brief Serves leases until every candidate is searched.
+ * @param fd Listening socket (closed by the caller).
+ * @param config Search space and lease policy.
+ * @param match Called once per distinct match (can be NULL).
+ * @param ctx Passed to match.
+ * @param stats Counters at the end (can be NULL).
+ * @return CLUSTER_OK or a negative error code.
+ */
+int cluster_coordinate(int fd, const cluster_config *config, cluster_match_fn match, void *ctx,
+                       cluster_stats *stats);
+
+/**
+ * @brief Works for a coordinator until it has nothing left.
+ * @param host Coordinator host.
+ * @param port Coordinator port.
+ * @param worker Job setup and search callbacks.
+ * @param searched Output: candidates this worker searched (can be NULL).
+ * @return CLUSTER_OK when the coordinator is done, or a negative error code.
+ */
+int cluster_work(const char *host, const char *port, const cluster_worker *worker, uint64_t *searched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLUSTER_H
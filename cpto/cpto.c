@@ -4,7 +4,8 @@
  * @details This is a portable implementation of cryptography algorithms.
  */
 #include "cpto.h"
-#include <string.h>  // For memcpy, memset
+#include <string.h>     // For memcpy, memset
+#include <stdatomic.h>  // For atomic_load_explicit, atomic_store_explicit
 
 // SHA-256 constants (first 32 bits of fractional parts of cube roots of first 64 primes)
 static const uint32_t k[64] = {
@@ -86,71 +87,292 @@ static uint32_t gamma1(uint32_t x) {
     return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10);
 }
 
-void sha256(const uint8_t *data, size_t len, uint8_t hash[32]) {
-    // Initialize hash values (first 32 bits of fractional parts of square roots of first 8 primes)
-    uint32_t h[8] = {
-        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-    };
+/**
+ * @brief Portable SHA-256 compression of one 64-byte block.
+ * @param state Chaining state, updated in place.
+ * @param block The 64-byte message block.
+ */
+static void sha256_compress_scalar(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]) {
+    uint32_t w[64];
+    for (int t = 0; t < 16; t++) {
+        w[t] = ((uint32_t)block[t * 4] << 24) | ((uint32_t)block[t * 4 + 1] << 16) |
+               ((uint32_t)block[t * 4 + 2] << 8) | block[t * 4 + 3];
+    }
+    for (int t = 16; t < 64; t++) {
+        w[t] = gamma1(w[t - 2]) + w[t - 7] + gamma0(w[t - 15]) + w[t - 16];
+    }
 
-    uint8_t block[64];
-    uint64_t bit_len = len * 8;
-    size_t block_len = 0;
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4], f = state[5], g = state[6], h_val = state[7];
 
-    for (size_t i = 0; i <= len; i++) {
-        if (i == len || block_len == 64) {
-            if (block_len < 64) {
-                memset(block + block_len, 0, 64 - block_len);
-                if (i == len) block[block_len] = 0x80;
-            }
-            if (block_len <= 56) {
-                for (int j = 0; j < 8; j++) {
-                    block[56 + j] = (bit_len >> (56 - j * 8)) & 0xFF;
-                }
-            }
+    for (int t = 0; t < 64; t++) {
+        uint32_t t1 = h_val + sigma1(e) + ch(e, f, g) + k[t] + w[t];
+        uint32_t t2 = sigma0(a) + maj(a, b, c);
+        h_val = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
 
-            uint32_t w[64];
-            for (int t = 0; t < 16; t++) {
-                w[t] = (block[t * 4] << 24) | (block[t * 4 + 1] << 16) | 
-                       (block[t * 4 + 2] << 8) | block[t * 4 + 3];
-            }
-            for (int t = 16; t < 64; t++) {
-                w[t] = gamma1(w[t - 2]) + w[t - 7] + gamma0(w[t - 15]) + w[t - 16];
-            }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h_val;
+}
 
-            uint32_t a = h[0], b = h[1], c = h[2], d = h[3],
-                     e = h[4], f = h[5], g = h[6], h_val = h[7];
-
-            for (int t = 0; t < 64; t++) {
-                uint32_t t1 = h_val + sigma1(e) + ch(e, f, g) + k[t] + w[t];
-                uint32_t t2 = sigma0(a) + maj(a, b, c);
-                h_val = g;
-                g = f;
-                f = e;
-                e = d + t1;
-                d = c;
-                c = b;
-                b = a;
-                a = t1 + t2;
-            }
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CPTO_HAVE_SHA_NI 1
+
+/**
+ * @brief SHA-256 compression with the x86 SHA extensions.
+ * @param state Chaining state, updated in place.
+ * @param block The 64-byte message block.
+ * @note The state is kept as ABEF/CDGH register pairs, the layout the
+ *       sha256rnds2 instruction works on.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
 
-            h[0] += a; h[1] += b; h[2] += c; h[3] += d;
-            h[4] += e; h[5] += f; h[6] += g; h[7] += h_val;
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);    // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);         // CDGH
+    __m128i abef = state0, cdgh = state1;
 
-            block_len = 0;
-        }
-        if (i < len) {
-            block[block_len++] = data[i];
+    // msg[i % 4] holds message words 4i..4i+3 (a rolling window of four)
+    __m128i msg[4];
+    for (int i = 0; i < 16; i++) {
+        if (i < 4) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(block + 16 * i)), byte_swap);
+        } else {
+            __m128i w = _mm_sha256msg1_epu32(msg[i % 4], msg[(i + 1) % 4]);
+            w = _mm_add_epi32(w, _mm_alignr_epi8(msg[(i + 3) % 4], msg[(i + 2) % 4], 4));
+            msg[i % 4] = _mm_sha256msg2_epu32(w, msg[(i + 3) % 4]);
         }
+        __m128i wk = _mm_add_epi32(msg[i % 4], _mm_loadu_si128((const __m128i *)&k[4 * i]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
     }
 
-    // Convert hash to big-endian byte array
-    for (int i = 0; i < 8; i++) {
-        hash[i * 4] = (h[i] >> 24) & 0xFF;
-        hash[i * 4 + 1] = (h[i] >> 16) & 0xFF;
-        hash[i * 4 + 2] = (h[i] >> 8) & 0xFF;
-        hash[i * 4 + 3] = h[i] & 0xFF;
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);             // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);          // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);             // HGFE
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+/**
+ * @brief Checks CPUID for the SHA extensions (leaf 7, EBX bit 29).
+ * @return Non-zero if sha256rnds2 and friends are available.
+ */
+static int cpu_has_sha_ni(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return 0;
+    if (!(ebx & (1u << 29))) return 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+    return (ecx & bit_SSE4_1) != 0;
+}
+#endif
+
+/** @brief SHA-256 block function chosen on first use from the CPU features. */
+typedef void (*sha256_compress_fn)(uint32_t *, const uint8_t *);
+
+/**
+ * @brief Picks the SHA-NI kernel when the CPU has it.
+ * @return Kernel function pointer.
+ */
+static sha256_compress_fn sha256_select_compress(void) {
+#ifdef CPTO_HAVE_SHA_NI
+    if (cpu_has_sha_ni()) return sha256_compress_shani;
+#endif
+    return sha256_compress_scalar;
+}
+
+void sha256_compress(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]) {
+    // Threads racing on first use all pick the same kernel; the atomic keeps that race defined
+    static _Atomic(sha256_compress_fn) selected = NULL;
+    sha256_compress_fn kernel = atomic_load_explicit(&selected, memory_order_relaxed);
+    if (!kernel) {
+        kernel = sha256_select_compress();
+        atomic_store_explicit(&selected, kernel, memory_order_relaxed);
+    }
+    kernel(state, block);
+}
+
+/**
+ * @brief Hashes the rest of a message into a running state and pads it.
+ * @param h Running state; holds the final hash words on return.
+ * @param data Remaining message bytes.
+ * @param len Number of remaining bytes.
+ * @param total_len Length of the whole message, including bytes already compressed.
+ */
+static void sha256_finish(uint32_t h[8], const uint8_t *data, size_t len, uint64_t total_len) {
+    size_t full = len - len % SHA256_BLOCK_SIZE;
+    for (size_t off = 0; off < full; off += SHA256_BLOCK_SIZE) {
+        sha256_compress(h, data + off);
+    }
+
+    // '1' bit, zeros, 64-bit length; a second block when fewer than 9 bytes are left
+    uint8_t block[2 * SHA256_BLOCK_SIZE] = {0};
+    size_t rem = len - full;
+    memcpy(block, data + full, rem);
+    block[rem] = 0x80;
+    size_t tail = rem + 9 <= SHA256_BLOCK_SIZE ? SHA256_BLOCK_SIZE : 2 * SHA256_BLOCK_SIZE;
+    uint64_t bits = total_len << 3;
+    for (int j = 0; j < 8; j++) {
+        block[tail - 8 + j] = (bits >> (56 - j * 8)) & 0xFF;
+    }
+
+    sha256_compress(h, block);
+    if (tail > SHA256_BLOCK_SIZE) {
+        sha256_compress(h, block + SHA256_BLOCK_SIZE);
+    }
+}
+
+/** @brief SHA-256 initial hash values (square roots of the first 8 primes) */
+static const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/**
+ * @brief Writes hash words as big-endian bytes.
+ * @param out Output, 4 * n bytes.
+ * @param h Hash words.
+ * @param n Number of words.
+ */
+static void store_be32_words(uint8_t *out, const uint32_t *h, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i * 4] = (h[i] >> 24) & 0xFF;
+        out[i * 4 + 1] = (h[i] >> 16) & 0xFF;
+        out[i * 4 + 2] = (h[i] >> 8) & 0xFF;
+        out[i * 4 + 3] = h[i] & 0xFF;
+    }
+}
+
+void sha256(const uint8_t *data, size_t len, uint8_t hash[32]) {
+    uint32_t h[8];
+    memcpy(h, sha256_iv, sizeof(h));
+    sha256_finish(h, data, len, len);
+    store_be32_words(hash, h, 8);
+}
+
+/**
+ * @brief HMAC-SHA256 pad midstates: the states after (key ^ ipad) and (key ^ opad).
+ * @param key HMAC key.
+ * @param keylen Key length (hashed first when longer than a block).
+ * @param istate Output: inner midstate.
+ * @param ostate Output: outer midstate.
+ */
+static void hmac_sha256_midstates(const uint8_t *key, size_t keylen,
+                                  uint32_t istate[8], uint32_t ostate[8]) {
+    uint8_t k[SHA256_BLOCK_SIZE] = {0};
+    if (keylen > SHA256_BLOCK_SIZE) {
+        sha256(key, keylen, k);
+    } else {
+        memcpy(k, key, keylen);
+    }
+
+    uint8_t pad[SHA256_BLOCK_SIZE];
+    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) pad[i] = k[i] ^ 0x36;
+    memcpy(istate, sha256_iv, 8 * sizeof(uint32_t));
+    sha256_compress(istate, pad);
+    for (size_t i = 0; i < SHA256_BLOCK_SIZE; i++) pad[i] = k[i] ^ 0x5c;
+    memcpy(ostate, sha256_iv, 8 * sizeof(uint32_t));
+    sha256_compress(ostate, pad);
+
+    memset(k, 0, sizeof(k));
+    memset(pad, 0, sizeof(pad));
+}
+
+void hmac_sha256(const uint8_t *key, size_t keylen,
+                 const uint8_t *data, size_t datalen,
+                 uint8_t digest[SHA256_DIGEST_SIZE]) {
+    uint32_t istate[8], ostate[8];
+    uint8_t inner[SHA256_DIGEST_SIZE];
+    hmac_sha256_midstates(key, keylen, istate, ostate);
+
+    sha256_finish(istate, data, datalen, SHA256_BLOCK_SIZE + datalen);
+    store_be32_words(inner, istate, 8);
+    sha256_finish(ostate, inner, sizeof(inner), SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE);
+    store_be32_words(digest, ostate, 8);
+
+    memset(istate, 0, sizeof(istate));
+    memset(inner, 0, sizeof(inner));
+}
+
+void pbkdf2_hmac_sha256(const uint8_t *password, size_t password_len,
+                        const uint8_t *salt, size_t salt_len,
+                        uint32_t iterations,
+                        uint8_t *output, size_t output_len) {
+    uint32_t istate[8], ostate[8];
+    hmac_sha256_midstates(password, password_len, istate, ostate);
+
+    // Every iteration after the first hashes a 32-byte U: inner and outer
+    // are one preformatted block each, compressed from the pad midstates
+    uint8_t inner_block[SHA256_BLOCK_SIZE] = {0};
+    uint8_t outer_block[SHA256_BLOCK_SIZE] = {0};
+    inner_block[SHA256_DIGEST_SIZE] = 0x80;
+    outer_block[SHA256_DIGEST_SIZE] = 0x80;
+    uint64_t bits = (uint64_t)(SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) << 3;
+    for (int j = 0; j < 8; j++) {
+        inner_block[SHA256_BLOCK_SIZE - 8 + j] = (bits >> (56 - j * 8)) & 0xFF;
+        outer_block[SHA256_BLOCK_SIZE - 8 + j] = (bits >> (56 - j * 8)) & 0xFF;
+    }
+
+    uint8_t salt_counter[salt_len + 4];
+    memcpy(salt_counter, salt, salt_len);
+    uint32_t block_index = 1;
+    while (output_len > 0) {
+        salt_counter[salt_len] = (block_index >> 24) & 0xFF;
+        salt_counter[salt_len + 1] = (block_index >> 16) & 0xFF;
+        salt_counter[salt_len + 2] = (block_index >> 8) & 0xFF;
+        salt_counter[salt_len + 3] = block_index & 0xFF;
+
+        // U1 = HMAC(password, salt || INT(i))
+        uint32_t h[8], t[8];
+        memcpy(h, istate, sizeof(h));
+        sha256_finish(h, salt_counter, salt_len + 4, SHA256_BLOCK_SIZE + salt_len + 4);
+        store_be32_words(outer_block, h, 8);
+        memcpy(h, ostate, sizeof(h));
+        sha256_compress(h, outer_block);
+        memcpy(t, h, sizeof(t));
+
+        for (uint32_t i = 1; i < iterations; i++) {
+            store_be32_words(inner_block, h, 8);
+            memcpy(h, istate, sizeof(h));
+            sha256_compress(h, inner_block);
+            store_be32_words(outer_block, h, 8);
+            memcpy(h, ostate, sizeof(h));
+            sha256_compress(h, outer_block);
+            for (int j = 0; j < 8; j++) t[j] ^= h[j];
+        }
+
+        uint8_t block[SHA256_DIGEST_SIZE];
+        store_be32_words(block, t, 8);
+        size_t to_copy = output_len < SHA256_DIGEST_SIZE ? output_len : SHA256_DIGEST_SIZE;
+        memcpy(output, block, to_copy);
+        output += to_copy;
+        output_len -= to_copy;
+        block_index++;
+
+        memset(block, 0, sizeof(block));
+        memset(h, 0, sizeof(h));
+        memset(t, 0, sizeof(t));
     }
+
+    memset(istate, 0, sizeof(istate));
+    memset(ostate, 0, sizeof(ostate));
+    memset(inner_block, 0, sizeof(inner_block));
+    memset(outer_block, 0, sizeof(outer_block));
 }
 
 static inline uint64_t rotr64(uint64_t x, int n) {
@@ -225,12 +447,67 @@ static const uint64_t k512[80] = {
     0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
 };
 
-void sha512(const uint8_t *data, size_t len, uint8_t digest[SHA512_DIGEST_SIZE]) {
-    // SHA-512 works on 1024-bit (128-byte) blocks.
-    const size_t block_size = 128;
-    uint8_t block[128];
-    size_t block_len = 0;
+/**
+ * @brief Loads a big-endian 64-bit word.
+ * @param p Pointer to 8 bytes.
+ * @return The decoded word.
+ */
+static inline uint64_t load_be64(const uint8_t *p) {
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+           ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+           ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+           ((uint64_t)p[6] << 8) | ((uint64_t)p[7]);
+}
+
+/**
+ * @brief Stores a 64-bit word in big-endian order.
+ * @param p Destination (8 bytes).
+ * @param x Word to store.
+ */
+static inline void store_be64(uint8_t *p, uint64_t x) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (x >> (56 - 8 * i)) & 0xFF;
+    }
+}
+
+void sha512_compress_words(uint64_t state[8], const uint64_t block[16]) {
+    uint64_t w[80];
+    for (int t = 0; t < 16; t++) {
+        w[t] = block[t];
+    }
+    for (int t = 16; t < 80; t++) {
+        w[t] = gamma1_64(w[t - 2]) + w[t - 7] + gamma0_64(w[t - 15]) + w[t - 16];
+    }
+
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4], f = state[5], g = state[6], hh = state[7];
+
+    for (int t = 0; t < 80; t++) {
+        uint64_t t1 = hh + sigma1_64(e) + ch64(e, f, g) + k512[t] + w[t];
+        uint64_t t2 = sigma0_64(a) + maj64(a, b, c);
+        hh = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
 
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += hh;
+}
+
+void sha512_compress(uint64_t state[8], const uint8_t block[SHA512_BLOCK_SIZE]) {
+    uint64_t w[16];
+    for (int t = 0; t < 16; t++) {
+        w[t] = load_be64(block + t * 8);
+    }
+    sha512_compress_words(state, w);
+}
+
+void sha512(const uint8_t *data, size_t len, uint8_t digest[SHA512_DIGEST_SIZE]) {
     // Initialize hash values (first 64 bits of the fractional parts of the square roots of the first eight primes)
     uint64_t h[8] = {
         0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
@@ -239,128 +516,210 @@ void sha512(const uint8_t *data, size_t len, uint8_t digest[SHA512_DIGEST_SIZE])
         0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
     };
 
-    // Calculate bit length. Note: For simplicity we assume len*8 fits in 64 bits.
-    uint64_t bit_len_low = (uint64_t)len * 8;
-    uint64_t bit_len_high = 0; // For very long messages, this should be computed properly.
-
-    size_t i = 0;
-    // Process the data, similar to the SHA-256 loop.
-    for (; i <= len; i++) {
-        // When we've reached the end of data or the block is full, process the block.
-        if (i == len || block_len == block_size) {
-            if (i == len) {
-                // Append the '1' bit.
-                block[block_len++] = 0x80;
-            }
-            // If there isn't enough space to append length (16 bytes)...
-            if (block_len > block_size - 16) {
-                // Pad the remainder of the block with zeros.
-                memset(block + block_len, 0, block_size - block_len);
-                // Process this block.
-                uint64_t w[80];
-                for (int t = 0; t < 16; t++) {
-                    w[t] = ((uint64_t)block[t * 8] << 56) |
-                           ((uint64_t)block[t * 8 + 1] << 48) |
-                           ((uint64_t)block[t * 8 + 2] << 40) |
-                           ((uint64_t)block[t * 8 + 3] << 32) |
-                           ((uint64_t)block[t * 8 + 4] << 24) |
-                           ((uint64_t)block[t * 8 + 5] << 16) |
-                           ((uint64_t)block[t * 8 + 6] << 8) |
-                           ((uint64_t)block[t * 8 + 7]);
-                }
-                for (int t = 16; t < 80; t++) {
-                    w[t] = gamma1_64(w[t - 2]) + w[t - 7] + gamma0_64(w[t - 15]) + w[t - 16];
-                }
-
-                uint64_t a = h[0], b = h[1], c = h[2], d = h[3],
-                         e = h[4], f = h[5], g = h[6], hh = h[7];
-
-                for (int t = 0; t < 80; t++) {
-                    uint64_t t1 = hh + sigma1_64(e) + ch64(e, f, g) + k512[t] + w[t];
-                    uint64_t t2 = sigma0_64(a) + maj64(a, b, c);
-                    hh = g;
-                    g = f;
-                    f = e;
-                    e = d + t1;
-                    d = c;
-                    c = b;
-                    b = a;
-                    a = t1 + t2;
-                }
-
-                h[0] += a; h[1] += b; h[2] += c; h[3] += d;
-                h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
-
-                block_len = 0;
-            }
+    // Process all complete 1024-bit (128-byte) blocks.
+    size_t full = len - len % SHA512_BLOCK_SIZE;
+    for (size_t off = 0; off < full; off += SHA512_BLOCK_SIZE) {
+        sha512_compress(h, data + off);
+    }
 
-            if (block_len <= block_size - 16) {
-                // Pad until the last 16 bytes.
-                memset(block + block_len, 0, (block_size - 16) - block_len);
-                block_len = block_size - 16;
-            }
+    // Pad the tail: '1' bit, zeros, then the 128-bit message length.
+    // The tail plus padding spills into a second block when fewer than
+    // 17 bytes are left in the first one.
+    uint8_t block[2 * SHA512_BLOCK_SIZE] = {0};
+    size_t rem = len - full;
+    memcpy(block, data + full, rem);
+    block[rem] = 0x80;
+    size_t tail = rem + 17 <= SHA512_BLOCK_SIZE ? SHA512_BLOCK_SIZE : 2 * SHA512_BLOCK_SIZE;
+    store_be64(block + tail - 16, (uint64_t)len >> 61);
+    store_be64(block + tail - 8, (uint64_t)len << 3);
 
-            // Append the 128-bit length (we assume bit_len_high is zero).
-            for (int j = 0; j < 8; j++) {
-                block[block_size - 16 + j] = (bit_len_high >> (56 - 8 * j)) & 0xFF;
-            }
-            for (int j = 0; j < 8; j++) {
-                block[block_size - 8 + j] = (bit_len_low >> (56 - 8 * j)) & 0xFF;
-            }
+    sha512_compress(h, block);
+    if (tail > SHA512_BLOCK_SIZE) {
+        sha512_compress(h, block + SHA512_BLOCK_SIZE);
+    }
 
-            // Process the final block.
-            uint64_t w[80];
-            for (int t = 0; t < 16; t++) {
-                w[t] = ((uint64_t)block[t * 8] << 56) |
-                       ((uint64_t)block[t * 8 + 1] << 48) |
-                       ((uint64_t)block[t * 8 + 2] << 40) |
-                       ((uint64_t)block[t * 8 + 3] << 32) |
-                       ((uint64_t)block[t * 8 + 4] << 24) |
-                       ((uint64_t)block[t * 8 + 5] << 16) |
-                       ((uint64_t)block[t * 8 + 6] << 8) |
-                       ((uint64_t)block[t * 8 + 7]);
-            }
-            for (int t = 16; t < 80; t++) {
-                w[t] = gamma1_64(w[t - 2]) + w[t - 7] + gamma0_64(w[t - 15]) + w[t - 16];
-            }
+    // Convert hash values to a big-endian byte array.
+    for (int i = 0; i < 8; i++) {
+        store_be64(digest + i * 8, h[i]);
+    }
+}
 
-            uint64_t a = h[0], b = h[1], c = h[2], d = h[3],
-                     e = h[4], f = h[5], g = h[6], hh = h[7];
-
-            for (int t = 0; t < 80; t++) {
-                uint64_t t1 = hh + sigma1_64(e) + ch64(e, f, g) + k512[t] + w[t];
-                uint64_t t2 = sigma0_64(a) + maj64(a, b, c);
-                hh = g;
-                g = f;
-                f = e;
-                e = d + t1;
-                d = c;
-                c = b;
-                b = a;
-                a = t1 + t2;
-            }
+// ============ MULTI-LANE SHA-512 ============
+//
+// The lane kernels run SHA512_LANES independent compressions in lock-step.
+// State and message words are interleaved by lane (word i of lane l lives at
+// index i * SHA512_LANES + l) so every load and store is a full vector.
 
-            h[0] += a; h[1] += b; h[2] += c; h[3] += d;
-            h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+/**
+ * @brief Portable multi-lane compression: one scalar compression per lane.
+ * @param state Interleaved lane states (8 * SHA512_LANES words).
+ * @param block Interleaved message words (16 * SHA512_LANES words).
+ */
+static void sha512_compress_lanes_scalar(uint64_t *state, const uint64_t *block) {
+    for (int lane = 0; lane < SHA512_LANES; lane++) {
+        uint64_t s[8], w[16];
+        for (int i = 0; i < 8; i++) s[i] = state[i * SHA512_LANES + lane];
+        for (int t = 0; t < 16; t++) w[t] = block[t * SHA512_LANES + lane];
+        sha512_compress_words(s, w);
+        for (int i = 0; i < 8; i++) state[i * SHA512_LANES + lane] = s[i];
+    }
+}
 
-            block_len = 0;
-        }
-        if (i < len) {
-            block[block_len++] = data[i];
-        }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CPTO_HAVE_X86_LANES 1
+
+#define AVX2_ROTR(x, n) \
+    _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+
+/**
+ * @brief 4-lane compression using AVX2, for lanes [base, base + 4).
+ * @param state Interleaved lane states, offset to the first lane.
+ * @param block Interleaved message words, offset to the first lane.
+ */
+__attribute__((target("avx2")))
+static void sha512_compress_x4_avx2(uint64_t *state, const uint64_t *block) {
+    __m256i w[80];
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm256_loadu_si256((const __m256i *)(block + t * SHA512_LANES));
+    }
+    for (int t = 16; t < 80; t++) {
+        __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(w[t - 15], 1),
+                     AVX2_ROTR(w[t - 15], 8)), _mm256_srli_epi64(w[t - 15], 7));
+        __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(w[t - 2], 19),
+                     AVX2_ROTR(w[t - 2], 61)), _mm256_srli_epi64(w[t - 2], 6));
+        w[t] = _mm256_add_epi64(_mm256_add_epi64(s1, w[t - 7]),
+                                _mm256_add_epi64(s0, w[t - 16]));
     }
 
-    // Convert hash values to a big-endian byte array.
+    __m256i v[8];
+    for (int i = 0; i < 8; i++) {
+        v[i] = _mm256_loadu_si256((const __m256i *)(state + i * SHA512_LANES));
+    }
+    __m256i a = v[0], b = v[1], c = v[2], d = v[3],
+            e = v[4], f = v[5], g = v[6], hh = v[7];
+
+    for (int t = 0; t < 80; t++) {
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(e, 14),
+                     AVX2_ROTR(e, 18)), AVX2_ROTR(e, 41));
+        __m256i chv = _mm256_xor_si256(_mm256_and_si256(e, f),
+                                       _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi64(_mm256_add_epi64(hh, S1),
+                     _mm256_add_epi64(_mm256_add_epi64(chv, w[t]),
+                                      _mm256_set1_epi64x((long long)k512[t])));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(a, 28),
+                     AVX2_ROTR(a, 34)), AVX2_ROTR(a, 39));
+        __m256i mj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b),
+                     _mm256_and_si256(a, c)), _mm256_and_si256(b, c));
+        __m256i t2 = _mm256_add_epi64(S0, mj);
+        hh = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi64(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi64(t1, t2);
+    }
+
+    __m256i out[8] = {a, b, c, d, e, f, g, hh};
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)(state + i * SHA512_LANES),
+                            _mm256_add_epi64(v[i], out[i]));
+    }
+}
+
+/**
+ * @brief 8-lane compression using AVX-512F.
+ * @param state Interleaved lane states (8 * SHA512_LANES words).
+ * @param block Interleaved message words (16 * SHA512_LANES words).
+ */
+__attribute__((target("avx512f")))
+static void sha512_compress_x8_avx512(uint64_t *state, const uint64_t *block) {
+    __m512i w[80];
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm512_loadu_si512((const void *)(block + t * SHA512_LANES));
+    }
+    for (int t = 16; t < 80; t++) {
+        __m512i s0 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(w[t - 15], 1),
+                     _mm512_ror_epi64(w[t - 15], 8), _mm512_srli_epi64(w[t - 15], 7), 0x96);
+        __m512i s1 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(w[t - 2], 19),
+                     _mm512_ror_epi64(w[t - 2], 61), _mm512_srli_epi64(w[t - 2], 6), 0x96);
+        w[t] = _mm512_add_epi64(_mm512_add_epi64(s1, w[t - 7]),
+                                _mm512_add_epi64(s0, w[t - 16]));
+    }
+
+    __m512i v[8];
     for (int i = 0; i < 8; i++) {
-        digest[i * 8] = (h[i] >> 56) & 0xFF;
-        digest[i * 8 + 1] = (h[i] >> 48) & 0xFF;
-        digest[i * 8 + 2] = (h[i] >> 40) & 0xFF;
-        digest[i * 8 + 3] = (h[i] >> 32) & 0xFF;
-        digest[i * 8 + 4] = (h[i] >> 24) & 0xFF;
-        digest[i * 8 + 5] = (h[i] >> 16) & 0xFF;
-        digest[i * 8 + 6] = (h[i] >> 8) & 0xFF;
-        digest[i * 8 + 7] = h[i] & 0xFF;
+        v[i] = _mm512_loadu_si512((const void *)(state + i * SHA512_LANES));
+    }
+    __m512i a = v[0], b = v[1], c = v[2], d = v[3],
+            e = v[4], f = v[5], g = v[6], hh = v[7];
+
+    for (int t = 0; t < 80; t++) {
+        // 0x96 = x ^ y ^ z, 0xCA = x ? y : z (choice), 0xE8 = majority
+        __m512i S1 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(e, 14),
+                     _mm512_ror_epi64(e, 18), _mm512_ror_epi64(e, 41), 0x96);
+        __m512i chv = _mm512_ternarylogic_epi64(e, f, g, 0xCA);
+        __m512i t1 = _mm512_add_epi64(_mm512_add_epi64(hh, S1),
+                     _mm512_add_epi64(_mm512_add_epi64(chv, w[t]),
+                                      _mm512_set1_epi64((long long)k512[t])));
+        __m512i S0 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(a, 28),
+                     _mm512_ror_epi64(a, 34), _mm512_ror_epi64(a, 39), 0x96);
+        __m512i t2 = _mm512_add_epi64(S0, _mm512_ternarylogic_epi64(a, b, c, 0xE8));
+        hh = g;
+        g = f;
+        f = e;
+        e = _mm512_add_epi64(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm512_add_epi64(t1, t2);
+    }
+
+    __m512i out[8] = {a, b, c, d, e, f, g, hh};
+    for (int i = 0; i < 8; i++) {
+        _mm512_storeu_si512((void *)(state + i * SHA512_LANES),
+                            _mm512_add_epi64(v[i], out[i]));
+    }
+}
+
+/**
+ * @brief Both AVX2 halves of an 8-lane compression.
+ * @param state Interleaved lane states (8 * SHA512_LANES words).
+ * @param block Interleaved message words (16 * SHA512_LANES words).
+ */
+static void sha512_compress_lanes_avx2(uint64_t *state, const uint64_t *block) {
+    sha512_compress_x4_avx2(state, block);
+    sha512_compress_x4_avx2(state + 4, block + 4);
+}
+#endif
+
+/** @brief Lane kernel chosen on first use from the CPU features. */
+typedef void (*sha512_lanes_fn)(uint64_t *, const uint64_t *);
+
+/**
+ * @brief Picks the widest lane kernel the running CPU supports.
+ * @return Kernel function pointer.
+ */
+static sha512_lanes_fn sha512_select_lanes(void) {
+#ifdef CPTO_HAVE_X86_LANES
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return sha512_compress_x8_avx512;
+    if (__builtin_cpu_supports("avx2")) return sha512_compress_lanes_avx2;
+#endif
+    return sha512_compress_lanes_scalar;
+}
+
+void sha512_compress_lanes(uint64_t state[8 * SHA512_LANES],
+                           const uint64_t block[16 * SHA512_LANES]) {
+    static _Atomic(sha512_lanes_fn) selected = NULL;
+    sha512_lanes_fn kernel = atomic_load_explicit(&selected, memory_order_relaxed);
+    if (!kernel) {
+        kernel = sha512_select_lanes();
+        atomic_store_explicit(&selected, kernel, memory_order_relaxed);
     }
+    kernel(state, block);
 }
 
 /**
@@ -405,6 +764,69 @@ void hmac_sha512(const uint8_t *key, size_t keylen,
     sha512(outer_data, SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE, digest);
 }
 
+/**
+ * @brief Multi-lane HMAC-SHA512 of one short message per lane.
+ * @param keys Per-lane keys (all keylen bytes, keylen <= 128).
+ * @param keylen Length of every key.
+ * @param msgs Per-lane messages (all msglen bytes, msglen <= 111).
+ * @param msglen Length of every message.
+ * @param digests Output: one 64-byte digest per lane.
+ */
+void hmac_sha512_lanes(const uint8_t *const keys[SHA512_LANES], size_t keylen,
+                       const uint8_t *const msgs[SHA512_LANES], size_t msglen,
+                       uint8_t digests[SHA512_LANES][SHA512_DIGEST_SIZE]) {
+    static const uint64_t iv[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+        0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+        0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    uint64_t istate[8 * SHA512_LANES], ostate[8 * SHA512_LANES];
+    uint64_t block[16 * SHA512_LANES];
+
+    // Pad blocks: (key ^ ipad) and (key ^ opad), one compression each.
+    for (int pad = 0; pad < 2; pad++) {
+        uint8_t xor_byte = pad ? 0x5c : 0x36;
+        uint64_t *state = pad ? ostate : istate;
+        for (int lane = 0; lane < SHA512_LANES; lane++) {
+            uint8_t k[SHA512_BLOCK_SIZE] = {0};
+            memcpy(k, keys[lane], keylen);
+            for (int t = 0; t < 16; t++) {
+                uint8_t w[8];
+                for (int j = 0; j < 8; j++) w[j] = k[t * 8 + j] ^ xor_byte;
+                block[t * SHA512_LANES + lane] = load_be64(w);
+            }
+            for (int i = 0; i < 8; i++) state[i * SHA512_LANES + lane] = iv[i];
+        }
+        sha512_compress_lanes(state, block);
+    }
+
+    // Inner: message, padding and length in a single block.
+    for (int lane = 0; lane < SHA512_LANES; lane++) {
+        uint8_t m[SHA512_BLOCK_SIZE] = {0};
+        memcpy(m, msgs[lane], msglen);
+        m[msglen] = 0x80;
+        store_be64(m + SHA512_BLOCK_SIZE - 8, (uint64_t)(SHA512_BLOCK_SIZE + msglen) << 3);
+        for (int t = 0; t < 16; t++) block[t * SHA512_LANES + lane] = load_be64(m + t * 8);
+    }
+    sha512_compress_lanes(istate, block);
+
+    // Outer: inner digest words, padding and length.
+    for (int lane = 0; lane < SHA512_LANES; lane++) {
+        for (int t = 0; t < 8; t++) block[t * SHA512_LANES + lane] = istate[t * SHA512_LANES + lane];
+        block[8 * SHA512_LANES + lane] = 0x8000000000000000ULL;
+        for (int t = 9; t < 15; t++) block[t * SHA512_LANES + lane] = 0;
+        block[15 * SHA512_LANES + lane] = (SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE) * 8;
+    }
+    sha512_compress_lanes(ostate, block);
+
+    for (int lane = 0; lane < SHA512_LANES; lane++) {
+        for (int i = 0; i < 8; i++) store_be64(digests[lane] + i * 8, ostate[i * SHA512_LANES + lane]);
+    }
+    memset(istate, 0, sizeof(istate));
+    memset(block, 0, sizeof(block));
+}
+
 /**
  * @brief PBKDF2-HMAC-SHA512 implementation.
  * @param password The password to derive the key from.
@@ -459,4 +881,226 @@ void pbkdf2_hmac_sha512(
             if (++counter[i] != 0) break;
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Multi-lane PBKDF2-HMAC-SHA512 implementation (first 64-byte block only).
+ * @param passwords Per-lane passwords.
+ * @param password_lens Length of each password.
+ * @param salts Per-lane salts.
+ * @param salt_lens Length of each salt.
+ * @param iterations Number of iterations.
+ * @param lanes Lanes in use, 1 to SHA512_LANES.
+ * @param outputs The output buffers for the derived keys.
+ */
+void pbkdf2_hmac_sha512_lanes(const uint8_t *const passwords[SHA512_LANES],
+                              const size_t password_lens[SHA512_LANES],
+                              const uint8_t *const salts[SHA512_LANES],
+                              const size_t salt_lens[SHA512_LANES],
+                              uint32_t iterations, size_t lanes,
+                              uint8_t outputs[SHA512_LANES][SHA512_DIGEST_SIZE]) {
+    static const uint64_t iv[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+        0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+        0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    if (lanes == 0 || lanes > SHA512_LANES) return;
+    uint64_t istate[8 * SHA512_LANES], ostate[8 * SHA512_LANES];
+    uint64_t state[8 * SHA512_LANES], block[16 * SHA512_LANES];
+    uint64_t u[8 * SHA512_LANES], t[8 * SHA512_LANES];
+
+    // Pad midstates, as in hmac_sha512_lanes; keys over one block are hashed first
+    for (int pad = 0; pad < 2; pad++) {
+        uint8_t xor_byte = pad ? 0x5c : 0x36;
+        uint64_t *mid = pad ? ostate : istate;
+        for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+            size_t src = lane < lanes ? lane : 0;
+            uint8_t k[SHA512_BLOCK_SIZE] = {0};
+            if (password_lens[src] > SHA512_BLOCK_SIZE) {
+                sha512(passwords[src], password_lens[src], k);
+            } else {
+                memcpy(k, passwords[src], password_lens[src]);
+            }
+            for (int w = 0; w < 16; w++) {
+                uint8_t b[8];
+                for (int j = 0; j < 8; j++) b[j] = k[w * 8 + j] ^ xor_byte;
+                block[w * SHA512_LANES + lane] = load_be64(b);
+            }
+            for (int i = 0; i < 8; i++) mid[i * SHA512_LANES + lane] = iv[i];
+            memset(k, 0, sizeof(k));
+        }
+        sha512_compress_lanes(mid, block);
+    }
+
+    // U1 = HMAC(password, salt || 00000001): salts differ in length, so one lane at a time
+    for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+        size_t src = lane < lanes ? lane : 0;
+        uint8_t msg[salt_lens[src] + 4];
+        uint8_t digest[SHA512_DIGEST_SIZE];
+        memcpy(msg, salts[src], salt_lens[src]);
+        memcpy(msg + salt_lens[src], "\0\0\0\1", 4);
+        hmac_sha512(passwords[src], password_lens[src], msg, sizeof(msg), digest);
+        for (int i = 0; i < 8; i++) {
+            u[i * SHA512_LANES + lane] = t[i * SHA512_LANES + lane] = load_be64(digest + i * 8);
+        }
+        memset(msg, 0, sizeof(msg));
+        memset(digest, 0, sizeof(digest));
+    }
+
+    // U2..Un: two multi-lane compressions per round, words stay interleaved
+    memset(block, 0, sizeof(block));
+    for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+        block[8 * SHA512_LANES + lane] = 0x8000000000000000ULL;
+        block[15 * SHA512_LANES + lane] = (SHA512_BLOCK_SIZE + SHA512_DIGEST_SIZE) * 8;
+    }
+    for (uint32_t round = 1; round < iterations; round++) {
+        memcpy(block, u, sizeof(u));
+        memcpy(state, istate, sizeof(state));
+        sha512_compress_lanes(state, block);
+        memcpy(block, state, sizeof(u));
+        memcpy(u, ostate, sizeof(u));
+        sha512_compress_lanes(u, block);
+        for (size_t i = 0; i < 8 * SHA512_LANES; i++) t[i] ^= u[i];
+    }
+
+    for (size_t lane = 0; lane < lanes; lane++) {
+        for (int i = 0; i < 8; i++) store_be64(outputs[lane] + i * 8, t[i * SHA512_LANES + lane]);
+    }
+    memset(istate, 0, sizeof(istate));
+    memset(ostate, 0, sizeof(ostate));
+    memset(state, 0, sizeof(state));
+    memset(block, 0, sizeof(block));
+    memset(u, 0, sizeof(u));
+    memset(t, 0, sizeof(t));
+}
+
+// ============ RIPEMD-160 ============
+
+// Message word selection and rotation amounts for the left and right lines.
+static const uint8_t rmd_r[80] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+    3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+    1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+    4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+};
+static const uint8_t rmd_rp[80] = {
+    5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+    6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+    15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+    8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+    12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+};
+static const uint8_t rmd_s[80] = {
+    11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+    7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+    11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+    11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+    9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+};
+static const uint8_t rmd_sp[80] = {
+    8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+    9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+    9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+    15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+    8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+};
+static const uint32_t rmd_k[5] = {
+    0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e
+};
+static const uint32_t rmd_kp[5] = {
+    0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000
+};
+
+/**
+ * @brief RIPEMD-160 round function for round group j (0-4).
+ * @param j Round group.
+ * @param x First word.
+ * @param y Second word.
+ * @param z Third word.
+ * @return f_j(x, y, z).
+ */
+static inline uint32_t rmd_f(int j, uint32_t x, uint32_t y, uint32_t z) {
+    switch (j) {
+        case 0: return x ^ y ^ z;
+        case 1: return (x & y) | (~x & z);
+        case 2: return (x | ~y) ^ z;
+        case 3: return (x & z) | (y & ~z);
+        default: return x ^ (y | ~z);
+    }
+}
+
+/**
+ * @brief Left rotation of a 32-bit word.
+ * @param x Word to rotate.
+ * @param n Rotation amount (1-31).
+ * @return Rotated word.
+ */
+static inline uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+/**
+ * @brief RIPEMD-160 compression of one 64-byte block.
+ * @param h Chaining state, updated in place.
+ * @param block The 64-byte block.
+ */
+static void ripemd160_compress(uint32_t h[5], const uint8_t block[64]) {
+    uint32_t x[16];
+    for (int i = 0; i < 16; i++) {
+        x[i] = (uint32_t)block[i * 4] | ((uint32_t)block[i * 4 + 1] << 8) |
+               ((uint32_t)block[i * 4 + 2] << 16) | ((uint32_t)block[i * 4 + 3] << 24);
+    }
+
+    uint32_t al = h[0], bl = h[1], cl = h[2], dl = h[3], el = h[4];
+    uint32_t ar = h[0], br = h[1], cr = h[2], dr = h[3], er = h[4];
+
+    for (int j = 0; j < 80; j++) {
+        int g = j / 16;
+        uint32_t t = rotl(al + rmd_f(g, bl, cl, dl) + x[rmd_r[j]] + rmd_k[g], rmd_s[j]) + el;
+        al = el; el = dl; dl = rotl(cl, 10); cl = bl; bl = t;
+
+        t = rotl(ar + rmd_f(4 - g, br, cr, dr) + x[rmd_rp[j]] + rmd_kp[g], rmd_sp[j]) + er;
+        ar = er; er = dr; dr = rotl(cr, 10); cr = br; br = t;
+    }
+
+    uint32_t t = h[1] + cl + dr;
+    h[1] = h[2] + dl + er;
+    h[2] = h[3] + el + ar;
+    h[3] = h[4] + al + br;
+    h[4] = h[0] + bl + cr;
+    h[0] = t;
+}
+
+void ripemd160(const uint8_t *data, size_t len, uint8_t digest[RIPEMD160_DIGEST_SIZE]) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+    size_t full = len - len % 64;
+    for (size_t off = 0; off < full; off += 64) {
+        ripemd160_compress(h, data + off);
+    }
+
+    // Tail, '1' bit, zeros and the 64-bit little-endian bit length.
+    uint8_t block[128] = {0};
+    size_t rem = len - full;
+    memcpy(block, data + full, rem);
+    block[rem] = 0x80;
+    size_t tail = rem + 9 <= 64 ? 64 : 128;
+    uint64_t bit_len = (uint64_t)len << 3;
+    for (int i = 0; i < 8; i++) {
+        block[tail - 8 + i] = (bit_len >> (8 * i)) & 0xFF;
+    }
+
+    ripemd160_compress(h, block);
+    if (tail > 64) {
+        ripemd160_compress(h, block + 64);
+    }
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = h[i] & 0xFF;
+        digest[i * 4 + 1] = (h[i] >> 8) & 0xFF;
+        digest[i * 4 + 2] = (h[i] >> 16) & 0xFF;
+        digest[i * 4 + 3] = (h[i] >> 24) & 0xFF;
+    }
+}
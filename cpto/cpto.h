@@ -14,6 +14,9 @@
 extern "C" {
 #endif
 
+#define SHA256_BLOCK_SIZE 64
+#define SHA256_DIGEST_SIZE 32
+
 /**
  * @brief Computes the SHA-256 hash of the input data.
  * @param[in] data Pointer to the input data to be hashed.
@@ -23,6 +26,43 @@ extern "C" {
  */
 void sha256(const uint8_t *data, size_t len, uint8_t hash[32]);
 
+/**
+ * @brief SHA-256 compression of one 64-byte block into a running state.
+ * @param state Chaining state (eight 32-bit words), updated in place.
+ * @param block The 64-byte message block.
+ * @note Uses the x86 SHA extensions when the CPU has them.
+ */
+void sha256_compress(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]);
+
+/**
+ * @brief HMAC-SHA256 implementation.
+ * @param key The key to use for HMAC.
+ * @param keylen Length of the key.
+ * @param data The data to hash.
+ * @param datalen Length of the data.
+ * @param digest Output buffer for the HMAC digest.
+ */
+void hmac_sha256(const uint8_t *key, size_t keylen,
+                 const uint8_t *data, size_t datalen,
+                 uint8_t digest[SHA256_DIGEST_SIZE]);
+
+/**
+ * @brief PBKDF2-HMAC-SHA256 implementation.
+ * @param password The password to derive the key from.
+ * @param password_len Length of the password.
+ * @param salt The salt to use.
+ * @param salt_len Length of the salt.
+ * @param iterations Number of iterations.
+ * @param output The output buffer for the derived key.
+ * @param output_len Length of the derived key.
+ * @note The pad midstates are computed once, so each iteration costs two
+ *       block compressions.
+ */
+void pbkdf2_hmac_sha256(const uint8_t *password, size_t password_len,
+                        const uint8_t *salt, size_t salt_len,
+                        uint32_t iterations,
+                        uint8_t *output, size_t output_len);
+
 #define SHA512_BLOCK_SIZE 128
 #define SHA512_DIGEST_SIZE 64
 
@@ -33,6 +73,35 @@ void sha256(const uint8_t *data, size_t len, uint8_t hash[32]);
  * @param digest Output buffer for the 64-byte hash.
  */
 void sha512(const uint8_t *data, size_t len, uint8_t digest[SHA512_DIGEST_SIZE]);
+
+/**
+ * @brief SHA-512 compression of one 128-byte block into a running state.
+ * @param state Chaining state (eight 64-bit words), updated in place.
+ * @param block The 128-byte message block.
+ * @note Exposed so callers can precompute midstates (e.g. HMAC pads).
+ */
+void sha512_compress(uint64_t state[8], const uint8_t block[SHA512_BLOCK_SIZE]);
+
+/**
+ * @brief SHA-512 compression of one block given as 16 host-order words.
+ * @param state Chaining state (eight 64-bit words), updated in place.
+ * @param block The message block as sixteen 64-bit words.
+ */
+void sha512_compress_words(uint64_t state[8], const uint64_t block[16]);
+
+/** @brief Number of independent compressions done by sha512_compress_lanes() */
+#define SHA512_LANES 8
+
+/**
+ * @brief Multi-lane SHA-512 compression (one block per lane, all lanes at once).
+ * @param state Lane states, interleaved: word i of lane l at [i * SHA512_LANES + l].
+ * @param block Message words, interleaved the same way (host order, 16 per lane).
+ * @note Uses AVX-512F (8 lanes per step) or AVX2 (2 x 4 lanes) when the CPU
+ *       supports it, and a scalar loop otherwise. Unused lanes are harmless.
+ */
+void sha512_compress_lanes(uint64_t state[8 * SHA512_LANES],
+                           const uint64_t block[16 * SHA512_LANES]);
+
 /**
  * @brief HMAC-SHA512 implementation.
  * @param key The key to use for HMAC.
@@ -45,6 +114,21 @@ void hmac_sha512(const uint8_t *key, size_t keylen,
     const uint8_t *data, size_t datalen, 
     uint8_t digest[SHA512_DIGEST_SIZE]);
 
+/**
+ * @brief Multi-lane HMAC-SHA512 of one short message per lane.
+ * @param keys Per-lane keys (all keylen bytes, keylen <= 128).
+ * @param keylen Length of every key.
+ * @param msgs Per-lane messages (all msglen bytes, msglen <= 111).
+ * @param msglen Length of every message.
+ * @param digests Output: one 64-byte digest per lane.
+ * @note Four sha512_compress_lanes() calls for all lanes together; meant for
+ *       BIP-32 child derivation (32-byte chain code key, 37-byte message).
+ *       Unused lanes can simply repeat another lane's inputs.
+ */
+void hmac_sha512_lanes(const uint8_t *const keys[SHA512_LANES], size_t keylen,
+                       const uint8_t *const msgs[SHA512_LANES], size_t msglen,
+                       uint8_t digests[SHA512_LANES][SHA512_DIGEST_SIZE]);
+
 /**
  * @brief PBKDF2-HMAC-SHA512 implementation.
  * @param password The password to derive the key from.
@@ -61,6 +145,37 @@ void pbkdf2_hmac_sha512(
     const uint8_t *salt, size_t salt_len,
     uint32_t iterations,
     uint8_t *output, size_t output_len);
+
+/**
+ * @brief Multi-lane PBKDF2-HMAC-SHA512, one password and salt per lane, 64-byte output.
+ * @param passwords Per-lane passwords.
+ * @param password_lens Length of each password.
+ * @param salts Per-lane salts.
+ * @param salt_lens Length of each salt.
+ * @param iterations Number of iterations.
+ * @param lanes Lanes in use (1 to SHA512_LANES); the others are neither read nor written.
+ * @param outputs Output: the first 64-byte block of each derived key.
+ * @note After the first round every lane does the same work, so each round
+ *       is two sha512_compress_lanes() calls for all lanes; meant for
+ *       BIP-39 seeds (2048 rounds, 64 bytes).
+ */
+void pbkdf2_hmac_sha512_lanes(const uint8_t *const passwords[SHA512_LANES],
+                              const size_t password_lens[SHA512_LANES],
+                              const uint8_t *const salts[SHA512_LANES],
+                              const size_t salt_lens[SHA512_LANES],
+                              uint32_t iterations, size_t lanes,
+                              uint8_t outputs[SHA512_LANES][SHA512_DIGEST_SIZE]);
+
+#define RIPEMD160_DIGEST_SIZE 20
+
+/**
+ * @brief RIPEMD-160 implementation.
+ * @param data Input data to hash.
+ * @param len Length of the input data in bytes.
+ * @param digest Output buffer for the 20-byte hash.
+ */
+void ripemd160(const uint8_t *data, size_t len, uint8_t digest[RIPEMD160_DIGEST_SIZE]);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,200 @@
+/**
+ * @file descriptor.c
+ * @brief Output script descriptors (BIP-380 family) with in-tree checksums.
+ * @details The checksum is the BCH code from BIP-380, computed here so no
+ *          `bitcoin-cli getdescriptorinfo` round trip is needed.
+ */
+#include "descriptor.h"
+
+#include <string.h>
+
+#include <openssl/crypto.h>
+
+/** @brief Characters allowed in descriptors, grouped by 32 */
+static const char INPUT_CHARSET[] =
+    "0123456789()[],'/*abcdefgh@:$%{}"
+    "IJKLMNOPQRSTUVWXYZ&+-.;<=>?!^_|~"
+    "ijklmnopqrstuvwxyzABCDEFGH`#\"\\ ";
+
+/** @brief Characters of the checksum itself */
+static const char CHECKSUM_CHARSET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+/**
+ * @brief One step of the descriptor checksum polymod.
+ * @param c Running checksum state.
+ * @param val Next 5-bit symbol.
+ * @return Updated state.
+ */
+static uint64_t polymod(uint64_t c, int val) {
+    uint8_t c0 = c >> 35;
+    c = ((c & 0x7ffffffffULL) << 5) ^ (uint64_t)val;
+    if (c0 & 1) c ^= 0xf5dee51989ULL;
+    if (c0 & 2) c ^= 0xa9fdca3312ULL;
+    if (c0 & 4) c ^= 0x1bab10e32dULL;
+    if (c0 & 8) c ^= 0x3706b1677aULL;
+    if (c0 & 16) c ^= 0x644d626ffdULL;
+    return c;
+}
+
+int descriptor_checksum(const char *desc, char checksum[DESCRIPTOR_CHECKSUM_LENGTH + 1]) {
+    if (desc == NULL || checksum == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint64_t c = 1;
+    int cls = 0;
+    int clscount = 0;
+    for (const char *p = desc; *p != '\0'; p++) {
+        const char *pos = strchr(INPUT_CHARSET, *p);
+        if (pos == NULL) {
+            return ERROR_INVALID_INPUT;
+        }
+        int v = (int)(pos - INPUT_CHARSET);
+        // Low 5 bits go in directly, the group number in triples
+        c = polymod(c, v & 31);
+        cls = cls * 3 + (v >> 5);
+        if (++clscount == 3) {
+            c = polymod(c, cls);
+            cls = 0;
+            clscount = 0;
+        }
+    }
+    if (clscount > 0) {
+        c = polymod(c, cls);
+    }
+    for (int j = 0; j < DESCRIPTOR_CHECKSUM_LENGTH; j++) {
+        c = polymod(c, 0);
+    }
+    c ^= 1;
+
+    for (int j = 0; j < DESCRIPTOR_CHECKSUM_LENGTH; j++) {
+        checksum[j] = CHECKSUM_CHARSET[(c >> (5 * (7 - j))) & 31];
+    }
+    checksum[DESCRIPTOR_CHECKSUM_LENGTH] = '\0';
+    return SUCCESS;
+}
+
+int descriptor_append_checksum(char *desc, size_t size) {
+    if (desc == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    size_t len = strlen(desc);
+    if (len + 1 + DESCRIPTOR_CHECKSUM_LENGTH + 1 > size) {
+        return ERROR_INVALID_LENGTH;
+    }
+
+    char checksum[DESCRIPTOR_CHECKSUM_LENGTH + 1];
+    int result = descriptor_checksum(desc, checksum);
+    if (result != SUCCESS) {
+        return result;
+    }
+    desc[len] = '#';
+    memcpy(desc + len + 1, checksum, DESCRIPTOR_CHECKSUM_LENGTH + 1);
+    return SUCCESS;
+}
+
+uint32_t descriptor_purpose(descriptor_type type) {
+    switch (type) {
+        case DESCRIPTOR_PKH: return 44;
+        case DESCRIPTOR_SH_WPKH: return 49;
+        case DESCRIPTOR_WPKH: return 84;
+        default: return 86;
+    }
+}
+
+int descriptor_type_from_name(const char *name, descriptor_type *type) {
+    if (name == NULL || type == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (strcmp(name, "pkh") == 0) {
+        *type = DESCRIPTOR_PKH;
+    } else if (strcmp(name, "sh-wpkh") == 0) {
+        *type = DESCRIPTOR_SH_WPKH;
+    } else if (strcmp(name, "wpkh") == 0) {
+        *type = DESCRIPTOR_WPKH;
+    } else if (strcmp(name, "tr") == 0) {
+        *type = DESCRIPTOR_TR;
+    } else {
+        return ERROR_INVALID_INPUT;
+    }
+    return SUCCESS;
+}
+
+int descriptor_for_account_xpub(descriptor_type type, uint32_t master_fingerprint,
+                                uint32_t account, const char *xpub,
+                                uint32_t chain, char *out, size_t size) {
+    if (xpub == NULL || out == NULL || account >= BIP32_HARDENED) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    static const char *const open[] = {"pkh(", "sh(wpkh(", "wpkh(", "tr("};
+    static const char *const close[] = {")", "))", ")", ")"};
+
+    int n = snprintf(out, size, "%s[%08x/%u'/0'/%u']%s/%u/*%s",
+                     open[type], master_fingerprint, descriptor_purpose(type),
+                     account, xpub, chain, close[type]);
+    if (n < 0 || (size_t)n >= size) {
+        return ERROR_INVALID_LENGTH;
+    }
+    return descriptor_append_checksum(out, size);
+}
+
+int descriptor_write_accounts(FILE *out, const byte *private_key,
+                              const byte *chain_code, descriptor_type type,
+                              uint32_t first_account, uint32_t count) {
+    if (out == NULL || private_key == NULL || chain_code == NULL ||
+        (uint64_t)first_account + count > BIP32_HARDENED) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte master_public[PUBLIC_KEY_LENGTH];
+    int result = private_key_to_public_key(private_key, master_public);
+    if (result != SUCCESS) {
+        return result;
+    }
+    uint32_t master_fingerprint = public_key_fingerprint(master_public);
+
+    /* Shared hardened prefix m/purpose'/0' */
+    uint32_t prefix[2] = {descriptor_purpose(type) | BIP32_HARDENED, BIP32_HARDENED};
+    byte coin_key[PRIVATE_KEY_LENGTH], coin_chain[CHAIN_CODE_LENGTH];
+    byte coin_public[PUBLIC_KEY_LENGTH];
+    result = derive_bip32_path(private_key, chain_code, prefix, 2,
+                               coin_key, coin_chain, NULL);
+    if (result == SUCCESS) {
+        result = private_key_to_public_key(coin_key, coin_public);
+    }
+    uint32_t coin_fingerprint = result == SUCCESS ? public_key_fingerprint(coin_public) : 0;
+
+    byte account_key[PRIVATE_KEY_LENGTH], account_chain[CHAIN_CODE_LENGTH];
+    byte account_public[PUBLIC_KEY_LENGTH];
+    byte xpub[112];
+    char desc[DESCRIPTOR_MAX_LENGTH];
+    for (uint32_t i = 0; i < count && result == SUCCESS; i++) {
+        uint32_t account = first_account + i;
+        result = derive_bip32_child_key(coin_key, coin_chain, account | BIP32_HARDENED,
+                                        account_key, account_chain);
+        if (result == SUCCESS) {
+            result = private_key_to_public_key(account_key, account_public);
+        }
+        if (result == SUCCESS) {
+            result = generate_extended_xpub(account_public, account_chain, 3,
+                                            coin_fingerprint, account | BIP32_HARDENED,
+                                            xpub);
+        }
+        for (uint32_t chain = 0; chain < 2 && result == SUCCESS; chain++) {
+            result = descriptor_for_account_xpub(type, master_fingerprint, account,
+                                                 (const char *)xpub, chain,
+                                                 desc, sizeof(desc));
+            if (result == SUCCESS) {
+                fprintf(out, "%s\n", desc);
+            }
+        }
+    }
+
+    OPENSSL_cleanse(coin_key, sizeof(coin_key));
+    OPENSSL_cleanse(coin_chain, sizeof(coin_chain));
+    OPENSSL_cleanse(account_key, sizeof(account_key));
+    OPENSSL_cleanse(account_chain, sizeof(account_chain));
+    return result;
+}
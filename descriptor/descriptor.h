@@ -0,0 +1,99 @@
+/**
+ * @file descriptor.h
+ * @brief Output script descriptors (BIP-380 family) with in-tree checksums.
+ * @details Builds pkh/sh(wpkh)/wpkh/tr account descriptors with key origin
+ *          info and computes the descriptor checksum without a node.
+ */
+
+#ifndef DESCRIPTOR_H
+#define DESCRIPTOR_H
+
+#include <stdio.h>   // For FILE
+
+#include "../hdkey/hdkey.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Number of characters in a descriptor checksum */
+#define DESCRIPTOR_CHECKSUM_LENGTH 8
+
+/** @brief Buffer size that fits any account descriptor built here */
+#define DESCRIPTOR_MAX_LENGTH 256
+
+/** @brief Script type of an account descriptor, with its BIP purpose */
+typedef enum {
+    DESCRIPTOR_PKH,      ///< pkh(), BIP-44
+    DESCRIPTOR_SH_WPKH,  ///< sh(wpkh()), BIP-49
+    DESCRIPTOR_WPKH,     ///< wpkh(), BIP-84
+    DESCRIPTOR_TR        ///< tr(), BIP-86
+} descriptor_type;
+
+/**
+ * @brief Computes the checksum of a descriptor (the part after '#').
+ * @param desc Descriptor without checksum.
+ * @param checksum Output, DESCRIPTOR_CHECKSUM_LENGTH characters + NUL.
+ * @return 0 on success, ERROR_INVALID_INPUT if desc has a character outside
+ *         the descriptor character set.
+ */
+int descriptor_checksum(const char *desc, char checksum[DESCRIPTOR_CHECKSUM_LENGTH + 1]);
+
+/**
+ * @brief Appends "#<checksum>" to a descriptor in place.
+ * @param desc Descriptor buffer.
+ * @param size Size of the buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+int descriptor_append_checksum(char *desc, size_t size);
+
+/**
+ * @brief BIP purpose (44, 49, 84 or 86) of a descriptor type.
+ * @param type Descriptor type.
+ * @return The purpose number.
+ */
+uint32_t descriptor_purpose(descriptor_type type);
+
+/**
+ * @brief Parses "pkh", "sh-wpkh", "wpkh" or "tr".
+ * @param name Type name.
+ * @param type Output type.
+ * @return 0 on success, ERROR_INVALID_INPUT for an unknown name.
+ */
+int descriptor_type_from_name(const char *name, descriptor_type *type);
+
+/**
+ * @brief Builds a checksummed account descriptor from an account xpub.
+ * @param type Descriptor type.
+ * @param master_fingerprint Fingerprint of the master key.
+ * @param account Account number (hardened in the origin path).
+ * @param xpub Account xpub (at m/purpose'/0'/account').
+ * @param chain 0 for receive, 1 for change.
+ * @param out Output buffer (DESCRIPTOR_MAX_LENGTH is enough).
+ * @param size Size of the output buffer.
+ * @return 0 on success, negative error code on failure.
+ */
+int descriptor_for_account_xpub(descriptor_type type, uint32_t master_fingerprint,
+                                uint32_t account, const char *xpub,
+                                uint32_t chain, char *out, size_t size);
+
+/**
+ * @brief Batch mode: writes receive and change descriptors for many accounts.
+ * @param out Stream to write one descriptor per line to.
+ * @param private_key 32-byte master private key.
+ * @param chain_code 32-byte master chain code.
+ * @param type Descriptor type.
+ * @param first_account First account number.
+ * @param count Number of accounts.
+ * @return 0 on success, negative error code on failure.
+ * @note m/purpose'/0' is derived once and shared by every account.
+ */
+int descriptor_write_accounts(FILE *out, const byte *private_key,
+                              const byte *chain_code, descriptor_type type,
+                              uint32_t first_account, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DESCRIPTOR_H
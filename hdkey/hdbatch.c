@@ -0,0 +1,269 @@
+/**
+ * @file hdbatch.c
+ * @brief Structure-of-arrays container for batches of BIP-32 extended keys.
+ * @details Child derivation runs SHA512_LANES HMACs at a time through
+ *          hmac_sha512_lanes(); the curve arithmetic stays per key.
+ */
+#include "hdbatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+
+#include "../cpto/cpto.h"
+
+/**
+ * @brief Rounds a size up to the lane alignment
+ * @param n Size in bytes.
+ * @return n rounded up to a multiple of HDBATCH_ALIGNMENT.
+ */
+static size_t align_up(size_t n) {
+    return (n + HDBATCH_ALIGNMENT - 1) & ~(size_t)(HDBATCH_ALIGNMENT - 1);
+}
+
+int hdkey_batch_init(hdkey_batch *batch, size_t capacity) {
+    if (batch == NULL || capacity == 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(batch, 0, sizeof(*batch));
+
+    // One allocation, every lane array starting on its own 64-byte boundary.
+    size_t chain_size = align_up(capacity * CHAIN_CODE_LENGTH);
+    size_t key_size = align_up(capacity * PRIVATE_KEY_LENGTH);
+    size_t pub_size = align_up(capacity * PUBLIC_KEY_LENGTH);
+    size_t depth_size = align_up(capacity * sizeof(uint8_t));
+    size_t word_size = align_up(capacity * sizeof(uint32_t));
+    size_t total = chain_size + key_size + pub_size + depth_size + 2 * word_size;
+
+    void *block = NULL;
+    if (posix_memalign(&block, HDBATCH_ALIGNMENT, total) != 0) {
+        return ERROR_INTERNAL;
+    }
+    memset(block, 0, total);
+
+    byte *p = block;
+    batch->chain_codes = p;
+    p += chain_size;
+    batch->private_keys = p;
+    p += key_size;
+    batch->public_keys = p;
+    p += pub_size;
+    batch->depths = p;
+    p += depth_size;
+    batch->child_numbers = (uint32_t *)p;
+    p += word_size;
+    batch->parent_fingerprints = (uint32_t *)p;
+
+    batch->capacity = capacity;
+    return SUCCESS;
+}
+
+void hdkey_batch_free(hdkey_batch *batch) {
+    if (batch == NULL || batch->chain_codes == NULL) {
+        return;
+    }
+    // chain_codes is the start of the single allocation
+    OPENSSL_cleanse(batch->chain_codes, batch->capacity * CHAIN_CODE_LENGTH);
+    OPENSSL_cleanse(batch->private_keys, batch->capacity * PRIVATE_KEY_LENGTH);
+    free(batch->chain_codes);
+    memset(batch, 0, sizeof(*batch));
+}
+
+int hdkey_batch_from_seeds(hdkey_batch *batch, const byte *seeds, size_t count) {
+    if (batch == NULL || seeds == NULL || count > batch->capacity) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    int result = derive_bip32_master_keys_batch(seeds, count, batch->private_keys,
+                                                batch->chain_codes);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    memset(batch->depths, 0, count * sizeof(uint8_t));
+    memset(batch->child_numbers, 0, count * sizeof(uint32_t));
+    memset(batch->parent_fingerprints, 0, count * sizeof(uint32_t));
+    batch->count = count;
+    batch->has_public_keys = 0;
+    return SUCCESS;
+}
+
+int hdkey_batch_public_keys(hdkey_batch *batch) {
+    if (batch == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (batch->has_public_keys) {
+        return SUCCESS;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        int result = private_key_to_public_key(batch->private_keys + i * PRIVATE_KEY_LENGTH,
+                                               batch->public_keys + i * PUBLIC_KEY_LENGTH);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    batch->has_public_keys = 1;
+    return SUCCESS;
+}
+
+/**
+ * @brief Derives up to SHA512_LANES children in one multi-lane HMAC step
+ * @param parent Parent batch, public keys already computed.
+ * @param parent_lanes Parent lane of each child.
+ * @param indices Child index of each child.
+ * @param fingerprints Fingerprint of each child's parent.
+ * @param n Number of children (1..SHA512_LANES).
+ * @param child Destination batch.
+ * @param out Lane of the first child in the destination.
+ * @return 0 on success, negative error code on failure.
+ */
+static int derive_group(const hdkey_batch *parent, const size_t *parent_lanes,
+                        const uint32_t *indices, const uint32_t *fingerprints,
+                        size_t n, hdkey_batch *child, size_t out) {
+    byte data[SHA512_LANES][PUBLIC_KEY_LENGTH + 4];
+    const byte *keys[SHA512_LANES];
+    const byte *msgs[SHA512_LANES];
+    byte digests[SHA512_LANES][SHA512_DIGEST_SIZE];
+
+    for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+        // Spare lanes repeat the first child; their output is dropped
+        size_t src = lane < n ? lane : 0;
+        size_t p = parent_lanes[src];
+        uint32_t index = indices[src];
+
+        // Hardened: 0x00 || key || index, normal: pubkey || index
+        if (index >= BIP32_HARDENED) {
+            data[lane][0] = 0x00;
+            memcpy(data[lane] + 1, parent->private_keys + p * PRIVATE_KEY_LENGTH,
+                   PRIVATE_KEY_LENGTH);
+        } else {
+            memcpy(data[lane], parent->public_keys + p * PUBLIC_KEY_LENGTH,
+                   PUBLIC_KEY_LENGTH);
+        }
+        for (int i = 0; i < 4; i++) {
+            data[lane][PUBLIC_KEY_LENGTH + i] = (index >> (24 - 8 * i)) & 0xFF;
+        }
+        keys[lane] = parent->chain_codes + p * CHAIN_CODE_LENGTH;
+        msgs[lane] = data[lane];
+    }
+
+    hmac_sha512_lanes(keys, CHAIN_CODE_LENGTH, msgs, PUBLIC_KEY_LENGTH + 4, digests);
+
+    int result = SUCCESS;
+    for (size_t lane = 0; lane < n && result == SUCCESS; lane++) {
+        size_t p = parent_lanes[lane];
+        size_t c = out + lane;
+        result = private_key_tweak_add(parent->private_keys + p * PRIVATE_KEY_LENGTH,
+                                       digests[lane],
+                                       child->private_keys + c * PRIVATE_KEY_LENGTH);
+        memcpy(child->chain_codes + c * CHAIN_CODE_LENGTH,
+               digests[lane] + PRIVATE_KEY_LENGTH, CHAIN_CODE_LENGTH);
+        child->depths[c] = parent->depths[p] + 1;
+        child->child_numbers[c] = indices[lane];
+        child->parent_fingerprints[c] = fingerprints[lane];
+    }
+
+    OPENSSL_cleanse(data, sizeof(data));
+    OPENSSL_cleanse(digests, sizeof(digests));
+    return result;
+}
+
+int hdkey_batch_derive(hdkey_batch *parent, uint32_t index, hdkey_batch *child) {
+    if (parent == NULL || child == NULL || parent == child ||
+        child->capacity < parent->count) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    int result = hdkey_batch_public_keys(parent);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    size_t lanes[SHA512_LANES];
+    uint32_t indices[SHA512_LANES];
+    uint32_t fingerprints[SHA512_LANES];
+    for (size_t base = 0; base < parent->count && result == SUCCESS; base += SHA512_LANES) {
+        size_t n = parent->count - base < SHA512_LANES ? parent->count - base : SHA512_LANES;
+        for (size_t i = 0; i < n; i++) {
+            lanes[i] = base + i;
+            indices[i] = index;
+            fingerprints[i] = public_key_fingerprint(parent->public_keys +
+                                                     (base + i) * PUBLIC_KEY_LENGTH);
+        }
+        result = derive_group(parent, lanes, indices, fingerprints, n, child, base);
+    }
+
+    child->count = result == SUCCESS ? parent->count : 0;
+    child->has_public_keys = 0;
+    return result;
+}
+
+int hdkey_batch_derive_range(hdkey_batch *parent, size_t lane, uint32_t first,
+                             size_t count, hdkey_batch *child) {
+    if (parent == NULL || child == NULL || parent == child ||
+        lane >= parent->count || child->capacity < count) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    int result = hdkey_batch_public_keys(parent);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    // Same parent for every child: one fingerprint, one public key
+    uint32_t fingerprint = public_key_fingerprint(parent->public_keys + lane * PUBLIC_KEY_LENGTH);
+    size_t lanes[SHA512_LANES];
+    uint32_t indices[SHA512_LANES];
+    uint32_t fingerprints[SHA512_LANES];
+    for (size_t base = 0; base < count && result == SUCCESS; base += SHA512_LANES) {
+        size_t n = count - base < SHA512_LANES ? count - base : SHA512_LANES;
+        for (size_t i = 0; i < n; i++) {
+            lanes[i] = lane;
+            indices[i] = first + (uint32_t)(base + i);
+            fingerprints[i] = fingerprint;
+        }
+        result = derive_group(parent, lanes, indices, fingerprints, n, child, base);
+    }
+
+    child->count = result == SUCCESS ? count : 0;
+    child->has_public_keys = 0;
+    return result;
+}
+
+int hdkey_batch_hash160(hdkey_batch *batch, byte *hashes) {
+    if (batch == NULL || hashes == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    int result = hdkey_batch_public_keys(batch);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        hash160(batch->public_keys + i * PUBLIC_KEY_LENGTH, PUBLIC_KEY_LENGTH,
+                hashes + i * 20);
+    }
+    return SUCCESS;
+}
+
+int hdkey_batch_serialize_xprv(const hdkey_batch *batch, byte *out, size_t stride) {
+    if (batch == NULL || out == NULL || stride < 112) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        int result = generate_extended_xprv(batch->private_keys + i * PRIVATE_KEY_LENGTH,
+                                            batch->chain_codes + i * CHAIN_CODE_LENGTH,
+                                            batch->depths[i],
+                                            batch->parent_fingerprints[i],
+                                            batch->child_numbers[i],
+                                            out + i * stride);
+        if (result != SUCCESS) {
+            return result;
+        }
+    }
+    return SUCCESS;
+}
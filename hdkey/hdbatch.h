@@ -0,0 +1,114 @@
+/**
+ * @file hdbatch.h
+ * @brief Structure-of-arrays container for batches of BIP-32 extended keys.
+ * @details Each field of the extended key lives in its own contiguous,
+ *          64-byte aligned lane array, so batch derivation feeds the
+ *          multi-lane SHA-512 kernels and serialization/hashing walk
+ *          memory linearly.
+ */
+
+#ifndef HDBATCH_H
+#define HDBATCH_H
+
+#include "hdkey.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Alignment of every lane array in bytes */
+#define HDBATCH_ALIGNMENT 64
+
+/**
+ * @brief A batch of extended private keys in structure-of-arrays layout.
+ *
+ * Key i is made of chain_codes[32 * i], private_keys[32 * i], depths[i],
+ * child_numbers[i] and parent_fingerprints[i]. public_keys[33 * i] is only
+ * meaningful while has_public_keys is set.
+ */
+typedef struct {
+    size_t count;                  ///< Keys currently held.
+    size_t capacity;               ///< Keys the lanes can hold.
+    byte *chain_codes;             ///< capacity x 32 bytes.
+    byte *private_keys;            ///< capacity x 32 bytes.
+    byte *public_keys;             ///< capacity x 33 bytes (compressed).
+    uint8_t *depths;               ///< capacity depths.
+    uint32_t *child_numbers;       ///< capacity child indices.
+    uint32_t *parent_fingerprints; ///< capacity parent fingerprints.
+    int has_public_keys;           ///< Non-zero once public_keys is filled.
+} hdkey_batch;
+
+/**
+ * @brief Allocates the lane arrays of a batch.
+ * @param batch Batch to initialize.
+ * @param capacity Maximum number of keys.
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_init(hdkey_batch *batch, size_t capacity);
+
+/**
+ * @brief Wipes and frees the lane arrays of a batch.
+ * @param batch Batch to release (can be zero-initialized).
+ */
+void hdkey_batch_free(hdkey_batch *batch);
+
+/**
+ * @brief Fills a batch with the master keys of many seeds.
+ * @param batch Destination batch (capacity >= count).
+ * @param seeds Concatenated 64-byte BIP-39 seeds.
+ * @param count Number of seeds.
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_from_seeds(hdkey_batch *batch, const byte *seeds, size_t count);
+
+/**
+ * @brief Computes the compressed public key of every key in the batch.
+ * @param batch Batch to update.
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_public_keys(hdkey_batch *batch);
+
+/**
+ * @brief Derives child `index` of every key in a batch (lane i -> lane i).
+ * @param parent Parent batch (its public keys are computed if missing).
+ * @param index Child index (>= BIP32_HARDENED for hardened).
+ * @param child Destination batch (capacity >= parent->count, not parent).
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_derive(hdkey_batch *parent, uint32_t index, hdkey_batch *child);
+
+/**
+ * @brief Derives children first..first+count-1 of one key of a batch.
+ * @param parent Batch holding the parent key.
+ * @param lane Index of the parent key within the batch.
+ * @param first First child index.
+ * @param count Number of consecutive children.
+ * @param child Destination batch (capacity >= count, not parent).
+ * @return 0 on success, negative error code on failure.
+ * @note The usual gap-limit case: one account chain key, many leaves.
+ */
+int hdkey_batch_derive_range(hdkey_batch *parent, size_t lane, uint32_t first,
+                             size_t count, hdkey_batch *child);
+
+/**
+ * @brief Computes HASH160 of every public key in the batch.
+ * @param batch Batch (public keys are computed if missing).
+ * @param hashes Output, 20 bytes per key.
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_hash160(hdkey_batch *batch, byte *hashes);
+
+/**
+ * @brief Encodes every key of the batch as an xprv string.
+ * @param batch Source batch.
+ * @param out Output buffer, one NUL-terminated xprv every `stride` bytes.
+ * @param stride Distance between strings (at least 112).
+ * @return 0 on success, negative error code on failure.
+ */
+int hdkey_batch_serialize_xprv(const hdkey_batch *batch, byte *out, size_t stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HDBATCH_H
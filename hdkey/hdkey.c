@@ -0,0 +1,940 @@
+/**
+ * @file hdkey.c
+ * @brief BIP-32 master key derivation from BIP-39 seed
+ *
+ * This file implements functionality to derive BIP-32 master keys from a BIP-39 seed,
+ * and convert them to WIF (Wallet Import Format) and xprv formats.
+ */
+
+#include "hdkey.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <openssl/evp.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <pthread.h>
+
+#include "../bip39/bip39.h"
+#include "../cpto/cpto.h"
+
+/**
+ * @brief Implementation of Base58 encoding for Bitcoin addresses and keys
+ * 
+ * @param[out] output Base58-encoded output string
+ * @param[in] input Binary input data
+ * @param[in] input_len Length of input data in bytes
+ * @return Length of the encoded string
+ */
+size_t base58_encode(byte *output, const byte *input, size_t input_len) {
+    /* Declare Base58 alphabet */
+    const char *alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    
+    /* Count leading zeros */
+    size_t zeros = 0;
+    while (zeros < input_len && input[zeros] == 0) {
+        zeros++;
+    }
+    
+    /* Calculate output size: worst case is 1.4x input size */
+    size_t output_size = input_len * 138 / 100 + 1;
+    byte buffer[output_size];
+    memset(buffer, 0, output_size);
+    
+    /* Convert binary to Base58 */
+    for (size_t i = zeros; i < input_len; i++) {
+        uint32_t carry = input[i];
+        size_t j = 0;
+        
+        for (size_t k = output_size - 1; k >= 0; k--, j++) {
+            if (j < output_size) {
+                carry += 256 * buffer[k];
+                buffer[k] = carry % 58;
+                carry /= 58;
+            }
+            
+            if (carry == 0 && j >= output_size - 1) {
+                break;
+            }
+        }
+    }
+    
+    /* Skip leading zeros in result */
+    size_t result_start = 0;
+    while (result_start < output_size && buffer[result_start] == 0) {
+        result_start++;
+    }
+    
+    /* Add leading '1' chars for each leading zero byte */
+    size_t output_index = 0;
+    for (size_t i = 0; i < zeros; i++) {
+        output[output_index++] = '1';
+    }
+    
+    /* Convert to Base58 alphabet */
+    for (size_t i = result_start; i < output_size; i++) {
+        output[output_index++] = alphabet[buffer[i]];
+    }
+    
+    output[output_index] = '\0';
+    return output_index;
+}
+
+/**
+ * @brief Decodes a Base58 string to binary data (no checksum check)
+ *
+ * @param[out] output Output buffer
+ * @param[in] output_size Size of the output buffer
+ * @param[in] input Base58 string (null-terminated)
+ * @return Number of decoded bytes, or 0 on invalid characters or a too small buffer
+ */
+size_t base58_decode(byte *output, size_t output_size, const char *input) {
+    static const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    if (output == NULL || input == NULL) {
+        return 0;
+    }
+    size_t len = strlen(input);
+    if (len == 0 || output_size == 0) {
+        return 0;
+    }
+
+    /* Leading '1's are leading zero bytes */
+    size_t zeros = 0;
+    while (input[zeros] == '1') {
+        zeros++;
+    }
+
+    /* Big-endian base-256 accumulator, multiplied by 58 per digit */
+    byte buffer[len];
+    memset(buffer, 0, len);
+    size_t used = 0;
+    for (size_t i = zeros; i < len; i++) {
+        const char *pos = strchr(alphabet, input[i]);
+        if (pos == NULL) {
+            OPENSSL_cleanse(buffer, len);
+            return 0;
+        }
+        uint32_t carry = (uint32_t)(pos - alphabet);
+        for (size_t j = 0; j < used || carry != 0; j++) {
+            carry += 58u * buffer[len - 1 - j];
+            buffer[len - 1 - j] = carry & 0xFF;
+            carry >>= 8;
+            if (j >= used) {
+                used = j + 1;
+            }
+        }
+    }
+
+    size_t total = zeros + used;
+    if (total > output_size) {
+        OPENSSL_cleanse(buffer, len);
+        return 0;
+    }
+    memset(output, 0, zeros);
+    memcpy(output + zeros, buffer + len - used, used);
+    OPENSSL_cleanse(buffer, len);
+    return total;
+}
+
+/**
+ * @brief Derives BIP-32 master key and chain code from a BIP-39 seed
+ *
+ * @param[in] seed Pointer to the BIP-39 seed
+ * @param[in] seed_len Length of the seed in bytes
+ * @param[out] private_key_out Buffer to store the master private key (32 bytes)
+ * @param[out] chain_code_out Buffer to store the chain code (32 bytes)
+ * @return 0 on success, negative error code on failure
+ * 
+ * @note Uses HMAC-SHA512 with "Bitcoin seed" as key per BIP-32 specification
+ * @note Output buffers must be at least 32 bytes each
+ */
+int derive_bip32_master_key(
+    const byte *seed, 
+    size_t seed_len,
+    byte *private_key_out, 
+    byte *chain_code_out
+) {
+    if (seed == NULL || private_key_out == NULL || chain_code_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    
+    if (seed_len != BIP39_SEED_LENGTH) {
+        fprintf(stderr, "Invalid seed length: %zu bytes (expected %d)\n", 
+                seed_len, BIP39_SEED_LENGTH);
+        return ERROR_INVALID_LENGTH;
+    }
+    
+    byte master_key[SHA512_DIGEST_SIZE];
+    
+    /* HMAC-SHA512 with key "Bitcoin seed" and message as the seed */
+    unsigned int md_len = SHA512_DIGEST_SIZE;
+    if (HMAC(EVP_sha512(), 
+        BIP32_KEY, strlen(BIP32_KEY),
+            seed, seed_len,
+            master_key, &md_len) == NULL) {
+        fprintf(stderr, "HMAC-SHA512 failed\n");
+        return ERROR_INTERNAL;
+    }
+    
+    /* First 32 bytes are the master private key */
+    memcpy(private_key_out, master_key, PRIVATE_KEY_LENGTH);
+    
+    /* Last 32 bytes are the chain code */
+    memcpy(chain_code_out, master_key + PRIVATE_KEY_LENGTH, CHAIN_CODE_LENGTH);
+    
+    return SUCCESS;
+}
+/**
+ * @brief Derives the BIP-32 master key straight from a mnemonic phrase
+ *
+ * @param[in] mnemonic Space separated mnemonic phrase (NFKD normalized)
+ * @param[in] passphrase Optional passphrase (can be NULL)
+ * @param[out] seed_out Optional buffer receiving the 64-byte seed (can be NULL)
+ * @param[out] private_key_out Buffer to store the master private key (32 bytes)
+ * @param[out] chain_code_out Buffer to store the chain code (32 bytes)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note The seed stays in a stack buffer between PBKDF2 and the HMAC, there is
+ *       no hex formatting or parsing in between
+ */
+int derive_bip32_master_key_from_mnemonic(
+    const char *mnemonic,
+    const char *passphrase,
+    byte *seed_out,
+    byte *private_key_out,
+    byte *chain_code_out
+) {
+    if (mnemonic == NULL || private_key_out == NULL || chain_code_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte seed[BIP39_SEED_LENGTH];
+
+    /* BIP-39: PBKDF2-HMAC-SHA512 of the phrase into the seed buffer */
+    if (bip39_mnemonic_to_seed(mnemonic, passphrase, seed) != 0) {
+        fprintf(stderr, "PBKDF2-HMAC-SHA512 failed\n");
+        return ERROR_INTERNAL;
+    }
+
+    /* BIP-32: the same buffer goes straight into the master-key HMAC */
+    int result = derive_bip32_master_key(seed, sizeof(seed),
+                                         private_key_out, chain_code_out);
+    if (result == SUCCESS && seed_out != NULL) {
+        memcpy(seed_out, seed, sizeof(seed));
+    }
+
+    OPENSSL_cleanse(seed, sizeof(seed));
+    return result;
+}
+
+/*
+ * HMAC-SHA512 midstates for the constant BIP-32 key "Bitcoin seed": the
+ * SHA-512 chaining state after compressing (key ^ ipad) and (key ^ opad).
+ * They only depend on the key, so they are precomputed here and each seed
+ * costs exactly two compressions (inner and outer).
+ */
+static const uint64_t BIP32_IPAD_MIDSTATE[8] = {
+    0x2e2af459060c1873ULL, 0x7894b868dc88433aULL,
+    0xdd1a797ef1a1933aULL, 0xe6486d04fcb412a7ULL,
+    0xfbcc67b9a396caa0ULL, 0xa2970b146f49b65eULL,
+    0xfdf1daabc66f6248ULL, 0x2ff99c812ada6dc3ULL
+};
+
+static const uint64_t BIP32_OPAD_MIDSTATE[8] = {
+    0xbbd27bac212e9dbdULL, 0xdd0bc55e7e4037c1ULL,
+    0xdfdd3d6890bd6424ULL, 0x2902de663032b34cULL,
+    0xa30f8aa6f67899fcULL, 0x69a566c30f88378fULL,
+    0x0500247985ecb694ULL, 0xf6d70307c6b2d337ULL
+};
+
+/** @brief Bit length of (128-byte pad block + 64-byte message) in an HMAC block */
+#define HMAC_SHA512_64B_MSG_BITS ((SHA512_BLOCK_SIZE + 64) * 8)
+
+/**
+ * @brief Loads a big-endian 64-bit word
+ *
+ * @param[in] p Pointer to 8 bytes
+ * @return The decoded word
+ */
+static uint64_t load_be64(const byte *p) {
+    uint64_t x = 0;
+    for (int i = 0; i < 8; i++) {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+/**
+ * @brief Stores a 64-bit word in big-endian order
+ *
+ * @param[out] p Destination (8 bytes)
+ * @param[in] x Word to store
+ */
+static void store_be64(byte *p, uint64_t x) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (x >> (56 - 8 * i)) & 0xFF;
+    }
+}
+
+/**
+ * @brief Derives BIP-32 master keys for many seeds at once
+ *
+ * @param[in] seeds Concatenated 64-byte BIP-39 seeds (count * 64 bytes)
+ * @param[in] count Number of seeds
+ * @param[out] private_keys_out Concatenated master private keys (count * 32 bytes)
+ * @param[out] chain_codes_out Concatenated chain codes (count * 32 bytes)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Starts from the precomputed "Bitcoin seed" midstates and runs the
+ *       inner and outer compressions for SHA512_LANES seeds per step through
+ *       sha512_compress_lanes(). The inner digest is fed to the outer
+ *       compression as words, never serialized to bytes.
+ */
+int derive_bip32_master_keys_batch(
+    const byte *seeds,
+    size_t count,
+    byte *private_keys_out,
+    byte *chain_codes_out
+) {
+    if (seeds == NULL || private_keys_out == NULL || chain_codes_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint64_t state[8 * SHA512_LANES];
+    uint64_t block[16 * SHA512_LANES];
+
+    for (size_t base = 0; base < count; base += SHA512_LANES) {
+        size_t lanes = count - base < SHA512_LANES ? count - base : SHA512_LANES;
+
+        /* Inner block: seed || 0x80 || zeros || length, from the ipad midstate */
+        memset(block, 0, sizeof(block));
+        for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+            /* Spare lanes of the last group recompute the first seed */
+            const byte *seed = seeds + (base + (lane < lanes ? lane : 0)) * BIP39_SEED_LENGTH;
+            for (int t = 0; t < 8; t++) {
+                block[t * SHA512_LANES + lane] = load_be64(seed + t * 8);
+                state[t * SHA512_LANES + lane] = BIP32_IPAD_MIDSTATE[t];
+            }
+            block[8 * SHA512_LANES + lane] = 0x8000000000000000ULL;
+            block[15 * SHA512_LANES + lane] = HMAC_SHA512_64B_MSG_BITS;
+        }
+        sha512_compress_lanes(state, block);
+
+        /* Outer block: inner digest words, from the opad midstate */
+        for (size_t lane = 0; lane < SHA512_LANES; lane++) {
+            for (int t = 0; t < 8; t++) {
+                block[t * SHA512_LANES + lane] = state[t * SHA512_LANES + lane];
+                state[t * SHA512_LANES + lane] = BIP32_OPAD_MIDSTATE[t];
+            }
+        }
+        sha512_compress_lanes(state, block);
+
+        /* IL is the private key, IR the chain code */
+        for (size_t lane = 0; lane < lanes; lane++) {
+            byte *key = private_keys_out + (base + lane) * PRIVATE_KEY_LENGTH;
+            byte *chain = chain_codes_out + (base + lane) * CHAIN_CODE_LENGTH;
+            for (int t = 0; t < 4; t++) {
+                store_be64(key + t * 8, state[t * SHA512_LANES + lane]);
+                store_be64(chain + t * 8, state[(t + 4) * SHA512_LANES + lane]);
+            }
+        }
+    }
+
+    OPENSSL_cleanse(state, sizeof(state));
+    OPENSSL_cleanse(block, sizeof(block));
+    return SUCCESS;
+}
+
+/**
+ * @brief Base58Check-encodes a private key as WIF
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] compressed Nonzero to append the 0x01 compressed-pubkey marker
+ * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+static int encode_wif(const byte *private_key, int compressed, byte *wif_key) {
+    if (private_key == NULL || wif_key == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte versioned_key[PRIVATE_KEY_LENGTH + 2 + 4]; /* Version + key + marker + checksum */
+    byte checksum[32];
+    size_t payload_len = PRIVATE_KEY_LENGTH + 1 + (compressed ? 1 : 0);
+
+    /* Prepend version byte (0x80 for mainnet) */
+    versioned_key[0] = WIF_VERSION_BYTE;
+    memcpy(versioned_key + 1, private_key, PRIVATE_KEY_LENGTH);
+    if (compressed) {
+        versioned_key[PRIVATE_KEY_LENGTH + 1] = 0x01;
+    }
+
+    /* Double SHA-256 checksum */
+    SHA256(versioned_key, payload_len, checksum);
+    SHA256(checksum, 32, checksum);
+
+    /* Append first 4 bytes of checksum */
+    memcpy(versioned_key + payload_len, checksum, 4);
+
+    /* Base58Check encode */
+    size_t len = base58_encode(wif_key, versioned_key, payload_len + 4);
+    OPENSSL_cleanse(versioned_key, sizeof(versioned_key));
+    if (len == 0) {
+        return ERROR_INTERNAL;
+    }
+    
+    wif_key[len] = '\0';
+    return SUCCESS;
+}
+
+/**
+ * @brief Converts a private key to WIF (Wallet Import Format)
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_wif(const byte *private_key, byte *wif_key) {
+    return encode_wif(private_key, 0, wif_key);
+}
+
+/**
+ * @brief Converts a private key to WIF for a compressed public key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_compressed_wif(const byte *private_key, byte *wif_key) {
+    return encode_wif(private_key, 1, wif_key);
+}
+
+/**
+ * @brief Decodes a mainnet WIF private key
+ *
+ * @param[in] wif WIF string (null-terminated)
+ * @param[out] private_key_out 32-byte private key
+ * @param[out] compressed Set to 1 for compressed-pubkey WIF, 0 otherwise (can be NULL)
+ * @return 0 on success, ERROR_INVALID_INPUT on a malformed WIF or bad checksum
+ */
+int wif_to_private_key(const char *wif, byte *private_key_out, int *compressed) {
+    if (wif == NULL || private_key_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte raw[PRIVATE_KEY_LENGTH + 2 + 4];
+    byte checksum[32];
+    size_t len = base58_decode(raw, sizeof(raw), wif);
+    int result = ERROR_INVALID_INPUT;
+    if ((len == PRIVATE_KEY_LENGTH + 1 + 4 ||
+         (len == PRIVATE_KEY_LENGTH + 2 + 4 && raw[PRIVATE_KEY_LENGTH + 1] == 0x01)) &&
+        raw[0] == WIF_VERSION_BYTE) {
+        SHA256(raw, len - 4, checksum);
+        SHA256(checksum, 32, checksum);
+        if (CRYPTO_memcmp(checksum, raw + len - 4, 4) == 0) {
+            memcpy(private_key_out, raw + 1, PRIVATE_KEY_LENGTH);
+            if (compressed) {
+                *compressed = len == PRIVATE_KEY_LENGTH + 2 + 4;
+            }
+            result = SUCCESS;
+        }
+    }
+    OPENSSL_cleanse(raw, sizeof(raw));
+    return result;
+}
+/**
+ * @brief Serializes and Base58Check-encodes an extended key
+ *
+ * @param[in] version 4 version bytes (xprv or xpub)
+ * @param[in] depth Depth in the tree (0 for master)
+ * @param[in] parent_fingerprint Fingerprint of the parent key (0 for master)
+ * @param[in] child_number Child index this key was derived with (0 for master)
+ * @param[in] chain_code 32-byte chain code
+ * @param[in] key_data 33-byte key field (0x00 || private key, or public key)
+ * @param[out] out Output buffer (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+static int encode_extended_key(const byte version[4], uint8_t depth,
+                               uint32_t parent_fingerprint, uint32_t child_number,
+                               const byte *chain_code, const byte *key_data,
+                               byte *out) {
+    /* Extended key format:
+     * 4 bytes: version
+     * 1 byte: depth
+     * 4 bytes: parent fingerprint
+     * 4 bytes: child number
+     * 32 bytes: chain code
+     * 33 bytes: key data
+     * 4 bytes: checksum
+     * Total: 82 bytes
+     */
+    byte raw[82];
+
+    memcpy(raw, version, 4);
+    raw[4] = depth;
+    for (int i = 0; i < 4; i++) {
+        raw[5 + i] = (parent_fingerprint >> (24 - 8 * i)) & 0xFF;
+        raw[9 + i] = (child_number >> (24 - 8 * i)) & 0xFF;
+    }
+    memcpy(raw + 13, chain_code, 32);
+    memcpy(raw + 45, key_data, 33);
+
+    /* Calculate checksum (first 4 bytes of double SHA-256) */
+    byte checksum[32];
+    SHA256(raw, 78, checksum);
+    SHA256(checksum, 32, checksum);
+
+    memcpy(raw + 78, checksum, 4);
+
+    /* Base58 encode the extended key */
+    size_t len = base58_encode(out, raw, 82);
+    OPENSSL_cleanse(raw, sizeof(raw));
+    if (len == 0) {
+        return ERROR_INTERNAL;
+    }
+
+    out[len] = '\0';
+    return SUCCESS;
+}
+
+/**
+ * @brief Generate extended private key (xprv) for a key anywhere in the tree
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] chain_code 32-byte chain code
+ * @param[in] depth Depth in the tree (0 for master)
+ * @param[in] parent_fingerprint Fingerprint of the parent key (0 for master)
+ * @param[in] child_number Child index this key was derived with (0 for master)
+ * @param[out] xprv Output buffer for xprv (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_extended_xprv(const byte *private_key, const byte *chain_code,
+                           uint8_t depth, uint32_t parent_fingerprint,
+                           uint32_t child_number, byte *xprv) {
+    if (private_key == NULL || chain_code == NULL || xprv == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    /* xprv version bytes */
+    static const byte version[4] = {0x04, 0x88, 0xAD, 0xE4};
+
+    /* Prepend 0x00 to private key */
+    byte key_data[33];
+    key_data[0] = 0x00;
+    memcpy(key_data + 1, private_key, PRIVATE_KEY_LENGTH);
+
+    int result = encode_extended_key(version, depth, parent_fingerprint,
+                                     child_number, chain_code, key_data, xprv);
+    OPENSSL_cleanse(key_data, sizeof(key_data));
+    return result;
+}
+
+/**
+ * @brief Generate extended public key (xpub) for a key anywhere in the tree
+ *
+ * @param[in] public_key 33-byte compressed public key
+ * @param[in] chain_code 32-byte chain code
+ * @param[in] depth Depth in the tree (0 for master)
+ * @param[in] parent_fingerprint Fingerprint of the parent key (0 for master)
+ * @param[in] child_number Child index this key was derived with (0 for master)
+ * @param[out] xpub Output buffer for xpub (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_extended_xpub(const byte *public_key, const byte *chain_code,
+                           uint8_t depth, uint32_t parent_fingerprint,
+                           uint32_t child_number, byte *xpub) {
+    if (public_key == NULL || chain_code == NULL || xpub == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    /* xpub version bytes */
+    static const byte version[4] = {0x04, 0x88, 0xB2, 0x1E};
+
+    return encode_extended_key(version, depth, parent_fingerprint,
+                               child_number, chain_code, public_key, xpub);
+}
+
+/**
+ * @brief Generate extended private key (xprv) from master private key and chain code
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] chain_code 32-byte chain code
+ * @param[out] xprv Output buffer for xprv (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_xprv(const byte *private_key, const byte *chain_code, byte *xprv) {
+    /* Master key: depth, fingerprint, and child number are zero */
+    return generate_extended_xprv(private_key, chain_code, 0, 0, 0, xprv);
+}
+
+// ============ CHILD KEY DERIVATION ============
+
+/** @brief secp256k1 group, created once and shared by every thread */
+static EC_GROUP *secp256k1_group = NULL;
+static pthread_once_t secp256k1_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Creates the shared secp256k1 group
+ */
+static void secp256k1_init(void) {
+    secp256k1_group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+}
+
+/**
+ * @brief Returns the shared secp256k1 group
+ *
+ * @return The group, or NULL if OpenSSL could not create it
+ */
+static const EC_GROUP *secp256k1(void) {
+    pthread_once(&secp256k1_once, secp256k1_init);
+    return secp256k1_group;
+}
+
+/**
+ * @brief Multiplies the generator by a private key and serializes the point
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] form POINT_CONVERSION_COMPRESSED or POINT_CONVERSION_UNCOMPRESSED
+ * @param[out] public_key_out Output buffer of `length` bytes
+ * @param[in] length 33 or 65, matching the form
+ * @return 0 on success, negative error code on failure
+ */
+static int encode_public_key(const byte *private_key, point_conversion_form_t form,
+                             byte *public_key_out, size_t length) {
+    if (private_key == NULL || public_key_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    const EC_GROUP *group = secp256k1();
+    if (group == NULL) {
+        return ERROR_INTERNAL;
+    }
+
+    int result = ERROR_INTERNAL;
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *k = BN_secure_new();
+    EC_POINT *point = EC_POINT_new(group);
+    if (ctx && k && point &&
+        BN_bin2bn(private_key, PRIVATE_KEY_LENGTH, k) &&
+        EC_POINT_mul(group, point, k, NULL, NULL, ctx) &&
+        EC_POINT_point2oct(group, point, form, public_key_out, length, ctx) == length) {
+        result = SUCCESS;
+    }
+
+    EC_POINT_free(point);
+    BN_clear_free(k);
+    BN_CTX_free(ctx);
+    return result;
+}
+
+/**
+ * @brief Computes the compressed public key of a private key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] public_key_out 33-byte compressed public key
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_public_key(const byte *private_key, byte *public_key_out) {
+    return encode_public_key(private_key, POINT_CONVERSION_COMPRESSED,
+                             public_key_out, PUBLIC_KEY_LENGTH);
+}
+
+/**
+ * @brief Computes the uncompressed public key of a private key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] public_key_out 65-byte uncompressed public key (0x04 || x || y)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_uncompressed_public_key(const byte *private_key, byte *public_key_out) {
+    return encode_public_key(private_key, POINT_CONVERSION_UNCOMPRESSED,
+                             public_key_out, UNCOMPRESSED_PUBLIC_KEY_LENGTH);
+}
+
+/**
+ * @brief Computes (key + tweak) mod n, the private half of BIP-32 CKD
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] tweak 32-byte IL from the child HMAC
+ * @param[out] child_key_out 32-byte child private key
+ * @return 0 on success, ERROR_INVALID_INPUT if IL >= n or the result is zero
+ *         (the caller should move to the next index), ERROR_INTERNAL otherwise
+ */
+int private_key_tweak_add(const byte *private_key, const byte *tweak,
+                          byte *child_key_out) {
+    const EC_GROUP *group = secp256k1();
+    if (group == NULL) {
+        return ERROR_INTERNAL;
+    }
+
+    int result = ERROR_INTERNAL;
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *k = BN_secure_new();
+    BIGNUM *il = BN_secure_new();
+    const BIGNUM *order = EC_GROUP_get0_order(group);
+    if (ctx && k && il &&
+        BN_bin2bn(private_key, PRIVATE_KEY_LENGTH, k) &&
+        BN_bin2bn(tweak, PRIVATE_KEY_LENGTH, il)) {
+        if (BN_cmp(il, order) >= 0) {
+            result = ERROR_INVALID_INPUT;
+        } else if (BN_mod_add(k, k, il, order, ctx)) {
+            if (BN_is_zero(k)) {
+                result = ERROR_INVALID_INPUT;
+            } else if (BN_bn2binpad(k, child_key_out, PRIVATE_KEY_LENGTH) == PRIVATE_KEY_LENGTH) {
+                result = SUCCESS;
+            }
+        }
+    }
+
+    BN_clear_free(il);
+    BN_clear_free(k);
+    BN_CTX_free(ctx);
+    return result;
+}
+
+/**
+ * @brief Computes HASH160 (RIPEMD-160 of SHA-256) of some data
+ *
+ * @param[in] data Input data
+ * @param[in] len Length of the input data in bytes
+ * @param[out] out 20-byte hash
+ */
+void hash160(const byte *data, size_t len, byte *out) {
+    byte sha[32];
+    SHA256(data, len, sha);
+    ripemd160(sha, sizeof(sha), out);
+}
+
+/**
+ * @brief Computes a key fingerprint (first 4 bytes of HASH160 of the public key)
+ *
+ * @param[in] public_key 33-byte compressed public key
+ * @return The fingerprint as a big-endian integer
+ */
+uint32_t public_key_fingerprint(const byte *public_key) {
+    byte id[20];
+    hash160(public_key, PUBLIC_KEY_LENGTH, id);
+    return ((uint32_t)id[0] << 24) | ((uint32_t)id[1] << 16) |
+           ((uint32_t)id[2] << 8) | (uint32_t)id[3];
+}
+
+/**
+ * @brief Derives a child private key and chain code (BIP-32 CKDpriv)
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] chain_code 32-byte parent chain code
+ * @param[in] index Child index (>= BIP32_HARDENED for hardened children)
+ * @param[out] child_key_out 32-byte child private key
+ * @param[out] child_chain_out 32-byte child chain code
+ * @return 0 on success, ERROR_INVALID_INPUT for the (2^-127) invalid child
+ *         case, other negative error codes on failure
+ */
+int derive_bip32_child_key(const byte *private_key, const byte *chain_code,
+                           uint32_t index, byte *child_key_out,
+                           byte *child_chain_out) {
+    if (private_key == NULL || chain_code == NULL ||
+        child_key_out == NULL || child_chain_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    /* Hardened: 0x00 || key || index, normal: pubkey || index */
+    byte data[PUBLIC_KEY_LENGTH + 4];
+    if (index >= BIP32_HARDENED) {
+        data[0] = 0x00;
+        memcpy(data + 1, private_key, PRIVATE_KEY_LENGTH);
+    } else if (private_key_to_public_key(private_key, data) != SUCCESS) {
+        return ERROR_INTERNAL;
+    }
+    for (int i = 0; i < 4; i++) {
+        data[PUBLIC_KEY_LENGTH + i] = (index >> (24 - 8 * i)) & 0xFF;
+    }
+
+    byte digest[SHA512_DIGEST_SIZE];
+    unsigned int md_len = SHA512_DIGEST_SIZE;
+    int result = ERROR_INTERNAL;
+    if (HMAC(EVP_sha512(), chain_code, CHAIN_CODE_LENGTH,
+             data, sizeof(data), digest, &md_len) != NULL) {
+        result = private_key_tweak_add(private_key, digest, child_key_out);
+        if (result == SUCCESS) {
+            memcpy(child_chain_out, digest + PRIVATE_KEY_LENGTH, CHAIN_CODE_LENGTH);
+        }
+    }
+
+    OPENSSL_cleanse(data, sizeof(data));
+    OPENSSL_cleanse(digest, sizeof(digest));
+    return result;
+}
+
+/**
+ * @brief Parses a derivation path such as "m/84'/0'/0'" or "m/44h/0h/0h/0/5"
+ *
+ * @param[in] path Path string, with or without the leading "m/"
+ * @param[out] indices Child indices, hardened ones offset by BIP32_HARDENED
+ * @param[in] max_depth Capacity of indices
+ * @param[out] depth_out Number of indices parsed
+ * @return 0 on success, negative error code on failure
+ */
+int parse_bip32_path(const char *path, uint32_t *indices, size_t max_depth,
+                     size_t *depth_out) {
+    if (path == NULL || indices == NULL || depth_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    const char *p = path;
+    if (*p == 'm') {
+        p++;
+        if (*p == '/') {
+            p++;
+        } else if (*p != '\0') {
+            return ERROR_INVALID_INPUT;
+        }
+    }
+
+    size_t depth = 0;
+    while (*p != '\0') {
+        if (*p < '0' || *p > '9' || depth == max_depth) {
+            return ERROR_INVALID_INPUT;
+        }
+        uint64_t index = 0;
+        while (*p >= '0' && *p <= '9') {
+            index = index * 10 + (uint64_t)(*p - '0');
+            if (index >= BIP32_HARDENED) {
+                return ERROR_INVALID_INPUT;
+            }
+            p++;
+        }
+        if (*p == '\'' || *p == 'h' || *p == 'H') {
+            index += BIP32_HARDENED;
+            p++;
+        }
+        if (*p == '/') {
+            p++;
+            if (*p == '\0') {
+                return ERROR_INVALID_INPUT;
+            }
+        } else if (*p != '\0') {
+            return ERROR_INVALID_INPUT;
+        }
+        indices[depth++] = (uint32_t)index;
+    }
+
+    *depth_out = depth;
+    return SUCCESS;
+}
+
+/**
+ * @brief Derives the key at a path below a parent key
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] chain_code 32-byte parent chain code
+ * @param[in] indices Child indices from parse_bip32_path()
+ * @param[in] depth Number of indices
+ * @param[out] key_out 32-byte derived private key
+ * @param[out] chain_out 32-byte derived chain code
+ * @param[out] parent_fingerprint_out Fingerprint of the derived key's parent
+ *             (0 when depth is 0), can be NULL
+ * @return 0 on success, negative error code on failure
+ */
+int derive_bip32_path(const byte *private_key, const byte *chain_code,
+                      const uint32_t *indices, size_t depth,
+                      byte *key_out, byte *chain_out,
+                      uint32_t *parent_fingerprint_out) {
+    if (private_key == NULL || chain_code == NULL || key_out == NULL ||
+        chain_out == NULL || (depth > 0 && indices == NULL)) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    byte key[PRIVATE_KEY_LENGTH];
+    byte chain[CHAIN_CODE_LENGTH];
+    memcpy(key, private_key, PRIVATE_KEY_LENGTH);
+    memcpy(chain, chain_code, CHAIN_CODE_LENGTH);
+    uint32_t parent_fingerprint = 0;
+
+    int result = SUCCESS;
+    for (size_t i = 0; i < depth && result == SUCCESS; i++) {
+        if (i == depth - 1 && parent_fingerprint_out != NULL) {
+            byte public_key[PUBLIC_KEY_LENGTH];
+            result = private_key_to_public_key(key, public_key);
+            if (result != SUCCESS) {
+                break;
+            }
+            parent_fingerprint = public_key_fingerprint(public_key);
+        }
+        result = derive_bip32_child_key(key, chain, indices[i], key, chain);
+    }
+
+    if (result == SUCCESS) {
+        memcpy(key_out, key, PRIVATE_KEY_LENGTH);
+        memcpy(chain_out, chain, CHAIN_CODE_LENGTH);
+        if (parent_fingerprint_out != NULL) {
+            *parent_fingerprint_out = parent_fingerprint;
+        }
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    OPENSSL_cleanse(chain, sizeof(chain));
+    return result;
+}
+
+/**
+ * @brief Computes the BIP-341 taproot output key for a key-path-only output
+ *
+ * @param[in] public_key 33-byte compressed internal public key
+ * @param[out] output_key_out 32-byte x-only output key Q = P + H_TapTweak(P)G
+ * @return 0 on success, negative error code on failure
+ *
+ * @note This is the BIP-86 tweak (no script tree)
+ */
+int taproot_output_key(const byte *public_key, byte *output_key_out) {
+    if (public_key == NULL || output_key_out == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    const EC_GROUP *group = secp256k1();
+    if (group == NULL) {
+        return ERROR_INTERNAL;
+    }
+
+    /* t = SHA256(SHA256("TapTweak") || SHA256("TapTweak") || x(P)) */
+    byte tag[32];
+    byte tweak_input[96];
+    byte tweak[32];
+    SHA256((const byte *)"TapTweak", 8, tag);
+    memcpy(tweak_input, tag, 32);
+    memcpy(tweak_input + 32, tag, 32);
+    memcpy(tweak_input + 64, public_key + 1, 32);
+    SHA256(tweak_input, sizeof(tweak_input), tweak);
+
+    /* P is taken with even y (x-only), Q = t*G + 1*P */
+    byte even_key[PUBLIC_KEY_LENGTH];
+    even_key[0] = 0x02;
+    memcpy(even_key + 1, public_key + 1, 32);
+
+    int result = ERROR_INTERNAL;
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *t = BN_new();
+    EC_POINT *p = EC_POINT_new(group);
+    EC_POINT *q = EC_POINT_new(group);
+    byte q_raw[PUBLIC_KEY_LENGTH];
+    if (ctx && t && p && q &&
+        BN_bin2bn(tweak, sizeof(tweak), t) &&
+        BN_cmp(t, EC_GROUP_get0_order(group)) < 0 &&
+        EC_POINT_oct2point(group, p, even_key, sizeof(even_key), ctx) &&
+        EC_POINT_mul(group, q, t, p, BN_value_one(), ctx) &&
+        EC_POINT_point2oct(group, q, POINT_CONVERSION_COMPRESSED,
+                           q_raw, sizeof(q_raw), ctx) == PUBLIC_KEY_LENGTH) {
+        memcpy(output_key_out, q_raw + 1, 32);
+        result = SUCCESS;
+    }
+
+    EC_POINT_free(q);
+    EC_POINT_free(p);
+    BN_free(t);
+    BN_CTX_free(ctx);
+    return result;
+}
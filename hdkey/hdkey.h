@@ -0,0 +1,298 @@
+/**
+ * @file hdkey.h
+ * @brief BIP-32 hierarchical deterministic key primitives.
+ * @details Master key derivation from a BIP-39 seed and its WIF, xprv and
+ *          Base58 encodings, shared by the command line tools.
+ */
+
+#ifndef HDKEY_H
+#define HDKEY_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Type definition for byte to improve readability */
+typedef unsigned char byte;
+
+/** @brief Size of SHA-512 digest in bytes */
+#ifndef SHA512_DIGEST_SIZE
+#define SHA512_DIGEST_SIZE 64
+#endif
+
+/** @brief Expected BIP-39 seed length in bytes */
+#define BIP39_SEED_LENGTH 64
+
+/** @brief Private key length in bytes */
+#define PRIVATE_KEY_LENGTH 32
+
+/** @brief Chain code length in bytes */
+#define CHAIN_CODE_LENGTH 32
+
+/** @brief Compressed public key length in bytes */
+#define PUBLIC_KEY_LENGTH 33
+
+/** @brief Uncompressed public key length in bytes */
+#define UNCOMPRESSED_PUBLIC_KEY_LENGTH 65
+
+/** @brief First hardened child index (written as i' or ih in paths) */
+#define BIP32_HARDENED 0x80000000u
+
+/** @brief Version byte for mainnet private key */
+#define WIF_VERSION_BYTE 0x80
+
+/** @brief BIP-32 root key for HMAC derivation */
+#define BIP32_KEY "Bitcoin seed"
+
+/** @brief Error codes for functions */
+enum {
+    SUCCESS = 0,
+    ERROR_INVALID_INPUT = -1,
+    ERROR_INVALID_LENGTH = -2,
+    ERROR_INTERNAL = -3
+};
+
+/**
+ * @brief Implementation of Base58 encoding for Bitcoin addresses and keys
+ *
+ * @param[out] output Base58-encoded output string
+ * @param[in] input Binary input data
+ * @param[in] input_len Length of input data in bytes
+ * @return Length of the encoded string
+ */
+size_t base58_encode(byte *output, const byte *input, size_t input_len);
+
+/**
+ * @brief Decodes a Base58 string to binary data (no checksum check)
+ *
+ * @param[out] output Output buffer
+ * @param[in] output_size Size of the output buffer
+ * @param[in] input Base58 string (null-terminated)
+ * @return Number of decoded bytes, or 0 on invalid characters or a too small buffer
+ */
+size_t base58_decode(byte *output, size_t output_size, const char *input);
+
+/**
+ * @brief Derives BIP-32 master key and chain code from a BIP-39 seed
+ *
+ * @param[in] seed Pointer to the BIP-39 seed
+ * @param[in] seed_len Length of the seed in bytes
+ * @param[out] private_key_out Buffer to store the master private key (32 bytes)
+ * @param[out] chain_code_out Buffer to store the chain code (32 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int derive_bip32_master_key(const byte *seed, size_t seed_len,
+                            byte *private_key_out, byte *chain_code_out);
+
+/**
+ * @brief Derives the BIP-32 master key straight from a mnemonic phrase
+ *
+ * Runs the BIP-39 PBKDF2 into a stack buffer and feeds that buffer directly
+ * into the master-key HMAC; the seed is never formatted or copied out and is
+ * wiped before returning.
+ *
+ * @param[in] mnemonic Space separated mnemonic phrase (NFKD normalized)
+ * @param[in] passphrase Optional passphrase (can be NULL)
+ * @param[out] seed_out Optional buffer receiving the 64-byte seed (can be NULL)
+ * @param[out] private_key_out Buffer to store the master private key (32 bytes)
+ * @param[out] chain_code_out Buffer to store the chain code (32 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int derive_bip32_master_key_from_mnemonic(const char *mnemonic,
+                                          const char *passphrase,
+                                          byte *seed_out,
+                                          byte *private_key_out,
+                                          byte *chain_code_out);
+
+/**
+ * @brief Derives BIP-32 master keys for many seeds at once
+ *
+ * @param[in] seeds Concatenated 64-byte BIP-39 seeds (count * 64 bytes)
+ * @param[in] count Number of seeds
+ * @param[out] private_keys_out Concatenated master private keys (count * 32 bytes)
+ * @param[out] chain_codes_out Concatenated chain codes (count * 32 bytes)
+ * @return 0 on success, negative error code on failure
+ *
+ * @note Bulk provisioning path: uses precomputed "Bitcoin seed" HMAC midstates
+ *       and multi-lane SHA-512, so each seed costs two compressions.
+ */
+int derive_bip32_master_keys_batch(const byte *seeds, size_t count,
+                                   byte *private_keys_out,
+                                   byte *chain_codes_out);
+
+/**
+ * @brief Converts a private key to WIF (Wallet Import Format)
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_wif(const byte *private_key, byte *wif_key);
+
+/**
+ * @brief Converts a private key to WIF for a compressed public key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] wif_key Output buffer for WIF key (should be at least 53 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_compressed_wif(const byte *private_key, byte *wif_key);
+
+/**
+ * @brief Decodes a mainnet WIF private key
+ *
+ * @param[in] wif WIF string (null-terminated)
+ * @param[out] private_key_out 32-byte private key
+ * @param[out] compressed Set to 1 for compressed-pubkey WIF, 0 otherwise (can be NULL)
+ * @return 0 on success, ERROR_INVALID_INPUT on a malformed WIF or bad checksum
+ */
+int wif_to_private_key(const char *wif, byte *private_key_out, int *compressed);
+
+/**
+ * @brief Generate extended private key (xprv) from master private key and chain code
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] chain_code 32-byte chain code
+ * @param[out] xprv Output buffer for xprv (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_xprv(const byte *private_key, const byte *chain_code, byte *xprv);
+
+/**
+ * @brief Generate extended private key (xprv) for a key anywhere in the tree
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[in] chain_code 32-byte chain code
+ * @param[in] depth Depth in the tree (0 for master)
+ * @param[in] parent_fingerprint Fingerprint of the parent key (0 for master)
+ * @param[in] child_number Child index this key was derived with (0 for master)
+ * @param[out] xprv Output buffer for xprv (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_extended_xprv(const byte *private_key, const byte *chain_code,
+                           uint8_t depth, uint32_t parent_fingerprint,
+                           uint32_t child_number, byte *xprv);
+
+/**
+ * @brief Computes the compressed public key of a private key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] public_key_out 33-byte compressed public key
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_public_key(const byte *private_key, byte *public_key_out);
+
+/**
+ * @brief Computes the uncompressed public key of a private key
+ *
+ * @param[in] private_key 32-byte private key
+ * @param[out] public_key_out 65-byte uncompressed public key (0x04 || x || y)
+ * @return 0 on success, negative error code on failure
+ */
+int private_key_to_uncompressed_public_key(const byte *private_key, byte *public_key_out);
+
+/**
+ * @brief Computes (key + tweak) mod n, the private half of BIP-32 CKD
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] tweak 32-byte IL from the child HMAC
+ * @param[out] child_key_out 32-byte child private key
+ * @return 0 on success, ERROR_INVALID_INPUT if IL >= n or the result is zero,
+ *         ERROR_INTERNAL otherwise
+ */
+int private_key_tweak_add(const byte *private_key, const byte *tweak,
+                          byte *child_key_out);
+
+/**
+ * @brief Computes HASH160 (RIPEMD-160 of SHA-256) of some data
+ *
+ * @param[in] data Input data
+ * @param[in] len Length of the input data in bytes
+ * @param[out] out 20-byte hash
+ */
+void hash160(const byte *data, size_t len, byte *out);
+
+/**
+ * @brief Computes a key fingerprint (first 4 bytes of HASH160 of the public key)
+ *
+ * @param[in] public_key 33-byte compressed public key
+ * @return The fingerprint as a big-endian integer
+ */
+uint32_t public_key_fingerprint(const byte *public_key);
+
+/**
+ * @brief Derives a child private key and chain code (BIP-32 CKDpriv)
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] chain_code 32-byte parent chain code
+ * @param[in] index Child index (>= BIP32_HARDENED for hardened children)
+ * @param[out] child_key_out 32-byte child private key
+ * @param[out] child_chain_out 32-byte child chain code
+ * @return 0 on success, negative error code on failure
+ */
+int derive_bip32_child_key(const byte *private_key, const byte *chain_code,
+                           uint32_t index, byte *child_key_out,
+                           byte *child_chain_out);
+
+/**
+ * @brief Generate extended public key (xpub) for a key anywhere in the tree
+ *
+ * @param[in] public_key 33-byte compressed public key
+ * @param[in] chain_code 32-byte chain code
+ * @param[in] depth Depth in the tree (0 for master)
+ * @param[in] parent_fingerprint Fingerprint of the parent key (0 for master)
+ * @param[in] child_number Child index this key was derived with (0 for master)
+ * @param[out] xpub Output buffer for xpub (should be at least 112 bytes)
+ * @return 0 on success, negative error code on failure
+ */
+int generate_extended_xpub(const byte *public_key, const byte *chain_code,
+                           uint8_t depth, uint32_t parent_fingerprint,
+                           uint32_t child_number, byte *xpub);
+
+/**
+ * @brief Parses a derivation path such as "m/84'/0'/0'" or "m/44h/0h/0h/0/5"
+ *
+ * @param[in] path Path string, with or without the leading "m/"
+ * @param[out] indices Child indices, hardened ones offset by BIP32_HARDENED
+ * @param[in] max_depth Capacity of indices
+ * @param[out] depth_out Number of indices parsed
+ * @return 0 on success, negative error code on failure
+ */
+int parse_bip32_path(const char *path, uint32_t *indices, size_t max_depth,
+                     size_t *depth_out);
+
+/**
+ * @brief Derives the key at a path below a parent key
+ *
+ * @param[in] private_key 32-byte parent private key
+ * @param[in] chain_code 32-byte parent chain code
+ * @param[in] indices Child indices from parse_bip32_path()
+ * @param[in] depth Number of indices
+ * @param[out] key_out 32-byte derived private key
+ * @param[out] chain_out 32-byte derived chain code
+ * @param[out] parent_fingerprint_out Fingerprint of the derived key's parent
+ *             (0 when depth is 0), can be NULL
+ * @return 0 on success, negative error code on failure
+ */
+int derive_bip32_path(const byte *private_key, const byte *chain_code,
+                      const uint32_t *indices, size_t depth,
+                      byte *key_out, byte *chain_out,
+                      uint32_t *parent_fingerprint_out);
+
+/**
+ * @brief Computes the BIP-341 taproot output key for a key-path-only output
+ *
+ * @param[in] public_key 33-byte compressed internal public key
+ * @param[out] output_key_out 32-byte x-only output key (BIP-86 tweak)
+ * @return 0 on success, negative error code on failure
+ */
+int taproot_output_key(const byte *public_key, byte *output_key_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HDKEY_H
@@ -0,0 +1,141 @@
+/**
+ * @file hugepage.c
+ * @brief Huge-page backed memory for lookup tables and batch buffers.
+ */
+#define _GNU_SOURCE
+#include "hugepage.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <openssl/crypto.h>
+
+/** @brief THP mode file; "[never]" means madvise() would be ignored */
+#define THP_ENABLED_PATH "/sys/kernel/mm/transparent_hugepage/enabled"
+
+/**
+ * @brief Tells whether transparent huge pages can back an madvise()d mapping.
+ * @return 1 if THP is in "always" or "madvise" mode.
+ */
+static int thp_available(void) {
+    char mode[128];
+    FILE *file = fopen(THP_ENABLED_PATH, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char *line = fgets(mode, sizeof(mode), file);
+    fclose(file);
+    return line != NULL && strstr(mode, "[never]") == NULL;
+}
+
+/**
+ * @brief Maps `size` bytes (a multiple of HUGEPAGE_SIZE) at a 2 MiB boundary.
+ * @return The mapping, or NULL.
+ * @note Over-maps by one huge page and trims both ends.
+ */
+static void *map_aligned(size_t size) {
+    size_t span = size + HUGEPAGE_SIZE;
+    uint8_t *raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    uint8_t *base = (uint8_t *)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+    if (base > raw) {
+        munmap(raw, (size_t)(base - raw));
+    }
+    size_t tail = (size_t)(raw + span - (base + size));
+    if (tail > 0) {
+        munmap(base + size, tail);
+    }
+    return base;
+}
+
+int hugepage_alloc(hugepage_region *region, size_t size, hugepage_backing best) {
+    if (region == NULL || size == 0 || size > SIZE_MAX - 2 * HUGEPAGE_SIZE) {
+        return HUGEPAGE_ERROR_INVALID;
+    }
+    memset(region, 0, sizeof(*region));
+    size_t rounded = (size + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+
+#ifdef MAP_HUGETLB
+    if (best >= HUGEPAGE_HUGETLB) {
+        void *base = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            *region = (hugepage_region){base, size, rounded, HUGEPAGE_HUGETLB};
+            return HUGEPAGE_OK;
+        }
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    // Below one huge page THP cannot help
+    if (best >= HUGEPAGE_THP && size >= HUGEPAGE_SIZE && thp_available()) {
+        void *base = map_aligned(rounded);
+        if (base != NULL) {
+            if (madvise(base, rounded, MADV_HUGEPAGE) == 0) {
+                *region = (hugepage_region){base, size, rounded, HUGEPAGE_THP};
+                return HUGEPAGE_OK;
+            }
+            munmap(base, rounded);
+        }
+    }
+#endif
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return HUGEPAGE_ERROR_NOMEM;
+    }
+    *region = (hugepage_region){base, size, size, HUGEPAGE_NONE};
+    return HUGEPAGE_OK;
+}
+
+void hugepage_free(hugepage_region *region) {
+    if (region == NULL || region->base == NULL) {
+        return;
+    }
+    OPENSSL_cleanse(region->base, region->size);
+    munmap(region->base, region->mapped);
+    memset(region, 0, sizeof(*region));
+}
+
+const char *hugepage_backing_name(hugepage_backing backing) {
+    switch (backing) {
+    case HUGEPAGE_HUGETLB:
+        return "hugetlb";
+    case HUGEPAGE_THP:
+        return "thp";
+    default:
+        return "4k";
+    }
+}
+
+int hugepage_arena_init(hugepage_arena *arena, size_t size) {
+    if (arena == NULL) {
+        return HUGEPAGE_ERROR_INVALID;
+    }
+    arena->used = 0;
+    return hugepage_alloc(&arena->region, size, HUGEPAGE_HUGETLB);
+}
+
+void *hugepage_arena_alloc(hugepage_arena *arena, size_t size, size_t align) {
+    if (arena == NULL || arena->region.base == NULL || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    size_t offset = (arena->used + align - 1) & ~(align - 1);
+    if (offset < arena->used || offset > arena->region.size || size > arena->region.size - offset) {
+        return NULL;
+    }
+    arena->used = offset + size;
+    return (uint8_t *)arena->region.base + offset;
+}
+
+void hugepage_arena_free(hugepage_arena *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    // Only the bytes handed out can hold data; wiping the rest would fault it in
+    arena->region.size = arena->used;
+    hugepage_free(&arena->region);
+    arena->used = 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file hugepage.h
+ * @brief Huge-page backed memory for lookup tables and batch buffers.
+ * @details Randomly indexed tables (Bloom filters, scrypt scratchpads) and
+ *          large batch buffers touch more 4 KiB pages than the TLB covers,
+ *          so hot loops pay page walks. A region from here is backed by
+ *          2 MiB pages when the system allows it, in this order:
+ *          - explicit huge pages (MAP_HUGETLB, from vm.nr_hugepages);
+ *          - transparent huge pages (a 2 MiB aligned mapping with
+ *            madvise(MADV_HUGEPAGE), when THP is not disabled);
+ *          - normal pages.
+ *
+ *          Regions are zero-filled and placed on first touch, so a pinned
+ *          thread that fills its region gets it on its own NUMA node.
+ */
+
+#ifndef HUGEPAGE_H
+#define HUGEPAGE_H
+
+#include <stddef.h>   // For size_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Huge page size used */
+#define HUGEPAGE_SIZE ((size_t)2 << 20)
+
+/** @brief Error codes */
+enum {
+    HUGEPAGE_OK = 0,
+    HUGEPAGE_ERROR_INVALID = -1,   /**< Bad arguments */
+    HUGEPAGE_ERROR_NOMEM = -2      /**< No mapping could be made */
+};
+
+/** @brief What backs a region, from least to most TLB-friendly */
+typedef enum {
+    HUGEPAGE_NONE = 0,    /**< Normal pages */
+    HUGEPAGE_THP,         /**< Transparent huge pages (best effort by the kernel) */
+    HUGEPAGE_HUGETLB      /**< Reserved huge pages */
+} hugepage_backing;
+
+/**
+ * @brief One mapping.
+ */
+typedef struct {
+    void *base;                 /**< Start, 2 MiB aligned unless backing is HUGEPAGE_NONE */
+    size_t size;                /**< Bytes requested */
+    size_t mapped;              /**< Bytes mapped */
+    hugepage_backing backing;   /**< What the mapping got */
+} hugepage_region;
+
+/**
+ * @brief Bump allocator over one region, for tables and buffers freed together.
+ */
+typedef struct {
+    hugepage_region region;
+    size_t used;                /**< Bytes handed out */
+} hugepage_arena;
+
+/**
+ * @brief Maps a zero-filled region.
+ * @param region Region to fill.
+ * @param size Bytes needed.
+ * @param best Most TLB-friendly backing to try (HUGEPAGE_HUGETLB for the
+ *             full fallback chain, HUGEPAGE_NONE for normal pages).
+ * @return HUGEPAGE_OK or a negative error code.
+ */
+int hugepage_alloc(hugepage_region *region, size_t size, hugepage_backing best);
+
+/**
+ * @brief Wipes and unmaps a region.
+ * @param region Region (can be zero-initialized).
+ */
+void hugepage_free(hugepage_region *region);
+
+/**
+ * @brief Name of a backing, for logs and benchmarks.
+ * @param backing Backing.
+ * @return "hugetlb", "thp" or "4k".
+ */
+const char *hugepage_backing_name(hugepage_backing backing);
+
+/**
+ * @brief Maps an arena with the full fallback chain.
+ * @param arena Arena to initialize.
+ * @param size Total bytes of all allocations, alignment padding included.
+ * @return HUGEPAGE_OK or a negative error code.
+ */
+int hugepage_arena_init(hugepage_arena *arena, size_t size);
+
+/**
+ * @brief Carves zero-filled memory out of an arena.
+ * @param arena Arena.
+ * @param size Bytes.
+ * @param align Alignment, a power of two.
+ * @return Memory, or NULL when the arena is exhausted.
+ */
+void *hugepage_arena_alloc(hugepage_arena *arena, size_t size, size_t align);
+
+/**
+ * @brief Wipes and unmaps an arena and everything allocated from it.
+ * @param arena Arena (can be zero-initialized).
+ */
+void hugepage_arena_free(hugepage_arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HUGEPAGE_H
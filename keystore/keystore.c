@@ -0,0 +1,643 @@
+/**
+ * @file keystore.c
+ * @brief Append-only store of derived public keys with sorted lookup indexes.
+ */
+#include "keystore.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <openssl/rand.h>
+
+#ifndef __cplusplus
+_Static_assert(sizeof(keystore_header) == KEYSTORE_HEADER_SIZE, "keystore header layout");
+_Static_assert(sizeof(keystore_entry) == KEYSTORE_ENTRY_SIZE, "keystore entry layout");
+#endif
+
+/** @brief Match key index record */
+typedef struct {
+    byte key[ADDRESS_KEY_LENGTH];
+    uint32_t entry;                      ///< Position in the log.
+} key_record;
+
+/** @brief Path index record */
+typedef struct {
+    uint32_t seed_fingerprint;
+    uint32_t depth;
+    uint32_t path[KEYSTORE_MAX_DEPTH];
+    uint32_t entry;                      ///< Position in the log.
+    uint32_t reserved;                   ///< Zero.
+} path_record;
+
+/** @brief Interpolation steps before falling back to binary search */
+#define INTERPOLATION_STEPS 8
+
+/** @brief Windows smaller than this are binary searched */
+#define INTERPOLATION_MIN_WINDOW 32
+
+/**
+ * @brief Builds "<base><suffix>".
+ * @return 0 on success, ERROR_INVALID_INPUT if the name is too long.
+ */
+static int store_file(char *out, const char *base, const char *suffix) {
+    size_t len = strlen(base);
+    if (len >= KEYSTORE_PATH_SIZE) {
+        return ERROR_INVALID_INPUT;
+    }
+    memcpy(out, base, len);
+    strcpy(out + len, suffix);
+    return SUCCESS;
+}
+
+/**
+ * @brief Loads 8 bytes big-endian.
+ */
+static uint64_t load_be64(const byte *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+int keystore_entry_set(keystore_entry *entry, uint32_t seed_fingerprint, const uint32_t *path,
+                       size_t depth, address_type type, const byte *public_key) {
+    if (entry == NULL || (path == NULL && depth > 0) || depth > KEYSTORE_MAX_DEPTH ||
+        public_key == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(entry, 0, sizeof(*entry));
+    int result = address_public_key_key(type, public_key, entry->key);
+    if (result != SUCCESS) {
+        return result;
+    }
+    entry->seed_fingerprint = seed_fingerprint;
+    entry->depth = (uint8_t)depth;
+    entry->type = (uint8_t)type;
+    for (size_t i = 0; i < depth; i++) {
+        entry->path[i] = path[i];
+    }
+    memcpy(entry->public_key, public_key, PUBLIC_KEY_LENGTH);
+    return SUCCESS;
+}
+
+// ============ LOG ============
+
+/**
+ * @brief Checks a log or index header.
+ */
+static int header_valid(const keystore_header *header, const char *magic, uint32_t record_size) {
+    return memcmp(header->magic, magic, sizeof(header->magic)) == 0 &&
+           header->version == KEYSTORE_VERSION && header->record_size == record_size;
+}
+
+int keystore_writer_open(keystore_writer *writer, const char *base) {
+    if (writer == NULL || base == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(writer, 0, sizeof(*writer));
+    char path[KEYSTORE_PATH_SIZE + 8];
+    if (store_file(path, base, ".log") != SUCCESS) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    // "a+b" appends whatever the read position, and creates the file
+    FILE *file = fopen(path, "a+b");
+    if (file == NULL) {
+        return ERROR_INTERNAL;
+    }
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0) {
+        fclose(file);
+        return ERROR_INTERNAL;
+    }
+
+    int result = SUCCESS;
+    keystore_header header;
+    if (st.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, KEYSTORE_MAGIC, sizeof(header.magic));
+        header.version = KEYSTORE_VERSION;
+        header.record_size = KEYSTORE_ENTRY_SIZE;
+        if (RAND_bytes(header.store_id, sizeof(header.store_id)) != 1 ||
+            fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+            result = ERROR_INTERNAL;
+        }
+    } else if ((size_t)st.st_size < sizeof(header) || fseek(file, 0, SEEK_SET) != 0 ||
+               fread(&header, sizeof(header), 1, file) != 1 ||
+               !header_valid(&header, KEYSTORE_MAGIC, KEYSTORE_ENTRY_SIZE)) {
+        result = ERROR_INVALID_INPUT;
+    } else {
+        writer->count = ((uint64_t)st.st_size - sizeof(header)) / KEYSTORE_ENTRY_SIZE;
+        off_t whole = (off_t)(sizeof(header) + writer->count * KEYSTORE_ENTRY_SIZE);
+        if (whole != st.st_size && ftruncate(fileno(file), whole) != 0) {
+            result = ERROR_INTERNAL;
+        }
+    }
+    if (result != SUCCESS) {
+        fclose(file);
+        return result;
+    }
+    writer->file = file;
+    return SUCCESS;
+}
+
+int keystore_writer_append(keystore_writer *writer, const keystore_entry *entries, size_t count) {
+    if (writer == NULL || writer->file == NULL || (entries == NULL && count > 0)) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (fwrite(entries, sizeof(*entries), count, writer->file) != count) {
+        return ERROR_INTERNAL;
+    }
+    writer->count += count;
+    return SUCCESS;
+}
+
+int keystore_writer_close(keystore_writer *writer) {
+    if (writer == NULL || writer->file == NULL) {
+        return SUCCESS;
+    }
+    int result = fclose(writer->file) == 0 ? SUCCESS : ERROR_INTERNAL;
+    memset(writer, 0, sizeof(*writer));
+    return result;
+}
+
+/**
+ * @brief Maps a whole file read-only.
+ * @return 0 on success, ERROR_INVALID_INPUT if it is missing or shorter than a header.
+ */
+static int map_file(const char *path, void **map, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < KEYSTORE_HEADER_SIZE) {
+        close(fd);
+        return ERROR_INVALID_INPUT;
+    }
+    void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return ERROR_INTERNAL;
+    }
+    *map = mapping;
+    *size = (size_t)st.st_size;
+    return SUCCESS;
+}
+
+// ============ PARALLEL SORT ============
+
+/**
+ * @brief One sort or merge task.
+ */
+typedef struct {
+    const byte *src;
+    byte *dst;
+    size_t begin;                        ///< First element of the left run.
+    size_t middle;                       ///< First element of the right run.
+    size_t end;                          ///< One past the right run.
+    size_t size;                         ///< Element size.
+    int (*compare)(const void *, const void *);
+} sort_task;
+
+static void *sort_run(void *arg) {
+    sort_task *task = arg;
+    qsort(task->dst + task->begin * task->size, task->end - task->begin, task->size, task->compare);
+    return NULL;
+}
+
+static void *merge_runs(void *arg) {
+    sort_task *task = arg;
+    size_t i = task->begin, j = task->middle, k = task->begin;
+    size_t size = task->size;
+    while (i < task->middle && j < task->end) {
+        // Ties take the left run, so the merge is stable
+        if (task->compare(task->src + j * size, task->src + i * size) < 0) {
+            memcpy(task->dst + k++ * size, task->src + j++ * size, size);
+        } else {
+            memcpy(task->dst + k++ * size, task->src + i++ * size, size);
+        }
+    }
+    memcpy(task->dst + k * size, task->src + i * size, (task->middle - i) * size);
+    k += task->middle - i;
+    memcpy(task->dst + k * size, task->src + j * size, (task->end - j) * size);
+    return NULL;
+}
+
+/**
+ * @brief Runs tasks on threads, the last one on the calling thread.
+ */
+static void run_tasks(sort_task *tasks, size_t count, void *(*fn)(void *)) {
+    pthread_t threads[64];
+    size_t started = 0;
+    for (size_t i = 0; i + 1 < count; i++) {
+        if (pthread_create(&threads[started], NULL, fn, &tasks[i]) == 0) {
+            started++;
+        } else {
+            fn(&tasks[i]);
+        }
+    }
+    if (count > 0) {
+        fn(&tasks[count - 1]);
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * @brief Sorts runs in parallel, then merges pairs of runs level by level.
+ * @return 0 on success, ERROR_INTERNAL if the scratch buffer cannot be allocated.
+ */
+static int parallel_sort(void *base, size_t count, size_t size, size_t threads,
+                         int (*compare)(const void *, const void *)) {
+    if (threads > 64) threads = 64;
+    if (threads < 2 || count < 4096) {
+        qsort(base, count, size, compare);
+        return SUCCESS;
+    }
+    byte *scratch = malloc(count * size);
+    if (scratch == NULL) {
+        return ERROR_INTERNAL;
+    }
+
+    size_t bounds[65];
+    size_t runs = threads;
+    sort_task tasks[64];
+    for (size_t r = 0; r <= runs; r++) {
+        bounds[r] = count * r / runs;
+    }
+    for (size_t r = 0; r < runs; r++) {
+        tasks[r] = (sort_task){NULL, base, bounds[r], bounds[r + 1], bounds[r + 1], size, compare};
+    }
+    run_tasks(tasks, runs, sort_run);
+
+    byte *src = base, *dst = scratch;
+    while (runs > 1) {
+        size_t merges = 0;
+        for (size_t r = 0; r < runs; r += 2) {
+            size_t end = r + 2 <= runs ? bounds[r + 2] : bounds[r + 1];
+            // An odd last run is merged with nothing, i.e. copied
+            tasks[merges++] = (sort_task){src, dst, bounds[r], bounds[r + 1], end, size, compare};
+        }
+        run_tasks(tasks, merges, merge_runs);
+        for (size_t m = 0; m < merges; m++) {
+            bounds[m] = tasks[m].begin;
+        }
+        bounds[merges] = count;
+        runs = merges;
+        byte *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != base) {
+        memcpy(base, src, count * size);
+    }
+    free(scratch);
+    return SUCCESS;
+}
+
+// ============ INDEXES ============
+
+static int compare_key_records(const void *a, const void *b) {
+    const key_record *x = a, *y = b;
+    int cmp = memcmp(x->key, y->key, ADDRESS_KEY_LENGTH);
+    if (cmp != 0) return cmp;
+    return (x->entry > y->entry) - (x->entry < y->entry);
+}
+
+/**
+ * @brief Orders path records by fingerprint, then path, shorter paths first.
+ */
+static int compare_path_keys(const path_record *x, const path_record *y) {
+    if (x->seed_fingerprint != y->seed_fingerprint) {
+        return x->seed_fingerprint < y->seed_fingerprint ? -1 : 1;
+    }
+    uint32_t depth = x->depth < y->depth ? x->depth : y->depth;
+    for (uint32_t i = 0; i < depth; i++) {
+        if (x->path[i] != y->path[i]) {
+            return x->path[i] < y->path[i] ? -1 : 1;
+        }
+    }
+    return (x->depth > y->depth) - (x->depth < y->depth);
+}
+
+static int compare_path_records(const void *a, const void *b) {
+    const path_record *x = a, *y = b;
+    int cmp = compare_path_keys(x, y);
+    if (cmp != 0) return cmp;
+    return (x->entry > y->entry) - (x->entry < y->entry);
+}
+
+/**
+ * @brief Writes an index to "<file>.tmp" and renames it over "<file>".
+ */
+static int write_index(const char *file, const keystore_header *log_header, uint32_t kind,
+                       const void *records, uint64_t count, size_t record_size) {
+    char tmp[KEYSTORE_PATH_SIZE + 16];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+
+    keystore_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, KEYSTORE_INDEX_MAGIC, sizeof(header.magic));
+    header.version = KEYSTORE_VERSION;
+    header.record_size = (uint32_t)record_size;
+    header.count = count;
+    header.kind = kind;
+    memcpy(header.store_id, log_header->store_id, sizeof(header.store_id));
+
+    FILE *out = fopen(tmp, "wb");
+    if (out == NULL) {
+        return ERROR_INTERNAL;
+    }
+    int result = SUCCESS;
+    if (fwrite(&header, sizeof(header), 1, out) != 1 ||
+        fwrite(records, record_size, (size_t)count, out) != count) {
+        result = ERROR_INTERNAL;
+    }
+    if (fclose(out) != 0) {
+        result = ERROR_INTERNAL;
+    }
+    if (result == SUCCESS && rename(tmp, file) != 0) {
+        result = ERROR_INTERNAL;
+    }
+    if (result != SUCCESS) {
+        remove(tmp);
+    }
+    return result;
+}
+
+int keystore_build_index(const char *base, size_t threads, uint64_t *count) {
+    char path[KEYSTORE_PATH_SIZE + 8];
+    if (base == NULL || store_file(path, base, ".log") != SUCCESS) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+
+    void *map;
+    size_t size;
+    int result = map_file(path, &map, &size);
+    if (result != SUCCESS) {
+        return result;
+    }
+    const keystore_header *log_header = map;
+    uint64_t n = (size - sizeof(*log_header)) / KEYSTORE_ENTRY_SIZE;
+    if (!header_valid(log_header, KEYSTORE_MAGIC, KEYSTORE_ENTRY_SIZE) || n > UINT32_MAX) {
+        munmap(map, size);
+        return ERROR_INVALID_INPUT;
+    }
+    // The log is read once, front to back
+    madvise(map, size, MADV_SEQUENTIAL);
+    const keystore_entry *entries = (const keystore_entry *)((const byte *)map + sizeof(*log_header));
+
+    key_record *keys = malloc((n ? n : 1) * sizeof(*keys));
+    path_record *paths = malloc((n ? n : 1) * sizeof(*paths));
+    if (keys == NULL || paths == NULL) {
+        result = ERROR_INTERNAL;
+    }
+    for (uint64_t i = 0; i < n && result == SUCCESS; i++) {
+        const keystore_entry *e = &entries[i];
+        memcpy(keys[i].key, e->key, ADDRESS_KEY_LENGTH);
+        keys[i].entry = (uint32_t)i;
+        memset(&paths[i], 0, sizeof(paths[i]));
+        paths[i].seed_fingerprint = e->seed_fingerprint;
+        paths[i].depth = e->depth <= KEYSTORE_MAX_DEPTH ? e->depth : KEYSTORE_MAX_DEPTH;
+        memcpy(paths[i].path, e->path, sizeof(paths[i].path));
+        paths[i].entry = (uint32_t)i;
+    }
+
+    if (result == SUCCESS) {
+        result = parallel_sort(keys, (size_t)n, sizeof(*keys), threads, compare_key_records);
+    }
+    if (result == SUCCESS) {
+        result = parallel_sort(paths, (size_t)n, sizeof(*paths), threads, compare_path_records);
+    }
+    if (result == SUCCESS && store_file(path, base, ".h160") == SUCCESS) {
+        result = write_index(path, log_header, KEYSTORE_INDEX_KEY, keys, n, sizeof(*keys));
+    }
+    if (result == SUCCESS && store_file(path, base, ".path") == SUCCESS) {
+        result = write_index(path, log_header, KEYSTORE_INDEX_PATH, paths, n, sizeof(*paths));
+    }
+
+    free(paths);
+    free(keys);
+    munmap(map, size);
+    if (result == SUCCESS && count != NULL) {
+        *count = n;
+    }
+    return result;
+}
+
+// ============ LOOKUPS ============
+
+/**
+ * @brief Maps an index and checks that it belongs to the log.
+ * @return Entries covered, or 0 if the index is unusable (and then unmapped).
+ */
+static uint64_t open_index(const char *file, const keystore *store, const keystore_header *log_header,
+                           uint32_t kind, size_t record_size, void **map, size_t *size) {
+    *map = NULL;
+    if (map_file(file, map, size) != SUCCESS) {
+        *map = NULL;
+        return 0;
+    }
+    const keystore_header *header = *map;
+    if (!header_valid(header, KEYSTORE_INDEX_MAGIC, (uint32_t)record_size) || header->kind != kind ||
+        memcmp(header->store_id, log_header->store_id, sizeof(header->store_id)) != 0 ||
+        header->count > store->count ||
+        header->count > (*size - sizeof(*header)) / record_size) {
+        munmap(*map, *size);
+        *map = NULL;
+        return 0;
+    }
+    // Lookups are random: skip readahead of neighbouring pages
+    madvise(*map, *size, MADV_RANDOM);
+    return header->count;
+}
+
+int keystore_open(keystore *store, const char *base) {
+    if (store == NULL || base == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(store, 0, sizeof(*store));
+    char path[KEYSTORE_PATH_SIZE + 8];
+    if (store_file(path, base, ".log") != SUCCESS) {
+        return ERROR_INVALID_INPUT;
+    }
+    int result = map_file(path, &store->log_map, &store->log_size);
+    if (result != SUCCESS) {
+        return result;
+    }
+    const keystore_header *log_header = store->log_map;
+    if (!header_valid(log_header, KEYSTORE_MAGIC, KEYSTORE_ENTRY_SIZE)) {
+        keystore_close(store);
+        return ERROR_INVALID_INPUT;
+    }
+    madvise(store->log_map, store->log_size, MADV_RANDOM);
+    store->entries = (const keystore_entry *)((const byte *)store->log_map + sizeof(*log_header));
+    store->count = (store->log_size - sizeof(*log_header)) / KEYSTORE_ENTRY_SIZE;
+
+    store_file(path, base, ".h160");
+    uint64_t keys = open_index(path, store, log_header, KEYSTORE_INDEX_KEY, sizeof(key_record),
+                               &store->key_map, &store->key_size);
+    store_file(path, base, ".path");
+    uint64_t paths = open_index(path, store, log_header, KEYSTORE_INDEX_PATH, sizeof(path_record),
+                                &store->path_map, &store->path_size);
+    // Both indexes come from one build; a mismatch means one is stale, so use neither
+    if (keys != paths || store->key_map == NULL || store->path_map == NULL) {
+        if (store->key_map) munmap(store->key_map, store->key_size);
+        if (store->path_map) munmap(store->path_map, store->path_size);
+        store->key_map = store->path_map = NULL;
+        keys = 0;
+    }
+    store->indexed = keys;
+    return SUCCESS;
+}
+
+void keystore_close(keystore *store) {
+    if (store == NULL) {
+        return;
+    }
+    if (store->key_map) munmap(store->key_map, store->key_size);
+    if (store->path_map) munmap(store->path_map, store->path_size);
+    if (store->log_map) munmap(store->log_map, store->log_size);
+    memset(store, 0, sizeof(*store));
+}
+
+/**
+ * @brief Lower bound of a probe in a sorted array: interpolation on a 64-bit
+ *        rank that grows with the sort order, then binary search.
+ * @param rank Monotonic rank of a record; ties are fine.
+ * @return First position whose record is not less than the probe.
+ */
+static uint64_t lower_bound(const byte *records, uint64_t count, size_t size, const void *probe,
+                            uint64_t (*rank)(const void *), int (*less)(const void *, const void *)) {
+    uint64_t lo = 0, hi = count;  // records before lo are less, from hi on not less
+    uint64_t target = rank(probe);
+    for (int step = 0; step < INTERPOLATION_STEPS && hi - lo > INTERPOLATION_MIN_WINDOW; step++) {
+        uint64_t lo_rank = rank(records + lo * size);
+        uint64_t hi_rank = rank(records + (hi - 1) * size);
+        if (target < lo_rank) {
+            return lo;
+        }
+        if (target > hi_rank) {
+            return hi;
+        }
+        if (lo_rank == hi_rank) {
+            break;
+        }
+        uint64_t pos = lo + (uint64_t)(((unsigned __int128)(target - lo_rank) * (hi - 1 - lo)) /
+                                       (hi_rank - lo_rank));
+        if (less(records + pos * size, probe)) {
+            lo = pos + 1;
+        } else {
+            hi = pos;
+        }
+    }
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (less(records + mid * size, probe)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static uint64_t key_rank(const void *record) {
+    return load_be64(((const key_record *)record)->key);
+}
+
+static int key_less(const void *record, const void *probe) {
+    return memcmp(((const key_record *)record)->key, ((const key_record *)probe)->key,
+                  ADDRESS_KEY_LENGTH) < 0;
+}
+
+static uint64_t path_rank(const void *record) {
+    const path_record *r = record;
+    // Fingerprints are hashes, so they interpolate well; paths of one seed do not
+    return (uint64_t)r->seed_fingerprint << 32 | (r->depth > 0 ? r->path[0] : 0);
+}
+
+static int path_less(const void *record, const void *probe) {
+    return compare_path_keys(record, probe) < 0;
+}
+
+int keystore_find_key(const keystore *store, const byte *key, keystore_match_fn fn, void *ctx) {
+    if (store == NULL || store->log_map == NULL || key == NULL || fn == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    int found = 0;
+    if (store->key_map != NULL) {
+        const key_record *records = (const key_record *)((const byte *)store->key_map + KEYSTORE_HEADER_SIZE);
+        key_record probe;
+        memcpy(probe.key, key, ADDRESS_KEY_LENGTH);
+        for (uint64_t i = lower_bound((const byte *)records, store->indexed, sizeof(*records), &probe,
+                                      key_rank, key_less);
+             i < store->indexed && memcmp(records[i].key, key, ADDRESS_KEY_LENGTH) == 0; i++) {
+            if (records[i].entry >= store->count) {
+                continue;  // Corrupt index record
+            }
+            int stop = fn(&store->entries[records[i].entry], ctx);
+            if (stop != 0) return stop;
+            found++;
+        }
+    }
+    // Entries appended since the last index build
+    for (uint64_t i = store->indexed; i < store->count; i++) {
+        if (memcmp(store->entries[i].key, key, ADDRESS_KEY_LENGTH) == 0) {
+            int stop = fn(&store->entries[i], ctx);
+            if (stop != 0) return stop;
+            found++;
+        }
+    }
+    return found;
+}
+
+int keystore_find_path(const keystore *store, uint32_t seed_fingerprint, const uint32_t *path,
+                       size_t depth, keystore_match_fn fn, void *ctx) {
+    if (store == NULL || store->log_map == NULL || (path == NULL && depth > 0) ||
+        depth > KEYSTORE_MAX_DEPTH || fn == NULL) {
+        return ERROR_INVALID_INPUT;
+    }
+    path_record probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.seed_fingerprint = seed_fingerprint;
+    probe.depth = (uint32_t)depth;
+    for (size_t i = 0; i < depth; i++) {
+        probe.path[i] = path[i];
+    }
+
+    int found = 0;
+    if (store->path_map != NULL) {
+        const path_record *records = (const path_record *)((const byte *)store->path_map + KEYSTORE_HEADER_SIZE);
+        for (uint64_t i = lower_bound((const byte *)records, store->indexed, sizeof(*records), &probe,
+                                      path_rank, path_less);
+             i < store->indexed && compare_path_keys(&records[i], &probe) == 0; i++) {
+            if (records[i].entry >= store->count) {
+                continue;  // Corrupt index record
+            }
+            int stop = fn(&store->entries[records[i].entry], ctx);
+            if (stop != 0) return stop;
+            found++;
+        }
+    }
+    for (uint64_t i = store->indexed; i < store->count; i++) {
+        const keystore_entry *e = &store->entries[i];
+        if (e->seed_fingerprint == seed_fingerprint && e->depth == depth &&
+            memcmp(e->path, probe.path, depth * sizeof(uint32_t)) == 0) {
+            int stop = fn(e, ctx);
+            if (stop != 0) return stop;
+            found++;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file keystore.h
+ * @brief Append-only store of derived public keys with sorted lookup indexes.
+ * @details A store is a set of files sharing one base name:
+ *          - "<base>.log": 64-byte header, then 96-byte entries, appended
+ *            only. An entry holds the seed fingerprint, the path, the output
+ *            type, the public key and its 20-byte match key. No secrets.
+ *          - "<base>.h160": entries sorted by match key (see
+ *            address_script_key), so an address, a scriptPubKey or a HASH160
+ *            leads to the seed and path that produced it.
+ *          - "<base>.path": entries sorted by (seed fingerprint, path).
+ *
+ *          Both indexes are mapped read-only and searched by interpolation
+ *          on their leading bytes, then by binary search. They are rebuilt
+ *          from the log with a parallel sort and replaced atomically; entries
+ *          appended since the last build are still found, by a linear scan
+ *          of the log tail.
+ */
+
+#ifndef KEYSTORE_H
+#define KEYSTORE_H
+
+#include <stdio.h>
+
+#include "../hdkey/hdkey.h"
+#include "../address/address.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Log file magic */
+#define KEYSTORE_MAGIC "MNKEYS01"
+
+/** @brief Index file magic */
+#define KEYSTORE_INDEX_MAGIC "MNKSIDX1"
+
+/** @brief Format version of the log and the indexes */
+#define KEYSTORE_VERSION 1
+
+/** @brief Longest path kept, in levels */
+#define KEYSTORE_MAX_DEPTH 6
+
+/** @brief Log and index header size */
+#define KEYSTORE_HEADER_SIZE 64
+
+/** @brief Log entry size */
+#define KEYSTORE_ENTRY_SIZE 96
+
+/** @brief Longest base name, suffix excluded */
+#define KEYSTORE_PATH_SIZE 4096
+
+/** @brief Index kinds */
+enum {
+    KEYSTORE_INDEX_KEY = 1,   ///< Sorted by match key.
+    KEYSTORE_INDEX_PATH = 2   ///< Sorted by seed fingerprint, then path.
+};
+
+/**
+ * @brief Log and index header (host byte order).
+ */
+typedef struct {
+    char magic[8];            ///< KEYSTORE_MAGIC or KEYSTORE_INDEX_MAGIC.
+    uint32_t version;         ///< KEYSTORE_VERSION.
+    uint32_t record_size;     ///< Entry or index record size.
+    uint64_t count;           ///< Index: log entries covered. Log: 0.
+    uint32_t kind;            ///< Index: KEYSTORE_INDEX_*. Log: 0.
+    uint32_t reserved0;       ///< Zero.
+    byte store_id[16];        ///< Random id of the log, copied into its indexes.
+    byte reserved1[16];       ///< Zero.
+} keystore_header;
+
+/**
+ * @brief One derived key (public data only).
+ */
+typedef struct {
+    byte key[ADDRESS_KEY_LENGTH];            ///< Match key of the output.
+    uint32_t seed_fingerprint;               ///< Master key fingerprint.
+    uint8_t depth;                           ///< Levels used in `path`.
+    uint8_t type;                            ///< address_type of the output.
+    uint16_t reserved0;                      ///< Zero.
+    uint32_t path[KEYSTORE_MAX_DEPTH];       ///< Child numbers, hardened ones offset by BIP32_HARDENED.
+    byte public_key[PUBLIC_KEY_LENGTH];      ///< Compressed public key.
+    byte reserved1[11];                      ///< Zero.
+} keystore_entry;
+
+/**
+ * @brief Append handle on a log.
+ */
+typedef struct {
+    FILE *file;               ///< Log, opened for appending.
+    uint64_t count;           ///< Entries in the log.
+} keystore_writer;
+
+/**
+ * @brief Read-only view of a store.
+ */
+typedef struct {
+    void *log_map;                  ///< Whole log mapping.
+    size_t log_size;                ///< Log mapping length.
+    const keystore_entry *entries;  ///< Log entries.
+    uint64_t count;                 ///< Entries in the log.
+    void *key_map;                  ///< Match key index mapping, NULL if absent or stale.
+    size_t key_size;
+    void *path_map;                 ///< Path index mapping, NULL if absent or stale.
+    size_t path_size;
+    uint64_t indexed;               ///< Entries covered by both indexes; the rest are scanned.
+} keystore;
+
+/**
+ * @brief Called for each entry found.
+ * @param entry Entry, in the log mapping.
+ * @param ctx Caller context.
+ * @return 0 to continue, anything else stops the lookup with that value.
+ */
+typedef int (*keystore_match_fn)(const keystore_entry *entry, void *ctx);
+
+/**
+ * @brief Fills an entry for a key at a path.
+ * @param entry Entry to fill.
+ * @param seed_fingerprint Master key fingerprint.
+ * @param path Child numbers.
+ * @param depth Number of child numbers (at most KEYSTORE_MAX_DEPTH).
+ * @param type Output type; gives the match key.
+ * @param public_key Compressed public key.
+ * @return 0 on success, negative error code on failure.
+ */
+int keystore_entry_set(keystore_entry *entry, uint32_t seed_fingerprint, const uint32_t *path,
+                       size_t depth, address_type type, const byte *public_key);
+
+/**
+ * @brief Opens a log for appending, creating it if needed.
+ * @param writer Writer to initialize.
+ * @param base Store base name.
+ * @return 0 on success, ERROR_INVALID_INPUT if the file is not a store log,
+ *         ERROR_INTERNAL on I/O failure.
+ * @note A torn last entry, left by an interrupted append, is cut off.
+ */
+int keystore_writer_open(keystore_writer *writer, const char *base);
+
+/**
+ * @brief Appends entries to the log.
+ * @param writer Open writer.
+ * @param entries Entries.
+ * @param count Number of entries.
+ * @return 0 on success, ERROR_INTERNAL on I/O failure.
+ */
+int keystore_writer_append(keystore_writer *writer, const keystore_entry *entries, size_t count);
+
+/**
+ * @brief Flushes and closes a log.
+ * @param writer Writer (can be zero-initialized).
+ * @return 0 on success, ERROR_INTERNAL on I/O failure.
+ */
+int keystore_writer_close(keystore_writer *writer);
+
+/**
+ * @brief Rebuilds both indexes from the log.
+ * @param base Store base name.
+ * @param threads Sorting threads, 0 for one per online CPU.
+ * @param count Output: entries indexed (nullable).
+ * @return 0 on success, negative error code on failure.
+ * @note Each index is written to a temporary file and renamed over the old
+ *       one, so readers see either index, never a partial one.
+ */
+int keystore_build_index(const char *base, size_t threads, uint64_t *count);
+
+/**
+ * @brief Maps a store for lookups.
+ * @param store Store to fill.
+ * @param base Store base name.
+ * @return 0 on success, ERROR_INVALID_INPUT if the log is missing or invalid.
+ * @note Missing, stale or foreign indexes are ignored; lookups then scan
+ *       the entries they do not cover.
+ */
+int keystore_open(keystore *store, const char *base);
+
+/**
+ * @brief Unmaps a store.
+ * @param store Store (can be zero-initialized).
+ */
+void keystore_close(keystore *store);
+
+/**
+ * @brief Finds the entries with a match key.
+ * @param store Open store.
+ * @param key 20-byte match key.
+ * @param fn Called for each entry.
+ * @param ctx Callback context.
+ * @return Number of entries found, the callback's value if it stopped the
+ *         lookup, or a negative error code.
+ */
+int keystore_find_key(const keystore *store, const byte *key, keystore_match_fn fn, void *ctx);
+
+/**
+ * @brief Finds the entries of a seed at a path.
+ * @param store Open store.
+ * @param seed_fingerprint Master key fingerprint.
+ * @param path Child numbers.
+ * @param depth Number of child numbers.
+ * @param fn Called for each entry.
+ * @param ctx Callback context.
+ * @return Number of entries found, the callback's value if it stopped the
+ *         lookup, or a negative error code.
+ */
+int keystore_find_path(const keystore *store, uint32_t seed_fingerprint, const uint32_t *path,
+                       size_t depth, keystore_match_fn fn, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KEYSTORE_H
@@ -5,7 +5,6 @@
  */
 #include <assert.h>
 #include <ctype.h>
-#include <dirent.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -16,6 +15,8 @@
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
 
+#include "wordlist/wordlist.h"
+
 // Platform-specific headers and functions
 #ifdef _WIN32
 #include <bcrypt.h>
@@ -26,9 +27,7 @@
 #include <unistd.h>
 #endif
 
-#define MNEMONIC_MAX_LENGTH 16  ///< Maximum expected length of a mnemonic line.
 #define MAX_FILES 100           // Maximum files in the folder
-#define PATH_MAX 4096           // Maximum path length
 
 // Function prototypes
 void print_header();
@@ -46,20 +45,17 @@ void concat_arrays(unsigned char **dest, size_t *dest_size, unsigned char *src,
                    size_t src_size);
 
 void free_words(char **words, size_t count);
-char **read_mnemonics(const char *filename, size_t *num_lines);
 size_t entropy_to_index(const unsigned char *chunk, size_t mnemonics_count);
 char **generate_mnemonics(const unsigned char *entropy, size_t num_bytes,
-                          const char *filename, size_t *num_words);
+                          const wordlist *list, size_t *num_words);
 
 int is_valid_number(int num);
-int receive_input(int argc, char *argv[], size_t *num_out, char **filename_out);
+int receive_input(int argc, char *argv[], wordlist_registry *registry,
+                  size_t *num_out, const wordlist **list_out);
 int process_command_line(int argc, char *argv[], size_t *num_out,
                          int *file_index_out, char *files[], int file_count);
-int get_wordlist_files(char *files[], int max_files);
 int process_interactive_mode(size_t *num_out, int *file_index_out,
                              char *files[], int file_count);
-int get_wordlist_files(char *files[], int max_files);
-void cleanup_files_list(char *files[], int count);
 
 // ============ CRYPTOGRAPHY ============
 
@@ -181,53 +177,6 @@ void entropy_checksum_and_concat(unsigned char **buffer, size_t *length) {
 
 // ============ MNEMONICS ===========
 
-/**
- * @brief Reads a file into an array of strings (one per line).
- * @param filename The name of the file to read.
- * @param num_lines Output parameter to store the number of lines read.
- * @return A dynamically allocated array of strings (must be freed by the
- * caller), or NULL on failure.
- */
-char **read_mnemonics(const char *filename, size_t *num_lines) {
-    if (!filename || !num_lines) return NULL;
-
-    FILE *file = fopen(filename, "r");
-    if (!file) return NULL;
-
-    // Count lines first to allocate exact memory needed.
-    size_t count = 0;
-    char ch;
-    while ((ch = fgetc(file)) != EOF) {
-        if (ch == '\n') count++;
-    }
-    rewind(file);
-
-    char **lines = malloc(count * sizeof(char *));
-    if (!lines) {
-        fclose(file);
-        return NULL;
-    }
-
-    char buffer[MNEMONIC_MAX_LENGTH];
-    size_t i = 0;
-    while (fgets(buffer, sizeof(buffer), file)) {
-        buffer[strcspn(buffer, "\n")] = '\0';  // Remove newline.
-        lines[i] = strdup(buffer);
-        if (!lines[i]) {
-            // Cleanup on failure.
-            for (size_t j = 0; j < i; j++) free(lines[j]);
-            free(lines);
-            fclose(file);
-            return NULL;
-        }
-        i++;
-    }
-    fclose(file);
-
-    *num_lines = count;
-    return lines;
-}
-
 /**
  * @brief Converts 11 bytes of entropy into an index within `mnemonics` range.
  * @param chunk Pointer to 11 bytes of entropy data.
@@ -250,50 +199,35 @@ size_t entropy_to_index(const unsigned char *chunk, size_t mnemonics_count) {
  * @param entropy The entropy array (must be at least `11 * num_words` bytes
  * long).
  * @param num_bytes Total size of the entropy array in bytes.
- * @param filename The file containing mnemonics (one per line).
+ * @param list Loaded wordlist from the registry.
  * @param num_words Output parameter to store the number of words generated.
  * @return A dynamically allocated array of selected mnemonics (must be freed by
  * the caller), or NULL on failure.
  */
 char **generate_mnemonics(const unsigned char *entropy, size_t num_bytes,
-                          const char *filename, size_t *num_words) {
-    if (!entropy || !filename || !num_words || num_bytes % 11 != 0) {
-        return NULL;
-    }
-
-    size_t mnemonics_count = 0;
-    char **mnemonics = read_mnemonics(filename, &mnemonics_count);
-    if (!mnemonics || mnemonics_count == 0) {
-        printf("Error: Failed to read mnemonics from file: %s.\n", filename);
+                          const wordlist *list, size_t *num_words) {
+    if (!entropy || !list || !num_words || num_bytes % 11 != 0) {
         return NULL;
     }
 
     *num_words = num_bytes / 11;
     char **selected_words = malloc(*num_words * sizeof(char *));
     if (!selected_words) {
-        for (size_t i = 0; i < mnemonics_count; i++) free(mnemonics[i]);
-        free(mnemonics);
         return NULL;
     }
 
     for (size_t i = 0; i < *num_words; i++) {
         const unsigned char *chunk = entropy + (i * 11);
-        size_t index = entropy_to_index(chunk, mnemonics_count);
-        selected_words[i] = strdup(mnemonics[index]);
+        size_t index = entropy_to_index(chunk, WORDLIST_WORD_COUNT);
+        selected_words[i] = strdup(list->words[index]);
         if (!selected_words[i]) {
             // Cleanup on failure.
             for (size_t j = 0; j < i; j++) free(selected_words[j]);
             free(selected_words);
-            for (size_t j = 0; j < mnemonics_count; j++) free(mnemonics[j]);
-            free(mnemonics);
             return NULL;
         }
     }
 
-    // Free the mnemonics array (no longer needed).
-    for (size_t i = 0; i < mnemonics_count; i++) free(mnemonics[i]);
-    free(mnemonics);
-
     return selected_words;
 }
 
@@ -447,18 +381,18 @@ int is_valid_number(int num) {
  * @brief Unified input processor (CLI or interactive)
  * @param argc Argument count
  * @param argv Argument vector
+ * @param registry Wordlist registry (list names come from its manifest)
  * @param num_out Output for validated number
- * @param filename_out Output for selected filename (must be freed by caller)
+ * @param list_out Output for the selected list, loaded and digest-checked
  * @return 1 on success, 0 if no input processed, -1 on error
  */
-int receive_input(int argc, char *argv[], size_t *num_out,
-                  char **filename_out) {
-    // Get available files first
+int receive_input(int argc, char *argv[], wordlist_registry *registry,
+                  size_t *num_out, const wordlist **list_out) {
+    // Names of the registered lists, no directory scan
     char *files[MAX_FILES];
-    int file_count = get_wordlist_files(files, MAX_FILES);
-    if (file_count <= 0) {
-        fprintf(stderr, "No wordlists found in ./wordlists directory\n");
-        return -1;
+    int file_count = 0;
+    for (size_t i = 0; i < registry->count && file_count < MAX_FILES; i++) {
+        files[file_count++] = registry->lists[i].name;
     }
 
     int file_index = -1;
@@ -467,43 +401,30 @@ int receive_input(int argc, char *argv[], size_t *num_out,
     // Try CLI first
     if ((result = process_command_line(argc, argv, num_out, &file_index, files,
                                        file_count)) != 0) {
-        if (result < 0) {
-            cleanup_files_list(files, file_count);
-            return -1;
-        }
+        if (result < 0) return -1;
     }
     // Fall back to interactive
     else if ((result = process_interactive_mode(num_out, &file_index, files,
                                                 file_count)) <= 0) {
-        cleanup_files_list(files, file_count);
         return result;
     }
 
     // Validate selected index
     if (file_index < 0 || file_index >= file_count) {
-        cleanup_files_list(files, file_count);
         return -1;
     }
 
-    // Build full path
-    char path[PATH_MAX];
-    snprintf(path, sizeof(path), "./wordlists/%s", files[file_index]);
-    *filename_out = strdup(path);
-
-    // Cleanup
-    cleanup_files_list(files, file_count);
-    return 1;
-}
-
-/**
- * @brief Helper to cleanup files list
- * @param files Array of filenames
- * @param count Number of files in array
- */
-void cleanup_files_list(char *files[], int count) {
-    for (int i = 0; i < count; i++) {
-        free(files[i]);
+    // Map the list on first use
+    int error = WORDLIST_OK;
+    *list_out = wordlist_registry_get(registry, (size_t)file_index, &error);
+    if (!*list_out) {
+        fprintf(stderr, "Wordlist %s rejected: %s\n", files[file_index],
+                error == WORDLIST_ERROR_DIGEST ? "SHA-256 differs from " WORDLIST_MANIFEST
+                : error == WORDLIST_ERROR_FORMAT ? "not 2048 unique words"
+                : "cannot be read");
+        return -1;
     }
+    return 1;
 }
 
 /**
@@ -604,35 +525,6 @@ void print_files_list(char *files[], int count) {
     }
 }
 
-/**
- * @brief Gets list of available wordlist files
- * @param files Output array for filenames (must be freed by caller)
- * @param max_files Maximum number of files to return
- * @return Number of files found, or -1 on error
- */
-int get_wordlist_files(char *files[], int max_files) {
-    DIR *dir = opendir("./wordlists");
-    if (!dir) return -1;
-
-    struct dirent *entry;
-    int count = 0;
-
-    while ((entry = readdir(dir)) && count < max_files) {
-        if (entry->d_type == DT_REG) {
-            files[count] = strdup(entry->d_name);
-            if (!files[count]) {
-                // Cleanup on allocation failure
-                while (count-- > 0) free(files[count]);
-                closedir(dir);
-                return -1;
-            }
-            count++;
-        }
-    }
-    closedir(dir);
-    return count;
-}
-
 /**
  * @brief Program entry point
  * @param argc Argument count
@@ -652,9 +544,18 @@ int main(int argc, char *argv[]) {
         print_help();
     }
 
+    wordlist_registry registry;
+    if (wordlist_registry_open(&registry, "./wordlists") != WORDLIST_OK) {
+        fprintf(stderr, "No wordlists found in ./wordlists directory\n");
+        return EXIT_FAILURE;
+    }
+
     size_t num = 0;
-    char *filename = NULL;
-    int result = receive_input(argc, argv, &num, &filename);
+    const wordlist *list = NULL;
+    if (receive_input(argc, argv, &registry, &num, &list) <= 0) {
+        wordlist_registry_close(&registry);
+        return EXIT_FAILURE;
+    }
 
     // printf("num: %d \n",num);
     // If you use 256 bits you get a 24-word mnemonic)
@@ -665,7 +566,7 @@ int main(int argc, char *argv[]) {
     // print_entropy(entropy,num); // Print the buffer with the hash
     // size_t num_bytes = sizeof(entropy);
     size_t num_words = 0;
-    char **words = generate_mnemonics(entropy, num, filename, &num_words);
+    char **words = generate_mnemonics(entropy, num, list, &num_words);
     printf("\nmnemonics words %zu:\n", num_words);
     print_mnemonics((const char **)words, num_words, 4);
 
@@ -679,6 +580,7 @@ int main(int argc, char *argv[]) {
 
     // Ending
     free_words(words, num_words);
+    wordlist_registry_close(&registry);
     print_ending();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+/**
+ * @file record.c
+ * @brief Fixed-width binary records for batch output.
+ */
+#include "record.h"
+
+#include <fcntl.h>      // For open
+#include <string.h>     // For memcmp, memcpy, memset, strlen
+#include <sys/mman.h>   // For mmap, munmap
+#include <sys/stat.h>   // For fstat
+#include <unistd.h>     // For close
+
+#include "../cpto/cpto.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "record files are little-endian; this host would need byte swapping"
+#endif
+
+int record_set_entropy(seed_record *record, const uint8_t *entropy, size_t len) {
+    if (!record || !entropy || len < 16 || len > 32 || len % 4 != 0) {
+        return RECORD_ERROR_INVALID;
+    }
+    uint8_t hash[SHA256_DIGEST_SIZE];
+    sha256(entropy, len, hash);
+    memset(record->entropy, 0, sizeof(record->entropy));
+    memcpy(record->entropy, entropy, len);
+    // Checksum: the top len / 4 bits of the hash, kept in the byte after the entropy
+    size_t checksum_bits = len / 4;
+    record->entropy[len] = (uint8_t)(hash[0] & (0xff << (8 - checksum_bits)));
+    record->entropy_length = (uint8_t)len;
+    record->word_count = (uint8_t)((len * 8 + checksum_bits) / 11);
+
+    for (size_t i = 0; i < record->word_count; i++) {
+        size_t bit = i * 11;
+        // Three bytes always cover an 11-bit group; entropy[] is padded for the last one
+        uint32_t window = (uint32_t)record->entropy[bit / 8] << 16 |
+                          (uint32_t)(bit / 8 + 1 < sizeof(record->entropy) ? record->entropy[bit / 8 + 1] : 0) << 8 |
+                          (uint32_t)(bit / 8 + 2 < sizeof(record->entropy) ? record->entropy[bit / 8 + 2] : 0);
+        record->indices[i] = (uint16_t)((window >> (24 - 11 - bit % 8)) & 0x7ff);
+    }
+    record->fields |= RECORD_HAS_ENTROPY;
+    return RECORD_OK;
+}
+
+int record_writer_init(record_writer *writer, FILE *out, const char *path, uint32_t pubkey_count) {
+    if (!writer || !out || pubkey_count > RECORD_MAX_PUBKEYS ||
+        (path && strlen(path) >= RECORD_PATH_SIZE)) {
+        return RECORD_ERROR_INVALID;
+    }
+    memset(writer, 0, sizeof(*writer));
+    writer->out = out;
+    writer->start = ftell(out);
+
+    record_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+    header.version = RECORD_VERSION;
+    header.record_size = RECORD_SIZE;
+    header.pubkey_count = pubkey_count;
+    if (path) memcpy(header.path, path, strlen(path));
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        writer->error = RECORD_ERROR_IO;
+    }
+    return writer->error;
+}
+
+int record_writer_append(record_writer *writer, const seed_record *records, size_t count) {
+    if (!writer || (!records && count)) return RECORD_ERROR_INVALID;
+    if (writer->error) return writer->error;
+    if (fwrite(records, sizeof(seed_record), count, writer->out) != count) {
+        writer->error = RECORD_ERROR_IO;
+    }
+    writer->count += count;
+    return writer->error;
+}
+
+int record_writer_finish(record_writer *writer) {
+    if (!writer || !writer->out) return RECORD_ERROR_INVALID;
+    if (writer->error == RECORD_OK) {
+        // Pipes and sealed streams cannot seek; readers then count by file size
+        long end = ftell(writer->out);
+        if (writer->start >= 0 && end >= 0 &&
+            fseek(writer->out, writer->start + (long)offsetof(record_header, record_count), SEEK_SET) == 0) {
+            if (fwrite(&writer->count, sizeof(writer->count), 1, writer->out) != 1 ||
+                fseek(writer->out, end, SEEK_SET) != 0) {
+                writer->error = RECORD_ERROR_IO;
+            }
+        }
+        clearerr(writer->out);
+        if (writer->error == RECORD_OK && fflush(writer->out) != 0) {
+            writer->error = RECORD_ERROR_IO;
+        }
+    }
+    int result = writer->error;
+    writer->out = NULL;
+    return result;
+}
+
+int record_reader_open(record_reader *reader, const char *path) {
+    if (!reader || !path) return RECORD_ERROR_INVALID;
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return RECORD_ERROR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return RECORD_ERROR_IO;
+    }
+    if (st.st_size < RECORD_HEADER_SIZE) {
+        close(fd);
+        return RECORD_ERROR_INVALID;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return RECORD_ERROR_IO;
+
+    const record_header *header = map;
+    size_t size = (size_t)st.st_size;
+    int result = RECORD_OK;
+    if (memcmp(header->magic, RECORD_MAGIC, sizeof(header->magic)) != 0 ||
+        header->pubkey_count > RECORD_MAX_PUBKEYS) {
+        result = RECORD_ERROR_INVALID;
+    } else if (header->version != RECORD_VERSION || header->record_size != RECORD_SIZE) {
+        result = RECORD_ERROR_VERSION;
+    } else if ((size - RECORD_HEADER_SIZE) % RECORD_SIZE != 0 ||
+               (header->record_count &&
+                header->record_count != (size - RECORD_HEADER_SIZE) / RECORD_SIZE)) {
+        result = RECORD_ERROR_INVALID;  // Truncated, or header and size disagree
+    }
+    if (result != RECORD_OK) {
+        munmap(map, size);
+        return result;
+    }
+
+    reader->map = map;
+    reader->size = size;
+    reader->header = header;
+    reader->records = (const seed_record *)((const uint8_t *)map + RECORD_HEADER_SIZE);
+    reader->count = (size - RECORD_HEADER_SIZE) / RECORD_SIZE;
+    return RECORD_OK;
+}
+
+void record_reader_close(record_reader *reader) {
+    if (!reader) return;
+    if (reader->map) munmap(reader->map, reader->size);
+    memset(reader, 0, sizeof(*reader));
+}
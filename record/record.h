@@ -0,0 +1,179 @@
+/**
+ * @file record.h
+ * @brief Fixed-width binary records for batch output.
+ * @details A record file is a 64-byte header followed by 512-byte records,
+ *          so record i starts at 64 + 512 * i and every record is 64-byte
+ *          aligned in a mapping. A record holds the entropy with its
+ *          checksum, the word indices, the seed, the master key and the
+ *          public keys of the first children of one derivation path.
+ *          Multi-byte integers are little-endian and every field sits at its
+ *          natural alignment, so on x86 and ARM the structs below are read
+ *          straight from the mapping.
+ */
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdio.h>   // For FILE
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint16_t, uint32_t, uint64_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief File magic */
+#define RECORD_MAGIC "MNRECS01"
+
+/** @brief Format version, bumped on any layout change */
+#define RECORD_VERSION 1
+
+/** @brief Header size in bytes */
+#define RECORD_HEADER_SIZE 64
+
+/** @brief Record size in bytes */
+#define RECORD_SIZE 512
+
+/** @brief Child public keys a record can hold */
+#define RECORD_MAX_PUBKEYS 6
+
+/** @brief Longest derivation path kept in the header, NUL included */
+#define RECORD_PATH_SIZE 32
+
+/** @brief Error codes */
+enum {
+    RECORD_OK = 0,
+    RECORD_ERROR_INVALID = -1,   /**< Bad arguments or not a record file */
+    RECORD_ERROR_IO = -2,        /**< Read, write or mapping failure */
+    RECORD_ERROR_VERSION = -3    /**< Record file of another version or record size */
+};
+
+/** @brief Which fields of a record are filled */
+enum {
+    RECORD_HAS_ENTROPY = 1 << 0,   /**< entropy, entropy_length, word_count, indices */
+    RECORD_HAS_SEED = 1 << 1,      /**< seed */
+    RECORD_HAS_MASTER = 1 << 2,    /**< master_key, chain_code, master_public_key */
+    RECORD_HAS_PUBKEYS = 1 << 3    /**< pubkeys[0..header pubkey_count) */
+};
+
+/**
+ * @brief File header.
+ */
+typedef struct {
+    char magic[8];                 /**< RECORD_MAGIC */
+    uint32_t version;              /**< RECORD_VERSION */
+    uint32_t record_size;          /**< RECORD_SIZE */
+    uint64_t record_count;         /**< Records, or 0 if the stream could not be rewound */
+    uint32_t pubkey_count;         /**< Child public keys per record */
+    uint32_t reserved;             /**< Zero */
+    char path[RECORD_PATH_SIZE];   /**< Parent path of the child keys, e.g. "m/84'/0'/0'/0" */
+} record_header;
+
+/**
+ * @brief One record.
+ */
+typedef struct {
+    uint8_t entropy[33];           /**< Entropy then the checksum byte, zero padded */
+    uint8_t entropy_length;        /**< Entropy bytes (16..32) */
+    uint8_t word_count;            /**< Words (12..24) */
+    uint8_t pubkey_count;          /**< Child public keys filled */
+    uint32_t fields;               /**< RECORD_HAS_* */
+    uint16_t indices[24];          /**< 11-bit word indices */
+    uint8_t reserved0[40];         /**< Zero */
+    uint8_t seed[64];              /**< BIP-39 seed, offset 128 */
+    uint8_t master_key[32];        /**< Master private key, offset 192 */
+    uint8_t chain_code[32];        /**< Master chain code, offset 224 */
+    uint8_t master_public_key[33]; /**< Compressed, offset 256 */
+    uint8_t pubkeys[RECORD_MAX_PUBKEYS][33]; /**< Children 0..n-1 of the header path, compressed */
+    uint8_t reserved1[25];         /**< Zero */
+} seed_record;
+
+#ifndef __cplusplus
+_Static_assert(sizeof(record_header) == RECORD_HEADER_SIZE, "record header layout");
+_Static_assert(sizeof(seed_record) == RECORD_SIZE, "record layout");
+#endif
+
+/** @brief Streaming record writer; fields are private */
+typedef struct {
+    FILE *out;                     /**< Destination */
+    long start;                    /**< Stream offset of the header, -1 if not seekable */
+    uint64_t count;                /**< Records written */
+    int error;                     /**< First error, sticky */
+} record_writer;
+
+/** @brief Mapped record file */
+typedef struct {
+    void *map;                     /**< Whole file */
+    size_t size;                   /**< File size */
+    const record_header *header;   /**< Header, in the mapping */
+    const seed_record *records;    /**< First record, in the mapping */
+    uint64_t count;                /**< Records in the file */
+} record_reader;
+
+/**
+ * @brief Fills the entropy fields of a record: checksum byte and word indices.
+ * @param record Record to update.
+ * @param entropy Entropy bytes.
+ * @param len 16, 20, 24, 28 or 32.
+ * @return RECORD_OK or RECORD_ERROR_INVALID.
+ */
+int record_set_entropy(seed_record *record, const uint8_t *entropy, size_t len);
+
+/**
+ * @brief Writes the header of a record stream.
+ * @param writer Writer to initialize.
+ * @param out Destination stream (not closed by the writer).
+ * @param path Parent path of the child public keys, or NULL.
+ * @param pubkey_count Child public keys per record (at most RECORD_MAX_PUBKEYS).
+ * @return RECORD_OK or a negative error code.
+ */
+int record_writer_init(record_writer *writer, FILE *out, const char *path, uint32_t pubkey_count);
+
+/**
+ * @brief Appends records.
+ * @param writer Writer.
+ * @param records Records to write.
+ * @param count Number of records.
+ * @return RECORD_OK or a negative error code (sticky).
+ */
+int record_writer_append(record_writer *writer, const seed_record *records, size_t count);
+
+/**
+ * @brief Stores the record count in the header when the stream can be
+ *        rewound, and flushes.
+ * @param writer Writer.
+ * @return RECORD_OK, or the first error seen by the writer.
+ */
+int record_writer_finish(record_writer *writer);
+
+/**
+ * @brief Maps a record file and checks its header.
+ * @param reader Reader to initialize.
+ * @param path Record file.
+ * @return RECORD_OK, RECORD_ERROR_VERSION for another layout, or another
+ *         negative error code.
+ * @note The count comes from the file size; a count in the header must agree.
+ */
+int record_reader_open(record_reader *reader, const char *path);
+
+/**
+ * @brief Returns record i (no copy, no parsing).
+ * @param reader Open reader.
+ * @param index Record index (< reader->count).
+ * @return The record in the mapping, or NULL if out of range.
+ */
+static inline const seed_record *record_reader_get(const record_reader *reader, uint64_t index) {
+    return index < reader->count ? &reader->records[index] : NULL;
+}
+
+/**
+ * @brief Unmaps a record file.
+ * @param reader Reader to close (can be zero-initialized).
+ */
+void record_reader_close(record_reader *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RECORD_H
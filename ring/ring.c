@@ -0,0 +1,194 @@
+/**
+ * @file ring.c
+ * @brief Bounded lock-free multi-producer/multi-consumer ring queue.
+ */
+#include "ring.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+/** @brief Empty polls spent spinning before a waiting call starts yielding */
+#define RING_SPIN_LIMIT 64
+
+/**
+ * @brief Sequence number of the slot of a position.
+ * @param ring Ring.
+ * @param pos Position (any lap).
+ * @return Sequence number; the element follows it in the slot.
+ */
+static inline atomic_size_t *slot_seq(const ring *ring, size_t pos) {
+    return (atomic_size_t *)(ring->slots + (pos & ring->mask) * ring->stride);
+}
+
+/**
+ * @brief Element storage of the slot of a position.
+ */
+static inline unsigned char *slot_data(const ring *ring, size_t pos) {
+    return ring->slots + (pos & ring->mask) * ring->stride + sizeof(atomic_size_t);
+}
+
+/**
+ * @brief Waits a little before polling again.
+ * @param spins Polls so far, updated.
+ */
+static void backoff(unsigned *spins) {
+    if (++*spins < RING_SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else {
+        sched_yield();
+    }
+}
+
+int ring_init(ring *ring, size_t capacity, size_t elem_size) {
+    if (ring == NULL || capacity == 0 || capacity > RING_MAX_CAPACITY || elem_size == 0 ||
+        elem_size > RING_MAX_CAPACITY) {
+        return RING_ERROR_INVALID;
+    }
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    size_t stride = (sizeof(atomic_size_t) + elem_size + RING_CACHE_LINE - 1) &
+                    ~(size_t)(RING_CACHE_LINE - 1);
+    if (slots > SIZE_MAX / stride) {
+        return RING_ERROR_INVALID;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = aligned_alloc(RING_CACHE_LINE, slots * stride);
+    if (ring->slots == NULL) {
+        return RING_ERROR_INTERNAL;
+    }
+    ring->mask = slots - 1;
+    ring->elem_size = elem_size;
+    ring->stride = stride;
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(slot_seq(ring, i), i);
+    }
+    atomic_init(&ring->enqueue_pos, 0);
+    atomic_init(&ring->dequeue_pos, 0);
+    atomic_init(&ring->closed, 0);
+    return RING_OK;
+}
+
+void ring_free(ring *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+size_t ring_push(ring *ring, const void *elems, size_t count) {
+    /* With nothing to claim, a ring that is neither full nor empty would never break the loop */
+    if (count == 0) {
+        return 0;
+    }
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    size_t n;
+    for (;;) {
+        /* A slot is free for position p once its sequence reads p */
+        for (n = 0; n < count && n <= ring->mask; n++) {
+            size_t seq = atomic_load_explicit(slot_seq(ring, pos + n), memory_order_acquire);
+            if (seq != pos + n) {
+                break;
+            }
+        }
+        if (n > 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + n,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        size_t seq = atomic_load_explicit(slot_seq(ring, pos), memory_order_acquire);
+        if ((intptr_t)(seq - pos) < 0) {
+            return 0;  // Full: the slot still holds the element of the previous lap
+        }
+        pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    }
+
+    const unsigned char *src = elems;
+    for (size_t i = 0; i < n; i++) {
+        memcpy(slot_data(ring, pos + i), src + i * ring->elem_size, ring->elem_size);
+        atomic_store_explicit(slot_seq(ring, pos + i), pos + i + 1, memory_order_release);
+    }
+    return n;
+}
+
+size_t ring_pop(ring *ring, void *elems, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    size_t n;
+    for (;;) {
+        /* A slot holds the element of position p once its sequence reads p + 1 */
+        for (n = 0; n < max && n <= ring->mask; n++) {
+            size_t seq = atomic_load_explicit(slot_seq(ring, pos + n), memory_order_acquire);
+            if (seq != pos + n + 1) {
+                break;
+            }
+        }
+        if (n > 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + n,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        size_t seq = atomic_load_explicit(slot_seq(ring, pos), memory_order_acquire);
+        if ((intptr_t)(seq - (pos + 1)) < 0) {
+            return 0;  // Empty: the slot has not been written this lap
+        }
+        pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    }
+
+    unsigned char *dst = elems;
+    for (size_t i = 0; i < n; i++) {
+        memcpy(dst + i * ring->elem_size, slot_data(ring, pos + i), ring->elem_size);
+        atomic_store_explicit(slot_seq(ring, pos + i), pos + i + ring->mask + 1, memory_order_release);
+    }
+    return n;
+}
+
+void ring_push_all(ring *ring, const void *elems, size_t count) {
+    const unsigned char *src = elems;
+    unsigned spins = 0;
+    while (count > 0) {
+        size_t n = ring_push(ring, src, count);
+        if (n == 0) {
+            backoff(&spins);
+            continue;
+        }
+        spins = 0;
+        src += n * ring->elem_size;
+        count -= n;
+    }
+}
+
+size_t ring_pop_wait(ring *ring, void *elems, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+    unsigned spins = 0;
+    for (;;) {
+        size_t n = ring_pop(ring, elems, max);
+        if (n > 0) {
+            return n;
+        }
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            /* Every push happened before the close, so one more poll is final */
+            return ring_pop(ring, elems, max);
+        }
+        backoff(&spins);
+    }
+}
+
+void ring_close(ring *ring) {
+    atomic_store_explicit(&ring->closed, 1, memory_order_release);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file ring.h
+ * @brief Bounded lock-free multi-producer/multi-consumer ring queue.
+ * @details The transport between the stages of a pipeline (read, PBKDF2,
+ *          derive, serialize, write). Elements are fixed-size and copied
+ *          into the ring, so small records need no allocation; pass pointers
+ *          for large ones.
+ *
+ *          Each slot carries a sequence number (Vyukov's bounded MPMC
+ *          queue): a producer claims positions by advancing the enqueue
+ *          counter with one compare-and-swap, writes the slots and publishes
+ *          each by setting its sequence; consumers do the same on the
+ *          dequeue counter. Batch calls claim a whole run of positions with
+ *          one compare-and-swap. Slots and both counters sit on their own
+ *          cache lines, so producers and consumers do not share lines except
+ *          for the slots they hand over.
+ *
+ *          No call takes a lock. A thread that has claimed a slot but not
+ *          yet published it makes the thread claiming that slot next lap
+ *          wait for it, as in any sequence-number ring.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>     // For size_t
+#include <stdatomic.h>  // For atomic_size_t, atomic_int
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Cache line size assumed for padding */
+#define RING_CACHE_LINE 64
+
+/** @brief Most slots a ring can have */
+#define RING_MAX_CAPACITY ((size_t)1 << 24)
+
+/** @brief Error codes */
+enum {
+    RING_OK = 0,
+    RING_ERROR_INVALID = -1,   /**< Bad arguments */
+    RING_ERROR_INTERNAL = -2   /**< Allocation failure */
+};
+
+/**
+ * @brief Ring queue; fields are private.
+ */
+typedef struct {
+    _Alignas(RING_CACHE_LINE) atomic_size_t enqueue_pos;  /**< Next position to claim for writing */
+    _Alignas(RING_CACHE_LINE) atomic_size_t dequeue_pos;  /**< Next position to claim for reading */
+    _Alignas(RING_CACHE_LINE) unsigned char *slots;       /**< capacity slots of `stride` bytes */
+    size_t mask;                                          /**< capacity - 1 */
+    size_t elem_size;                                     /**< Bytes per element */
+    size_t stride;                                        /**< Bytes per slot, a multiple of RING_CACHE_LINE */
+    atomic_int closed;                                    /**< Set once no more elements will come */
+} ring;
+
+/**
+ * @brief Creates a ring.
+ * @param ring Ring to initialize.
+ * @param capacity Slots; rounded up to a power of two (at most RING_MAX_CAPACITY).
+ * @param elem_size Bytes per element (at least 1).
+ * @return RING_OK or a negative error code.
+ */
+int ring_init(ring *ring, size_t capacity, size_t elem_size);
+
+/**
+ * @brief Frees a ring.
+ * @param ring Ring (can be zero-initialized). No thread may still use it.
+ */
+void ring_free(ring *ring);
+
+/**
+ * @brief Pushes up to `count` elements without waiting.
+ * @param ring Ring.
+ * @param elems `count` elements, back to back.
+ * @param count Number of elements.
+ * @return Number of elements pushed, from the front of `elems` (0 if full or `count` is 0).
+ */
+size_t ring_push(ring *ring, const void *elems, size_t count);
+
+/**
+ * @brief Pops up to `max` elements without waiting.
+ * @param ring Ring.
+ * @param elems Output, room for `max` elements.
+ * @param max Most elements to pop.
+ * @return Number of elements popped (0 if empty or `max` is 0).
+ */
+size_t ring_pop(ring *ring, void *elems, size_t max);
+
+/**
+ * @brief Pushes all elements, spinning then yielding while the ring is full.
+ * @param ring Ring.
+ * @param elems `count` elements, back to back.
+ * @param count Number of elements.
+ */
+void ring_push_all(ring *ring, const void *elems, size_t count);
+
+/**
+ * @brief Pops at least one element, spinning then yielding while the ring is empty.
+ * @param ring Ring.
+ * @param elems Output, room for `max` elements.
+ * @param max Most elements to pop (at least 1).
+ * @return Number of elements popped; 0 only once the ring is closed and empty, or if `max` is 0.
+ */
+size_t ring_pop_wait(ring *ring, void *elems, size_t max);
+
+/**
+ * @brief Marks the end of the stream.
+ * @param ring Ring.
+ * @note Call once every producer has returned from its last push; waiting
+ *       consumers then drain the ring and get 0.
+ */
+void ring_close(ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RING_H
@@ -0,0 +1,403 @@
+/**
+ * @file scan.c
+ * @brief Parallel multi-purpose, multi-account address derivation.
+ */
+#include "scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../hdkey/hdbatch.h"
+
+/** @brief Number of address types a scan can cover */
+#define SCAN_TYPE_COUNT 4
+
+/** @brief Jobs in flight per thread between two in-order flushes */
+#define SCAN_JOBS_PER_THREAD 4
+
+/**
+ * @brief One block of leaves: count children of one chain key.
+ */
+typedef struct {
+    hdkey_batch *chain;  ///< Chain keys of every account of one type.
+    size_t lane;         ///< Lane of the account in `chain`.
+    address_type type;
+    uint32_t account;
+    uint32_t chain_index;
+    uint32_t first;
+    size_t count;
+} scan_job;
+
+/**
+ * @brief Thread pool state; jobs are processed in waves of `slots` jobs.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;     ///< Signalled when a wave starts or on shutdown.
+    pthread_cond_t done;     ///< Signalled when the last job of a wave finishes.
+    const scan_job *jobs;
+    scan_entry *results;     ///< slots x SCAN_BLOCK entries.
+    size_t slots;
+    size_t wave_start;       ///< First job of the current wave.
+    size_t next;             ///< Next job to hand out.
+    size_t end;              ///< One past the last job of the wave.
+    size_t pending;          ///< Jobs of the wave not finished yet.
+    unsigned generation;     ///< Incremented for every wave.
+    int stop;
+    int error;               ///< First error of the wave.
+    scan_emit_fn emit;       ///< Set when blocks are emitted by the thread that derived them.
+    void *ctx;               ///< Context of `emit`.
+    const topology *topo;    ///< Set when workers are pinned.
+} scan_pool;
+
+/**
+ * @brief Start arguments of one worker.
+ */
+typedef struct {
+    scan_pool *pool;
+    int cpu;                 ///< CPU to pin to, when pool->topo is set.
+} scan_worker_arg;
+
+/**
+ * @brief Derives one block of addresses.
+ * @param job Block to derive.
+ * @param addrs Per-thread scratch batch (capacity SCAN_BLOCK).
+ * @param out Output, job->count entries.
+ * @return 0 on success, negative error code on failure.
+ */
+static int run_job(const scan_job *job, hdkey_batch *addrs, scan_entry *out) {
+    int result = hdkey_batch_derive_range(job->chain, job->lane, job->first, job->count, addrs);
+    if (result == SUCCESS) {
+        result = hdkey_batch_public_keys(addrs);
+    }
+    for (size_t i = 0; i < addrs->count && result == SUCCESS; i++) {
+        scan_entry *entry = &out[i];
+        entry->type = job->type;
+        entry->account = job->account;
+        entry->chain = job->chain_index;
+        entry->index = addrs->child_numbers[i];
+        memcpy(entry->public_key, addrs->public_keys + i * PUBLIC_KEY_LENGTH, PUBLIC_KEY_LENGTH);
+        result = address_from_public_key(job->type, entry->public_key,
+                                         entry->address, sizeof(entry->address));
+    }
+    return result;
+}
+
+/**
+ * @brief Takes jobs of the current wave until none are left.
+ * @param pool Pool, locked by the caller; unlocked while a job runs.
+ * @param addrs Per-thread scratch batch.
+ * @param local Per-thread output block (SCAN_BLOCK entries) when blocks are
+ *              emitted by the thread that derived them, NULL otherwise.
+ */
+static void drain_wave(scan_pool *pool, hdkey_batch *addrs, scan_entry *local) {
+    while (pool->next < pool->end) {
+        size_t j = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+
+        scan_entry *entries = local ? local : pool->results + (j - pool->wave_start) * SCAN_BLOCK;
+        int result = run_job(&pool->jobs[j], addrs, entries);
+        if (result == SUCCESS && pool->emit != NULL) {
+            result = pool->emit(entries, pool->jobs[j].count, pool->ctx);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (result != SUCCESS && pool->error == SUCCESS) {
+            pool->error = result;
+        }
+        if (pool->error != SUCCESS) {
+            // Drop the jobs of the wave nobody took yet
+            pool->pending -= pool->end - pool->next;
+            pool->next = pool->end;
+        }
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+}
+
+/**
+ * @brief Worker thread: drains every wave until the pool stops.
+ * @note A pinned worker allocates its scratch after pinning, so it lands on
+ *       the worker's NUMA node.
+ */
+static void *scan_worker(void *arg) {
+    scan_pool *pool = ((scan_worker_arg *)arg)->pool;
+    if (pool->topo != NULL) {
+        topology_pin_thread(pool->topo, ((scan_worker_arg *)arg)->cpu);
+    }
+    hdkey_batch addrs;
+    int ready = hdkey_batch_init(&addrs, SCAN_BLOCK) == SUCCESS;
+    scan_entry *local = NULL;
+    if (ready && pool->emit != NULL) {
+        local = malloc(SCAN_BLOCK * sizeof(scan_entry));
+        ready = local != NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    unsigned seen = 0;
+    while (!pool->stop) {
+        if (pool->generation == seen) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+            continue;
+        }
+        seen = pool->generation;
+        if (ready) {
+            drain_wave(pool, &addrs, local);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    free(local);
+    hdkey_batch_free(&addrs);
+    return NULL;
+}
+
+/**
+ * @brief Derives the hardened prefix, account and chain keys of one type.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param type Output type.
+ * @param spec Scan spec.
+ * @param chains Output: chain key batches for receive and change (capacity account_count).
+ * @return 0 on success, negative error code on failure.
+ */
+static int build_tree(const byte *private_key, const byte *chain_code, address_type type,
+                      const scan_spec *spec, hdkey_batch chains[2]) {
+    hdkey_batch coin, accounts;
+    memset(&coin, 0, sizeof(coin));
+    memset(&accounts, 0, sizeof(accounts));
+
+    // m/purpose'/0' once, then every account' from the same coin key
+    uint32_t path[2] = {address_purpose(type) | BIP32_HARDENED, BIP32_HARDENED};
+    uint32_t parent_fp = 0;
+    int result = hdkey_batch_init(&coin, 1);
+    if (result == SUCCESS) {
+        result = hdkey_batch_init(&accounts, spec->account_count);
+    }
+    if (result == SUCCESS) {
+        result = derive_bip32_path(private_key, chain_code, path, 2, coin.private_keys,
+                                   coin.chain_codes, &parent_fp);
+    }
+    if (result == SUCCESS) {
+        coin.count = 1;
+        coin.depths[0] = 2;
+        coin.child_numbers[0] = path[1];
+        coin.parent_fingerprints[0] = parent_fp;
+        coin.has_public_keys = 0;
+        result = hdkey_batch_derive_range(&coin, 0, spec->first_account | BIP32_HARDENED,
+                                          spec->account_count, &accounts);
+    }
+
+    // Chain keys get their public keys now so workers only read them
+    for (uint32_t c = 0; c < 2 && result == SUCCESS; c++) {
+        if (spec->chains & (1u << c)) {
+            result = hdkey_batch_derive(&accounts, c, &chains[c]);
+            if (result == SUCCESS) {
+                result = hdkey_batch_public_keys(&chains[c]);
+            }
+        }
+    }
+
+    hdkey_batch_free(&accounts);
+    hdkey_batch_free(&coin);
+    return result;
+}
+
+/**
+ * @brief Runs a scan, emitting blocks in order or from the workers.
+ * @param concurrent Nonzero to emit each block on the thread that derived it.
+ */
+static int scan_execute(const byte *private_key, const byte *chain_code, const scan_spec *spec,
+                        scan_emit_fn emit, void *ctx, int concurrent) {
+    if (private_key == NULL || chain_code == NULL || spec == NULL || emit == NULL ||
+        spec->account_count == 0 || spec->index_count == 0 ||
+        spec->first_account >= BIP32_HARDENED ||
+        spec->account_count > BIP32_HARDENED - spec->first_account ||
+        spec->first_index >= BIP32_HARDENED ||
+        spec->index_count > BIP32_HARDENED - spec->first_index ||
+        (spec->types & SCAN_ALL_TYPES) == 0 || (spec->chains & (SCAN_RECEIVE | SCAN_CHANGE)) == 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    // Pinned pools plan one CPU per worker; the calling thread then only
+    // coordinates, so it never shares a planned CPU with a worker
+    topology topo;
+    memset(&topo, 0, sizeof(topo));
+    int *cpus = NULL;
+    size_t threads = spec->threads;
+    if (spec->placement != TOPOLOGY_ANY) {
+        if (topology_load(&topo, NULL) != TOPOLOGY_OK) {
+            return ERROR_INTERNAL;
+        }
+        cpus = malloc((threads > topo.cpu_count ? threads : topo.cpu_count) * sizeof(int));
+        threads = cpus ? topology_plan(&topo, spec->placement, threads, cpus) : 0;
+        if (threads == 0) {
+            free(cpus);
+            topology_free(&topo);
+            return ERROR_INTERNAL;
+        }
+    } else if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+
+    // Shared prefixes: one tree per type, two chain batches per tree
+    hdkey_batch chains[SCAN_TYPE_COUNT][2];
+    memset(chains, 0, sizeof(chains));
+    int result = SUCCESS;
+    size_t blocks_per_chain = (spec->index_count + SCAN_BLOCK - 1) / SCAN_BLOCK;
+    size_t chain_count = 0;
+    for (int t = 0; t < SCAN_TYPE_COUNT && result == SUCCESS; t++) {
+        if (!(spec->types & SCAN_TYPE(t))) {
+            continue;
+        }
+        for (uint32_t c = 0; c < 2 && result == SUCCESS; c++) {
+            if (spec->chains & (1u << c)) {
+                result = hdkey_batch_init(&chains[t][c], spec->account_count);
+                chain_count++;
+            }
+        }
+        if (result == SUCCESS) {
+            result = build_tree(private_key, chain_code, (address_type)t, spec, chains[t]);
+        }
+    }
+
+    // Jobs in output order: type, account, chain, index block
+    size_t job_count = chain_count * spec->account_count * blocks_per_chain;
+    scan_job *jobs = NULL;
+    if (result == SUCCESS) {
+        jobs = malloc(job_count * sizeof(*jobs));
+        if (jobs == NULL) {
+            result = ERROR_INTERNAL;
+        }
+    }
+    size_t j = 0;
+    for (int t = 0; t < SCAN_TYPE_COUNT && result == SUCCESS; t++) {
+        if (!(spec->types & SCAN_TYPE(t))) {
+            continue;
+        }
+        for (uint32_t a = 0; a < spec->account_count; a++) {
+            for (uint32_t c = 0; c < 2; c++) {
+                if (!(spec->chains & (1u << c))) {
+                    continue;
+                }
+                for (size_t b = 0; b < blocks_per_chain; b++) {
+                    uint32_t first = (uint32_t)(b * SCAN_BLOCK);
+                    uint32_t left = spec->index_count - first;
+                    jobs[j].chain = &chains[t][c];
+                    jobs[j].lane = a;
+                    jobs[j].type = (address_type)t;
+                    jobs[j].account = spec->first_account + a;
+                    jobs[j].chain_index = c;
+                    jobs[j].first = spec->first_index + first;
+                    jobs[j].count = left < SCAN_BLOCK ? left : SCAN_BLOCK;
+                    j++;
+                }
+            }
+        }
+    }
+
+    scan_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.jobs = jobs;
+    pool.slots = threads * SCAN_JOBS_PER_THREAD;
+    if (concurrent) {
+        pool.emit = emit;
+        pool.ctx = ctx;
+    }
+    pool.topo = cpus ? &topo : NULL;
+    int calling_works = pool.topo == NULL;
+    hdkey_batch addrs;
+    memset(&addrs, 0, sizeof(addrs));
+    scan_entry *local = NULL;
+    pthread_t *workers = NULL;
+    scan_worker_arg *args = NULL;
+    size_t started = 0;
+    if (result == SUCCESS) {
+        pool.results = malloc(pool.slots * SCAN_BLOCK * sizeof(scan_entry));
+        workers = malloc(threads * sizeof(*workers));
+        args = malloc(threads * sizeof(*args));
+        local = concurrent ? malloc(SCAN_BLOCK * sizeof(scan_entry)) : NULL;
+        result = pool.results && workers && args && (local || !concurrent)
+                     ? hdkey_batch_init(&addrs, SCAN_BLOCK) : ERROR_INTERNAL;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work, NULL);
+    pthread_cond_init(&pool.done, NULL);
+
+    // Unpinned, the calling thread works too, so threads - 1 helpers
+    for (size_t i = calling_works; i < threads && result == SUCCESS; i++) {
+        args[started].pool = &pool;
+        args[started].cpu = cpus ? cpus[i] : -1;
+        if (pthread_create(&workers[started], NULL, scan_worker, &args[started]) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (!calling_works && started == 0) {
+        result = ERROR_INTERNAL;
+    }
+
+    for (size_t wave = 0; wave < job_count && result == SUCCESS; wave += pool.slots) {
+        size_t end = wave + pool.slots < job_count ? wave + pool.slots : job_count;
+
+        pthread_mutex_lock(&pool.lock);
+        pool.wave_start = wave;
+        pool.next = wave;
+        pool.end = end;
+        pool.pending = end - wave;
+        pool.error = SUCCESS;
+        pool.generation++;
+        pthread_cond_broadcast(&pool.work);
+        if (calling_works) {
+            drain_wave(&pool, &addrs, local);
+        }
+        while (pool.pending > 0) {
+            pthread_cond_wait(&pool.done, &pool.lock);
+        }
+        result = pool.error;
+        pthread_mutex_unlock(&pool.lock);
+
+        for (size_t k = wave; k < end && result == SUCCESS && !concurrent; k++) {
+            result = emit(pool.results + (k - wave) * SCAN_BLOCK, jobs[k].count, ctx);
+        }
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = 1;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool.done);
+    pthread_cond_destroy(&pool.work);
+    pthread_mutex_destroy(&pool.lock);
+
+    hdkey_batch_free(&addrs);
+    free(local);
+    free(args);
+    free(workers);
+    free(cpus);
+    topology_free(&topo);
+    free(pool.results);
+    free(jobs);
+    for (int t = 0; t < SCAN_TYPE_COUNT; t++) {
+        hdkey_batch_free(&chains[t][0]);
+        hdkey_batch_free(&chains[t][1]);
+    }
+    return result;
+}
+
+int scan_run(const byte *private_key, const byte *chain_code, const scan_spec *spec,
+             scan_emit_fn emit, void *ctx) {
+    return scan_execute(private_key, chain_code, spec, emit, ctx, 0);
+}
+
+int scan_run_parallel(const byte *private_key, const byte *chain_code, const scan_spec *spec,
+                      scan_emit_fn emit, void *ctx) {
+    return scan_execute(private_key, chain_code, spec, emit, ctx, 1);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file scan.h
+ * @brief Parallel multi-purpose, multi-account address derivation.
+ * @details A scan derives m/purpose'/0'/account'/chain/index for a grid of
+ *          purposes, accounts, chains and indices from one master key. The
+ *          hardened prefix of each purpose and every account and chain key
+ *          are derived once, up front; the leaf ranges are then split into
+ *          blocks and spread over a thread pool. Blocks are handed to the
+ *          caller in derivation order as soon as they are ready.
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "../hdkey/hdkey.h"
+#include "../address/address.h"
+#include "../topology/topology.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Addresses derived per job */
+#define SCAN_BLOCK 256
+
+/** @brief scan_spec.types bit of an address type */
+#define SCAN_TYPE(type) (1u << (type))
+
+/** @brief scan_spec.types value selecting BIP-44, 49, 84 and 86 */
+#define SCAN_ALL_TYPES 0xFu
+
+/** @brief scan_spec.chains bits */
+#define SCAN_RECEIVE 1u
+#define SCAN_CHANGE 2u
+
+/**
+ * @brief What to derive.
+ */
+typedef struct {
+    unsigned types;          ///< SCAN_TYPE() bits.
+    uint32_t first_account;  ///< First account number.
+    uint32_t account_count;  ///< Number of accounts.
+    unsigned chains;         ///< SCAN_RECEIVE and/or SCAN_CHANGE.
+    uint32_t first_index;    ///< First address index of each chain.
+    uint32_t index_count;    ///< Addresses per chain.
+    size_t threads;          ///< Worker threads, 0 for one per online CPU (or per planned CPU when pinned).
+    topology_placement placement;  ///< Worker pinning; TOPOLOGY_ANY leaves it to the scheduler.
+} scan_spec;
+
+/**
+ * @brief One derived address.
+ */
+typedef struct {
+    address_type type;                   ///< Output type (gives the purpose).
+    uint32_t account;                    ///< Account number.
+    uint32_t chain;                      ///< 0 = receive, 1 = change.
+    uint32_t index;                      ///< Address index.
+    byte public_key[PUBLIC_KEY_LENGTH];  ///< Compressed public key.
+    char address[ADDRESS_MAX_LENGTH];    ///< Encoded address.
+} scan_entry;
+
+/**
+ * @brief Receives the addresses of one block.
+ * @param entries Consecutive addresses of one chain.
+ * @param count Number of entries (at most SCAN_BLOCK).
+ * @param ctx Caller context.
+ * @return 0 to continue, anything else stops the scan with that value.
+ * @note scan_run() calls it from one thread at a time; scan_run_parallel()
+ *       calls it from every worker at once.
+ */
+typedef int (*scan_emit_fn)(const scan_entry *entries, size_t count, void *ctx);
+
+/**
+ * @brief Runs a scan.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param spec What to derive.
+ * @param emit Result callback; blocks arrive ordered by purpose, account,
+ *             chain, then index.
+ * @param ctx Callback context.
+ * @return 0 on success, the callback's value if it stopped the scan, or a
+ *         negative error code.
+ */
+int scan_run(const byte *private_key, const byte *chain_code, const scan_spec *spec,
+             scan_emit_fn emit, void *ctx);
+
+/**
+ * @brief Runs a scan, handing each block to the callback on the thread that
+ *        derived it.
+ * @details For sinks that can take blocks concurrently and in any order, such
+ *          as an encoder that formats each block before a short serialized
+ *          append; no thread waits for an earlier block to be emitted.
+ * @param private_key Master private key.
+ * @param chain_code Master chain code.
+ * @param spec What to derive.
+ * @param emit Result callback, called concurrently and in no particular order.
+ * @param ctx Callback context.
+ * @return 0 on success, the callback's value if it stopped the scan, or a
+ *         negative error code.
+ * @note A block still being emitted when another stops the scan completes;
+ *       no new block starts afterwards.
+ */
+int scan_run_parallel(const byte *private_key, const byte *chain_code, const scan_spec *spec,
+                      scan_emit_fn emit, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_H
@@ -0,0 +1,471 @@
+/**
+ * @file scrypt.c
+ * @brief scrypt key derivation (RFC 7914).
+ */
+#include "scrypt.h"
+
+#include <stdlib.h>  // For malloc, free
+#include <string.h>  // For memcpy, memset
+#include <pthread.h>
+#include <unistd.h>  // For sysconf
+
+#include <openssl/crypto.h>
+
+#include "../cpto/cpto.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SCRYPT_HAVE_X86 1
+#endif
+
+/** @brief Alignment of every scratch area carved out of the arena */
+#define SCRYPT_ALIGN 64
+
+static uint32_t load_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+#ifndef SCRYPT_HAVE_X86
+// ============ PORTABLE KERNEL ============
+
+#define ROTL32(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
+
+/**
+ * @brief Salsa20/8 core, B = B + salsa20_8_rounds(B).
+ * @param B Sixteen words in natural order, updated in place.
+ */
+static void salsa20_8(uint32_t B[16]) {
+    uint32_t x[16];
+    memcpy(x, B, sizeof(x));
+    for (int i = 0; i < 8; i += 2) {
+        // Columns
+        x[ 4] ^= ROTL32(x[ 0] + x[12],  7);  x[ 8] ^= ROTL32(x[ 4] + x[ 0],  9);
+        x[12] ^= ROTL32(x[ 8] + x[ 4], 13);  x[ 0] ^= ROTL32(x[12] + x[ 8], 18);
+        x[ 9] ^= ROTL32(x[ 5] + x[ 1],  7);  x[13] ^= ROTL32(x[ 9] + x[ 5],  9);
+        x[ 1] ^= ROTL32(x[13] + x[ 9], 13);  x[ 5] ^= ROTL32(x[ 1] + x[13], 18);
+        x[14] ^= ROTL32(x[10] + x[ 6],  7);  x[ 2] ^= ROTL32(x[14] + x[10],  9);
+        x[ 6] ^= ROTL32(x[ 2] + x[14], 13);  x[10] ^= ROTL32(x[ 6] + x[ 2], 18);
+        x[ 3] ^= ROTL32(x[15] + x[11],  7);  x[ 7] ^= ROTL32(x[ 3] + x[15],  9);
+        x[11] ^= ROTL32(x[ 7] + x[ 3], 13);  x[15] ^= ROTL32(x[11] + x[ 7], 18);
+        // Rows
+        x[ 1] ^= ROTL32(x[ 0] + x[ 3],  7);  x[ 2] ^= ROTL32(x[ 1] + x[ 0],  9);
+        x[ 3] ^= ROTL32(x[ 2] + x[ 1], 13);  x[ 0] ^= ROTL32(x[ 3] + x[ 2], 18);
+        x[ 6] ^= ROTL32(x[ 5] + x[ 4],  7);  x[ 7] ^= ROTL32(x[ 6] + x[ 5],  9);
+        x[ 4] ^= ROTL32(x[ 7] + x[ 6], 13);  x[ 5] ^= ROTL32(x[ 4] + x[ 7], 18);
+        x[11] ^= ROTL32(x[10] + x[ 9],  7);  x[ 8] ^= ROTL32(x[11] + x[10],  9);
+        x[ 9] ^= ROTL32(x[ 8] + x[11], 13);  x[10] ^= ROTL32(x[ 9] + x[ 8], 18);
+        x[12] ^= ROTL32(x[15] + x[14],  7);  x[13] ^= ROTL32(x[12] + x[15],  9);
+        x[14] ^= ROTL32(x[13] + x[12], 13);  x[15] ^= ROTL32(x[14] + x[13], 18);
+    }
+    for (int i = 0; i < 16; i++) B[i] += x[i];
+}
+
+/**
+ * @brief BlockMix: out = BlockMix(in) with the even/odd output reordering.
+ * @param in 2r blocks of 16 words.
+ * @param out 2r blocks of 16 words (must not overlap in).
+ * @param r Block size parameter.
+ */
+static void blockmix_salsa8(const uint32_t *in, uint32_t *out, size_t r) {
+    uint32_t X[16];
+    memcpy(X, in + (2 * r - 1) * 16, sizeof(X));
+    for (size_t i = 0; i < 2 * r; i++) {
+        for (int k = 0; k < 16; k++) X[k] ^= in[i * 16 + k];
+        salsa20_8(X);
+        memcpy(out + ((i >> 1) + (i & 1) * r) * 16, X, sizeof(X));
+    }
+}
+
+/**
+ * @brief ROMix of one lane.
+ * @param B Lane bytes (128 * r), updated in place.
+ * @param r Block size parameter.
+ * @param n Cost parameter.
+ * @param scratch 128 * r * (n + 2) bytes.
+ */
+static void smix_scalar(uint8_t *B, size_t r, uint64_t n, uint8_t *scratch) {
+    size_t words = 32 * r;
+    uint32_t *V = (uint32_t *)scratch;
+    uint32_t *X = V + words * n;
+    uint32_t *Y = X + words;
+
+    for (size_t k = 0; k < words; k++) X[k] = load_le32(B + 4 * k);
+    for (uint64_t i = 0; i < n; i++) {
+        memcpy(V + i * words, X, words * 4);
+        blockmix_salsa8(X, Y, r);
+        uint32_t *t = X; X = Y; Y = t;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        const uint32_t *Vj = V + (X[(2 * r - 1) * 16] & (n - 1)) * words;
+        for (size_t k = 0; k < words; k++) X[k] ^= Vj[k];
+        blockmix_salsa8(X, Y, r);
+        uint32_t *t = X; X = Y; Y = t;
+    }
+    for (size_t k = 0; k < words; k++) store_le32(B + 4 * k, X[k]);
+}
+#else
+// ============ SSE2 / AVX2 KERNELS ============
+
+/*
+ * The vector kernels keep every 64-byte block with its words permuted so
+ * that word i*5 mod 16 sits in slot i: each of the four registers then holds
+ * one diagonal of the Salsa20 state, and the row/column quarter-rounds
+ * become four parallel lanes plus three shuffles.
+ */
+
+/** @brief Natural word index stored in slot i of a permuted block */
+#define SHUFFLE(i) (((i) * 5) & 15)
+
+#define XOR_ROTL128(dst, t, b) \
+    (dst) = _mm_xor_si128(_mm_xor_si128((dst), _mm_slli_epi32((t), (b))), _mm_srli_epi32((t), 32 - (b)))
+
+/**
+ * @brief Salsa20/8 on one permuted block held in four registers (SSE2).
+ */
+#define SALSA20_8_SSE2(X0, X1, X2, X3) do { \
+    __m128i Y0 = X0, Y1 = X1, Y2 = X2, Y3 = X3, T; \
+    for (int round = 0; round < 8; round += 2) { \
+        T = _mm_add_epi32(Y0, Y3); XOR_ROTL128(Y1, T, 7); \
+        T = _mm_add_epi32(Y1, Y0); XOR_ROTL128(Y2, T, 9); \
+        T = _mm_add_epi32(Y2, Y1); XOR_ROTL128(Y3, T, 13); \
+        T = _mm_add_epi32(Y3, Y2); XOR_ROTL128(Y0, T, 18); \
+        Y1 = _mm_shuffle_epi32(Y1, 0x93); \
+        Y2 = _mm_shuffle_epi32(Y2, 0x4E); \
+        Y3 = _mm_shuffle_epi32(Y3, 0x39); \
+        T = _mm_add_epi32(Y0, Y1); XOR_ROTL128(Y3, T, 7); \
+        T = _mm_add_epi32(Y3, Y0); XOR_ROTL128(Y2, T, 9); \
+        T = _mm_add_epi32(Y2, Y3); XOR_ROTL128(Y1, T, 13); \
+        T = _mm_add_epi32(Y1, Y2); XOR_ROTL128(Y0, T, 18); \
+        Y1 = _mm_shuffle_epi32(Y1, 0x39); \
+        Y2 = _mm_shuffle_epi32(Y2, 0x4E); \
+        Y3 = _mm_shuffle_epi32(Y3, 0x93); \
+    } \
+    X0 = _mm_add_epi32(X0, Y0); X1 = _mm_add_epi32(X1, Y1); \
+    X2 = _mm_add_epi32(X2, Y2); X3 = _mm_add_epi32(X3, Y3); \
+} while (0)
+
+/**
+ * @brief BlockMix on permuted blocks, 4 registers per block (SSE2).
+ */
+static void blockmix_sse2(const __m128i *in, __m128i *out, size_t r) {
+    const __m128i *last = in + (2 * r - 1) * 4;
+    __m128i X0 = last[0], X1 = last[1], X2 = last[2], X3 = last[3];
+    for (size_t i = 0; i < 2 * r; i++) {
+        const __m128i *b = in + i * 4;
+        X0 = _mm_xor_si128(X0, b[0]);
+        X1 = _mm_xor_si128(X1, b[1]);
+        X2 = _mm_xor_si128(X2, b[2]);
+        X3 = _mm_xor_si128(X3, b[3]);
+        SALSA20_8_SSE2(X0, X1, X2, X3);
+        __m128i *o = out + ((i >> 1) + (i & 1) * r) * 4;
+        o[0] = X0; o[1] = X1; o[2] = X2; o[3] = X3;
+    }
+}
+
+/**
+ * @brief ROMix of one lane with the SSE2 kernel.
+ * @param B Lane bytes (128 * r), updated in place.
+ * @param r Block size parameter.
+ * @param n Cost parameter.
+ * @param scratch 128 * r * (n + 2) bytes, 16-byte aligned.
+ */
+static void smix_sse2(uint8_t *B, size_t r, uint64_t n, uint8_t *scratch) {
+    size_t vecs = 8 * r;
+    __m128i *V = (__m128i *)scratch;
+    __m128i *X = V + vecs * n;
+    __m128i *Y = X + vecs;
+    uint32_t *X32 = (uint32_t *)X;
+
+    for (size_t k = 0; k < 2 * r; k++) {
+        for (int i = 0; i < 16; i++) X32[k * 16 + i] = load_le32(B + (k * 16 + SHUFFLE(i)) * 4);
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        memcpy(V + i * vecs, X, vecs * sizeof(__m128i));
+        blockmix_sse2(X, Y, r);
+        __m128i *t = X; X = Y; Y = t;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        const __m128i *Vj = V + (((uint32_t *)X)[(2 * r - 1) * 16] & (n - 1)) * vecs;
+        for (size_t k = 0; k < vecs; k++) X[k] = _mm_xor_si128(X[k], Vj[k]);
+        blockmix_sse2(X, Y, r);
+        __m128i *t = X; X = Y; Y = t;
+    }
+    X32 = (uint32_t *)X;
+    for (size_t k = 0; k < 2 * r; k++) {
+        for (int i = 0; i < 16; i++) store_le32(B + (k * 16 + SHUFFLE(i)) * 4, X32[k * 16 + i]);
+    }
+}
+
+#define XOR_ROTL256(dst, t, b) \
+    (dst) = _mm256_xor_si256(_mm256_xor_si256((dst), _mm256_slli_epi32((t), (b))), _mm256_srli_epi32((t), 32 - (b)))
+
+/**
+ * @brief Salsa20/8 on two permuted blocks at once, one per 128-bit half (AVX2).
+ */
+#define SALSA20_8_AVX2(X0, X1, X2, X3) do { \
+    __m256i Y0 = X0, Y1 = X1, Y2 = X2, Y3 = X3, T; \
+    for (int round = 0; round < 8; round += 2) { \
+        T = _mm256_add_epi32(Y0, Y3); XOR_ROTL256(Y1, T, 7); \
+        T = _mm256_add_epi32(Y1, Y0); XOR_ROTL256(Y2, T, 9); \
+        T = _mm256_add_epi32(Y2, Y1); XOR_ROTL256(Y3, T, 13); \
+        T = _mm256_add_epi32(Y3, Y2); XOR_ROTL256(Y0, T, 18); \
+        Y1 = _mm256_shuffle_epi32(Y1, 0x93); \
+        Y2 = _mm256_shuffle_epi32(Y2, 0x4E); \
+        Y3 = _mm256_shuffle_epi32(Y3, 0x39); \
+        T = _mm256_add_epi32(Y0, Y1); XOR_ROTL256(Y3, T, 7); \
+        T = _mm256_add_epi32(Y3, Y0); XOR_ROTL256(Y2, T, 9); \
+        T = _mm256_add_epi32(Y2, Y3); XOR_ROTL256(Y1, T, 13); \
+        T = _mm256_add_epi32(Y1, Y2); XOR_ROTL256(Y0, T, 18); \
+        Y1 = _mm256_shuffle_epi32(Y1, 0x39); \
+        Y2 = _mm256_shuffle_epi32(Y2, 0x4E); \
+        Y3 = _mm256_shuffle_epi32(Y3, 0x93); \
+    } \
+    X0 = _mm256_add_epi32(X0, Y0); X1 = _mm256_add_epi32(X1, Y1); \
+    X2 = _mm256_add_epi32(X2, Y2); X3 = _mm256_add_epi32(X3, Y3); \
+} while (0)
+
+/**
+ * @brief BlockMix of two lanes, lane 0 in the low and lane 1 in the high halves (AVX2).
+ */
+__attribute__((target("avx2")))
+static void blockmix_avx2(const __m256i *in, __m256i *out, size_t r) {
+    const __m256i *last = in + (2 * r - 1) * 4;
+    __m256i X0 = last[0], X1 = last[1], X2 = last[2], X3 = last[3];
+    for (size_t i = 0; i < 2 * r; i++) {
+        const __m256i *b = in + i * 4;
+        X0 = _mm256_xor_si256(X0, b[0]);
+        X1 = _mm256_xor_si256(X1, b[1]);
+        X2 = _mm256_xor_si256(X2, b[2]);
+        X3 = _mm256_xor_si256(X3, b[3]);
+        SALSA20_8_AVX2(X0, X1, X2, X3);
+        __m256i *o = out + ((i >> 1) + (i & 1) * r) * 4;
+        o[0] = X0; o[1] = X1; o[2] = X2; o[3] = X3;
+    }
+}
+
+/**
+ * @brief ROMix of two lanes interleaved in 256-bit registers (AVX2).
+ * @param B0 First lane bytes (128 * r), updated in place.
+ * @param B1 Second lane bytes (128 * r), updated in place.
+ * @param r Block size parameter.
+ * @param n Cost parameter.
+ * @param scratch 256 * r * (n + 2) bytes, 32-byte aligned.
+ * @note Each lane keeps its own scratchpad so the random reads of the second
+ *       loop fetch only the bytes they need; the two independent lanes also
+ *       keep two cache misses in flight.
+ */
+__attribute__((target("avx2")))
+static void smix_avx2(uint8_t *B0, uint8_t *B1, size_t r, uint64_t n, uint8_t *scratch) {
+    size_t vecs = 8 * r;
+    __m128i *V0 = (__m128i *)scratch;
+    __m128i *V1 = V0 + vecs * n;
+    __m256i *X = (__m256i *)(V1 + vecs * n);
+    __m256i *Y = X + vecs;
+    uint8_t *lanes[2] = {B0, B1};
+
+    uint32_t *X32 = (uint32_t *)X;
+    for (int lane = 0; lane < 2; lane++) {
+        for (size_t k = 0; k < 2 * r; k++) {
+            for (int i = 0; i < 16; i++) {
+                X32[(k * 4 + i / 4) * 8 + lane * 4 + i % 4] =
+                    load_le32(lanes[lane] + (k * 16 + SHUFFLE(i)) * 4);
+            }
+        }
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        __m128i *v0 = V0 + i * vecs;
+        __m128i *v1 = V1 + i * vecs;
+        for (size_t k = 0; k < vecs; k++) {
+            _mm_store_si128(v0 + k, _mm256_castsi256_si128(X[k]));
+            _mm_store_si128(v1 + k, _mm256_extracti128_si256(X[k], 1));
+        }
+        blockmix_avx2(X, Y, r);
+        __m256i *t = X; X = Y; Y = t;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        const uint32_t *tail = (const uint32_t *)(X + (2 * r - 1) * 4);
+        const __m128i *v0 = V0 + (tail[0] & (n - 1)) * vecs;
+        const __m128i *v1 = V1 + (tail[4] & (n - 1)) * vecs;
+        for (size_t k = 0; k < vecs; k++) {
+            __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_load_si128(v0 + k)),
+                                                _mm_load_si128(v1 + k), 1);
+            X[k] = _mm256_xor_si256(X[k], v);
+        }
+        blockmix_avx2(X, Y, r);
+        __m256i *t = X; X = Y; Y = t;
+    }
+    X32 = (uint32_t *)X;
+    for (int lane = 0; lane < 2; lane++) {
+        for (size_t k = 0; k < 2 * r; k++) {
+            for (int i = 0; i < 16; i++) {
+                store_le32(lanes[lane] + (k * 16 + SHUFFLE(i)) * 4,
+                           X32[(k * 4 + i / 4) * 8 + lane * 4 + i % 4]);
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Whether lanes are run two at a time (AVX2), decided on first use.
+ */
+static int scrypt_wide(void) {
+#ifdef SCRYPT_HAVE_X86
+    static int wide = -1;
+    if (wide < 0) {
+        __builtin_cpu_init();
+        wide = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return wide;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief ROMix of a single lane with the best narrow kernel.
+ */
+static void smix_one(uint8_t *B, size_t r, uint64_t n, uint8_t *scratch) {
+#ifdef SCRYPT_HAVE_X86
+    smix_sse2(B, r, n, scratch);
+#else
+    smix_scalar(B, r, n, scratch);
+#endif
+}
+
+// ============ LANE SCHEDULING ============
+
+/** @brief One worker's share of the lanes */
+typedef struct {
+    uint8_t *B;         /**< All p lanes, 128 * r bytes each */
+    size_t r;
+    uint64_t n;
+    uint32_t p;
+    int wide;           /**< Run lanes in pairs */
+    size_t units;       /**< Pairs (or single lanes) to process */
+    size_t stride;      /**< Number of workers */
+    size_t first;       /**< First unit of this worker */
+    uint8_t *scratch;   /**< This worker's scratchpad */
+} scrypt_worker;
+
+static void *scrypt_worker_run(void *arg) {
+    scrypt_worker *w = (scrypt_worker *)arg;
+    size_t lane_size = 128 * w->r;
+    for (size_t u = w->first; u < w->units; u += w->stride) {
+#ifdef SCRYPT_HAVE_X86
+        if (w->wide && 2 * u + 1 < w->p) {
+            smix_avx2(w->B + 2 * u * lane_size, w->B + (2 * u + 1) * lane_size,
+                      w->r, w->n, w->scratch);
+            continue;
+        }
+#endif
+        size_t lane = w->wide ? 2 * u : u;
+        smix_one(w->B + lane * lane_size, w->r, w->n, w->scratch);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Makes sure the arena holds at least `size` bytes.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int arena_reserve(scrypt_arena *arena, size_t size) {
+    if (arena->size >= size) {
+        return 0;
+    }
+    scrypt_arena_free(arena);
+    if (hugepage_alloc(&arena->region, size, HUGEPAGE_HUGETLB) != HUGEPAGE_OK) {
+        return -1;
+    }
+    arena->memory = arena->region.base;
+    arena->size = size;
+    return 0;
+}
+
+void scrypt_arena_free(scrypt_arena *arena) {
+    if (arena == NULL) return;
+    hugepage_free(&arena->region);
+    arena->memory = NULL;
+    arena->size = 0;
+}
+
+int scrypt(const uint8_t *password, size_t password_len,
+           const uint8_t *salt, size_t salt_len,
+           uint64_t n, uint32_t r, uint32_t p, size_t threads,
+           scrypt_arena *arena, uint8_t *output, size_t output_len) {
+    if ((password == NULL && password_len) || (salt == NULL && salt_len) || output == NULL ||
+        n < 2 || (n & (n - 1)) != 0 || n > ((uint64_t)1 << 32) ||
+        r == 0 || p == 0 || (uint64_t)r * p >= (1u << 30)) {
+        return -1;
+    }
+
+    int wide = scrypt_wide() && p >= 2;
+    size_t units = wide ? (p + 1) / 2 : p;
+    size_t width = wide ? 2 : 1;
+
+    // Per worker: `width` scratchpads of n blocks plus the X/Y working blocks
+    size_t lane_size = 128 * (size_t)r;
+    size_t per_worker;
+    if (__builtin_mul_overflow(lane_size * width, (size_t)n + 2, &per_worker) ||
+        per_worker > SIZE_MAX - SCRYPT_ALIGN) {
+        return -1;
+    }
+    per_worker = (per_worker + SCRYPT_ALIGN - 1) & ~(size_t)(SCRYPT_ALIGN - 1);
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    size_t workers = threads < units ? threads : units;
+    // Fall back to fewer workers rather than fail when memory is tight
+    scrypt_arena local = {0};
+    scrypt_arena *scratch = arena ? arena : &local;
+    size_t total = 0;
+    while (workers > 0 &&
+           (__builtin_mul_overflow(per_worker, workers, &total) ||
+            arena_reserve(scratch, total) != 0)) {
+        workers /= 2;
+    }
+    if (workers == 0) {
+        return -1;
+    }
+
+    uint8_t *B = malloc(lane_size * p);
+    if (B == NULL) {
+        scrypt_arena_free(&local);
+        return -1;
+    }
+    pbkdf2_hmac_sha256(password, password_len, salt, salt_len, 1, B, lane_size * p);
+
+    scrypt_worker jobs[workers];
+    pthread_t tids[workers];
+    int started[workers];
+    for (size_t i = 0; i < workers; i++) {
+        jobs[i] = (scrypt_worker){B, r, n, p, wide, units, workers, i,
+                                  scratch->memory + i * per_worker};
+        started[i] = i > 0 && pthread_create(&tids[i], NULL, scrypt_worker_run, &jobs[i]) == 0;
+    }
+    scrypt_worker_run(&jobs[0]);
+    for (size_t i = 1; i < workers; i++) {
+        if (started[i]) {
+            pthread_join(tids[i], NULL);
+        } else {
+            // Thread creation failed: do its share here
+            scrypt_worker_run(&jobs[i]);
+        }
+    }
+
+    pbkdf2_hmac_sha256(password, password_len, B, lane_size * p, 1, output, output_len);
+
+    OPENSSL_cleanse(B, lane_size * p);
+    free(B);
+    scrypt_arena_free(&local);
+    return 0;
+}
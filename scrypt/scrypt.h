@@ -0,0 +1,68 @@
+/**
+ * @file scrypt.h
+ * @brief scrypt key derivation (RFC 7914).
+ * @details PBKDF2-HMAC-SHA256 around p independent ROMix lanes of
+ *          Salsa20/8 BlockMix. Lanes run on worker threads and their
+ *          scratchpads come from a caller-owned arena, so repeated calls
+ *          (e.g. one BIP-38 key after another) do not re-allocate them.
+ */
+
+#ifndef SCRYPT_H
+#define SCRYPT_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint32_t, uint64_t
+
+#include "../hugepage/hugepage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reusable scratch memory for scrypt().
+ * @note Zero-initialize before first use; it grows on demand and is only
+ *       released (and wiped) by scrypt_arena_free(). ROMix reads the
+ *       scratchpad at random, so it is mapped on huge pages when possible.
+ *       Not thread-safe: use one arena per concurrent scrypt() call.
+ */
+typedef struct {
+    uint8_t *memory;          /**< 64-byte aligned block (2 MiB aligned on huge pages) */
+    size_t size;              /**< Usable size of memory in bytes */
+    hugepage_region region;   /**< Mapping behind memory */
+} scrypt_arena;
+
+/**
+ * @brief Wipes and releases an arena.
+ * @param arena Arena to free (can be zero-initialized).
+ */
+void scrypt_arena_free(scrypt_arena *arena);
+
+/**
+ * @brief Derives a key with scrypt.
+ * @param password Password bytes.
+ * @param password_len Length of the password.
+ * @param salt Salt bytes.
+ * @param salt_len Length of the salt.
+ * @param n CPU/memory cost, a power of two greater than 1 (at most 2^32).
+ * @param r Block size parameter.
+ * @param p Parallelization parameter (number of ROMix lanes).
+ * @param threads Worker threads, 0 for one per online CPU (never more than needed).
+ * @param arena Scratch arena to reuse, or NULL for a temporary one.
+ * @param output Output buffer for the derived key.
+ * @param output_len Length of the derived key.
+ * @return 0 on success, -1 on invalid parameters or allocation failure.
+ * @note Each busy thread needs 128 * r * n bytes of scratchpad (16 MiB for
+ *       BIP-38's n = 16384, r = 8). With AVX2 a thread runs two lanes
+ *       interleaved in 256-bit registers and needs twice that.
+ */
+int scrypt(const uint8_t *password, size_t password_len,
+           const uint8_t *salt, size_t salt_len,
+           uint64_t n, uint32_t r, uint32_t p, size_t threads,
+           scrypt_arena *arena, uint8_t *output, size_t output_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCRYPT_H
@@ -0,0 +1,384 @@
+/**
+ * @file seal.c
+ * @brief Chunked, seekable authenticated encryption of export streams.
+ */
+#define _GNU_SOURCE  // For fopencookie
+#include "seal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include "../scrypt/scrypt.h"
+
+/** @brief Header format version */
+#define SEAL_VERSION 1
+
+/** @brief KDF identifier: scrypt */
+#define SEAL_KDF_SCRYPT 1
+
+/** @brief Header field offsets */
+#define OFF_VERSION 8
+#define OFF_CIPHER 9
+#define OFF_KDF 10
+#define OFF_LOG2_N 11
+#define OFF_R 12
+#define OFF_P 13
+#define OFF_CHUNK_SIZE 16
+#define OFF_SALT 20
+#define OFF_NONCE_PREFIX 36
+
+#define SALT_SIZE 16
+#define NONCE_PREFIX_SIZE 4
+#define NONCE_SIZE 12
+#define KEY_SIZE 32
+
+/** @brief Default scrypt r and p of the passphrase KDF */
+#define SEAL_KDF_R 8
+#define SEAL_KDF_P 1
+
+static void store_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t load_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief OpenSSL cipher of a header cipher id, or NULL if unknown.
+ * @note EVP picks the AES-NI/VAES or SIMD ChaCha20 code paths at runtime.
+ */
+static const EVP_CIPHER *evp_cipher(uint8_t cipher) {
+    switch (cipher) {
+        case SEAL_CHACHA20_POLY1305: return EVP_chacha20_poly1305();
+        case SEAL_AES_256_GCM: return EVP_aes_256_gcm();
+        default: return NULL;
+    }
+}
+
+/**
+ * @brief Derives the key from the header's KDF fields and loads it into a
+ *        new cipher context.
+ * @param header Serialized header.
+ * @param passphrase Operator passphrase.
+ * @param encrypt 1 for sealing, 0 for opening.
+ * @param ctx_out New EVP_CIPHER_CTX.
+ * @return SEAL_OK or a negative error code.
+ */
+static int load_key(const uint8_t *header, const char *passphrase, int encrypt, void **ctx_out) {
+    const EVP_CIPHER *cipher = evp_cipher(header[OFF_CIPHER]);
+    uint8_t log2_n = header[OFF_LOG2_N];
+    uint8_t r = header[OFF_R];
+    uint8_t p = header[OFF_P];
+    // Bound the KDF cost a file can demand
+    if (cipher == NULL || passphrase == NULL || header[OFF_KDF] != SEAL_KDF_SCRYPT ||
+        log2_n < 10 || log2_n > 22 || r < 1 || r > 32 || p < 1 || p > 16) {
+        return SEAL_ERROR_INVALID;
+    }
+
+    uint8_t key[KEY_SIZE];
+    if (scrypt((const uint8_t *)passphrase, strlen(passphrase), header + OFF_SALT, SALT_SIZE,
+               (uint64_t)1 << log2_n, r, p, 1, NULL, key, sizeof(key)) != 0) {
+        return SEAL_ERROR_INTERNAL;
+    }
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int ok = ctx != NULL &&
+             EVP_CipherInit_ex(ctx, cipher, NULL, NULL, NULL, encrypt) == 1 &&
+             EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, NONCE_SIZE, NULL) == 1 &&
+             EVP_CipherInit_ex(ctx, NULL, NULL, key, NULL, encrypt) == 1;
+    OPENSSL_cleanse(key, sizeof(key));
+    if (!ok) {
+        EVP_CIPHER_CTX_free(ctx);
+        return SEAL_ERROR_INTERNAL;
+    }
+    *ctx_out = ctx;
+    return SEAL_OK;
+}
+
+/**
+ * @brief Starts one chunk: nonce = prefix || index, AAD = header || final flag.
+ */
+static int begin_chunk(EVP_CIPHER_CTX *ctx, const uint8_t *header, uint64_t index, int final) {
+    uint8_t nonce[NONCE_SIZE];
+    uint8_t aad[SEAL_HEADER_SIZE + 1];
+    int len = 0;
+    memcpy(nonce, header + OFF_NONCE_PREFIX, NONCE_PREFIX_SIZE);
+    for (int i = 0; i < 8; i++) nonce[NONCE_PREFIX_SIZE + i] = (uint8_t)(index >> (8 * i));
+    memcpy(aad, header, SEAL_HEADER_SIZE);
+    aad[SEAL_HEADER_SIZE] = (uint8_t)(final != 0);
+    return EVP_CipherInit_ex(ctx, NULL, NULL, NULL, nonce, -1) == 1 &&
+           EVP_CipherUpdate(ctx, NULL, &len, aad, sizeof(aad)) == 1;
+}
+
+// ============ WRITER ============
+
+/**
+ * @brief Seals the pending plaintext as chunk `index` and writes it.
+ */
+static int flush_chunk(seal_writer *writer, int final) {
+    EVP_CIPHER_CTX *ctx = writer->ctx;
+    int len = 0;
+    int tail = 0;
+    if (!begin_chunk(ctx, writer->header, writer->index, final) ||
+        (writer->fill > 0 &&
+         EVP_CipherUpdate(ctx, writer->sealed, &len, writer->buffer, (int)writer->fill) != 1) ||
+        EVP_CipherFinal_ex(ctx, writer->sealed + len, &tail) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, SEAL_TAG_SIZE,
+                            writer->sealed + writer->fill) != 1) {
+        return SEAL_ERROR_INTERNAL;
+    }
+    size_t total = writer->fill + SEAL_TAG_SIZE;
+    if (fwrite(writer->sealed, 1, total, writer->out) != total) {
+        return SEAL_ERROR_IO;
+    }
+    OPENSSL_cleanse(writer->buffer, writer->fill);
+    writer->fill = 0;
+    writer->index++;
+    return SEAL_OK;
+}
+
+int seal_writer_init(seal_writer *writer, FILE *out, const char *passphrase,
+                     seal_cipher cipher, uint32_t chunk_size) {
+    if (writer == NULL) {
+        return SEAL_ERROR_INVALID;
+    }
+    memset(writer, 0, sizeof(*writer));
+    if (chunk_size == 0) {
+        chunk_size = SEAL_DEFAULT_CHUNK_SIZE;
+    }
+    if (out == NULL || passphrase == NULL || evp_cipher((uint8_t)cipher) == NULL ||
+        chunk_size > SEAL_MAX_CHUNK_SIZE) {
+        return SEAL_ERROR_INVALID;
+    }
+
+    uint8_t *header = writer->header;
+    memcpy(header, SEAL_MAGIC, 8);
+    header[OFF_VERSION] = SEAL_VERSION;
+    header[OFF_CIPHER] = (uint8_t)cipher;
+    header[OFF_KDF] = SEAL_KDF_SCRYPT;
+    header[OFF_LOG2_N] = SEAL_DEFAULT_LOG2_N;
+    header[OFF_R] = SEAL_KDF_R;
+    header[OFF_P] = SEAL_KDF_P;
+    store_le32(header + OFF_CHUNK_SIZE, chunk_size);
+    if (RAND_bytes(header + OFF_SALT, SALT_SIZE + NONCE_PREFIX_SIZE) != 1) {
+        return SEAL_ERROR_INTERNAL;
+    }
+
+    int result = load_key(header, passphrase, 1, &writer->ctx);
+    if (result != SEAL_OK) {
+        return result;
+    }
+    writer->out = out;
+    writer->chunk_size = chunk_size;
+    writer->buffer = malloc(chunk_size);
+    writer->sealed = malloc((size_t)chunk_size + SEAL_TAG_SIZE);
+    if (writer->buffer == NULL || writer->sealed == NULL) {
+        writer->error = SEAL_ERROR_INTERNAL;
+    } else if (fwrite(header, 1, SEAL_HEADER_SIZE, out) != SEAL_HEADER_SIZE) {
+        writer->error = SEAL_ERROR_IO;
+    }
+    if (writer->error != SEAL_OK) {
+        result = writer->error;
+        seal_writer_finish(writer);
+    }
+    return result;
+}
+
+int seal_writer_write(seal_writer *writer, const void *data, size_t len) {
+    const uint8_t *bytes = data;
+    while (len > 0 && writer->error == SEAL_OK) {
+        // A full buffer is only sealed once more data proves it is not the last chunk
+        if (writer->fill == writer->chunk_size) {
+            writer->error = flush_chunk(writer, 0);
+            continue;
+        }
+        size_t take = writer->chunk_size - writer->fill;
+        if (take > len) take = len;
+        memcpy(writer->buffer + writer->fill, bytes, take);
+        writer->fill += take;
+        bytes += take;
+        len -= take;
+    }
+    return writer->error;
+}
+
+int seal_writer_finish(seal_writer *writer) {
+    if (writer == NULL) {
+        return SEAL_ERROR_INVALID;
+    }
+    int result = writer->error;
+    if (result == SEAL_OK && writer->ctx != NULL) {
+        result = flush_chunk(writer, 1);
+        if (result == SEAL_OK && fflush(writer->out) != 0) {
+            result = SEAL_ERROR_IO;
+        }
+    }
+    if (writer->buffer) {
+        OPENSSL_cleanse(writer->buffer, writer->chunk_size);
+    }
+    free(writer->buffer);
+    free(writer->sealed);
+    EVP_CIPHER_CTX_free(writer->ctx);
+    memset(writer, 0, sizeof(*writer));
+    return result;
+}
+
+/** @brief fopencookie() state: the writer and the file it writes to */
+typedef struct {
+    seal_writer writer;
+    FILE *file;
+} seal_cookie;
+
+static ssize_t cookie_write(void *cookie, const char *buf, size_t size) {
+    seal_cookie *c = cookie;
+    return seal_writer_write(&c->writer, buf, size) == SEAL_OK ? (ssize_t)size : -1;
+}
+
+static int cookie_close(void *cookie) {
+    seal_cookie *c = cookie;
+    int result = seal_writer_finish(&c->writer);
+    if (fclose(c->file) != 0 && result == SEAL_OK) {
+        result = SEAL_ERROR_IO;
+    }
+    free(c);
+    return result == SEAL_OK ? 0 : EOF;
+}
+
+FILE *seal_fopen(const char *path, const char *passphrase, seal_cipher cipher) {
+    if (path == NULL) {
+        return NULL;
+    }
+    seal_cookie *c = calloc(1, sizeof(*c));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->file = fopen(path, "wb");
+    if (c->file == NULL) {
+        free(c);
+        return NULL;
+    }
+    if (seal_writer_init(&c->writer, c->file, passphrase, cipher, 0) != SEAL_OK) {
+        fclose(c->file);
+        free(c);
+        return NULL;
+    }
+
+    cookie_io_functions_t io = {NULL, cookie_write, NULL, cookie_close};
+    FILE *stream = fopencookie(c, "w", io);
+    if (stream == NULL) {
+        seal_writer_finish(&c->writer);
+        fclose(c->file);
+        free(c);
+        return NULL;
+    }
+    // Hand whole chunks to the writer instead of BUFSIZ pieces
+    setvbuf(stream, NULL, _IOFBF, SEAL_DEFAULT_CHUNK_SIZE);
+    return stream;
+}
+
+// ============ READER ============
+
+int seal_reader_open(seal_reader *reader, const char *path, const char *passphrase) {
+    if (reader == NULL) {
+        return SEAL_ERROR_INVALID;
+    }
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+    if (path == NULL || passphrase == NULL) {
+        return SEAL_ERROR_INVALID;
+    }
+
+    reader->fd = open(path, O_RDONLY);
+    struct stat st;
+    if (reader->fd < 0 || fstat(reader->fd, &st) != 0) {
+        seal_reader_close(reader);
+        return SEAL_ERROR_IO;
+    }
+    if (pread(reader->fd, reader->header, SEAL_HEADER_SIZE, 0) != SEAL_HEADER_SIZE ||
+        memcmp(reader->header, SEAL_MAGIC, 8) != 0 ||
+        reader->header[OFF_VERSION] != SEAL_VERSION) {
+        seal_reader_close(reader);
+        return SEAL_ERROR_INVALID;
+    }
+
+    // Every chunk but the last is full; the last holds at least its tag
+    uint32_t chunk_size = load_le32(reader->header + OFF_CHUNK_SIZE);
+    uint64_t body = (uint64_t)st.st_size - SEAL_HEADER_SIZE;
+    uint64_t stride = (uint64_t)chunk_size + SEAL_TAG_SIZE;
+    if (chunk_size == 0 || chunk_size > SEAL_MAX_CHUNK_SIZE ||
+        (uint64_t)st.st_size < SEAL_HEADER_SIZE + SEAL_TAG_SIZE ||
+        (body % stride != 0 && body % stride < SEAL_TAG_SIZE)) {
+        seal_reader_close(reader);
+        return SEAL_ERROR_INVALID;
+    }
+    reader->chunk_size = chunk_size;
+    reader->chunk_count = (body + stride - 1) / stride;
+    reader->file_size = (uint64_t)st.st_size;
+
+    reader->sealed = malloc(stride);
+    uint8_t *first = malloc(chunk_size);
+    int result = reader->sealed && first ? load_key(reader->header, passphrase, 0, &reader->ctx)
+                                         : SEAL_ERROR_INTERNAL;
+    if (result == SEAL_OK) {
+        size_t len = 0;
+        result = seal_reader_read_chunk(reader, 0, first, &len);
+        OPENSSL_cleanse(first, len);
+    }
+    free(first);
+    if (result != SEAL_OK) {
+        seal_reader_close(reader);
+    }
+    return result;
+}
+
+int seal_reader_read_chunk(seal_reader *reader, uint64_t index, uint8_t *out, size_t *len) {
+    if (reader == NULL || reader->ctx == NULL || out == NULL || len == NULL ||
+        index >= reader->chunk_count) {
+        return SEAL_ERROR_INVALID;
+    }
+
+    uint64_t stride = (uint64_t)reader->chunk_size + SEAL_TAG_SIZE;
+    uint64_t offset = SEAL_HEADER_SIZE + index * stride;
+    int final = index + 1 == reader->chunk_count;
+    size_t total = final ? (size_t)(reader->file_size - offset) : (size_t)stride;
+    size_t data_len = total - SEAL_TAG_SIZE;
+    if (pread(reader->fd, reader->sealed, total, (off_t)offset) != (ssize_t)total) {
+        return SEAL_ERROR_IO;
+    }
+
+    EVP_CIPHER_CTX *ctx = reader->ctx;
+    int n = 0;
+    int tail = 0;
+    if (!begin_chunk(ctx, reader->header, index, final) ||
+        (data_len > 0 && EVP_CipherUpdate(ctx, out, &n, reader->sealed, (int)data_len) != 1) ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, SEAL_TAG_SIZE,
+                            reader->sealed + data_len) != 1) {
+        return SEAL_ERROR_INTERNAL;
+    }
+    if (EVP_CipherFinal_ex(ctx, out + n, &tail) != 1) {
+        OPENSSL_cleanse(out, data_len);
+        return SEAL_ERROR_AUTH;
+    }
+    *len = data_len;
+    return SEAL_OK;
+}
+
+void seal_reader_close(seal_reader *reader) {
+    if (reader == NULL) return;
+    if (reader->fd >= 0) {
+        close(reader->fd);
+    }
+    free(reader->sealed);
+    EVP_CIPHER_CTX_free(reader->ctx);
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file seal.h
+ * @brief Chunked, seekable authenticated encryption of export streams.
+ * @details Output is cut into fixed-size chunks, each sealed with
+ *          ChaCha20-Poly1305 or AES-256-GCM under a key derived from an
+ *          operator passphrase with scrypt. Chunk i lives at a fixed offset
+ *          and uses nonce prefix || i, so any chunk can be read and
+ *          authenticated on its own. The file header and a last-chunk flag
+ *          are bound into every tag, which detects truncation, reordering
+ *          and header tampering.
+ *
+ *          File layout: 64-byte header, then chunks of
+ *          chunk_size ciphertext bytes + 16-byte tag (the last one shorter).
+ */
+
+#ifndef SEAL_H
+#define SEAL_H
+
+#include <stdio.h>   // For FILE
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint32_t, uint64_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief File magic */
+#define SEAL_MAGIC "MNSEAL01"
+
+/** @brief Header size in bytes */
+#define SEAL_HEADER_SIZE 64
+
+/** @brief AEAD tag size in bytes */
+#define SEAL_TAG_SIZE 16
+
+/** @brief Default plaintext bytes per chunk */
+#define SEAL_DEFAULT_CHUNK_SIZE 65536
+
+/** @brief Largest accepted chunk size */
+#define SEAL_MAX_CHUNK_SIZE (16u << 20)
+
+/** @brief Default passphrase KDF cost: scrypt N = 2^15, r = 8, p = 1 */
+#define SEAL_DEFAULT_LOG2_N 15
+
+/** @brief Error codes */
+enum {
+    SEAL_OK = 0,
+    SEAL_ERROR_INVALID = -1,   /**< Bad arguments or not a sealed file */
+    SEAL_ERROR_IO = -2,        /**< Read or write failure */
+    SEAL_ERROR_AUTH = -3,      /**< Wrong passphrase or tampered/truncated data */
+    SEAL_ERROR_INTERNAL = -4   /**< Allocation or OpenSSL failure */
+};
+
+/** @brief AEAD used for the chunks */
+typedef enum {
+    SEAL_CHACHA20_POLY1305 = 1,
+    SEAL_AES_256_GCM = 2
+} seal_cipher;
+
+/** @brief Streaming encryptor; fields are private */
+typedef struct {
+    FILE *out;                           /**< Destination */
+    void *ctx;                           /**< EVP_CIPHER_CTX with the key loaded */
+    uint8_t header[SEAL_HEADER_SIZE];    /**< Serialized header (AAD of every chunk) */
+    uint8_t *buffer;                     /**< Pending plaintext, chunk_size bytes */
+    size_t fill;                         /**< Bytes pending in buffer */
+    uint8_t *sealed;                     /**< Output scratch, chunk_size + tag */
+    uint32_t chunk_size;                 /**< Plaintext bytes per chunk */
+    uint64_t index;                      /**< Next chunk index */
+    int error;                           /**< First error, sticky */
+} seal_writer;
+
+/** @brief Random-access decryptor; fields are private */
+typedef struct {
+    int fd;                              /**< Sealed file */
+    void *ctx;                           /**< EVP_CIPHER_CTX with the key loaded */
+    uint8_t header[SEAL_HEADER_SIZE];    /**< Header as read (AAD of every chunk) */
+    uint8_t *sealed;                     /**< Input scratch, chunk_size + tag */
+    uint32_t chunk_size;                 /**< Plaintext bytes per chunk */
+    uint64_t chunk_count;                /**< Chunks in the file (at least 1) */
+    uint64_t file_size;                  /**< File size in bytes */
+} seal_reader;
+
+/**
+ * @brief Starts a sealed stream and writes its header.
+ * @param writer Writer to initialize.
+ * @param out Destination stream (not closed by the writer).
+ * @param passphrase Operator passphrase.
+ * @param cipher Chunk AEAD.
+ * @param chunk_size Plaintext bytes per chunk, 0 for SEAL_DEFAULT_CHUNK_SIZE.
+ * @return SEAL_OK or a negative error code.
+ * @note Costs one scrypt derivation (32 MiB, tens of milliseconds).
+ */
+int seal_writer_init(seal_writer *writer, FILE *out, const char *passphrase,
+                     seal_cipher cipher, uint32_t chunk_size);
+
+/**
+ * @brief Encrypts more plaintext; full chunks are written as soon as the
+ *        next byte arrives.
+ * @param writer Writer.
+ * @param data Plaintext.
+ * @param len Length of the plaintext.
+ * @return SEAL_OK or a negative error code (sticky).
+ */
+int seal_writer_write(seal_writer *writer, const void *data, size_t len);
+
+/**
+ * @brief Writes the last chunk, flushes the stream and wipes the writer.
+ * @param writer Writer.
+ * @return SEAL_OK, or the first error seen by the writer.
+ */
+int seal_writer_finish(seal_writer *writer);
+
+/**
+ * @brief Opens a sealed file for writing as a plain FILE stream.
+ * @param path Output path (created or truncated).
+ * @param passphrase Operator passphrase.
+ * @param cipher Chunk AEAD.
+ * @return A stream to fprintf()/fwrite() to, or NULL on failure. fclose()
+ *         seals the last chunk and returns EOF if anything failed.
+ */
+FILE *seal_fopen(const char *path, const char *passphrase, seal_cipher cipher);
+
+/**
+ * @brief Opens a sealed file and checks the passphrase on its first chunk.
+ * @param reader Reader to initialize.
+ * @param path Sealed file.
+ * @param passphrase Operator passphrase.
+ * @return SEAL_OK, SEAL_ERROR_AUTH for a wrong passphrase, or another
+ *         negative error code.
+ */
+int seal_reader_open(seal_reader *reader, const char *path, const char *passphrase);
+
+/**
+ * @brief Decrypts and authenticates one chunk.
+ * @param reader Reader.
+ * @param index Chunk index (< reader->chunk_count).
+ * @param out Output buffer of at least reader->chunk_size bytes.
+ * @param len Set to the plaintext length of the chunk.
+ * @return SEAL_OK or a negative error code; out is wiped on SEAL_ERROR_AUTH.
+ * @note Uses pread(), so it does not disturb other readers of the file.
+ */
+int seal_reader_read_chunk(seal_reader *reader, uint64_t index, uint8_t *out, size_t *len);
+
+/**
+ * @brief Closes a reader and wipes its key.
+ * @param reader Reader passed to seal_reader_open() (safe to close twice).
+ */
+void seal_reader_close(seal_reader *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEAL_H
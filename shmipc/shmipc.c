@@ -0,0 +1,429 @@
+/**
+ * @file shmipc.c
+ * @brief Request/response ring in shared memory, for callers on the same host.
+ */
+#define _GNU_SOURCE
+#include "shmipc.h"
+
+#include <errno.h>          // For errno, EPERM
+#include <fcntl.h>          // For O_CREAT, O_EXCL, O_RDWR
+#include <limits.h>         // For INT_MAX
+#include <pthread.h>        // For pthread_create, pthread_join
+#include <signal.h>         // For kill
+#include <stdlib.h>         // For calloc, free
+#include <string.h>         // For memcpy, memset, strchr, strlen
+#include <time.h>           // For clock_gettime, struct timespec
+#include <unistd.h>         // For close, ftruncate, getpid, sysconf
+#include <linux/futex.h>    // For FUTEX_WAIT, FUTEX_WAKE
+#include <sys/mman.h>       // For mmap, mlock, madvise, shm_open
+#include <sys/stat.h>       // For fstat
+#include <sys/syscall.h>    // For SYS_futex
+
+#include <openssl/crypto.h>
+
+/** @brief "SHMR" */
+#define SHMIPC_MAGIC 0x524d4853u
+
+/** @brief Layout version; bumped whenever the header or a slot changes */
+#define SHMIPC_VERSION 1u
+
+/** @brief Polls before sleeping on a futex, when there is another CPU to make progress */
+#define SHMIPC_SPIN_LIMIT 4096
+
+/** @brief Longest client sleep before checking that the server is alive */
+#define SHMIPC_CHECK_NS 100000000L
+
+/** @brief Longest wait in shmipc_close() for clients to release their slots */
+#define SHMIPC_DRAIN_NS 1000000000L
+
+/** @brief Slot states */
+enum {
+    SLOT_FREE = 0,
+    SLOT_FILLING = 1,
+    SLOT_REQUEST = 2,
+    SLOT_WORKING = 3,
+    SLOT_RESPONSE = 4
+};
+
+/** @brief The futex system call, which libc does not wrap */
+static long futex(atomic_uint *word, int op, unsigned value, const struct timespec *timeout) {
+    return syscall(SYS_futex, word, op, value, timeout, NULL, 0);
+}
+
+/**
+ * @brief Waits until a futex word no longer holds `value` (or a wakeup or timeout).
+ * @param region Region.
+ * @param word Futex word.
+ * @param value Value seen.
+ * @param waiters Counter the wakers read before issuing FUTEX_WAKE.
+ * @param timeout Longest sleep (NULL for none).
+ */
+static void wait_change(const shmipc_region *region, atomic_uint *word, unsigned value,
+                        atomic_uint *waiters, const struct timespec *timeout) {
+    for (uint32_t i = 0; i < region->spin; i++) {
+        if (atomic_load(word) != value) return;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    // Counted before the last check, so a waker that changes the word after it sees us
+    atomic_fetch_add(waiters, 1);
+    if (atomic_load(word) == value) futex(word, FUTEX_WAIT, value, timeout);
+    atomic_fetch_sub(waiters, 1);
+}
+
+/** @brief Wakes up to `count` sleepers on a futex word, if any sleep */
+static void wake(atomic_uint *word, atomic_uint *waiters, int count) {
+    if (atomic_load(waiters) > 0) futex(word, FUTEX_WAKE, (unsigned)count, NULL);
+}
+
+/** @brief 0 once the server process is gone */
+static int server_alive(const shmipc_region *region) {
+    return kill((pid_t)region->header->server_pid, 0) == 0 || errno == EPERM;
+}
+
+/** @brief Copies a name, adding the leading "/" shm_open wants */
+static int region_name(shmipc_region *region, const char *name) {
+    if (!name || name[0] == '\0') return SHMIPC_ERROR_INVALID;
+    if (name[0] == '/') name++;
+    size_t len = strlen(name);
+    if (len == 0 || len + 2 > sizeof(region->name) || strchr(name, '/')) return SHMIPC_ERROR_INVALID;
+    region->name[0] = '/';
+    memcpy(region->name + 1, name, len + 1);
+    return SHMIPC_OK;
+}
+
+/** @brief Maps `size` bytes of a shared-memory object, locked and out of core dumps */
+static int map_region(shmipc_region *region, int fd, size_t size) {
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return SHMIPC_ERROR_SYSTEM;
+    (void)mlock(map, size);
+#ifdef MADV_DONTDUMP
+    (void)madvise(map, size, MADV_DONTDUMP);
+#endif
+    region->header = map;
+    region->slots = (shmipc_slot *)((unsigned char *)map + sizeof(shmipc_header));
+    region->size = size;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    region->spin = online > 1 ? SHMIPC_SPIN_LIMIT : 0;
+    return SHMIPC_OK;
+}
+
+// ============ Server ============
+
+/**
+ * @brief A worker thread of shmipc_serve().
+ */
+typedef struct {
+    shmipc_region *region;
+    shmipc_handler handler;
+    void *ctx;
+    uint32_t cursor;             /**< Where the next scan starts */
+} serve_worker;
+
+/** @brief Hands back the responses of a batch */
+static void respond(shmipc_slot *const *slots, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        atomic_store(&slots[i]->state, SLOT_RESPONSE);
+        wake(&slots[i]->state, &slots[i]->waiters, INT_MAX);
+    }
+}
+
+/** @brief Takes up to SHMIPC_BATCH submitted slots, from the worker's cursor on */
+static size_t take_requests(serve_worker *worker, shmipc_slot **batch) {
+    shmipc_region *region = worker->region;
+    uint32_t slot_count = region->header->slot_count;
+    size_t count = 0;
+    uint32_t i = 0;
+    for (; i < slot_count && count < SHMIPC_BATCH; i++) {
+        shmipc_slot *slot = &region->slots[(worker->cursor + i) % slot_count];
+        unsigned expected = SLOT_REQUEST;
+        if (atomic_load_explicit(&slot->state, memory_order_relaxed) == SLOT_REQUEST &&
+            atomic_compare_exchange_strong(&slot->state, &expected, SLOT_WORKING)) {
+            batch[count++] = slot;
+        }
+    }
+    worker->cursor = (worker->cursor + i) % slot_count;
+    return count;
+}
+
+static void *serve_worker_main(void *arg) {
+    serve_worker *worker = arg;
+    shmipc_region *region = worker->region;
+    shmipc_header *header = region->header;
+    shmipc_slot *batch[SHMIPC_BATCH];
+    for (;;) {
+        // Read before the scan: a request submitted after it changes the word
+        unsigned seen = atomic_load(&header->submitted);
+        size_t count = take_requests(worker, batch);
+        if (count > 0) {
+            worker->handler(worker->ctx, batch, count);
+            respond(batch, count);
+            atomic_fetch_add(&region->requests, count);
+            atomic_fetch_add(&region->batches, 1);
+            continue;
+        }
+        if (atomic_load(&header->stopping)) break;
+        wait_change(region, &header->submitted, seen, &header->server_waiters, NULL);
+    }
+    return NULL;
+}
+
+int shmipc_create(shmipc_region *region, const char *name, uint32_t slots) {
+    if (!region || slots == 0 || slots > SHMIPC_MAX_SLOTS) return SHMIPC_ERROR_INVALID;
+    memset(region, 0, sizeof(*region));
+    int result = region_name(region, name);
+    if (result != SHMIPC_OK) return result;
+
+    size_t size = sizeof(shmipc_header) + (size_t)slots * sizeof(shmipc_slot);
+    int fd = shm_open(region->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return SHMIPC_ERROR_SYSTEM;
+    // A new object reads as zeros: every slot starts FREE
+    result = ftruncate(fd, (off_t)size) == 0 ? map_region(region, fd, size) : SHMIPC_ERROR_SYSTEM;
+    close(fd);
+    if (result != SHMIPC_OK) {
+        shm_unlink(region->name);
+        memset(region, 0, sizeof(*region));
+        return result;
+    }
+
+    shmipc_header *header = region->header;
+    header->version = SHMIPC_VERSION;
+    header->slot_count = slots;
+    header->slot_size = sizeof(shmipc_slot);
+    header->server_pid = (int32_t)getpid();
+    atomic_thread_fence(memory_order_release);
+    header->magic = SHMIPC_MAGIC;
+    region->owner = 1;
+    return SHMIPC_OK;
+}
+
+int shmipc_serve(shmipc_region *region, uint32_t workers, shmipc_handler handler, void *ctx) {
+    if (!region || !region->header || !region->owner || !handler) return SHMIPC_ERROR_INVALID;
+    if (workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = online > 0 ? (uint32_t)online : 1;
+    }
+    uint32_t slot_count = region->header->slot_count;
+    serve_worker *pool = calloc(workers, sizeof(*pool));
+    pthread_t *threads = calloc(workers, sizeof(*threads));
+    int result = pool && threads ? SHMIPC_OK : SHMIPC_ERROR_SYSTEM;
+    uint32_t started = 0;
+    for (; result == SHMIPC_OK && started < workers; started++) {
+        pool[started] = (serve_worker){region, handler, ctx, (uint32_t)((uint64_t)started * slot_count / workers)};
+        if (pthread_create(&threads[started], NULL, serve_worker_main, &pool[started]) != 0) {
+            shmipc_stop(region);
+            result = SHMIPC_ERROR_SYSTEM;
+            break;
+        }
+    }
+    for (uint32_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(pool);
+    free(threads);
+
+    // Answer what is still submitted; clients that submit from now on see `stopping`
+    atomic_store(&region->header->stopping, 1);
+    for (uint32_t i = 0; i < slot_count; i++) {
+        shmipc_slot *slot = &region->slots[i];
+        unsigned expected = SLOT_REQUEST;
+        if (atomic_compare_exchange_strong(&slot->state, &expected, SLOT_WORKING)) {
+            slot->status = SHMIPC_ERROR_CLOSED;
+            respond(&slot, 1);
+        }
+    }
+    futex(&region->header->released, FUTEX_WAKE, INT_MAX, NULL);
+    return result;
+}
+
+void shmipc_stop(shmipc_region *region) {
+    if (!region || !region->header) return;
+    atomic_store(&region->header->stopping, 1);
+    futex(&region->header->submitted, FUTEX_WAKE, INT_MAX, NULL);
+    futex(&region->header->released, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+void shmipc_get_stats(shmipc_region *region, shmipc_stats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!region) return;
+    stats->requests = atomic_load(&region->requests);
+    stats->batches = atomic_load(&region->batches);
+}
+
+// ============ Client ============
+
+int shmipc_open(shmipc_region *region, const char *name) {
+    if (!region) return SHMIPC_ERROR_INVALID;
+    memset(region, 0, sizeof(*region));
+    int result = region_name(region, name);
+    if (result != SHMIPC_OK) return result;
+
+    int fd = shm_open(region->name, O_RDWR, 0);
+    if (fd < 0) return SHMIPC_ERROR_SYSTEM;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        result = SHMIPC_ERROR_SYSTEM;
+    } else if ((size_t)st.st_size < sizeof(shmipc_header)) {
+        result = SHMIPC_ERROR_VERSION;
+    } else {
+        result = map_region(region, fd, (size_t)st.st_size);
+    }
+    close(fd);
+    if (result != SHMIPC_OK) return result;
+
+    const shmipc_header *header = region->header;
+    if (header->magic != SHMIPC_MAGIC || header->version != SHMIPC_VERSION ||
+        header->slot_size != sizeof(shmipc_slot) || header->slot_count == 0 ||
+        header->slot_count > SHMIPC_MAX_SLOTS ||
+        region->size != sizeof(shmipc_header) + (size_t)header->slot_count * sizeof(shmipc_slot)) {
+        shmipc_close(region);
+        return SHMIPC_ERROR_VERSION;
+    }
+    return SHMIPC_OK;
+}
+
+/** @brief Monotonic clock in nanoseconds */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Waits, at most SHMIPC_DRAIN_NS, for clients to release every slot.
+ * @note Clients may still be reading a response when the server stops.
+ */
+static void drain_slots(shmipc_region *region) {
+    shmipc_header *header = region->header;
+    const struct timespec tick = {0, 10000000L};
+    uint64_t deadline = now_ns() + SHMIPC_DRAIN_NS;
+    for (;;) {
+        unsigned seen = atomic_load(&header->released);
+        uint32_t busy = 0;
+        for (uint32_t i = 0; i < header->slot_count; i++) {
+            if (atomic_load(&region->slots[i].state) != SLOT_FREE) busy++;
+        }
+        if (busy == 0 || now_ns() >= deadline) return;
+        wait_change(region, &header->released, seen, &header->client_waiters, &tick);
+    }
+}
+
+/**
+ * @brief Wipes the payload of every free slot.
+ * @note A slot is held WORKING while it is wiped, so no client claims it
+ *       meanwhile; slots clients still hold are left alone.
+ */
+static void wipe_free_slots(shmipc_region *region) {
+    for (uint32_t i = 0; i < region->header->slot_count; i++) {
+        shmipc_slot *slot = &region->slots[i];
+        unsigned expected = SLOT_FREE;
+        if (atomic_compare_exchange_strong(&slot->state, &expected, SLOT_WORKING)) {
+            OPENSSL_cleanse(&slot->op, sizeof(*slot) - offsetof(shmipc_slot, op));
+            atomic_store(&slot->state, SLOT_FREE);
+        }
+    }
+}
+
+void shmipc_close(shmipc_region *region) {
+    if (!region || !region->header) return;
+    if (region->owner) {
+        drain_slots(region);
+        wipe_free_slots(region);
+    }
+    munlock(region->header, region->size);
+    munmap(region->header, region->size);
+    if (region->owner) shm_unlink(region->name);
+    memset(region, 0, sizeof(*region));
+}
+
+shmipc_slot *shmipc_acquire(shmipc_region *region) {
+    if (!region || !region->header) return NULL;
+    shmipc_header *header = region->header;
+    uint32_t slot_count = header->slot_count;
+    const struct timespec check = {0, SHMIPC_CHECK_NS};
+    for (;;) {
+        if (atomic_load(&header->stopping)) return NULL;
+        unsigned seen = atomic_load(&header->released);
+        uint32_t start = atomic_fetch_add(&header->cursor, 1);
+        for (uint32_t i = 0; i < slot_count; i++) {
+            shmipc_slot *slot = &region->slots[(start + i) % slot_count];
+            unsigned expected = SLOT_FREE;
+            if (atomic_load_explicit(&slot->state, memory_order_relaxed) == SLOT_FREE &&
+                atomic_compare_exchange_strong(&slot->state, &expected, SLOT_FILLING)) {
+                return slot;
+            }
+        }
+        wait_change(region, &header->released, seen, &header->client_waiters, &check);
+        if (atomic_load(&header->released) == seen && !server_alive(region)) return NULL;
+    }
+}
+
+int shmipc_call(shmipc_region *region, shmipc_slot *slot) {
+    if (!region || !region->header || !slot) return SHMIPC_ERROR_INVALID;
+    shmipc_header *header = region->header;
+    slot->status = SHMIPC_OK;
+    atomic_store(&slot->state, SLOT_REQUEST);
+    atomic_fetch_add(&header->submitted, 1);
+    wake(&header->submitted, &header->server_waiters, 1);
+
+    // Submitted after the server's last sweep: take the request back
+    if (atomic_load(&header->stopping)) {
+        unsigned expected = SLOT_REQUEST;
+        if (atomic_compare_exchange_strong(&slot->state, &expected, SLOT_RESPONSE)) {
+            slot->status = SHMIPC_ERROR_CLOSED;
+        }
+    }
+
+    const struct timespec check = {0, SHMIPC_CHECK_NS};
+    unsigned state;
+    while ((state = atomic_load(&slot->state)) != SLOT_RESPONSE) {
+        wait_change(region, &slot->state, state, &slot->waiters, &check);
+        if (atomic_load(&slot->state) == state && !server_alive(region)) return SHMIPC_ERROR_CLOSED;
+    }
+    return slot->status;
+}
+
+void shmipc_release(shmipc_region *region, shmipc_slot *slot) {
+    if (!region || !region->header || !slot) return;
+    shmipc_header *header = region->header;
+    OPENSSL_cleanse(&slot->op, sizeof(*slot) - offsetof(shmipc_slot, op));
+    atomic_store(&slot->state, SLOT_FREE);
+    atomic_fetch_add(&header->released, 1);
+    wake(&header->released, &header->client_waiters, 1);
+}
+
+int shmipc_mnemonic_to_seed(shmipc_region *region, const char *mnemonic, const char *passphrase,
+                            uint8_t seed[BIP39_SEED_SIZE]) {
+    if (!mnemonic || !seed) return SHMIPC_ERROR_INVALID;
+    size_t mnemonic_len = strlen(mnemonic);
+    size_t passphrase_len = passphrase ? strlen(passphrase) : 0;
+    if (mnemonic_len >= BIP39_MNEMONIC_MAX_SIZE || passphrase_len > SHMIPC_MAX_PASSPHRASE) {
+        return SHMIPC_ERROR_INVALID;
+    }
+    shmipc_slot *slot = shmipc_acquire(region);
+    if (!slot) return SHMIPC_ERROR_CLOSED;
+    slot->op = SHMIPC_OP_SEED;
+    memcpy(slot->mnemonic, mnemonic, mnemonic_len + 1);
+    if (passphrase_len) memcpy(slot->passphrase, passphrase, passphrase_len);
+    slot->passphrase[passphrase_len] = '\0';
+    int result = shmipc_call(region, slot);
+    if (result == SHMIPC_OK) memcpy(seed, slot->seed, BIP39_SEED_SIZE);
+    shmipc_release(region, slot);
+    return result;
+}
+
+int shmipc_master_key(shmipc_region *region, const uint8_t seed[BIP39_SEED_SIZE],
+                      uint8_t private_key[32], uint8_t chain_code[32]) {
+    if (!seed || !private_key || !chain_code) return SHMIPC_ERROR_INVALID;
+    shmipc_slot *slot = shmipc_acquire(region);
+    if (!slot) return SHMIPC_ERROR_CLOSED;
+    slot->op = SHMIPC_OP_MASTER_KEY;
+    memcpy(slot->seed, seed, BIP39_SEED_SIZE);
+    int result = shmipc_call(region, slot);
+    if (result == SHMIPC_OK) {
+        memcpy(private_key, slot->private_key, 32);
+        memcpy(chain_code, slot->chain_code, 32);
+    }
+    shmipc_release(region, slot);
+    return result;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file shmipc.h
+ * @brief Request/response ring in shared memory, for callers on the same host.
+ * @details A resident server creates a named POSIX shared-memory region
+ *          holding a header and a ring of fixed-size slots. A client maps
+ *          the region, claims a free slot, writes its request (a phrase, a
+ *          seed) straight into it and marks it submitted; a server worker
+ *          writes the response (seed, master key) into the same slot. No
+ *          buffer goes through the kernel and nothing is serialized.
+ *
+ *          Each slot has a state word that moves FREE -> FILLING (client)
+ *          -> REQUEST (client) -> WORKING (server) -> RESPONSE (server) ->
+ *          FREE (client); every move is a compare-and-swap or a store by the
+ *          slot's current owner. Waiting spins briefly, then sleeps on a
+ *          futex: on the slot's state for a response, on header counters for
+ *          a request (server) or a free slot (client). Wakeups are only
+ *          issued when someone sleeps, so a busy server and a spinning client
+ *          exchange a request without a system call.
+ *
+ *          Workers scan the ring for submitted slots and take up to
+ *          SHMIPC_BATCH at once, so the handler can derive several seeds on
+ *          the SIMD lanes together.
+ *
+ *          The region is created 0600: only processes of the same user can
+ *          map it. Phrases, seeds and keys pass through it, so the mapping is
+ *          locked in memory and left out of core dumps, and a client wipes
+ *          its slot when it releases it.
+ */
+
+#ifndef SHMIPC_H
+#define SHMIPC_H
+
+#include <stddef.h>     // For size_t
+#include <stdint.h>     // For uint8_t, uint32_t, uint64_t
+#include <stdatomic.h>  // For atomic_uint, atomic_uint_fast64_t
+
+#include "../bip39/bip39.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Cache line size assumed for padding */
+#define SHMIPC_CACHE_LINE 64
+
+/** @brief Longest region name, "/" included */
+#define SHMIPC_NAME_SIZE 256
+
+/** @brief Most slots in a ring */
+#define SHMIPC_MAX_SLOTS 4096
+
+/** @brief Most slots a worker takes in one go */
+#define SHMIPC_BATCH 8
+
+/** @brief Longest passphrase a slot carries, in bytes */
+#define SHMIPC_MAX_PASSPHRASE 255
+
+/** @brief Error codes */
+enum {
+    SHMIPC_OK = 0,
+    SHMIPC_ERROR_INVALID = -1,    /**< Bad arguments, or a request field too long */
+    SHMIPC_ERROR_SYSTEM = -2,     /**< shm_open, mmap or thread creation failed (see errno) */
+    SHMIPC_ERROR_VERSION = -3,    /**< The region is not a ring of this version */
+    SHMIPC_ERROR_CLOSED = -4,     /**< The server stopped or died */
+    SHMIPC_ERROR_FAILED = -5      /**< The server could not serve the request */
+};
+
+/** @brief Request kinds */
+typedef enum {
+    SHMIPC_OP_PING = 0,           /**< No work: measures the round trip */
+    SHMIPC_OP_SEED = 1,           /**< mnemonic, passphrase -> seed */
+    SHMIPC_OP_MASTER_KEY = 2,     /**< seed -> private_key, chain_code, public_key, fingerprint */
+    SHMIPC_OP_MNEMONIC_KEY = 3    /**< mnemonic, passphrase -> seed and master key */
+} shmipc_op;
+
+/**
+ * @brief One request and its response; a slot of the ring.
+ */
+typedef struct {
+    _Alignas(SHMIPC_CACHE_LINE) atomic_uint state;     /**< Futex word: FREE, FILLING, REQUEST, WORKING, RESPONSE */
+    atomic_uint waiters;                               /**< Clients sleeping on state */
+    uint32_t op;                                       /**< shmipc_op */
+    int32_t status;                                    /**< SHMIPC_OK or a negative error code */
+    char mnemonic[BIP39_MNEMONIC_MAX_SIZE];            /**< Request: phrase (NFKD normalized) */
+    char passphrase[SHMIPC_MAX_PASSPHRASE + 1];        /**< Request: passphrase */
+    uint8_t seed[BIP39_SEED_SIZE];                     /**< Request or response: seed */
+    uint8_t private_key[32];                           /**< Response: master private key */
+    uint8_t chain_code[32];                            /**< Response: master chain code */
+    uint8_t public_key[33];                            /**< Response: compressed master public key */
+    uint32_t fingerprint;                              /**< Response: master key fingerprint */
+} shmipc_slot;
+
+/**
+ * @brief Start of the region; followed by the slots.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;                                   /**< sizeof(shmipc_slot), checked by clients */
+    int32_t server_pid;                                   /**< Checked by clients that wait long */
+    atomic_uint stopping;                                 /**< Set when the server shuts down */
+    _Alignas(SHMIPC_CACHE_LINE) atomic_uint submitted;    /**< Futex word: bumped on each request */
+    atomic_uint server_waiters;                           /**< Workers sleeping on submitted */
+    _Alignas(SHMIPC_CACHE_LINE) atomic_uint released;     /**< Futex word: bumped on each freed slot */
+    atomic_uint client_waiters;                           /**< Clients sleeping on released */
+    _Alignas(SHMIPC_CACHE_LINE) atomic_uint cursor;       /**< Where clients start looking for a free slot */
+} shmipc_header;
+
+/**
+ * @brief Server counters.
+ */
+typedef struct {
+    uint64_t requests;           /**< Requests answered */
+    uint64_t batches;            /**< Handler calls */
+} shmipc_stats;
+
+/**
+ * @brief Serves the requests of a batch: fills each slot's response and status.
+ * @param ctx Handler context.
+ * @param slots Slots in the WORKING state.
+ * @param count 1 to SHMIPC_BATCH.
+ */
+typedef void (*shmipc_handler)(void *ctx, shmipc_slot *const *slots, size_t count);
+
+/**
+ * @brief A mapped region, on the server or a client side; fields are private.
+ */
+typedef struct {
+    shmipc_header *header;
+    shmipc_slot *slots;
+    size_t size;                 /**< Bytes mapped */
+    uint32_t spin;               /**< Polls before sleeping on a futex (0 on a single CPU) */
+    int owner;                   /**< Created by this process: unlinked on close */
+    char name[SHMIPC_NAME_SIZE];
+    atomic_uint_fast64_t requests;
+    atomic_uint_fast64_t batches;
+} shmipc_region;
+
+/**
+ * @brief Creates a region for a server.
+ * @param region Region to initialize.
+ * @param name Region name, e.g. "bip32" (a leading "/" is added if missing).
+ * @param slots Slots in the ring, 1 to SHMIPC_MAX_SLOTS.
+ * @return SHMIPC_OK or a negative error code.
+ * @note Fails if a region of that name exists; a server that died leaves
+ *       its region behind in /dev/shm.
+ */
+int shmipc_create(shmipc_region *region, const char *name, uint32_t slots);
+
+/**
+ * @brief Answers requests until shmipc_stop() is called.
+ * @param region Region from shmipc_create().
+ * @param workers Worker threads (0 for the CPU count).
+ * @param handler Serves each batch.
+ * @param ctx Passed to handler.
+ * @return SHMIPC_OK or a negative error code.
+ * @note Requests still submitted when the server stops are answered with
+ *       SHMIPC_ERROR_CLOSED.
+ */
+int shmipc_serve(shmipc_region *region, uint32_t workers, shmipc_handler handler, void *ctx);
+
+/**
+ * @brief Makes shmipc_serve() return; safe to call from a signal handler.
+ * @param region Region being served.
+ */
+void shmipc_stop(shmipc_region *region);
+
+/**
+ * @brief Returns the server counters.
+ * @param region Region being served.
+ * @param stats Output.
+ */
+void shmipc_get_stats(shmipc_region *region, shmipc_stats *stats);
+
+/**
+ * @brief Maps the region of a running server.
+ * @param region Region to initialize.
+ * @param name Region name, as given to the server.
+ * @return SHMIPC_OK or a negative error code.
+ */
+int shmipc_open(shmipc_region *region, const char *name);
+
+/**
+ * @brief Unmaps a region; the server side also removes its name.
+ * @param region Region (can be zero-initialized).
+ * @note On the server side, first waits up to a second for clients to
+ *       release their slots, then wipes the slots that are free.
+ */
+void shmipc_close(shmipc_region *region);
+
+/**
+ * @brief Claims a free slot to write a request into.
+ * @param region Client region.
+ * @return The slot, or NULL once the server stops.
+ */
+shmipc_slot *shmipc_acquire(shmipc_region *region);
+
+/**
+ * @brief Submits the request written in a slot and waits for its response.
+ * @param region Client region.
+ * @param slot Slot from shmipc_acquire(), with op and the request fields set.
+ * @return The response status: SHMIPC_OK or a negative error code.
+ * @note The response fields stay in the slot until shmipc_release().
+ */
+int shmipc_call(shmipc_region *region, shmipc_slot *slot);
+
+/**
+ * @brief Wipes a slot and returns it to the ring.
+ * @param region Client region.
+ * @param slot Slot from shmipc_acquire().
+ */
+void shmipc_release(shmipc_region *region, shmipc_slot *slot);
+
+/**
+ * @brief bip39_mnemonic_to_seed() through the server.
+ * @param region Client region.
+ * @param mnemonic Space separated mnemonic phrase (NFKD normalized).
+ * @param passphrase Optional passphrase (can be NULL).
+ * @param seed Output buffer for the seed.
+ * @return SHMIPC_OK or a negative error code.
+ */
+int shmipc_mnemonic_to_seed(shmipc_region *region, const char *mnemonic, const char *passphrase,
+                            uint8_t seed[BIP39_SEED_SIZE]);
+
+/**
+ * @brief derive_bip32_master_key() through the server.
+ * @param region Client region.
+ * @param seed Seed.
+ * @param private_key Output: master private key (32 bytes).
+ * @param chain_code Output: master chain code (32 bytes).
+ * @return SHMIPC_OK or a negative error code.
+ */
+int shmipc_master_key(shmipc_region *region, const uint8_t seed[BIP39_SEED_SIZE],
+                      uint8_t private_key[32], uint8_t chain_code[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHMIPC_H
@@ -0,0 +1,311 @@
+/**
+ * @file slip39.c
+ * @brief SLIP-39 Shamir backups of mnemonic entropy
+ *
+ * Splits master secrets (such as the entropy printed by the mnemonics program)
+ * into SLIP-39 share mnemonics and recombines them. Secrets and share sets
+ * are read from stdin so thousands of wallets can be processed in one run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <openssl/crypto.h>
+
+#include "slip39/slip39.h"
+
+/** @brief Longest input line: a share mnemonic or a hex secret */
+#define LINE_SIZE 512
+
+/**
+ * @brief Converts a hexadecimal string of any even length to binary data
+ *
+ * @param[out] bin Output buffer
+ * @param[in] hex Input hexadecimal string (null-terminated)
+ * @param[in] max Size of the output buffer
+ * @param[out] len Number of bytes written
+ * @return 0 on success, -1 on invalid input
+ */
+static int hex_to_bin(uint8_t *bin, const char *hex, size_t max, size_t *len) {
+    size_t hex_len = strlen(hex);
+    if (hex_len % 2 != 0 || hex_len / 2 > max) {
+        return -1;
+    }
+    for (size_t i = 0; i < hex_len / 2; i++) {
+        if (sscanf(hex + 2 * i, "%2hhx", &bin[i]) != 1) {
+            return -1;
+        }
+    }
+    *len = hex_len / 2;
+    return 0;
+}
+
+/**
+ * @brief Parses a group list such as "2of3,3of5"
+ *
+ * @param[in] spec Group list
+ * @param[out] groups Output groups (SLIP39_MAX_GROUPS entries)
+ * @param[out] count Number of groups
+ * @return 0 on success, -1 on invalid input
+ */
+static int parse_groups(const char *spec, slip39_group *groups, size_t *count) {
+    size_t n = 0;
+    const char *p = spec;
+    while (*p) {
+        unsigned threshold, members;
+        int used = 0;
+        if (n == SLIP39_MAX_GROUPS ||
+            sscanf(p, "%uof%u%n", &threshold, &members, &used) != 2 ||
+            threshold == 0 || members == 0 || members > SLIP39_MAX_MEMBERS) {
+            return -1;
+        }
+        groups[n].member_threshold = (uint8_t)threshold;
+        groups[n].member_count = (uint8_t)members;
+        n++;
+        p += used;
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    *count = n;
+    return n > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Recombines freshly generated shares from the minimum subset
+ *
+ * @param[in] mnemonics Encoded shares, SLIP39_MNEMONIC_MAX_SIZE bytes apart
+ * @param[in] groups Group specifications
+ * @param[in] group_threshold Groups needed
+ * @param[in] list Wordlist
+ * @param[in] passphrase Passphrase
+ * @param[in] secret Expected secret
+ * @param[in] length Secret length
+ * @return 0 if the secret comes back from the words, negative code otherwise
+ */
+static int verify_shares(const char *mnemonics, const slip39_group *groups,
+                         uint8_t group_threshold, const slip39_wordlist *list,
+                         const char *passphrase, const uint8_t *secret, size_t length) {
+    slip39_share subset[SLIP39_MAX_GROUPS * SLIP39_MAX_MEMBERS];
+    size_t n = 0;
+    size_t offset = 0;
+    int result = SLIP39_OK;
+
+    // First member_threshold members of the first group_threshold groups
+    for (uint8_t g = 0; g < group_threshold && result == SLIP39_OK; g++) {
+        for (uint8_t m = 0; m < groups[g].member_threshold && result == SLIP39_OK; m++) {
+            result = slip39_mnemonic_to_share(mnemonics + (offset + m) * SLIP39_MNEMONIC_MAX_SIZE,
+                                              list, &subset[n++]);
+        }
+        offset += groups[g].member_count;
+    }
+
+    uint8_t recovered[SLIP39_MAX_SECRET_SIZE];
+    size_t recovered_length = 0;
+    if (result == SLIP39_OK) {
+        result = slip39_combine(subset, n, passphrase, recovered, &recovered_length);
+    }
+    if (result == SLIP39_OK &&
+        (recovered_length != length || CRYPTO_memcmp(recovered, secret, length) != 0)) {
+        result = SLIP39_ERROR_DIGEST;
+    }
+
+    OPENSSL_cleanse(subset, sizeof(subset));
+    OPENSSL_cleanse(recovered, sizeof(recovered));
+    return result;
+}
+
+/**
+ * @brief Splits every hex secret read from stdin and prints its share mnemonics
+ *
+ * @param[in] wordlist_path SLIP-39 wordlist file
+ * @param[in] group_threshold Groups needed to recover
+ * @param[in] group_spec Group list such as "2of3,3of5"
+ * @param[in] passphrase Passphrase (can be empty)
+ * @param[in] iteration_exponent Feistel cost exponent
+ * @return 0 on success, negative code on failure
+ *
+ * @note Each set is decoded and recombined before it is printed; sets are
+ *       separated by a blank line
+ */
+static int process_split(const char *wordlist_path, uint8_t group_threshold,
+                         const char *group_spec, const char *passphrase,
+                         uint8_t iteration_exponent) {
+    slip39_group groups[SLIP39_MAX_GROUPS];
+    size_t group_count = 0;
+    if (parse_groups(group_spec, groups, &group_count) != 0) {
+        fprintf(stderr, "Invalid group list: %s (e.g. 2of3,3of5)\n", group_spec);
+        return SLIP39_ERROR_INVALID;
+    }
+
+    slip39_wordlist list;
+    if (slip39_wordlist_load(&list, wordlist_path) != SLIP39_OK) {
+        fprintf(stderr, "Cannot load SLIP-39 wordlist %s\n", wordlist_path);
+        return SLIP39_ERROR_INVALID;
+    }
+
+    static slip39_share shares[SLIP39_MAX_GROUPS * SLIP39_MAX_MEMBERS];
+    static char mnemonics[SLIP39_MAX_GROUPS * SLIP39_MAX_MEMBERS][SLIP39_MNEMONIC_MAX_SIZE];
+    uint8_t secret[SLIP39_MAX_SECRET_SIZE];
+    char line[LINE_SIZE];
+    size_t line_no = 0;
+    int result = SLIP39_OK;
+    while (result == SLIP39_OK && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+
+        size_t length = 0;
+        size_t count = 0;
+        if (hex_to_bin(secret, line, sizeof(secret), &length) != 0) {
+            fprintf(stderr, "Invalid secret hex string on line %zu\n", line_no);
+            result = SLIP39_ERROR_INVALID;
+            break;
+        }
+        result = slip39_generate(secret, length, passphrase, group_threshold, groups, group_count,
+                                 iteration_exponent, 0, shares, &count);
+        for (size_t i = 0; i < count && result == SLIP39_OK; i++) {
+            result = slip39_share_to_mnemonic(&shares[i], &list, mnemonics[i], SLIP39_MNEMONIC_MAX_SIZE);
+        }
+        if (result == SLIP39_OK) {
+            result = verify_shares(mnemonics[0], groups, group_threshold, &list,
+                                   passphrase, secret, length);
+        }
+        if (result != SLIP39_OK) {
+            fprintf(stderr, "Failed to create shares for line %zu (error %d)\n", line_no, result);
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            printf("%s\n", mnemonics[i]);
+        }
+        printf("\n");
+    }
+
+    OPENSSL_cleanse(shares, sizeof(shares));
+    OPENSSL_cleanse(mnemonics, sizeof(mnemonics));
+    OPENSSL_cleanse(secret, sizeof(secret));
+    OPENSSL_cleanse(line, sizeof(line));
+    slip39_wordlist_free(&list);
+    return result;
+}
+
+/**
+ * @brief Recovers one secret from a set of share mnemonics and prints it
+ *
+ * @param[in] shares Decoded shares
+ * @param[in] count Number of shares
+ * @param[in] passphrase Passphrase
+ * @param[in] set_no Set number for error messages
+ * @return 0 on success, negative code on failure
+ */
+static int combine_set(const slip39_share *shares, size_t count, const char *passphrase,
+                       size_t set_no) {
+    uint8_t secret[SLIP39_MAX_SECRET_SIZE];
+    size_t length = 0;
+    int result = slip39_combine(shares, count, passphrase, secret, &length);
+    if (result != SLIP39_OK) {
+        fprintf(stderr, "Cannot recover set %zu (error %d)\n", set_no, result);
+        return result;
+    }
+    for (size_t i = 0; i < length; i++) {
+        printf("%02x", secret[i]);
+    }
+    printf("\n");
+    OPENSSL_cleanse(secret, sizeof(secret));
+    return SLIP39_OK;
+}
+
+/**
+ * @brief Recombines share sets read from stdin, one secret per set
+ *
+ * @param[in] wordlist_path SLIP-39 wordlist file
+ * @param[in] passphrase Passphrase (can be empty)
+ * @return 0 on success, negative code on failure
+ *
+ * @note One mnemonic per line; sets are separated by blank lines
+ */
+static int process_combine(const char *wordlist_path, const char *passphrase) {
+    slip39_wordlist list;
+    if (slip39_wordlist_load(&list, wordlist_path) != SLIP39_OK) {
+        fprintf(stderr, "Cannot load SLIP-39 wordlist %s\n", wordlist_path);
+        return SLIP39_ERROR_INVALID;
+    }
+
+    static slip39_share shares[SLIP39_MAX_GROUPS * SLIP39_MAX_MEMBERS];
+    size_t count = 0;
+    size_t set_no = 1;
+    size_t line_no = 0;
+    char line[LINE_SIZE];
+    int result = SLIP39_OK;
+    while (result == SLIP39_OK && fgets(line, sizeof(line), stdin)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0') {
+            if (count > 0) {
+                result = combine_set(shares, count, passphrase, set_no++);
+                count = 0;
+            }
+            continue;
+        }
+        if (count == sizeof(shares) / sizeof(shares[0])) {
+            fprintf(stderr, "Too many shares in set %zu\n", set_no);
+            result = SLIP39_ERROR_INVALID;
+            break;
+        }
+        result = slip39_mnemonic_to_share(line, &list, &shares[count]);
+        if (result != SLIP39_OK) {
+            fprintf(stderr, "Invalid share on line %zu (error %d)\n", line_no, result);
+            break;
+        }
+        count++;
+    }
+    if (result == SLIP39_OK && count > 0) {
+        result = combine_set(shares, count, passphrase, set_no);
+    }
+
+    OPENSSL_cleanse(shares, sizeof(shares));
+    OPENSSL_cleanse(line, sizeof(line));
+    slip39_wordlist_free(&list);
+    return result;
+}
+
+/**
+ * @brief Main function: SLIP-39 split and combine
+ *
+ * @param[in] argc Number of command-line arguments
+ * @param[in] argv Array of command-line argument strings
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure
+ *
+ * @note Usage: ./slip39 split <wordlist> <group_threshold> <TofN>[,<TofN>...] [passphrase] [exponent] < secrets.txt
+ * @note Usage: ./slip39 combine <wordlist> [passphrase] < shares.txt
+ */
+int main(int argc, char *argv[]) {
+    if (argc >= 5 && argc <= 7 && strcmp(argv[1], "split") == 0) {
+        long group_threshold = strtol(argv[3], NULL, 10);
+        long exponent = argc > 6 ? strtol(argv[6], NULL, 10) : SLIP39_DEFAULT_ITERATION_EXPONENT;
+        if (group_threshold < 1 || group_threshold > SLIP39_MAX_GROUPS || exponent < 0 || exponent > 15) {
+            fprintf(stderr, "Invalid group threshold or iteration exponent\n");
+            return EXIT_FAILURE;
+        }
+        const char *passphrase = argc > 5 ? argv[5] : "";
+        return process_split(argv[2], (uint8_t)group_threshold, argv[4], passphrase,
+                             (uint8_t)exponent) == SLIP39_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "combine") == 0) {
+        const char *passphrase = argc > 3 ? argv[3] : "";
+        return process_combine(argv[2], passphrase) == SLIP39_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    fprintf(stderr, "Usage: %s split <wordlist> <group_threshold> <TofN>[,<TofN>...] [passphrase] [exponent] < secrets.txt\n", argv[0]);
+    fprintf(stderr, "       %s combine <wordlist> [passphrase] < shares.txt\n", argv[0]);
+    fprintf(stderr, "Example: echo 00112233445566778899aabbccddeeff | %s split slip39.txt 1 2of3\n", argv[0]);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file gf256.c
+ * @brief GF(256) arithmetic for Shamir secret sharing.
+ */
+#include "gf256.h"
+
+#include <string.h>
+#include <pthread.h>
+
+/** @brief exp[i] = 3^i (doubled so exp[a + b] needs no reduction) and log[exp[i]] = i */
+static uint8_t gf_exp[510];
+static uint8_t gf_log[256];
+static pthread_once_t gf_once = PTHREAD_ONCE_INIT;
+
+/** @brief Multiply-accumulate kernel, chosen from the CPU features in gf256_init(). */
+typedef void (*gf256_mul_add_fn)(uint8_t *, const uint8_t *, uint8_t, size_t);
+static gf256_mul_add_fn gf_mul_add;
+static gf256_mul_add_fn gf256_select(void);
+
+/**
+ * @brief Fills the log/exp tables with powers of the generator 3 and picks
+ *        the multiply-accumulate kernel.
+ */
+static void gf256_init(void) {
+    uint8_t poly = 1;
+    for (int i = 0; i < 255; i++) {
+        gf_exp[i] = gf_exp[i + 255] = poly;
+        gf_log[poly] = (uint8_t)i;
+        // poly *= 3, i.e. poly ^ (poly << 1), reduced by 0x11B
+        uint16_t next = (uint16_t)(poly ^ (poly << 1));
+        if (next & 0x100) next ^= 0x11B;
+        poly = (uint8_t)next;
+    }
+    gf_mul_add = gf256_select();
+}
+
+uint8_t gf256_mul(uint8_t a, uint8_t b) {
+    pthread_once(&gf_once, gf256_init);
+    if (a == 0 || b == 0) return 0;
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+/**
+ * @brief Table-driven multiply-accumulate.
+ */
+static void gf256_mul_add_scalar(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len) {
+    if (c == 0) return;
+    unsigned log_c = gf_log[c];
+    for (size_t i = 0; i < len; i++) {
+        if (src[i]) dst[i] ^= gf_exp[log_c + gf_log[src[i]]];
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GF256_HAVE_X86 1
+
+/**
+ * @brief Nibble product tables: lo[i] = c * i and hi[i] = c * (i << 4).
+ */
+static void nibble_tables(uint8_t c, uint8_t lo[16], uint8_t hi[16]) {
+    for (int i = 0; i < 16; i++) {
+        lo[i] = gf256_mul(c, (uint8_t)i);
+        hi[i] = gf256_mul(c, (uint8_t)(i << 4));
+    }
+}
+
+/**
+ * @brief Multiply-accumulate 16 bytes at a time with PSHUFB.
+ */
+__attribute__((target("ssse3")))
+static void gf256_mul_add_ssse3(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len) {
+    uint8_t lo[16], hi[16];
+    nibble_tables(c, lo, hi);
+    const __m128i tlo = _mm_loadu_si128((const __m128i *)lo);
+    const __m128i thi = _mm_loadu_si128((const __m128i *)hi);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i p = _mm_xor_si128(
+            _mm_shuffle_epi8(tlo, _mm_and_si128(s, mask)),
+            _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi16(s, 4), mask)));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(d, p));
+    }
+    for (; i < len; i++) {
+        dst[i] ^= lo[src[i] & 0x0F] ^ hi[src[i] >> 4];
+    }
+}
+
+/**
+ * @brief Multiply-accumulate 32 bytes at a time with VPSHUFB.
+ */
+__attribute__((target("avx2")))
+static void gf256_mul_add_avx2(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len) {
+    uint8_t lo[16], hi[16];
+    nibble_tables(c, lo, hi);
+    // VPSHUFB looks up within each 128-bit half, so both halves get the table
+    const __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo));
+    const __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i p = _mm256_xor_si256(
+            _mm256_shuffle_epi8(tlo, _mm256_and_si256(s, mask)),
+            _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi16(s, 4), mask)));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(d, p));
+    }
+    for (; i < len; i++) {
+        dst[i] ^= lo[src[i] & 0x0F] ^ hi[src[i] >> 4];
+    }
+}
+#endif
+
+/**
+ * @brief Picks the widest kernel the running CPU supports.
+ * @return Kernel function pointer.
+ */
+static gf256_mul_add_fn gf256_select(void) {
+#ifdef GF256_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return gf256_mul_add_avx2;
+    if (__builtin_cpu_supports("ssse3")) return gf256_mul_add_ssse3;
+#endif
+    return gf256_mul_add_scalar;
+}
+
+void gf256_mul_add(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len) {
+    pthread_once(&gf_once, gf256_init);
+    // Vectors shorter than one register are not worth the table setup
+    if (len < 16) {
+        gf256_mul_add_scalar(dst, src, c, len);
+    } else {
+        gf_mul_add(dst, src, c, len);
+    }
+}
+
+int gf256_interpolate(const uint8_t *xs, const uint8_t *const *ys, size_t n,
+                      size_t len, uint8_t x, uint8_t *out) {
+    pthread_once(&gf_once, gf256_init);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            if (xs[i] == xs[j]) return -1;
+        }
+        if (xs[i] == x) {
+            memcpy(out, ys[i], len);
+            return 0;
+        }
+    }
+
+    // Lagrange basis in the log domain:
+    // l_i(x) = prod_{j != i} (x - x_j) / (x_i - x_j), and subtraction is XOR
+    unsigned log_prod = 0;
+    for (size_t i = 0; i < n; i++) {
+        log_prod += gf_log[xs[i] ^ x];
+    }
+    memset(out, 0, len);
+    for (size_t i = 0; i < n; i++) {
+        unsigned log_denominator = gf_log[xs[i] ^ x];
+        for (size_t j = 0; j < n; j++) {
+            if (j != i) log_denominator += gf_log[xs[i] ^ xs[j]];
+        }
+        unsigned log_basis = (log_prod + 255 * n - log_denominator) % 255;
+        gf256_mul_add(out, ys[i], gf_exp[log_basis], len);
+    }
+    return 0;
+}
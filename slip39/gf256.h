@@ -0,0 +1,54 @@
+/**
+ * @file gf256.h
+ * @brief GF(256) arithmetic for Shamir secret sharing.
+ * @details The field is GF(2)[x] / (x^8 + x^4 + x^3 + x + 1), as in AES and
+ *          SLIP-39. Scalar products use log/exp tables; the bulk
+ *          multiply-accumulate splits each byte into nibbles and looks both
+ *          up with PSHUFB (SSSE3) or VPSHUFB (AVX2) when the CPU has them.
+ */
+
+#ifndef GF256_H
+#define GF256_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Product of two field elements.
+ * @param a First factor.
+ * @param b Second factor.
+ * @return a * b.
+ */
+uint8_t gf256_mul(uint8_t a, uint8_t b);
+
+/**
+ * @brief Multiply-accumulate over a byte vector: dst[i] ^= c * src[i].
+ * @param dst Accumulator, updated in place.
+ * @param src Source vector.
+ * @param c Constant factor.
+ * @param len Vector length.
+ */
+void gf256_mul_add(uint8_t *dst, const uint8_t *src, uint8_t c, size_t len);
+
+/**
+ * @brief Evaluates at x the polynomial through n points, byte by byte.
+ * @param xs Point x coordinates (distinct).
+ * @param ys Point y vectors, len bytes each.
+ * @param n Number of points.
+ * @param len Length of every y vector.
+ * @param x Where to evaluate.
+ * @param out Output, len bytes.
+ * @return 0 on success, -1 if two points share an x coordinate.
+ */
+int gf256_interpolate(const uint8_t *xs, const uint8_t *const *ys, size_t n,
+                      size_t len, uint8_t x, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GF256_H
@@ -0,0 +1,579 @@
+/**
+ * @file slip39.c
+ * @brief SLIP-39 Shamir backup shares.
+ */
+#include "slip39.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include "gf256.h"
+#include "../cpto/cpto.h"
+
+/** @brief Bits per word */
+#define RADIX_BITS 10
+
+/** @brief Words before the share value: identifier/exponent and share parameters */
+#define PREFIX_WORDS 4
+
+/** @brief RS1024 checksum words */
+#define CHECKSUM_WORDS 3
+
+/** @brief Feistel rounds and total PBKDF2 iterations at exponent 0 */
+#define ROUND_COUNT 4
+#define BASE_ITERATION_COUNT 10000
+
+/** @brief Shamir x coordinates holding the digest share and the secret */
+#define DIGEST_INDEX 254
+#define SECRET_INDEX 255
+
+/** @brief Length of the secret digest stored in the digest share */
+#define DIGEST_LENGTH 4
+
+/** @brief Customization strings of the checksum (and, for non-extendable sets, the salt) */
+static const char CUSTOMIZATION[] = "shamir";
+static const char CUSTOMIZATION_EXTENDABLE[] = "shamir_extendable";
+
+// ============ WORDLIST ============
+
+int slip39_wordlist_load(slip39_wordlist *list, const char *path) {
+    if (!list || !path) return SLIP39_ERROR_INVALID;
+    memset(list, 0, sizeof(*list));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return SLIP39_ERROR_INVALID;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    if (size <= 0 || size > SLIP39_WORD_COUNT * (SLIP39_MAX_WORD_SIZE + 2)) {
+        fclose(file);
+        return SLIP39_ERROR_INVALID;
+    }
+    char *arena = malloc((size_t)size + 1);
+    if (!arena || fread(arena, 1, (size_t)size, file) != (size_t)size) {
+        free(arena);
+        fclose(file);
+        return SLIP39_ERROR_INVALID;
+    }
+    fclose(file);
+    arena[size] = '\0';
+
+    // One word per line; the list must be sorted for binary search
+    size_t count = 0;
+    char *line = arena;
+    while (*line) {
+        size_t len = strcspn(line, "\r\n");
+        char *next = line + len;
+        next += strspn(next, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || len > SLIP39_MAX_WORD_SIZE || count == SLIP39_WORD_COUNT ||
+            (count > 0 && strcmp(list->words[count - 1], line) >= 0)) {
+            free(arena);
+            memset(list, 0, sizeof(*list));
+            return SLIP39_ERROR_INVALID;
+        }
+        list->words[count++] = line;
+        line = next;
+    }
+    if (count != SLIP39_WORD_COUNT) {
+        free(arena);
+        memset(list, 0, sizeof(*list));
+        return SLIP39_ERROR_INVALID;
+    }
+
+    list->arena = arena;
+    return SLIP39_OK;
+}
+
+void slip39_wordlist_free(slip39_wordlist *list) {
+    if (!list) return;
+    free(list->arena);
+    memset(list, 0, sizeof(*list));
+}
+
+/**
+ * @brief Index of a word in the sorted list.
+ * @return The index, or -1 if the word is not in the list.
+ */
+static int word_index(const slip39_wordlist *list, const char *word) {
+    int lo = 0, hi = SLIP39_WORD_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(list->words[mid], word);
+        if (cmp == 0) return mid;
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+// ============ RS1024 CHECKSUM ============
+
+/**
+ * @brief RS1024 polymod over the customization string and the words.
+ * @param extendable Selects the customization string.
+ * @param values 10-bit word values.
+ * @param n Number of values.
+ * @return The residue.
+ */
+static uint32_t rs1024_polymod(int extendable, const uint16_t *values, size_t n) {
+    static const uint32_t gen[10] = {
+        0xE0E040, 0x1C1C080, 0x3838100, 0x7070200, 0xE0E0009,
+        0x1C0C2412, 0x38086C24, 0x3090FC48, 0x21B1F890, 0x3F3F120
+    };
+    const char *cs = extendable ? CUSTOMIZATION_EXTENDABLE : CUSTOMIZATION;
+    size_t cs_len = strlen(cs);
+
+    uint32_t chk = 1;
+    for (size_t i = 0; i < cs_len + n; i++) {
+        uint32_t v = i < cs_len ? (uint8_t)cs[i] : values[i - cs_len];
+        uint32_t b = chk >> 20;
+        chk = ((chk & 0xFFFFF) << 10) ^ v;
+        for (int j = 0; j < 10; j++) {
+            if ((b >> j) & 1) chk ^= gen[j];
+        }
+    }
+    return chk;
+}
+
+// ============ FEISTEL CIPHER ============
+
+/**
+ * @brief Encrypts or decrypts a master secret with the SLIP-39 Feistel network.
+ * @param in Input, length bytes.
+ * @param length Even length.
+ * @param passphrase Passphrase (NULL for none).
+ * @param iteration_exponent Cost exponent.
+ * @param identifier Set identifier (part of the salt unless extendable).
+ * @param extendable Extendable flag.
+ * @param decrypt Non-zero to run the rounds in reverse.
+ * @param out Output, length bytes.
+ */
+static void feistel(const uint8_t *in, size_t length, const char *passphrase,
+                    uint8_t iteration_exponent, uint16_t identifier, int extendable,
+                    int decrypt, uint8_t *out) {
+    size_t half = length / 2;
+    size_t pass_len = passphrase ? strlen(passphrase) : 0;
+    uint32_t iterations = (BASE_ITERATION_COUNT << iteration_exponent) / ROUND_COUNT;
+
+    uint8_t left[SLIP39_MAX_SECRET_SIZE / 2], right[SLIP39_MAX_SECRET_SIZE / 2];
+    uint8_t f[SLIP39_MAX_SECRET_SIZE / 2];
+    memcpy(left, in, half);
+    memcpy(right, in + half, half);
+
+    // Password: round number then passphrase. Salt: "shamir" || id (unless
+    // extendable), then the right half
+    uint8_t password[1 + pass_len];
+    if (pass_len) memcpy(password + 1, passphrase, pass_len);
+    uint8_t salt[sizeof(CUSTOMIZATION) - 1 + 2 + SLIP39_MAX_SECRET_SIZE / 2];
+    size_t salt_prefix = 0;
+    if (!extendable) {
+        memcpy(salt, CUSTOMIZATION, sizeof(CUSTOMIZATION) - 1);
+        salt[sizeof(CUSTOMIZATION) - 1] = identifier >> 8;
+        salt[sizeof(CUSTOMIZATION)] = identifier & 0xFF;
+        salt_prefix = sizeof(CUSTOMIZATION) + 1;
+    }
+
+    for (int r = 0; r < ROUND_COUNT; r++) {
+        password[0] = (uint8_t)(decrypt ? ROUND_COUNT - 1 - r : r);
+        memcpy(salt + salt_prefix, right, half);
+        pbkdf2_hmac_sha256(password, sizeof(password), salt, salt_prefix + half,
+                           iterations, f, half);
+        for (size_t i = 0; i < half; i++) {
+            uint8_t next = left[i] ^ f[i];
+            left[i] = right[i];
+            right[i] = next;
+        }
+    }
+    memcpy(out, right, half);
+    memcpy(out + half, left, half);
+
+    OPENSSL_cleanse(left, sizeof(left));
+    OPENSSL_cleanse(right, sizeof(right));
+    OPENSSL_cleanse(f, sizeof(f));
+    OPENSSL_cleanse(password, sizeof(password));
+    OPENSSL_cleanse(salt, sizeof(salt));
+}
+
+// ============ SHAMIR ============
+
+/**
+ * @brief Splits a secret into `count` share values, any `threshold` of which recover it.
+ * @param threshold Shares needed.
+ * @param count Shares created (x = 0..count-1).
+ * @param secret Secret.
+ * @param length Secret length.
+ * @param values Output: count x SLIP39_MAX_SECRET_SIZE bytes.
+ * @return SLIP39_OK or a negative error code.
+ * @note For threshold > 1 the polynomial also passes through the digest
+ *       share at x = 254: HMAC-SHA256(random, secret)[:4] || random.
+ */
+static int split_secret(uint8_t threshold, uint8_t count, const uint8_t *secret,
+                        size_t length, uint8_t values[][SLIP39_MAX_SECRET_SIZE]) {
+    if (threshold == 1) {
+        for (uint8_t i = 0; i < count; i++) memcpy(values[i], secret, length);
+        return SLIP39_OK;
+    }
+
+    uint8_t random_count = threshold - 2;
+    uint8_t digest_share[SLIP39_MAX_SECRET_SIZE];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    for (uint8_t i = 0; i < random_count; i++) {
+        if (RAND_bytes(values[i], (int)length) != 1) return SLIP39_ERROR_INTERNAL;
+    }
+    if (RAND_bytes(digest_share + DIGEST_LENGTH, (int)(length - DIGEST_LENGTH)) != 1) {
+        return SLIP39_ERROR_INTERNAL;
+    }
+    hmac_sha256(digest_share + DIGEST_LENGTH, length - DIGEST_LENGTH, secret, length, digest);
+    memcpy(digest_share, digest, DIGEST_LENGTH);
+
+    // Base points: the random shares, the digest share and the secret
+    uint8_t xs[SLIP39_MAX_MEMBERS];
+    const uint8_t *ys[SLIP39_MAX_MEMBERS];
+    for (uint8_t i = 0; i < random_count; i++) {
+        xs[i] = i;
+        ys[i] = values[i];
+    }
+    xs[random_count] = DIGEST_INDEX;
+    ys[random_count] = digest_share;
+    xs[random_count + 1] = SECRET_INDEX;
+    ys[random_count + 1] = secret;
+
+    int result = SLIP39_OK;
+    for (uint8_t i = random_count; i < count && result == SLIP39_OK; i++) {
+        if (gf256_interpolate(xs, ys, threshold, length, i, values[i]) != 0) {
+            result = SLIP39_ERROR_INTERNAL;
+        }
+    }
+    OPENSSL_cleanse(digest_share, sizeof(digest_share));
+    OPENSSL_cleanse(digest, sizeof(digest));
+    return result;
+}
+
+/**
+ * @brief Recovers a secret from exactly `threshold` share values.
+ * @param threshold Shares given.
+ * @param xs Share x coordinates.
+ * @param ys Share values.
+ * @param length Value length.
+ * @param secret Output.
+ * @return SLIP39_OK, SLIP39_ERROR_DIGEST if the digest does not match.
+ */
+static int recover_secret(uint8_t threshold, const uint8_t *xs, const uint8_t *const *ys,
+                          size_t length, uint8_t *secret) {
+    if (threshold == 1) {
+        memcpy(secret, ys[0], length);
+        return SLIP39_OK;
+    }
+
+    uint8_t digest_share[SLIP39_MAX_SECRET_SIZE];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    if (gf256_interpolate(xs, ys, threshold, length, SECRET_INDEX, secret) != 0 ||
+        gf256_interpolate(xs, ys, threshold, length, DIGEST_INDEX, digest_share) != 0) {
+        return SLIP39_ERROR_MISMATCH;
+    }
+    hmac_sha256(digest_share + DIGEST_LENGTH, length - DIGEST_LENGTH, secret, length, digest);
+    int result = CRYPTO_memcmp(digest, digest_share, DIGEST_LENGTH) == 0
+                     ? SLIP39_OK : SLIP39_ERROR_DIGEST;
+    OPENSSL_cleanse(digest_share, sizeof(digest_share));
+    OPENSSL_cleanse(digest, sizeof(digest));
+    return result;
+}
+
+/**
+ * @brief Checks a passphrase is printable ASCII, as SLIP-39 requires.
+ */
+static int passphrase_valid(const char *passphrase) {
+    for (const char *p = passphrase; p && *p; p++) {
+        if (*p < 32 || *p > 126) return 0;
+    }
+    return 1;
+}
+
+int slip39_generate(const uint8_t *secret, size_t length, const char *passphrase,
+                    uint8_t group_threshold, const slip39_group *groups, size_t group_count,
+                    uint8_t iteration_exponent, int extendable,
+                    slip39_share *shares, size_t *share_count) {
+    if (!secret || !groups || !shares || !share_count ||
+        length < SLIP39_MIN_SECRET_SIZE || length > SLIP39_MAX_SECRET_SIZE || length % 2 ||
+        group_count < 1 || group_count > SLIP39_MAX_GROUPS ||
+        group_threshold < 1 || group_threshold > group_count ||
+        iteration_exponent > 15 || !passphrase_valid(passphrase)) {
+        return SLIP39_ERROR_INVALID;
+    }
+    for (size_t g = 0; g < group_count; g++) {
+        const slip39_group *group = &groups[g];
+        if (group->member_count < 1 || group->member_count > SLIP39_MAX_MEMBERS ||
+            group->member_threshold < 1 || group->member_threshold > group->member_count ||
+            (group->member_threshold == 1 && group->member_count > 1)) {
+            return SLIP39_ERROR_INVALID;
+        }
+    }
+
+    uint8_t id_bytes[2];
+    if (RAND_bytes(id_bytes, sizeof(id_bytes)) != 1) return SLIP39_ERROR_INTERNAL;
+    uint16_t identifier = (uint16_t)(((id_bytes[0] << 8) | id_bytes[1]) & 0x7FFF);
+
+    uint8_t encrypted[SLIP39_MAX_SECRET_SIZE];
+    uint8_t group_values[SLIP39_MAX_GROUPS][SLIP39_MAX_SECRET_SIZE];
+    uint8_t member_values[SLIP39_MAX_MEMBERS][SLIP39_MAX_SECRET_SIZE];
+    feistel(secret, length, passphrase, iteration_exponent, identifier, extendable, 0, encrypted);
+
+    int result = split_secret(group_threshold, (uint8_t)group_count, encrypted, length, group_values);
+    size_t n = 0;
+    for (size_t g = 0; g < group_count && result == SLIP39_OK; g++) {
+        const slip39_group *group = &groups[g];
+        result = split_secret(group->member_threshold, group->member_count,
+                              group_values[g], length, member_values);
+        for (uint8_t m = 0; m < group->member_count && result == SLIP39_OK; m++) {
+            slip39_share *share = &shares[n++];
+            share->identifier = identifier;
+            share->extendable = extendable ? 1 : 0;
+            share->iteration_exponent = iteration_exponent;
+            share->group_index = (uint8_t)g;
+            share->group_threshold = group_threshold;
+            share->group_count = (uint8_t)group_count;
+            share->member_index = m;
+            share->member_threshold = group->member_threshold;
+            memcpy(share->value, member_values[m], length);
+            share->value_length = length;
+        }
+    }
+    *share_count = result == SLIP39_OK ? n : 0;
+
+    OPENSSL_cleanse(encrypted, sizeof(encrypted));
+    OPENSSL_cleanse(group_values, sizeof(group_values));
+    OPENSSL_cleanse(member_values, sizeof(member_values));
+    return result;
+}
+
+int slip39_combine(const slip39_share *shares, size_t count, const char *passphrase,
+                   uint8_t *secret, size_t *length) {
+    if (!shares || count == 0 || !secret || !length || !passphrase_valid(passphrase)) {
+        return SLIP39_ERROR_INVALID;
+    }
+
+    // All shares must come from the same set
+    const slip39_share *first = &shares[0];
+    for (size_t i = 1; i < count; i++) {
+        const slip39_share *s = &shares[i];
+        if (s->identifier != first->identifier || s->extendable != first->extendable ||
+            s->iteration_exponent != first->iteration_exponent ||
+            s->group_threshold != first->group_threshold ||
+            s->group_count != first->group_count || s->value_length != first->value_length) {
+            return SLIP39_ERROR_MISMATCH;
+        }
+    }
+
+    // Sort members into their groups, dropping exact duplicates
+    const slip39_share *members[SLIP39_MAX_GROUPS][SLIP39_MAX_MEMBERS];
+    uint8_t member_counts[SLIP39_MAX_GROUPS] = {0};
+    for (size_t i = 0; i < count; i++) {
+        const slip39_share *s = &shares[i];
+        if (s->group_index >= SLIP39_MAX_GROUPS) return SLIP39_ERROR_INVALID;
+        int duplicate = 0;
+        for (uint8_t j = 0; j < member_counts[s->group_index]; j++) {
+            const slip39_share *other = members[s->group_index][j];
+            if (other->member_threshold != s->member_threshold) return SLIP39_ERROR_MISMATCH;
+            if (other->member_index == s->member_index) {
+                if (memcmp(other->value, s->value, s->value_length) != 0) {
+                    return SLIP39_ERROR_MISMATCH;
+                }
+                duplicate = 1;
+            }
+        }
+        if (!duplicate) members[s->group_index][member_counts[s->group_index]++] = s;
+    }
+
+    // Recover the first group_threshold complete groups
+    size_t value_length = first->value_length;
+    uint8_t group_values[SLIP39_MAX_GROUPS][SLIP39_MAX_SECRET_SIZE];
+    uint8_t group_xs[SLIP39_MAX_GROUPS];
+    const uint8_t *group_ys[SLIP39_MAX_GROUPS];
+    uint8_t recovered = 0;
+    int result = SLIP39_OK;
+    for (uint8_t g = 0; g < SLIP39_MAX_GROUPS && recovered < first->group_threshold &&
+                        result == SLIP39_OK; g++) {
+        if (member_counts[g] == 0 || member_counts[g] < members[g][0]->member_threshold) {
+            continue;
+        }
+        uint8_t threshold = members[g][0]->member_threshold;
+        uint8_t xs[SLIP39_MAX_MEMBERS];
+        const uint8_t *ys[SLIP39_MAX_MEMBERS];
+        for (uint8_t m = 0; m < threshold; m++) {
+            xs[m] = members[g][m]->member_index;
+            ys[m] = members[g][m]->value;
+        }
+        result = recover_secret(threshold, xs, ys, value_length, group_values[recovered]);
+        group_xs[recovered] = g;
+        group_ys[recovered] = group_values[recovered];
+        recovered++;
+    }
+    if (result == SLIP39_OK && recovered < first->group_threshold) {
+        result = SLIP39_ERROR_INSUFFICIENT;
+    }
+
+    uint8_t encrypted[SLIP39_MAX_SECRET_SIZE];
+    if (result == SLIP39_OK) {
+        result = recover_secret(first->group_threshold, group_xs, group_ys, value_length, encrypted);
+    }
+    if (result == SLIP39_OK) {
+        feistel(encrypted, value_length, passphrase, first->iteration_exponent,
+                first->identifier, first->extendable, 1, secret);
+        *length = value_length;
+    }
+
+    OPENSSL_cleanse(group_values, sizeof(group_values));
+    OPENSSL_cleanse(encrypted, sizeof(encrypted));
+    return result;
+}
+
+// ============ MNEMONIC ENCODING ============
+
+int slip39_share_to_mnemonic(const slip39_share *share, const slip39_wordlist *list,
+                             char *out, size_t size) {
+    if (!share || !list || !list->arena || !out ||
+        share->value_length < SLIP39_MIN_SECRET_SIZE ||
+        share->value_length > SLIP39_MAX_SECRET_SIZE || share->value_length % 2) {
+        return SLIP39_ERROR_INVALID;
+    }
+
+    size_t value_words = (share->value_length * 8 + RADIX_BITS - 1) / RADIX_BITS;
+    size_t total = PREFIX_WORDS + value_words + CHECKSUM_WORDS;
+    uint16_t words[SLIP39_MAX_SHARE_WORDS];
+
+    // identifier (15) | extendable (1) | exponent (4), then five 4-bit parameters
+    uint32_t id_exp = ((uint32_t)share->identifier << 5) | ((uint32_t)(share->extendable & 1) << 4) |
+                      (share->iteration_exponent & 0xF);
+    uint32_t params = ((uint32_t)(share->group_index & 0xF) << 16) |
+                      ((uint32_t)((share->group_threshold - 1) & 0xF) << 12) |
+                      ((uint32_t)((share->group_count - 1) & 0xF) << 8) |
+                      ((uint32_t)(share->member_index & 0xF) << 4) |
+                      ((share->member_threshold - 1) & 0xF);
+    words[0] = id_exp >> 10;
+    words[1] = id_exp & 0x3FF;
+    words[2] = params >> 10;
+    words[3] = params & 0x3FF;
+
+    // Value as a big-endian integer, left-padded with zero bits to whole words
+    size_t padding = value_words * RADIX_BITS - share->value_length * 8;
+    for (size_t w = 0; w < value_words; w++) {
+        uint16_t v = 0;
+        for (size_t b = 0; b < RADIX_BITS; b++) {
+            size_t pos = w * RADIX_BITS + b;
+            int bit = 0;
+            if (pos >= padding) {
+                pos -= padding;
+                bit = (share->value[pos / 8] >> (7 - pos % 8)) & 1;
+            }
+            v = (uint16_t)((v << 1) | bit);
+        }
+        words[PREFIX_WORDS + w] = v;
+    }
+
+    for (size_t i = 0; i < CHECKSUM_WORDS; i++) words[total - CHECKSUM_WORDS + i] = 0;
+    uint32_t checksum = rs1024_polymod(share->extendable, words, total) ^ 1;
+    for (size_t i = 0; i < CHECKSUM_WORDS; i++) {
+        words[total - CHECKSUM_WORDS + i] = (checksum >> (RADIX_BITS * (CHECKSUM_WORDS - 1 - i))) & 0x3FF;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < total; i++) {
+        const char *word = list->words[words[i]];
+        size_t len = strlen(word);
+        if (pos + (i > 0) + len + 1 > size) {
+            out[0] = '\0';
+            OPENSSL_cleanse(words, sizeof(words));
+            return SLIP39_ERROR_INVALID;
+        }
+        if (i > 0) out[pos++] = ' ';
+        memcpy(out + pos, word, len);
+        pos += len;
+    }
+    out[pos] = '\0';
+    OPENSSL_cleanse(words, sizeof(words));
+    return SLIP39_OK;
+}
+
+int slip39_mnemonic_to_share(const char *mnemonic, const slip39_wordlist *list,
+                             slip39_share *share) {
+    if (!mnemonic || !list || !list->arena || !share) return SLIP39_ERROR_INVALID;
+
+    uint16_t words[SLIP39_MAX_SHARE_WORDS];
+    size_t total = 0;
+    const char *p = mnemonic;
+    int result = SLIP39_OK;
+    while (result == SLIP39_OK) {
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        char word[SLIP39_MAX_WORD_SIZE + 1];
+        size_t len = 0;
+        while (*p && !isspace((unsigned char)*p)) {
+            if (len == SLIP39_MAX_WORD_SIZE) {
+                result = SLIP39_ERROR_WORD;
+                break;
+            }
+            word[len++] = (char)tolower((unsigned char)*p++);
+        }
+        word[len] = '\0';
+        int index = result == SLIP39_OK ? word_index(list, word) : -1;
+        if (index < 0) {
+            result = SLIP39_ERROR_WORD;
+        } else if (total == SLIP39_MAX_SHARE_WORDS) {
+            result = SLIP39_ERROR_INVALID;
+        } else {
+            words[total++] = (uint16_t)index;
+        }
+    }
+    size_t min_words = PREFIX_WORDS + (SLIP39_MIN_SECRET_SIZE * 8 + RADIX_BITS - 1) / RADIX_BITS +
+                       CHECKSUM_WORDS;
+    if (result == SLIP39_OK && total < min_words) result = SLIP39_ERROR_INVALID;
+
+    int extendable = result == SLIP39_OK ? (words[1] >> 4) & 1 : 0;
+    if (result == SLIP39_OK && rs1024_polymod(extendable, words, total) != 1) {
+        result = SLIP39_ERROR_CHECKSUM;
+    }
+
+    size_t value_words = total - PREFIX_WORDS - CHECKSUM_WORDS;
+    size_t padding = (value_words * RADIX_BITS) % 16;
+    if (result == SLIP39_OK && padding > 8) result = SLIP39_ERROR_INVALID;
+
+    if (result == SLIP39_OK) {
+        uint32_t id_exp = ((uint32_t)words[0] << 10) | words[1];
+        uint32_t params = ((uint32_t)words[2] << 10) | words[3];
+        memset(share, 0, sizeof(*share));
+        share->identifier = (uint16_t)(id_exp >> 5);
+        share->extendable = (uint8_t)extendable;
+        share->iteration_exponent = id_exp & 0xF;
+        share->group_index = (params >> 16) & 0xF;
+        share->group_threshold = ((params >> 12) & 0xF) + 1;
+        share->group_count = ((params >> 8) & 0xF) + 1;
+        share->member_index = (params >> 4) & 0xF;
+        share->member_threshold = (params & 0xF) + 1;
+        share->value_length = (value_words * RADIX_BITS - padding) / 8;
+        if (share->group_threshold > share->group_count ||
+            share->value_length > SLIP39_MAX_SECRET_SIZE) {
+            result = SLIP39_ERROR_INVALID;
+        }
+    }
+
+    // Unpack the value; the padding bits must be zero
+    for (size_t pos = 0; result == SLIP39_OK && pos < value_words * RADIX_BITS; pos++) {
+        int bit = (words[PREFIX_WORDS + pos / RADIX_BITS] >> (RADIX_BITS - 1 - pos % RADIX_BITS)) & 1;
+        if (pos < padding) {
+            if (bit) result = SLIP39_ERROR_INVALID;
+        } else {
+            size_t v = pos - padding;
+            share->value[v / 8] |= (uint8_t)(bit << (7 - v % 8));
+        }
+    }
+
+    if (result != SLIP39_OK) OPENSSL_cleanse(share, sizeof(*share));
+    OPENSSL_cleanse(words, sizeof(words));
+    return result;
+}
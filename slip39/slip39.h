@@ -0,0 +1,159 @@
+/**
+ * @file slip39.h
+ * @brief SLIP-39 Shamir backup shares.
+ * @details Splits a master secret (for example the entropy printed by the
+ *          mnemonics program) into groups of member shares and recombines
+ *          them. The secret is first encrypted with the passphrase by the
+ *          four-round Feistel network of SLIP-39 (PBKDF2-HMAC-SHA256 round
+ *          function), then split twice with Shamir's scheme over GF(256).
+ */
+
+#ifndef SLIP39_H
+#define SLIP39_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Number of words in the SLIP-39 wordlist (10 bits per word) */
+#define SLIP39_WORD_COUNT 1024
+
+/** @brief Longest SLIP-39 word, in bytes */
+#define SLIP39_MAX_WORD_SIZE 8
+
+/** @brief Shortest and longest master secret, in bytes (even lengths only) */
+#define SLIP39_MIN_SECRET_SIZE 16
+#define SLIP39_MAX_SECRET_SIZE 32
+
+/** @brief Most groups, and most members per group */
+#define SLIP39_MAX_GROUPS 16
+#define SLIP39_MAX_MEMBERS 16
+
+/** @brief Most words in a share (32-byte secret) */
+#define SLIP39_MAX_SHARE_WORDS 33
+
+/** @brief Buffer size that fits any share mnemonic */
+#define SLIP39_MNEMONIC_MAX_SIZE (SLIP39_MAX_SHARE_WORDS * (SLIP39_MAX_WORD_SIZE + 1))
+
+/** @brief Default iteration exponent (20000 PBKDF2 iterations in total) */
+#define SLIP39_DEFAULT_ITERATION_EXPONENT 1
+
+/** @brief Result codes */
+enum {
+    SLIP39_OK = 0,
+    SLIP39_ERROR_INVALID = -1,     ///< Bad arguments or malformed share.
+    SLIP39_ERROR_CHECKSUM = -2,    ///< Share mnemonic fails its RS1024 checksum.
+    SLIP39_ERROR_WORD = -3,        ///< Word not in the wordlist.
+    SLIP39_ERROR_MISMATCH = -4,    ///< Shares from different sets or inconsistent.
+    SLIP39_ERROR_INSUFFICIENT = -5,///< Not enough shares to meet the thresholds.
+    SLIP39_ERROR_DIGEST = -6,      ///< Recovered secret fails its digest check.
+    SLIP39_ERROR_INTERNAL = -7     ///< RNG or allocation failure.
+};
+
+/**
+ * @brief A loaded 1024-word list.
+ */
+typedef struct {
+    char *arena;                              ///< All words, NUL-separated.
+    const char *words[SLIP39_WORD_COUNT];     ///< Word i, pointing into arena.
+} slip39_wordlist;
+
+/**
+ * @brief Member threshold and count of one group.
+ */
+typedef struct {
+    uint8_t member_threshold;  ///< Shares needed from this group (1-16).
+    uint8_t member_count;      ///< Shares created for this group (1-16).
+} slip39_group;
+
+/**
+ * @brief One decoded share.
+ */
+typedef struct {
+    uint16_t identifier;          ///< Random 15-bit set identifier.
+    uint8_t extendable;           ///< Extendable backup flag.
+    uint8_t iteration_exponent;   ///< PBKDF2 iterations are 10000 << e in total.
+    uint8_t group_index;          ///< Group x coordinate.
+    uint8_t group_threshold;      ///< Groups needed.
+    uint8_t group_count;          ///< Groups created.
+    uint8_t member_index;         ///< Member x coordinate.
+    uint8_t member_threshold;     ///< Members of this group needed.
+    uint8_t value[SLIP39_MAX_SECRET_SIZE];  ///< Share value.
+    size_t value_length;          ///< Same as the secret length.
+} slip39_share;
+
+/**
+ * @brief Loads the SLIP-39 wordlist (one word per line, 1024 sorted lines).
+ * @param list Wordlist to fill.
+ * @param path Wordlist file.
+ * @return SLIP39_OK, or SLIP39_ERROR_INVALID if the file is not a 1024-word sorted list.
+ */
+int slip39_wordlist_load(slip39_wordlist *list, const char *path);
+
+/**
+ * @brief Frees a loaded wordlist.
+ * @param list Wordlist to free (can be zero-initialized).
+ */
+void slip39_wordlist_free(slip39_wordlist *list);
+
+/**
+ * @brief Splits a master secret into shares.
+ * @param secret Master secret.
+ * @param length Secret length (16-32 bytes, even).
+ * @param passphrase Printable ASCII passphrase (NULL or "" for none).
+ * @param group_threshold Groups needed to recover (1..group_count).
+ * @param groups Group specifications.
+ * @param group_count Number of groups (1-16).
+ * @param iteration_exponent Feistel cost exponent (0-15).
+ * @param extendable Non-zero for an extendable backup (salt without identifier).
+ * @param shares Output: sum of member counts shares, group by group.
+ * @param share_count Output: number of shares written.
+ * @return SLIP39_OK or a negative SLIP39_ERROR_* code.
+ */
+int slip39_generate(const uint8_t *secret, size_t length, const char *passphrase,
+                    uint8_t group_threshold, const slip39_group *groups, size_t group_count,
+                    uint8_t iteration_exponent, int extendable,
+                    slip39_share *shares, size_t *share_count);
+
+/**
+ * @brief Recovers the master secret from shares.
+ * @param shares Shares of one set, in any order; surplus shares are ignored.
+ * @param count Number of shares.
+ * @param passphrase Passphrase used at generation.
+ * @param secret Output, SLIP39_MAX_SECRET_SIZE bytes.
+ * @param length Output: secret length.
+ * @return SLIP39_OK or a negative SLIP39_ERROR_* code.
+ * @note A wrong passphrase is not detected: it yields a different secret.
+ */
+int slip39_combine(const slip39_share *shares, size_t count, const char *passphrase,
+                   uint8_t *secret, size_t *length);
+
+/**
+ * @brief Encodes a share as words with its RS1024 checksum.
+ * @param share Share to encode.
+ * @param list Wordlist.
+ * @param out Output buffer (SLIP39_MNEMONIC_MAX_SIZE bytes).
+ * @param size Size of the output buffer.
+ * @return SLIP39_OK or a negative SLIP39_ERROR_* code.
+ */
+int slip39_share_to_mnemonic(const slip39_share *share, const slip39_wordlist *list,
+                             char *out, size_t size);
+
+/**
+ * @brief Decodes and checks a share mnemonic.
+ * @param mnemonic Space separated words (case-insensitive).
+ * @param list Wordlist.
+ * @param share Output share.
+ * @return SLIP39_OK or a negative SLIP39_ERROR_* code.
+ */
+int slip39_mnemonic_to_share(const char *mnemonic, const slip39_wordlist *list,
+                             slip39_share *share);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLIP39_H
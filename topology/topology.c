@@ -0,0 +1,290 @@
+/**
+ * @file topology.c
+ * @brief CPU topology from sysfs and worker placement.
+ */
+#define _GNU_SOURCE
+#include "topology.h"
+
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/** @brief set_mempolicy() mode placing pages on one node while it has room (linux/mempolicy.h) */
+#define TOPOLOGY_MPOL_PREFERRED 1
+
+/** @brief Longest sysfs path built here */
+#define TOPOLOGY_PATH_SIZE 512
+
+/**
+ * @brief Reads the first line of a sysfs file.
+ * @param path File.
+ * @param buf Output, NUL-terminated without the newline.
+ * @param size Size of buf.
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_line(const char *path, char *buf, size_t size) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char *line = fgets(buf, (int)size, file);
+    fclose(file);
+    if (line == NULL) {
+        return -1;
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Reads a sysfs file holding one integer.
+ * @return The value, or `fallback` if the file is missing or malformed.
+ */
+static int read_int(const char *path, int fallback) {
+    char buf[32];
+    char *end;
+    if (read_line(path, buf, sizeof(buf)) != 0) {
+        return fallback;
+    }
+    long value = strtol(buf, &end, 10);
+    return end != buf && value >= 0 && value <= INT_MAX ? (int)value : fallback;
+}
+
+/**
+ * @brief Parses a CPU list such as "0-3,8-11" into a set.
+ * @param text CPU list.
+ * @param set Output; CPUs are added to it.
+ * @return 0 on success, -1 on a malformed list.
+ */
+static int parse_cpulist(const char *text, cpu_set_t *set) {
+    const char *p = text;
+    while (*p != '\0') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) {
+            return -1;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) {
+                return -1;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET((int)cpu, set);
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Assigns NUMA nodes from <sysfs>/devices/system/node/node<N>/cpulist.
+ * @param topo Topology with cpus filled, node 0 everywhere.
+ * @param sysfs sysfs root.
+ */
+static void load_nodes(topology *topo, const char *sysfs) {
+    char path[TOPOLOGY_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/devices/system/node", sysfs);
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int node;
+        char list[1024];
+        cpu_set_t set;
+        if (sscanf(entry->d_name, "node%d", &node) != 1 || node < 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/devices/system/node/%s/cpulist", sysfs, entry->d_name);
+        CPU_ZERO(&set);
+        if (read_line(path, list, sizeof(list)) != 0 || parse_cpulist(list, &set) != 0) {
+            continue;
+        }
+        for (size_t i = 0; i < topo->cpu_count; i++) {
+            if (CPU_ISSET(topo->cpus[i].cpu, &set)) {
+                topo->cpus[i].node = node;
+            }
+        }
+    }
+    closedir(dir);
+}
+
+int topology_load(topology *topo, const char *sysfs) {
+    if (topo == NULL) {
+        return TOPOLOGY_ERROR_INVALID;
+    }
+    memset(topo, 0, sizeof(*topo));
+    int real = sysfs == NULL;
+    if (real) {
+        sysfs = "/sys";
+    }
+
+    char path[TOPOLOGY_PATH_SIZE];
+    char list[1024];
+    cpu_set_t online;
+    CPU_ZERO(&online);
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/online", sysfs);
+    if (read_line(path, list, sizeof(list)) != 0 || parse_cpulist(list, &online) != 0) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < count && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET((int)cpu, &online);
+        }
+    }
+    // Only the real tree is subject to the affinity mask (taskset, cpusets)
+    cpu_set_t allowed;
+    if (real && sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        CPU_AND(&online, &online, &allowed);
+    }
+
+    size_t count = (size_t)CPU_COUNT(&online);
+    if (count == 0) {
+        return TOPOLOGY_ERROR_SYSTEM;
+    }
+    topo->cpus = calloc(count, sizeof(topology_cpu));
+    if (topo->cpus == NULL) {
+        return TOPOLOGY_ERROR_SYSTEM;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE && topo->cpu_count < count; cpu++) {
+        if (!CPU_ISSET(cpu, &online)) {
+            continue;
+        }
+        topology_cpu *entry = &topo->cpus[topo->cpu_count++];
+        entry->cpu = cpu;
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/topology/core_id", sysfs, cpu);
+        entry->core = read_int(path, cpu);
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/topology/physical_package_id", sysfs, cpu);
+        entry->package = read_int(path, 0);
+    }
+    load_nodes(topo, sysfs);
+
+    // Siblings are ranked among the usable threads of the same core
+    for (size_t i = 0; i < topo->cpu_count; i++) {
+        topology_cpu *entry = &topo->cpus[i];
+        for (size_t j = 0; j < i; j++) {
+            if (topo->cpus[j].package == entry->package && topo->cpus[j].core == entry->core) {
+                entry->sibling++;
+            }
+        }
+        if (entry->sibling == 0) {
+            topo->core_count++;
+        }
+        size_t j = 0;
+        while (j < i && topo->cpus[j].node != entry->node) {
+            j++;
+        }
+        if (j == i) {
+            topo->node_count++;
+        }
+    }
+    return TOPOLOGY_OK;
+}
+
+void topology_free(topology *topo) {
+    if (topo == NULL) {
+        return;
+    }
+    free(topo->cpus);
+    memset(topo, 0, sizeof(*topo));
+}
+
+/**
+ * @brief Placement order of one CPU: sibling level, then its rank on its node, then node.
+ */
+typedef struct {
+    int sibling;
+    int rank;
+    int node;
+    int cpu;
+} plan_key;
+
+static int compare_plan_keys(const void *a, const void *b) {
+    const plan_key *x = a, *y = b;
+    if (x->sibling != y->sibling) return x->sibling < y->sibling ? -1 : 1;
+    if (x->rank != y->rank) return x->rank < y->rank ? -1 : 1;
+    if (x->node != y->node) return x->node < y->node ? -1 : 1;
+    return (x->cpu > y->cpu) - (x->cpu < y->cpu);
+}
+
+size_t topology_plan(const topology *topo, topology_placement placement, size_t threads, int *cpus) {
+    if (topo == NULL || cpus == NULL || topo->cpu_count == 0 ||
+        (placement != TOPOLOGY_SPREAD && placement != TOPOLOGY_CORES)) {
+        return 0;
+    }
+    plan_key *keys = malloc(topo->cpu_count * sizeof(plan_key));
+    if (keys == NULL) {
+        return 0;
+    }
+
+    // Ranking within (node, sibling level) and sorting by rank first deals
+    // consecutive workers to alternating nodes
+    size_t n = 0;
+    for (size_t i = 0; i < topo->cpu_count; i++) {
+        const topology_cpu *entry = &topo->cpus[i];
+        if (placement == TOPOLOGY_CORES && entry->sibling != 0) {
+            continue;
+        }
+        plan_key *key = &keys[n++];
+        key->sibling = entry->sibling;
+        key->node = entry->node;
+        key->cpu = entry->cpu;
+        key->rank = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (topo->cpus[j].node == entry->node && topo->cpus[j].sibling == entry->sibling) {
+                key->rank++;
+            }
+        }
+    }
+    qsort(keys, n, sizeof(plan_key), compare_plan_keys);
+
+    if (threads == 0) {
+        threads = n;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        cpus[i] = keys[i % n].cpu;
+    }
+    free(keys);
+    return threads;
+}
+
+int topology_pin_thread(const topology *topo, int cpu) {
+    if (topo == NULL || cpu < 0 || cpu >= CPU_SETSIZE) {
+        return TOPOLOGY_ERROR_INVALID;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return TOPOLOGY_ERROR_SYSTEM;
+    }
+
+    if (topo->node_count > 1) {
+        for (size_t i = 0; i < topo->cpu_count; i++) {
+            int node = topo->cpus[i].node;
+            if (topo->cpus[i].cpu != cpu || node >= 1024) {
+                continue;
+            }
+            // A refused policy (e.g. seccomp in containers) only costs locality
+            unsigned long mask[1024 / (8 * sizeof(unsigned long))] = {0};
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            syscall(SYS_set_mempolicy, TOPOLOGY_MPOL_PREFERRED, mask, (unsigned long)node + 2);
+            break;
+        }
+    }
+    return TOPOLOGY_OK;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file topology.h
+ * @brief CPU topology from sysfs and worker placement.
+ * @details Reads which CPUs are online, their core, package and NUMA node
+ *          from /sys/devices/system, keeps those the process may run on,
+ *          and plans where each worker of a pool goes: threads are dealt
+ *          round-robin over the NUMA nodes, one per physical core before any
+ *          second hyperthread of a core is used. For SIMD-heavy kernels
+ *          (multi-lane SHA-512, secp256k1) the plan can skip the extra
+ *          hyperthreads altogether.
+ *
+ *          A pinned worker also prefers memory from its own node, so the
+ *          scratch batches and output buffers it allocates after pinning
+ *          are local to it.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stddef.h>   // For size_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Error codes */
+enum {
+    TOPOLOGY_OK = 0,
+    TOPOLOGY_ERROR_INVALID = -1,   /**< Bad arguments */
+    TOPOLOGY_ERROR_SYSTEM = -2     /**< Allocation or system call failure */
+};
+
+/** @brief Where the workers of a pool run */
+typedef enum {
+    TOPOLOGY_ANY = 0,     /**< Not pinned; the scheduler decides */
+    TOPOLOGY_SPREAD,      /**< Pinned over every hardware thread, cores first */
+    TOPOLOGY_CORES        /**< Pinned to one hardware thread per physical core */
+} topology_placement;
+
+/**
+ * @brief One usable hardware thread.
+ */
+typedef struct {
+    int cpu;              /**< Kernel CPU number */
+    int core;             /**< core_id within the package */
+    int package;          /**< physical_package_id (socket) */
+    int node;             /**< NUMA node, 0 without NUMA */
+    int sibling;          /**< 0 for the first hardware thread of its core, 1 for the next, ... */
+} topology_cpu;
+
+/**
+ * @brief Usable CPUs, ordered by CPU number.
+ */
+typedef struct {
+    topology_cpu *cpus;   /**< cpu_count entries */
+    size_t cpu_count;
+    size_t core_count;    /**< Physical cores among them */
+    size_t node_count;    /**< NUMA nodes among them */
+} topology;
+
+/**
+ * @brief Reads the topology of the CPUs this process may run on.
+ * @param topo Topology to fill.
+ * @param sysfs Root of the sysfs tree, NULL for "/sys".
+ * @return TOPOLOGY_OK or a negative error code.
+ * @note Missing files degrade gracefully: without topology files every CPU
+ *       is its own core, without node directories everything is node 0.
+ */
+int topology_load(topology *topo, const char *sysfs);
+
+/**
+ * @brief Frees a topology.
+ * @param topo Topology (can be zero-initialized).
+ */
+void topology_free(topology *topo);
+
+/**
+ * @brief Plans the CPU of every worker of a pool.
+ * @param topo Topology.
+ * @param placement TOPOLOGY_SPREAD or TOPOLOGY_CORES.
+ * @param threads Workers, 0 for one per usable CPU of the placement.
+ * @param cpus Output: CPU of worker i, room for `threads` entries (or
+ *             topo->cpu_count when threads is 0).
+ * @return Number of entries written, 0 on invalid arguments.
+ * @note With more workers than CPUs the plan wraps around.
+ */
+size_t topology_plan(const topology *topo, topology_placement placement, size_t threads, int *cpus);
+
+/**
+ * @brief Pins the calling thread to a CPU and makes it prefer memory from that CPU's node.
+ * @param topo Topology the CPU comes from.
+ * @param cpu Kernel CPU number.
+ * @return TOPOLOGY_OK or a negative error code.
+ * @note Allocate per-thread buffers after this call; pages are placed when
+ *       first touched.
+ */
+int topology_pin_thread(const topology *topo, int cpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOPOLOGY_H
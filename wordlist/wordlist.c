@@ -0,0 +1,559 @@
+/**
+ * @file wordlist.c
+ * @brief Registry of known wordlists with pinned digests and cached indexes.
+ */
+#include "wordlist.h"
+
+#include <dirent.h>     // For opendir, readdir, closedir
+#include <stdio.h>      // For FILE, fopen, snprintf, rename
+#include <stdlib.h>     // For malloc, realloc, free, qsort
+#include <string.h>     // For memcmp, memcpy, strcmp, strlen
+#include <sys/stat.h>   // For stat, utimensat
+
+#include "../cpto/cpto.h"
+
+#ifndef _WIN32
+#include <fcntl.h>      // For open, AT_FDCWD
+#include <sys/mman.h>   // For mmap, munmap
+#include <unistd.h>     // For close
+#endif
+
+/** @brief Index header size in bytes */
+#define INDEX_HEADER_SIZE 64
+
+/** @brief Bytes of the index body hash kept in the header */
+#define INDEX_CHECK_SIZE 8
+
+/** @brief Index size before the word blob */
+#define INDEX_TABLE_END (INDEX_HEADER_SIZE + 4 * WORDLIST_WORD_COUNT)
+
+/** @brief Longest path built from the directory and a file name */
+#define PATH_SIZE (2 * WORDLIST_NAME_SIZE + 16)
+
+// ============ FILES ============
+
+/**
+ * @brief Maps a whole file read-only.
+ * @param path File path.
+ * @param data Set to the mapping.
+ * @param size Set to the file size.
+ * @return WORDLIST_OK or WORDLIST_ERROR_IO (also for empty files).
+ * @note Windows reads the file into memory instead.
+ */
+static int map_file(const char *path, void **data, size_t *size) {
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (!file) return WORDLIST_ERROR_IO;
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    rewind(file);
+    void *buffer = len > 0 ? malloc((size_t)len) : NULL;
+    if (!buffer || fread(buffer, 1, (size_t)len, file) != (size_t)len) {
+        free(buffer);
+        fclose(file);
+        return WORDLIST_ERROR_IO;
+    }
+    fclose(file);
+    *data = buffer;
+    *size = (size_t)len;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return WORDLIST_ERROR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return WORDLIST_ERROR_IO;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return WORDLIST_ERROR_IO;
+    *data = map;
+    *size = (size_t)st.st_size;
+#endif
+    return WORDLIST_OK;
+}
+
+/**
+ * @brief Releases a mapping from map_file().
+ */
+static void unmap_file(void *data, size_t size) {
+    if (!data) return;
+#ifdef _WIN32
+    (void)size;
+    free(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+/**
+ * @brief Allocates memory that unmap_file() releases.
+ * @return The buffer, or NULL.
+ */
+static void *alloc_map(size_t size) {
+#ifdef _WIN32
+    return malloc(size);
+#else
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return map == MAP_FAILED ? NULL : map;
+#endif
+}
+
+/**
+ * @brief True if a was modified at the same time as b or later.
+ */
+static int modified_since(const struct stat *a, const struct stat *b) {
+#ifdef __linux__
+    if (a->st_mtim.tv_sec != b->st_mtim.tv_sec) return a->st_mtim.tv_sec > b->st_mtim.tv_sec;
+    return a->st_mtim.tv_nsec >= b->st_mtim.tv_nsec;
+#else
+    return a->st_mtime >= b->st_mtime;
+#endif
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// ============ VALIDATION ============
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/** @brief First four characters of a word, as a sortable key */
+typedef struct {
+    char key[4 * 4 + 1];
+} prefix_key;
+
+static int compare_prefixes(const void *a, const void *b) {
+    return strcmp(((const prefix_key *)a)->key, ((const prefix_key *)b)->key);
+}
+
+/**
+ * @brief Copies the first four UTF-8 characters of a word.
+ */
+static void prefix_of(const char *word, prefix_key *out) {
+    size_t len = 0;
+    int chars = 0;
+    while (word[len] && chars <= 4) {
+        if (((uint8_t)word[len] & 0xc0) != 0x80 && ++chars > 4) break;
+        len++;
+    }
+    memcpy(out->key, word, len);
+    out->key[len] = '\0';
+}
+
+/**
+ * @brief Splits and validates list text.
+ * @param text List text, one word per line (LF or CRLF).
+ * @param size Text size.
+ * @param blob Output: the words, NUL-terminated, back to back (text size + 1 bytes).
+ * @param offsets Output: offset of each word in blob.
+ * @param blob_size Set to the bytes used in blob.
+ * @param flags Set to the WORDLIST_SORTED / WORDLIST_PREFIX4_UNIQUE properties.
+ * @return WORDLIST_OK, WORDLIST_ERROR_FORMAT or WORDLIST_ERROR_INTERNAL.
+ */
+static int parse_words(const char *text, size_t size, char *blob,
+                       uint32_t offsets[WORDLIST_WORD_COUNT], size_t *blob_size, uint32_t *flags) {
+    size_t count = 0;
+    size_t used = 0;
+    size_t pos = 0;
+    while (pos < size) {
+        const char *line = text + pos;
+        const char *end = memchr(line, '\n', size - pos);
+        size_t len = end ? (size_t)(end - line) : size - pos;
+        pos += len + 1;
+        if (len > 0 && line[len - 1] == '\r') len--;
+        if (len == 0 || len > WORDLIST_MAX_WORD_SIZE || memchr(line, '\0', len) ||
+            count == WORDLIST_WORD_COUNT) {
+            return WORDLIST_ERROR_FORMAT;
+        }
+        offsets[count++] = (uint32_t)used;
+        memcpy(blob + used, line, len);
+        blob[used + len] = '\0';
+        used += len + 1;
+    }
+    if (count != WORDLIST_WORD_COUNT) return WORDLIST_ERROR_FORMAT;
+    *blob_size = used;
+
+    const char **sorted = malloc(WORDLIST_WORD_COUNT * sizeof(*sorted));
+    prefix_key *prefixes = malloc(WORDLIST_WORD_COUNT * sizeof(*prefixes));
+    if (!sorted || !prefixes) {
+        free(sorted);
+        free(prefixes);
+        return WORDLIST_ERROR_INTERNAL;
+    }
+    *flags = WORDLIST_SORTED | WORDLIST_PREFIX4_UNIQUE;
+    for (size_t i = 0; i < WORDLIST_WORD_COUNT; i++) {
+        sorted[i] = blob + offsets[i];
+        prefix_of(sorted[i], &prefixes[i]);
+        if (i > 0 && strcmp(sorted[i - 1], sorted[i]) >= 0) *flags &= ~(uint32_t)WORDLIST_SORTED;
+    }
+    qsort(sorted, WORDLIST_WORD_COUNT, sizeof(*sorted), compare_strings);
+    qsort(prefixes, WORDLIST_WORD_COUNT, sizeof(*prefixes), compare_prefixes);
+    int result = WORDLIST_OK;
+    for (size_t i = 1; i < WORDLIST_WORD_COUNT; i++) {
+        if (strcmp(sorted[i - 1], sorted[i]) == 0) result = WORDLIST_ERROR_FORMAT;
+        if (strcmp(prefixes[i - 1].key, prefixes[i].key) == 0) {
+            *flags &= ~(uint32_t)WORDLIST_PREFIX4_UNIQUE;
+        }
+    }
+    free(sorted);
+    free(prefixes);
+    return result;
+}
+
+// ============ INDEX ============
+
+/**
+ * @brief Checks a mapped index and points the list's words into it.
+ * @return WORDLIST_OK, or WORDLIST_ERROR_FORMAT if the index is corrupt or
+ *         was built from text with another digest.
+ */
+static int attach_index(wordlist *list, const uint8_t *map, size_t size) {
+    if (size <= INDEX_TABLE_END ||
+        memcmp(map, WORDLIST_INDEX_MAGIC, 8) != 0 ||
+        get_le32(map + 8) != WORDLIST_INDEX_VERSION ||
+        memcmp(map + 16, list->digest, 32) != 0 ||
+        get_le32(map + 48) != size - INDEX_TABLE_END ||
+        map[size - 1] != '\0') {
+        return WORDLIST_ERROR_FORMAT;
+    }
+    uint8_t check[SHA256_DIGEST_SIZE];
+    sha256(map + INDEX_HEADER_SIZE, size - INDEX_HEADER_SIZE, check);
+    if (memcmp(map + 52, check, INDEX_CHECK_SIZE) != 0) return WORDLIST_ERROR_FORMAT;
+    const char *blob = (const char *)map + INDEX_TABLE_END;
+    size_t blob_size = size - INDEX_TABLE_END;
+    for (size_t i = 0; i < WORDLIST_WORD_COUNT; i++) {
+        uint32_t offset = get_le32(map + INDEX_HEADER_SIZE + 4 * i);
+        if (offset >= blob_size) return WORDLIST_ERROR_FORMAT;
+        list->words[i] = blob + offset;
+    }
+    list->flags = get_le32(map + 12);
+    return WORDLIST_OK;
+}
+
+/**
+ * @brief Validates list text and builds its index in memory.
+ * @param list List whose digest goes into the header.
+ * @param text List text.
+ * @param size Text size.
+ * @param index Set to the index, to be released with unmap_file().
+ * @param index_size Set to the index size.
+ * @return WORDLIST_OK, WORDLIST_ERROR_FORMAT or WORDLIST_ERROR_INTERNAL.
+ */
+static int build_index(const wordlist *list, const char *text, size_t size,
+                       void **index, size_t *index_size) {
+    uint32_t offsets[WORDLIST_WORD_COUNT];
+    uint32_t flags = 0;
+    size_t blob_size = 0;
+    char *words = malloc(size + 1);
+    if (!words) return WORDLIST_ERROR_INTERNAL;
+    int result = parse_words(text, size, words, offsets, &blob_size, &flags);
+    uint8_t *map = result == WORDLIST_OK ? alloc_map(INDEX_TABLE_END + blob_size) : NULL;
+    if (!map) {
+        free(words);
+        return result != WORDLIST_OK ? result : WORDLIST_ERROR_INTERNAL;
+    }
+    // Body: offset table then words, hashed as one piece
+    uint8_t *body = map + INDEX_HEADER_SIZE;
+    for (size_t i = 0; i < WORDLIST_WORD_COUNT; i++) {
+        put_le32(body + 4 * i, offsets[i]);
+    }
+    memcpy(map + INDEX_TABLE_END, words, blob_size);
+    free(words);
+    uint8_t check[SHA256_DIGEST_SIZE];
+    sha256(body, 4 * WORDLIST_WORD_COUNT + blob_size, check);
+
+    memset(map, 0, INDEX_HEADER_SIZE);
+    memcpy(map, WORDLIST_INDEX_MAGIC, 8);
+    put_le32(map + 8, WORDLIST_INDEX_VERSION);
+    put_le32(map + 12, flags);
+    memcpy(map + 16, list->digest, 32);
+    put_le32(map + 48, (uint32_t)blob_size);
+    memcpy(map + 52, check, INDEX_CHECK_SIZE);
+    *index = map;
+    *index_size = INDEX_TABLE_END + blob_size;
+    return WORDLIST_OK;
+}
+
+/**
+ * @brief Writes an index next to its list (via a temporary file).
+ * @return WORDLIST_OK or WORDLIST_ERROR_IO.
+ */
+static int write_index(const char *path, const void *index, size_t index_size) {
+    char tmp[PATH_SIZE + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *file = fopen(tmp, "wb");
+    if (!file) return WORDLIST_ERROR_IO;
+    int ok = fwrite(index, index_size, 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return WORDLIST_ERROR_IO;
+    }
+    return WORDLIST_OK;
+}
+
+/**
+ * @brief Maps a list: checks (or, for a new list, takes) the text digest,
+ *        then attaches the index, rebuilding it if needed.
+ * @param dir Wordlist directory.
+ * @param list List with name (and digest when pinned) set.
+ * @param pinned 0 to record the digest of the current text instead of checking it.
+ */
+static int load_list(const char *dir, wordlist *list, int pinned) {
+    char text_path[PATH_SIZE];
+    char index_path[PATH_SIZE];
+    snprintf(text_path, sizeof(text_path), "%s/%s", dir, list->name);
+    snprintf(index_path, sizeof(index_path), "%s/%s" WORDLIST_INDEX_SUFFIX, dir, list->name);
+
+    void *text = NULL;
+    size_t text_size = 0;
+    int result = map_file(text_path, &text, &text_size);
+    if (result != WORDLIST_OK) return result;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256(text, text_size, digest);
+    if (!pinned) {
+        memcpy(list->digest, digest, sizeof(digest));
+    } else if (memcmp(list->digest, digest, sizeof(digest)) != 0) {
+        unmap_file(text, text_size);
+        return WORDLIST_ERROR_DIGEST;
+    }
+
+    // Cached index first; rebuild it if it is stale or damaged
+    if (map_file(index_path, &list->map, &list->map_size) == WORDLIST_OK) {
+        result = attach_index(list, list->map, list->map_size);
+        if (result != WORDLIST_OK) {
+            unmap_file(list->map, list->map_size);
+            list->map = NULL;
+        }
+    }
+    if (!list->map) {
+        result = build_index(list, text, text_size, &list->map, &list->map_size);
+        if (result == WORDLIST_OK) {
+            // The file is only a cache: a read-only directory keeps the index in memory
+            write_index(index_path, list->map, list->map_size);
+            result = attach_index(list, list->map, list->map_size);
+        }
+        if (result != WORDLIST_OK) {
+            unmap_file(list->map, list->map_size);
+            list->map = NULL;
+        }
+    }
+    unmap_file(text, text_size);
+    return result;
+}
+
+// ============ MANIFEST ============
+
+/**
+ * @brief Appends a list entry to the registry.
+ * @return The new entry, or NULL on allocation failure.
+ */
+static wordlist *add_list(wordlist_registry *registry, const char *name) {
+    wordlist *lists = realloc(registry->lists, (registry->count + 1) * sizeof(*lists));
+    if (!lists) return NULL;
+    registry->lists = lists;
+    wordlist *list = &lists[registry->count++];
+    memset(list, 0, sizeof(*list));
+    snprintf(list->name, sizeof(list->name), "%s", name);
+    return list;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Reads "<64 hex>  <name>" lines (sha256sum text or binary mode).
+ */
+static int read_manifest(wordlist_registry *registry, FILE *file) {
+    char line[WORDLIST_NAME_SIZE + 80];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        if (strlen(line) < 67 || line[64] != ' ' || (line[65] != ' ' && line[65] != '*') ||
+            strlen(line + 66) >= WORDLIST_NAME_SIZE || strchr(line + 66, '/')) {
+            return WORDLIST_ERROR_FORMAT;
+        }
+        wordlist *list = add_list(registry, line + 66);
+        if (!list) return WORDLIST_ERROR_INTERNAL;
+        for (size_t i = 0; i < 32; i++) {
+            int hi = hex_value(line[2 * i]);
+            int lo = hex_value(line[2 * i + 1]);
+            if (hi < 0 || lo < 0) return WORDLIST_ERROR_FORMAT;
+            list->digest[i] = (uint8_t)(hi << 4 | lo);
+        }
+    }
+    return WORDLIST_OK;
+}
+
+static int write_manifest(const wordlist_registry *registry, const char *path) {
+    // Rewritten in place: replacing the file would touch the directory again
+    FILE *file = fopen(path, "w");
+    if (!file) return WORDLIST_ERROR_IO;
+    for (size_t i = 0; i < registry->count; i++) {
+        for (size_t j = 0; j < 32; j++) fprintf(file, "%02x", registry->lists[i].digest[j]);
+        fprintf(file, "  %s\n", registry->lists[i].name);
+    }
+    return fclose(file) == 0 ? WORDLIST_OK : WORDLIST_ERROR_IO;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Registers the valid *.txt lists of the directory not in the manifest yet.
+ * @param registry Registry.
+ * @param found Set to the number of *.txt files checked, valid or not.
+ */
+static int scan_new_lists(wordlist_registry *registry, size_t *found) {
+    DIR *d = opendir(registry->dir);
+    if (!d) return WORDLIST_ERROR_IO;
+    char **names = NULL;
+    size_t count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        size_t len = strlen(entry->d_name);
+        if (len <= 4 || len >= WORDLIST_NAME_SIZE || strcmp(entry->d_name + len - 4, ".txt") != 0 ||
+            wordlist_registry_find(registry, entry->d_name) >= 0) {
+            continue;
+        }
+        char path[PATH_SIZE];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", registry->dir, entry->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        char **grown = realloc(names, (count + 1) * sizeof(*names));
+        if (!grown) break;
+        names = grown;
+        names[count] = malloc(len + 1);
+        if (!names[count]) break;
+        memcpy(names[count++], entry->d_name, len + 1);
+    }
+    closedir(d);
+    if (count) qsort(names, count, sizeof(*names), compare_names);
+    *found = count;
+
+    int result = WORDLIST_OK;
+    for (size_t i = 0; i < count; i++) {
+        wordlist *list = result == WORDLIST_OK ? add_list(registry, names[i]) : NULL;
+        if (!list) {
+            result = WORDLIST_ERROR_INTERNAL;
+        } else if (load_list(registry->dir, list, 0) == WORDLIST_OK) {
+            list->state = 1;
+        } else {
+            registry->count--;  // Not a valid list: leave it unregistered
+        }
+        free(names[i]);
+    }
+    free(names);
+    return result;
+}
+
+// ============ REGISTRY ============
+
+int wordlist_registry_open(wordlist_registry *registry, const char *dir) {
+    if (!registry || !dir || strlen(dir) >= WORDLIST_NAME_SIZE) return WORDLIST_ERROR_INVALID;
+    memset(registry, 0, sizeof(*registry));
+    memcpy(registry->dir, dir, strlen(dir) + 1);
+
+    char manifest[PATH_SIZE];
+    snprintf(manifest, sizeof(manifest), "%s/" WORDLIST_MANIFEST, dir);
+    struct stat dir_stat, manifest_stat;
+    if (stat(dir, &dir_stat) != 0) return WORDLIST_ERROR_IO;
+    int have_manifest = stat(manifest, &manifest_stat) == 0;
+
+    int result = WORDLIST_OK;
+    if (have_manifest) {
+        FILE *file = fopen(manifest, "r");
+        if (!file) return WORDLIST_ERROR_IO;
+        result = read_manifest(registry, file);
+        fclose(file);
+    }
+    // Files added, removed or renamed since the manifest: look for new lists
+    if (result == WORDLIST_OK && (!have_manifest || !modified_since(&manifest_stat, &dir_stat))) {
+        registry->scanned = 1;
+        size_t found = 0;
+        result = scan_new_lists(registry, &found);
+        // Only new *.txt files count: index files written since leave the manifest alone.
+        // Failing to write it is not fatal, so a read-only directory still works.
+        if (result == WORDLIST_OK && found > 0 && registry->count > 0) {
+            write_manifest(registry, manifest);
+        }
+#ifndef _WIN32
+        // Nothing new: mark the manifest current so the next open skips the scan
+        if (result == WORDLIST_OK && found == 0 && have_manifest) {
+            utimensat(AT_FDCWD, manifest, NULL, 0);
+        }
+#endif
+    }
+    if (result == WORDLIST_OK && registry->count == 0) result = WORDLIST_ERROR_INVALID;
+    if (result != WORDLIST_OK) wordlist_registry_close(registry);
+    return result;
+}
+
+void wordlist_registry_close(wordlist_registry *registry) {
+    if (!registry) return;
+    for (size_t i = 0; i < registry->count; i++) {
+        unmap_file(registry->lists[i].map, registry->lists[i].map_size);
+    }
+    free(registry->lists);
+    memset(registry, 0, sizeof(*registry));
+}
+
+int wordlist_registry_find(const wordlist_registry *registry, const char *name) {
+    if (!registry || !name) return -1;
+    for (size_t i = 0; i < registry->count; i++) {
+        if (strcmp(registry->lists[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+const wordlist *wordlist_registry_get(wordlist_registry *registry, size_t position, int *error) {
+    int result = WORDLIST_ERROR_INVALID;
+    if (registry && position < registry->count) {
+        wordlist *list = &registry->lists[position];
+        if (list->state == 0) {
+            int loaded = load_list(registry->dir, list, 1);
+            list->state = loaded == WORDLIST_OK ? 1 : loaded;
+        }
+        if (list->state == 1) return list;
+        result = list->state;
+    }
+    if (error) *error = result;
+    return NULL;
+}
+
+int wordlist_index_of(const wordlist *list, const char *word) {
+    if (!list || !list->map || !word) return -1;
+    if (list->flags & WORDLIST_SORTED) {
+        size_t lo = 0, hi = WORDLIST_WORD_COUNT;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            int cmp = strcmp(list->words[mid], word);
+            if (cmp == 0) return (int)mid;
+            if (cmp < 0) lo = mid + 1; else hi = mid;
+        }
+        return -1;
+    }
+    for (size_t i = 0; i < WORDLIST_WORD_COUNT; i++) {
+        if (strcmp(list->words[i], word) == 0) return (int)i;
+    }
+    return -1;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file wordlist.h
+ * @brief Registry of known wordlists with pinned digests and cached indexes.
+ * @details A directory of wordlists is described by a manifest,
+ *          "manifest.sha256", in sha256sum format ("<hex>  <file>"), which
+ *          pins the SHA-256 of every known list. Opening the registry only
+ *          reads the manifest; the directory is scanned again only when it
+ *          changed after the manifest was written, and new lists found then
+ *          are validated and added.
+ *
+ *          A list is mapped on first use. Its text must match the pinned
+ *          digest; the words then come from a binary index, "<file>.idx",
+ *          kept next to the text and rebuilt only when the digest it was
+ *          built from differs.
+ *
+ *          Index layout: 64-byte header (magic, version, flags, text digest,
+ *          blob size, first 8 bytes of the SHA-256 of the rest), 2048
+ *          little-endian uint32 word offsets, then the words as
+ *          NUL-terminated strings.
+ */
+
+#ifndef WORDLIST_H
+#define WORDLIST_H
+
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint8_t, uint32_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Words in a list */
+#define WORDLIST_WORD_COUNT 2048
+
+/** @brief Longest word accepted, in bytes (UTF-8) */
+#define WORDLIST_MAX_WORD_SIZE 32
+
+/** @brief Manifest file name inside the wordlist directory */
+#define WORDLIST_MANIFEST "manifest.sha256"
+
+/** @brief Index file suffix appended to the list file name */
+#define WORDLIST_INDEX_SUFFIX ".idx"
+
+/** @brief Index file magic */
+#define WORDLIST_INDEX_MAGIC "MNWLIDX1"
+
+/** @brief Index format version */
+#define WORDLIST_INDEX_VERSION 1
+
+/** @brief Longest list file name kept */
+#define WORDLIST_NAME_SIZE 256
+
+/** @brief Error codes */
+enum {
+    WORDLIST_OK = 0,
+    WORDLIST_ERROR_INVALID = -1,   /**< Bad arguments or unknown list */
+    WORDLIST_ERROR_IO = -2,        /**< File cannot be read, mapped or written */
+    WORDLIST_ERROR_DIGEST = -3,    /**< Text does not match the pinned digest */
+    WORDLIST_ERROR_FORMAT = -4,    /**< Not 2048 unique non-empty words */
+    WORDLIST_ERROR_INTERNAL = -5   /**< Allocation failure */
+};
+
+/** @brief Properties found by validation (index flags) */
+enum {
+    WORDLIST_SORTED = 1 << 0,         /**< Words in strcmp() order: binary search works */
+    WORDLIST_PREFIX4_UNIQUE = 1 << 1  /**< First four characters identify a word */
+};
+
+/**
+ * @brief One registered list.
+ */
+typedef struct {
+    char name[WORDLIST_NAME_SIZE];            /**< File name, e.g. "english.txt" */
+    uint8_t digest[32];                       /**< Pinned SHA-256 of the text */
+    uint32_t flags;                           /**< WORDLIST_SORTED etc. (once loaded) */
+    const char *words[WORDLIST_WORD_COUNT];   /**< Words (once loaded), in the mapped index */
+    void *map;                                /**< Mapped index, NULL until loaded */
+    size_t map_size;                          /**< Size of the mapping */
+    int state;                                /**< 0 not loaded, 1 loaded, or the load error */
+} wordlist;
+
+/**
+ * @brief Lists of one directory.
+ */
+typedef struct {
+    char dir[WORDLIST_NAME_SIZE];   /**< Directory, e.g. "./wordlists" */
+    wordlist *lists;                /**< Registered lists, manifest order */
+    size_t count;                   /**< Number of lists */
+    int scanned;                    /**< 1 if open had to rescan the directory */
+} wordlist_registry;
+
+/**
+ * @brief Opens the registry of a directory.
+ * @param registry Registry to fill.
+ * @param dir Wordlist directory.
+ * @return WORDLIST_OK, or a negative error code if there is neither a
+ *         manifest nor a valid list to register.
+ * @note A missing manifest is created from the valid lists of the directory
+ *       (trust on first use). Files whose digest later changes are refused,
+ *       not re-pinned; remove their line from the manifest to accept them.
+ */
+int wordlist_registry_open(wordlist_registry *registry, const char *dir);
+
+/**
+ * @brief Unmaps all lists and frees the registry.
+ * @param registry Registry to close (can be zero-initialized).
+ */
+void wordlist_registry_close(wordlist_registry *registry);
+
+/**
+ * @brief Finds a list by file name.
+ * @param registry Registry.
+ * @param name File name, e.g. "english.txt".
+ * @return Position in registry->lists, or -1.
+ */
+int wordlist_registry_find(const wordlist_registry *registry, const char *name);
+
+/**
+ * @brief Returns a list, mapping and checking it on first use.
+ * @param registry Registry.
+ * @param position Position in registry->lists.
+ * @param error Set to the load error when NULL is returned (can be NULL).
+ * @return The loaded list, or NULL.
+ * @note The first call hashes the text and maps the index, rebuilding and
+ *       validating it if it is missing, corrupt or built from other text.
+ *       A failed load is remembered and not retried.
+ */
+const wordlist *wordlist_registry_get(wordlist_registry *registry, size_t position, int *error);
+
+/**
+ * @brief Looks a word up in a loaded list.
+ * @param list Loaded list.
+ * @param word Word.
+ * @return Index of the word, or -1. Binary search when the list is sorted.
+ */
+int wordlist_index_of(const wordlist *list, const char *word);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORDLIST_H